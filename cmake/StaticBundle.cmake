@@ -48,6 +48,31 @@ set(protobuf_BUILD_PROTOC_BINARIES ON CACHE BOOL "" FORCE)
 set(protobuf_INSTALL OFF CACHE BOOL "" FORCE)
 FetchContent_MakeAvailable(protobuf)
 
+# musl's malloc is slow and takes a global lock, and protobuf decode and PayloadBuilder
+# allocate per metric. This option compiles mimalloc's single-object build
+# (which defines malloc/free and friends) into the bundle. A program linking the
+# bundle ahead of libc then resolves malloc to mimalloc.
+option(SPARKPLUG_BUNDLE_MIMALLOC "Bundle mimalloc as the process allocator" OFF)
+
+if(SPARKPLUG_BUNDLE_MIMALLOC)
+    FetchContent_Declare(
+        mimalloc
+        GIT_REPOSITORY https://github.com/microsoft/mimalloc.git
+        GIT_TAG v2.1.7
+        GIT_SHALLOW TRUE
+    )
+    set(MI_OVERRIDE ON CACHE BOOL "" FORCE)
+    set(MI_BUILD_OBJECT ON CACHE BOOL "" FORCE)
+    set(MI_BUILD_STATIC OFF CACHE BOOL "" FORCE)
+    set(MI_BUILD_SHARED OFF CACHE BOOL "" FORCE)
+    set(MI_BUILD_TESTS OFF CACHE BOOL "" FORCE)
+    if(EXISTS "/lib/ld-musl-${CMAKE_SYSTEM_PROCESSOR}.so.1")
+        set(MI_LIBC_MUSL ON CACHE BOOL "" FORCE)
+    endif()
+    FetchContent_MakeAvailable(mimalloc)
+    set_target_properties(mimalloc-obj PROPERTIES POSITION_INDEPENDENT_CODE ON)
+endif()
+
 # Note: protoc target is now available as 'protoc' (not protobuf::protoc in this version)
 # The proto/CMakeLists.txt will use this target
 include(${protobuf_SOURCE_DIR}/cmake/protobuf-generate.cmake)
@@ -58,9 +83,31 @@ function(create_static_bundle)
         ${CMAKE_CURRENT_SOURCE_DIR}/edge_node.cpp
         ${CMAKE_CURRENT_SOURCE_DIR}/topic.cpp
         ${CMAKE_CURRENT_SOURCE_DIR}/host_application.cpp
+        ${CMAKE_CURRENT_SOURCE_DIR}/sink.cpp
+        ${CMAKE_CURRENT_SOURCE_DIR}/json_encoder.cpp
+        ${CMAKE_CURRENT_SOURCE_DIR}/shm_ring.cpp
+        ${CMAKE_CURRENT_SOURCE_DIR}/tag_table.cpp
+        ${CMAKE_CURRENT_SOURCE_DIR}/window_aggregator.cpp
+        ${CMAKE_CURRENT_SOURCE_DIR}/edge_node_pool.cpp
+        ${CMAKE_CURRENT_SOURCE_DIR}/command_tracker.cpp
+        ${CMAKE_CURRENT_SOURCE_DIR}/state_replication.cpp
+        ${CMAKE_CURRENT_SOURCE_DIR}/stale_monitor.cpp
+        ${CMAKE_CURRENT_SOURCE_DIR}/metric_aggregates.cpp
+        ${CMAKE_CURRENT_SOURCE_DIR}/alarm_engine.cpp
+        ${CMAKE_CURRENT_SOURCE_DIR}/derived_metrics.cpp
+        ${CMAKE_CURRENT_SOURCE_DIR}/lifecycle_events.cpp
+        ${CMAKE_CURRENT_SOURCE_DIR}/subscription_manager.cpp
+        ${CMAKE_CURRENT_SOURCE_DIR}/resync_tracker.cpp
+        ${CMAKE_CURRENT_SOURCE_DIR}/node_state_budget.cpp
+        ${CMAKE_CURRENT_SOURCE_DIR}/alias_table_cache.cpp
         ${CMAKE_CURRENT_SOURCE_DIR}/c_bindings.cpp
     )
 
+    if(SPARKPLUG_NATIVE_MQTT)
+        target_sources(sparkplug_bundle_objects
+            PRIVATE ${CMAKE_CURRENT_SOURCE_DIR}/mqtt_client.cpp)
+    endif()
+
     target_include_directories(sparkplug_bundle_objects
         PUBLIC
             $<BUILD_INTERFACE:${CMAKE_SOURCE_DIR}/include>
@@ -70,7 +117,7 @@ function(create_static_bundle)
     target_link_libraries(sparkplug_bundle_objects
         PUBLIC
             sparkplug_proto
-            libprotobuf
+            ${SPARKPLUG_PROTOBUF_LIBRARY}
             tl::expected
         PRIVATE
             paho-mqtt3as-static
@@ -81,6 +128,10 @@ function(create_static_bundle)
         $<TARGET_OBJECTS:sparkplug_proto>
     )
 
+    if(SPARKPLUG_BUNDLE_MIMALLOC)
+        target_sources(sparkplug_c_bundle PRIVATE $<TARGET_OBJECTS:mimalloc-obj>)
+    endif()
+
     set_target_properties(sparkplug_c_bundle PROPERTIES
         OUTPUT_NAME "sparkplug_c_bundle"
         POSITION_INDEPENDENT_CODE ON
@@ -90,7 +141,7 @@ function(create_static_bundle)
 
     target_link_libraries(sparkplug_c_bundle PUBLIC
         paho-mqtt3as-static
-        libprotobuf
+        ${SPARKPLUG_PROTOBUF_LIBRARY}
         OpenSSL::SSL
         OpenSSL::Crypto
     )
@@ -100,5 +151,8 @@ function(create_static_bundle)
         ARCHIVE DESTINATION lib
     )
 
+    if(SPARKPLUG_BUNDLE_MIMALLOC)
+        message(STATUS "Static bundle allocator: mimalloc")
+    endif()
     message(STATUS "Static bundle created: sparkplug_c_bundle (bundles Paho, Protobuf, Abseil)")
 endfunction()
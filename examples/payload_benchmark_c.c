@@ -0,0 +1,109 @@
+// examples/payload_benchmark_c.c - Payload encode/decode throughput through the C API
+//
+// Builds, serializes, parses and frees a typical NDATA payload in a loop on one
+// or more threads. Almost all of the time goes to protobuf and the allocator, so
+// this is the number to compare when changing the allocator (e.g. the musl static
+// bundle with and without SPARKPLUG_BUNDLE_MIMALLOC).
+//
+// Usage: payload_benchmark_c [threads] [payloads_per_thread]
+#include <sparkplug/sparkplug_c.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define METRICS_PER_PAYLOAD 20
+
+typedef struct {
+  long payloads;
+  size_t bytes;
+  int failed;
+} worker_t;
+
+static double now_seconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void* run_worker(void* arg) {
+  worker_t* worker = (worker_t*)arg;
+  static const char* names[METRICS_PER_PAYLOAD] = {
+      "Line/Temperature", "Line/Pressure",  "Line/Flow",       "Line/Level",
+      "Line/Speed",       "Line/Torque",    "Line/Current",    "Line/Voltage",
+      "Line/Power",       "Line/Energy",    "Line/Vibration",  "Line/Humidity",
+      "Line/Count",       "Line/Rejects",   "Line/Runtime",    "Line/Downtime",
+      "Line/State",       "Line/Recipe",    "Line/Operator",   "Line/Active"};
+  uint8_t buffer[4096];
+
+  for (long i = 0; i < worker->payloads; i++) {
+    sparkplug_payload_t* payload = sparkplug_payload_create();
+    sparkplug_payload_set_timestamp(payload, 1700000000000ULL + (uint64_t)i);
+    sparkplug_payload_set_seq(payload, (uint64_t)(i & 0xFF));
+    for (int m = 0; m < 12; m++) {
+      sparkplug_payload_add_double(payload, names[m], 20.0 + (double)m + (double)i);
+    }
+    for (int m = 12; m < 16; m++) {
+      sparkplug_payload_add_int64(payload, names[m], i * m);
+    }
+    sparkplug_payload_add_string(payload, names[16], "RUNNING");
+    sparkplug_payload_add_string(payload, names[17], "Recipe-0042");
+    sparkplug_payload_add_string(payload, names[18], "operator@plant");
+    sparkplug_payload_add_bool(payload, names[19], (i & 1) != 0);
+
+    size_t size = sparkplug_payload_serialize(payload, buffer, sizeof(buffer));
+    sparkplug_payload_destroy(payload);
+
+    sparkplug_payload_t* decoded = size > 0 ? sparkplug_payload_parse(buffer, size) : NULL;
+    if (!decoded || sparkplug_payload_get_metric_count(decoded) != METRICS_PER_PAYLOAD) {
+      worker->failed = 1;
+    }
+    sparkplug_payload_destroy(decoded);
+    worker->bytes += size;
+  }
+  return NULL;
+}
+
+int main(int argc, char** argv) {
+  int threads = argc > 1 ? atoi(argv[1]) : 1;
+  long payloads = argc > 2 ? atol(argv[2]) : 200000;
+  if (threads < 1 || threads > 256 || payloads < 1) {
+    fprintf(stderr, "Usage: %s [threads 1-256] [payloads_per_thread]\n", argv[0]);
+    return 1;
+  }
+
+  worker_t* workers = calloc((size_t)threads, sizeof(worker_t));
+  pthread_t* ids = calloc((size_t)threads, sizeof(pthread_t));
+  if (!workers || !ids) {
+    return 1;
+  }
+
+  double start = now_seconds();
+  for (int t = 0; t < threads; t++) {
+    workers[t].payloads = payloads;
+    pthread_create(&ids[t], NULL, run_worker, &workers[t]);
+  }
+  size_t bytes = 0;
+  int failed = 0;
+  for (int t = 0; t < threads; t++) {
+    pthread_join(ids[t], NULL);
+    bytes += workers[t].bytes;
+    failed |= workers[t].failed;
+  }
+  double elapsed = now_seconds() - start;
+
+  double total = (double)payloads * threads;
+  printf("threads=%d payloads=%.0f metrics/payload=%d avg_bytes=%.0f\n", threads, total,
+         METRICS_PER_PAYLOAD, (double)bytes / total);
+  printf("encode+decode: %.0f payloads/s (%.0f per thread), %.2f us per payload "
+         "per thread\n",
+         total / elapsed, total / elapsed / threads, elapsed * 1e6 / (double)payloads);
+
+  free(ids);
+  free(workers);
+  if (failed) {
+    fprintf(stderr, "Round trip check failed\n");
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,228 @@
+// include/sparkplug/alarm_engine.hpp
+#pragma once
+
+#include "detail/node_key.hpp"
+#include "sparkplug_b.pb.h"
+#include "topic.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace sparkplug {
+
+/**
+ * @brief Alarm state of a metric; the sign gives the direction.
+ */
+enum class AlarmLevel : int8_t {
+  LoLo = -2,
+  Lo = -1,
+  Normal = 0,
+  Hi = 1,
+  HiHi = 2,
+};
+
+/**
+ * @brief Limits applied to every metric whose name matches a pattern.
+ */
+struct AlarmLimits {
+  std::string pattern{};        ///< Metric name glob ('*' any run, '?' one character)
+  std::optional<double> hihi{}; ///< HiHi when value >= hihi
+  std::optional<double> hi{};   ///< Hi when value >= hi
+  std::optional<double> lo{};   ///< Lo when value <= lo
+  std::optional<double> lolo{}; ///< LoLo when value <= lolo
+  double deadband{0.0};         ///< Distance back past a limit needed to leave it
+  /// Time a worse level must persist before it is raised
+  std::chrono::milliseconds delay_on{0};
+};
+
+/**
+ * @brief An alarm transition emitted by AlarmEngine.
+ */
+struct AlarmEvent {
+  std::string group_id;
+  std::string edge_node_id;
+  std::string device_id;   ///< Empty for node metrics
+  std::string metric_name;
+  AlarmLevel previous{AlarmLevel::Normal};
+  AlarmLevel level{AlarmLevel::Normal};
+  double value{0.0};       ///< Value that caused the transition
+  uint64_t timestamp{0};   ///< Metric timestamp, or payload timestamp if absent
+};
+
+/**
+ * @brief Callback invoked for each alarm transition.
+ */
+using AlarmCallback = std::function<void(const AlarmEvent&)>;
+
+/**
+ * @brief Evaluates hi/lo/hihi/lolo limits against host ingest, emitting transitions.
+ *
+ * Limits are registered per metric name pattern and compiled once per NBIRTH or
+ * DBIRTH into a per-node (or per-device) table: the matching limits of each birth
+ * metric are laid out as parallel arrays indexed by a dense slot, with the birth
+ * aliases mapped straight to slots. Pattern matching runs once per distinct
+ * metric name, not per birth.
+ *
+ * For a DATA message the engine gathers (slot, value) pairs, then computes every
+ * new level in one branch-free loop of four comparisons per value. Each slot keeps
+ * its limits with the deadband already applied for its current level, updated
+ * when the level changes, so the loop reads nothing else; only slots whose level
+ * changed take the slow path. Disabled limits are infinities, so they never
+ * compare true.
+ *
+ * Raising (moving to a worse level) waits for AlarmLimits::delay_on if set: the
+ * level must still hold on the next evaluation or poll() after the delay. Clearing
+ * is immediate once the value is back past the limit by the deadband. A rebirth
+ * keeps the level of metrics it redeclares; a death discards the node's tables
+ * without events.
+ *
+ * HostApplication::add_alarm_limits() runs every validated message through
+ * process() on the MQTT thread; HostApplication::check_alarms() calls poll() so
+ * delayed alarms are raised even when their metric stops reporting.
+ *
+ * @par Thread Safety
+ * Not thread-safe; process() and poll() on different threads need a common lock.
+ */
+class AlarmEngine {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  /**
+   * @brief Registers limits; the first matching registration applies to a metric.
+   *
+   * Takes effect for births processed afterwards.
+   */
+  void add_limits(AlarmLimits limits);
+
+  /**
+   * @brief Processes one validated message, appending transitions to `out`.
+   *
+   * Births compile tables and evaluate their values, DATA evaluates, deaths drop
+   * tables. Other message types are ignored.
+   *
+   * @return Number of events appended
+   */
+  size_t process(const Topic& topic,
+                 const org::eclipse::tahu::protobuf::Payload& payload,
+                 std::vector<AlarmEvent>& out,
+                 Clock::time_point now = Clock::now());
+
+  /**
+   * @brief Raises delayed alarms whose delay has elapsed by `now`.
+   *
+   * @return Number of events appended
+   */
+  size_t poll(Clock::time_point now, std::vector<AlarmEvent>& out);
+
+  /**
+   * @brief Discards the tables of an edge node and its devices, without events.
+   *
+   * What an NDEATH does; for state dropped without one (host memory eviction).
+   */
+  void forget(std::string_view group_id, std::string_view edge_node_id);
+
+  /// Metrics with limits across all compiled tables.
+  [[nodiscard]] size_t size() const noexcept {
+    return slots_;
+  }
+
+  /// Metrics currently at a level other than Normal.
+  [[nodiscard]] size_t active() const noexcept {
+    return active_;
+  }
+
+private:
+  static constexpr uint32_t kNoSlot = UINT32_MAX;
+
+  struct StringHash {
+    using is_transparent = void;
+    [[nodiscard]] size_t operator()(std::string_view sv) const noexcept {
+      return std::hash<std::string_view>{}(sv);
+    }
+  };
+
+  // Compiled limits of one node or device; slot-indexed parallel arrays
+  struct Table {
+    std::vector<std::string> names;
+    std::vector<double> hihi, hi, lo, lolo, deadband;
+    // The limits above, moved inward by the deadband while the level is at or
+    // beyond them; what evaluate() compares against
+    std::vector<double> hihi_at, hi_at, lo_at, lolo_at;
+    std::vector<Clock::duration> delay_on;
+    std::vector<int8_t> level;   // Current AlarmLevel
+    std::vector<int8_t> pending; // Level awaiting delay_on (0 = none)
+    std::vector<Clock::time_point> pending_since;
+    std::vector<uint32_t> by_alias; // Dense alias -> slot (compact alias ranges)
+    std::unordered_map<uint64_t, uint32_t> sparse_alias{}; // Otherwise
+    std::unordered_map<std::string_view, uint32_t> by_name{};
+    std::vector<std::string> devices{}; // Node tables: ids of devices with tables
+
+    [[nodiscard]] uint32_t
+    slot_of(const org::eclipse::tahu::protobuf::Payload::Metric& metric) const;
+    // Recomputes the *_at thresholds of a slot from its level
+    void apply_level(uint32_t slot) noexcept;
+  };
+
+  struct Pending {
+    Clock::time_point due;
+    Clock::time_point since;
+    detail::NodeKey key;
+    uint32_t slot;
+    double value;
+    uint64_t timestamp;
+
+    [[nodiscard]] bool operator>(const Pending& other) const noexcept {
+      return due > other.due;
+    }
+  };
+
+  // Key of the node table, or of the device table if `device`
+  static detail::NodeKeyView table_key(const Topic& topic, bool device);
+  static bool glob_match(std::string_view pattern, std::string_view name);
+  int32_t rule_for(const std::string& name);
+  void compile(const Topic& topic,
+               const org::eclipse::tahu::protobuf::Payload& payload);
+  void evaluate(Table& table,
+                const detail::NodeKey& key,
+                const org::eclipse::tahu::protobuf::Payload& payload,
+                Clock::time_point now,
+                std::vector<AlarmEvent>& out);
+  void transition(Table& table,
+                  const detail::NodeKey& key,
+                  uint32_t slot,
+                  int8_t level,
+                  double value,
+                  uint64_t timestamp,
+                  Clock::time_point now,
+                  std::vector<AlarmEvent>& out);
+  void emit(Table& table,
+            const detail::NodeKey& key,
+            uint32_t slot,
+            int8_t level,
+            double value,
+            uint64_t timestamp,
+            std::vector<AlarmEvent>& out);
+  void drop(const detail::NodeKeyView& key);
+
+  std::vector<AlarmLimits> rules_;
+  std::unordered_map<std::string, int32_t, StringHash, std::equal_to<>> rule_cache_;
+  detail::NodeKeyMap<Table> tables_;
+  std::priority_queue<Pending, std::vector<Pending>, std::greater<>> pending_;
+  size_t slots_{0};
+  size_t active_{0};
+
+  // Reused by evaluate() so a DATA message allocates nothing
+  std::vector<uint32_t> scratch_slots_;
+  std::vector<double> scratch_values_;
+  std::vector<uint64_t> scratch_timestamps_;
+  std::vector<int8_t> scratch_levels_;
+};
+
+} // namespace sparkplug
@@ -0,0 +1,96 @@
+// include/sparkplug/alias_table_cache.hpp
+#pragma once
+
+#include "sparkplug_b.pb.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace sparkplug {
+
+/// Metric alias to name, as declared by one NBIRTH or DBIRTH.
+using AliasTable = std::unordered_map<uint64_t, std::string>;
+
+/**
+ * @brief Alias table sharing counters, from AliasTableCache::stats().
+ */
+struct AliasTableStats {
+  size_t tables{0};         ///< Distinct alias tables alive
+  size_t references{0};     ///< Nodes and devices holding one of them
+  size_t bytes{0};          ///< Estimated memory of the distinct tables
+  size_t unshared_bytes{0}; ///< Estimate if every holder had its own copy
+  uint64_t hits{0};         ///< Births that reused an existing table
+  uint64_t misses{0};       ///< Births that created a new table
+};
+
+/**
+ * @brief Interns birth alias tables so nodes with the same schema share one copy.
+ *
+ * Fleets running identical firmware publish identical metric inventories, so
+ * their alias tables are equal. intern() hashes a birth's (alias, name) pairs and
+ * returns the existing table with that content when there is one, otherwise a new
+ * table. A hit is checked against the payload in place, so it allocates nothing.
+ *
+ * Tables are immutable and reference counted. A node whose schema diverges gets a
+ * different table at its next birth; the table it held is untouched for the other
+ * holders and freed with the last of them. The cache only keeps weak references,
+ * and tables it creates report their release, so bytes() is kept exact in O(1).
+ *
+ * Used by HostApplication for node and device alias tables.
+ *
+ * @par Thread Safety
+ * intern() and the accessors need an external lock. Returned tables are
+ * immutable and may be read, and released, from any thread: the byte count they
+ * report to is atomic.
+ */
+class AliasTableCache {
+public:
+  using Handle = std::shared_ptr<const AliasTable>;
+
+  /**
+   * @brief The shared table for the aliased metrics of a birth payload.
+   *
+   * Metrics need both an alias and a name; if an alias repeats, the last name
+   * wins. Returns nullptr when no metric has both.
+   */
+  [[nodiscard]] Handle intern(const org::eclipse::tahu::protobuf::Payload& payload);
+
+  /**
+   * @brief The shared table equal to `table`, or `table` itself if it is new.
+   *
+   * For tables built elsewhere (state replication). A new table is copied into
+   * the cache, so that its release is counted. Returns nullptr for an empty or
+   * null table.
+   */
+  [[nodiscard]] Handle intern(Handle table);
+
+  /// Estimated memory of one table (buckets, nodes and heap strings).
+  [[nodiscard]] static size_t table_bytes(const AliasTable& table) noexcept;
+
+  /// Estimated memory of the distinct tables alive, each counted once; O(1).
+  [[nodiscard]] size_t bytes() const noexcept {
+    return live_bytes_->load(std::memory_order_relaxed);
+  }
+
+  /// Walks the live tables; O(tables).
+  [[nodiscard]] AliasTableStats stats() const;
+
+private:
+  Handle find(uint64_t hash, const AliasTable& table);
+  Handle insert(uint64_t hash, AliasTable table);
+
+  std::unordered_multimap<uint64_t, std::weak_ptr<const AliasTable>> tables_;
+  // Shared with the deleters of created tables, which may outlive the cache or run
+  // on another thread
+  std::shared_ptr<std::atomic<size_t>> live_bytes_{
+      std::make_shared<std::atomic<size_t>>(0)};
+  size_t sweep_at_{64}; // Drop expired entries when tables_ grows to this size
+  uint64_t hits_{0};
+  uint64_t misses_{0};
+};
+
+} // namespace sparkplug
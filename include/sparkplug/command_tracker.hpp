@@ -0,0 +1,170 @@
+// include/sparkplug/command_tracker.hpp
+#pragma once
+
+#include "detail/node_key.hpp"
+#include "sparkplug_b.pb.h"
+#include "topic.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace sparkplug {
+
+/**
+ * @brief Log2-bucketed latency histogram.
+ *
+ * Bucket i counts latencies in [2^i, 2^(i+1)) microseconds (bucket 0 also counts
+ * zero), covering 1 µs to over an hour with 32 counters.
+ */
+struct LatencyHistogram {
+  static constexpr size_t kBuckets = 32;
+
+  std::array<uint64_t, kBuckets> buckets{}; ///< Counts per power-of-two bucket
+  uint64_t count{0};                        ///< Samples recorded
+  std::chrono::microseconds min{0};         ///< Smallest sample
+  std::chrono::microseconds max{0};         ///< Largest sample
+  std::chrono::microseconds total{0};       ///< Sum of all samples
+
+  /// Adds one sample.
+  void record(std::chrono::microseconds latency) noexcept;
+
+  /// Upper bound of the bucket holding quantile `q` (0..1), clamped to max.
+  [[nodiscard]] std::chrono::microseconds percentile(double q) const noexcept;
+
+  /// Mean of all samples (zero if empty).
+  [[nodiscard]] std::chrono::microseconds mean() const noexcept {
+    return count > 0 ? total / static_cast<int64_t>(count) : std::chrono::microseconds(0);
+  }
+};
+
+/**
+ * @brief Command-to-effect counters, reported by CommandTracker::stats().
+ */
+struct CommandLatencyStats {
+  LatencyHistogram latency; ///< Command sent to first DATA carrying the metric
+  uint64_t commands{0};     ///< Metric writes tracked
+  uint64_t matched{0};      ///< Writes answered by a DATA message
+  uint64_t timed_out{0};    ///< Writes not answered within Options::timeout
+  uint64_t superseded{0};   ///< Writes replaced by a newer write before an answer
+  uint64_t untracked{0};    ///< Writes ignored because max_outstanding was reached
+  uint64_t outstanding{0};  ///< Writes currently awaiting an answer
+};
+
+/**
+ * @brief Correlates NCMD/DCMD metric writes with the DATA messages that report them.
+ *
+ * Each written metric is recorded per (group, edge node, device, metric name). The
+ * first subsequent NDATA/DDATA from that node or device carrying the metric
+ * completes the write, and the elapsed time goes into a latency histogram, both
+ * fleet-wide and per edge node. Writes without an answer within Options::timeout
+ * are counted as timed out.
+ *
+ * HostApplication::enable_command_tracking() records the writes of every NCMD/DCMD
+ * it publishes and matches incoming DATA on the MQTT thread.
+ *
+ * @par Thread Safety
+ * All methods are thread-safe: commands are usually sent from application threads
+ * while answers arrive on the MQTT thread, so the tracker locks internally.
+ */
+class CommandTracker {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  /**
+   * @brief Tracking options.
+   */
+  struct Options {
+    std::chrono::milliseconds timeout{5000}; ///< Time allowed for the DATA answer
+    size_t max_outstanding = 100000;         ///< Writes tracked at once
+  };
+
+  CommandTracker();
+  explicit CommandTracker(Options options);
+
+  /**
+   * @brief Records writes of `metrics` to a node (empty device_id) or device.
+   *
+   * A write to a metric that is still outstanding supersedes the earlier one.
+   *
+   * @return Id of this command, for cancel_command()
+   */
+  uint64_t record_command(std::string_view group_id,
+                          std::string_view edge_node_id,
+                          std::string_view device_id,
+                          std::span<const std::string> metrics,
+                          Clock::time_point sent = Clock::now());
+
+  /**
+   * @brief Forgets the writes of one command, e.g. when it failed to publish.
+   *
+   * Only writes still belonging to `command` are affected. A write it superseded
+   * is outstanding again (or timed out, if its deadline passed meanwhile), and no
+   * longer counts as superseded.
+   */
+  void cancel_command(std::string_view group_id,
+                      std::string_view edge_node_id,
+                      std::string_view device_id,
+                      std::span<const std::string> metrics,
+                      uint64_t command);
+
+  /**
+   * @brief Completes outstanding writes answered by an NDATA/DDATA message.
+   *
+   * @param topic Parsed topic (other message types are ignored)
+   * @param payload Decoded payload
+   * @param alias_map Alias table from the matching birth, for alias-only metrics
+   * @param received Arrival time
+   * @return Number of writes completed
+   */
+  size_t match_data(const Topic& topic,
+                    const org::eclipse::tahu::protobuf::Payload& payload,
+                    const std::unordered_map<uint64_t, std::string>* alias_map,
+                    Clock::time_point received = Clock::now());
+
+  /**
+   * @brief Fleet-wide counters (expires overdue writes first).
+   */
+  [[nodiscard]] CommandLatencyStats stats();
+
+  /**
+   * @brief Counters for one edge node and its devices.
+   */
+  [[nodiscard]] CommandLatencyStats stats(std::string_view group_id,
+                                          std::string_view edge_node_id);
+
+private:
+  struct Outstanding {
+    Clock::time_point sent;
+    uint64_t serial{0};
+    // The write this one superseded, restored if this one is cancelled (0 = none)
+    Clock::time_point superseded_sent{};
+    uint64_t superseded_serial{0};
+  };
+
+  struct Deadline {
+    Clock::time_point expires;
+    detail::NodeKey key;
+    uint64_t serial{0};
+  };
+
+  // Stats of the edge node a (group, node, device, metric) key belongs to
+  CommandLatencyStats& node_stats(const detail::NodeKeyView& key);
+  void expire_locked(Clock::time_point now);
+
+  Options options_;
+  mutable std::mutex mutex_;
+  detail::NodeKeyMap<Outstanding> outstanding_; // By (group, node, device, metric)
+  std::deque<Deadline> deadlines_; // In send order; entries for answered writes are stale
+  detail::NodeKeyMap<CommandLatencyStats> per_node_; // By (group, node)
+  CommandLatencyStats totals_;
+  uint64_t next_serial_{1};
+};
+
+} // namespace sparkplug
@@ -0,0 +1,208 @@
+// include/sparkplug/derived_metrics.hpp
+#pragma once
+
+#include "detail/compat.hpp"
+#include "detail/node_key.hpp"
+#include "sparkplug_b.pb.h"
+#include "topic.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace sparkplug {
+
+/**
+ * @brief Defines one derived (calculated) metric.
+ *
+ * The expression combines numbers and metric references with `+ - * /`, unary
+ * minus, parentheses, and `min(a, b, ...)`, `max(a, b, ...)`, `abs(x)`. A
+ * reference is written in braces: `{Energy/Out}` names a metric of the edge node
+ * itself, `{Pump01:Power}` a metric of device Pump01. A reference to the name of
+ * a derived metric added earlier uses that metric's result instead.
+ *
+ * @par Example
+ * @code
+ * host.add_derived_metric({.group_id = "Plant",
+ *                          .name = "Efficiency",
+ *                          .expression = "{Energy/Out} / {Energy/In}"});
+ * @endcode
+ */
+struct DerivedMetricSpec {
+  std::string group_id{};     ///< Group it applies to (empty = every group)
+  std::string edge_node_id{}; ///< Edge node it applies to (empty = every node)
+  std::string name{};         ///< Name of the synthetic metric
+  std::string expression{};   ///< Expression over metric references
+};
+
+/**
+ * @brief A derived metric result emitted by DerivedMetrics.
+ */
+struct DerivedValue {
+  std::string group_id;
+  std::string edge_node_id;
+  std::string name;
+  std::optional<double> value; ///< Empty when an input is unknown (null or device dead)
+  uint64_t timestamp{0};       ///< Timestamp of the message that caused the change
+};
+
+/**
+ * @brief `uuid` of the synthetic NDATA payloads that carry derived metrics.
+ *
+ * HostApplication delivers derived results through Config::message_callback as
+ * an NDATA for the edge node with this uuid and no `seq`.
+ */
+inline constexpr std::string_view DERIVED_PAYLOAD_UUID = "sparkplug-cpp/derived";
+
+/**
+ * @brief Derived metrics recomputed incrementally from host ingest.
+ *
+ * Expressions are parsed once by add() into stack programs. Each NBIRTH compiles
+ * the expressions that apply to the edge node into a dependency graph: every
+ * input reference maps to the expressions that read it, and is reachable from the
+ * birth alias as well as the metric name (DBIRTH adds the device aliases).
+ *
+ * A BIRTH or DATA message updates only the inputs it carries, then recomputes the
+ * expressions marked dirty, in definition order, so a derived metric that feeds
+ * another is always computed first. A result is emitted only when it changes, so
+ * cost follows the change rate rather than the number of nodes or expressions.
+ * A result is unknown (emitted as an empty value) while any input is null or
+ * belongs to a dead device, or when it is not finite (e.g. division by zero);
+ * NDEATH discards the node's graph without events.
+ *
+ * HostApplication::add_derived_metric() processes each validated message on the
+ * MQTT thread and delivers the results as a synthetic NDATA (see
+ * DERIVED_PAYLOAD_UUID).
+ *
+ * @par Thread Safety
+ * Not thread-safe; value() reads the graphs process() updates, so calling it from
+ * another thread needs the same lock.
+ */
+class DerivedMetrics {
+public:
+  using Id = uint32_t;
+
+  /**
+   * @brief Parses and registers a derived metric.
+   *
+   * Takes effect for edge nodes born afterwards.
+   *
+   * @return The new Id, or a description of the syntax error
+   */
+  [[nodiscard]] stdx::expected<Id, std::string> add(DerivedMetricSpec spec);
+
+  /**
+   * @brief Processes one validated message, appending changed results to `out`.
+   *
+   * @return Number of results appended
+   */
+  size_t process(const Topic& topic,
+                 const org::eclipse::tahu::protobuf::Payload& payload,
+                 std::vector<DerivedValue>& out);
+
+  /**
+   * @brief Discards the graph of an edge node, without events.
+   *
+   * What an NDEATH does; for state dropped without one (host memory eviction).
+   */
+  void forget(std::string_view group_id, std::string_view edge_node_id);
+
+  /**
+   * @brief Current result of a derived metric on an edge node.
+   *
+   * @return The value, or std::nullopt if unknown or not compiled for that node
+   */
+  [[nodiscard]] std::optional<double> value(std::string_view group_id,
+                                            std::string_view edge_node_id,
+                                            std::string_view name) const;
+
+  /// Registered derived metrics.
+  [[nodiscard]] size_t size() const noexcept {
+    return specs_.size();
+  }
+
+  /// Compiled (edge node, derived metric) pairs.
+  [[nodiscard]] size_t instances() const noexcept {
+    return instances_;
+  }
+
+private:
+  static constexpr int32_t kNoDerived = -1;
+
+  enum class OpCode : uint8_t { Constant, Input, Add, Sub, Mul, Div, Neg, Min, Max, Abs };
+
+  struct Op {
+    OpCode code;
+    uint32_t input{0};
+    double constant{0.0};
+  };
+
+  struct Reference {
+    std::string device_id;
+    std::string metric_name;
+    int32_t derived{kNoDerived}; // Earlier spec whose result this reads
+  };
+
+  struct Spec {
+    DerivedMetricSpec spec;
+    std::vector<Op> program;
+    std::vector<Reference> refs;
+    size_t stack_depth{0};
+  };
+
+  struct Input {
+    uint32_t instance;
+    uint32_t ref;
+  };
+
+  // One spec compiled for one edge node
+  struct Instance {
+    Id spec;
+    std::vector<double> inputs;
+    std::vector<uint8_t> known;
+    uint32_t missing{0};
+    std::optional<double> value{};
+    bool dirty{false};
+    std::vector<Input> dependents{}; // Instances reading this result
+  };
+
+  struct Node {
+    std::vector<Instance> instances;
+    std::vector<std::vector<Input>> inputs; // Per distinct (device, metric)
+    detail::NodeKeyMap<uint32_t> by_name; // Keyed by input_key()
+    std::unordered_map<uint64_t, uint32_t> by_alias;
+  };
+
+  class Parser;
+
+  // Node::by_name key; the group and node are those of the owning Node
+  static detail::NodeKey input_key(std::string device_id, std::string metric_name) {
+    return {{}, {}, std::move(device_id), std::move(metric_name)};
+  }
+  void compile(const Topic& topic);
+  void apply(Node& node,
+             const Topic& topic,
+             const org::eclipse::tahu::protobuf::Payload& payload);
+  void set_input(Node& node, Input input, std::optional<double> value);
+  void forget_device(Node& node, std::string_view device_id);
+  size_t recompute(Node& node,
+                   const Topic& topic,
+                   uint64_t timestamp,
+                   std::vector<DerivedValue>& out);
+  [[nodiscard]] double evaluate(const Spec& spec, const Instance& instance);
+
+  std::vector<Spec> specs_;
+  detail::NodeKeyMap<Node> nodes_;
+  size_t instances_{0};
+
+  // Reused per message so steady-state DATA allocates nothing
+  std::vector<double> scratch_stack_;
+  std::priority_queue<uint32_t, std::vector<uint32_t>, std::greater<>> dirty_;
+};
+
+} // namespace sparkplug
@@ -0,0 +1,24 @@
+// include/sparkplug/detail/memory_estimate.hpp
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace sparkplug::detail {
+
+/// Heap bytes behind a string (0 while it lives in the small-string buffer).
+[[nodiscard]] inline size_t heap_bytes(const std::string& str) noexcept {
+  const auto* object = reinterpret_cast<const char*>(&str);
+  bool in_place = str.data() >= object && str.data() < object + sizeof(str);
+  return in_place ? 0 : str.capacity() + 1;
+}
+
+/// Hash map estimate: bucket array, plus a node (value, next link, cached hash) per
+/// element. Heap memory owned by the values is not included.
+template <typename Map>
+[[nodiscard]] size_t map_bytes(const Map& map) noexcept {
+  return map.bucket_count() * sizeof(void*) +
+         map.size() * (sizeof(typename Map::value_type) + 2 * sizeof(void*));
+}
+
+} // namespace sparkplug::detail
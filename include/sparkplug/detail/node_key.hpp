@@ -0,0 +1,95 @@
+// include/sparkplug/detail/node_key.hpp
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+namespace sparkplug::detail {
+
+/**
+ * @brief Non-owning form of NodeKey, for lookups that must not allocate.
+ */
+struct NodeKeyView {
+  std::string_view group_id;
+  std::string_view edge_node_id;
+  std::string_view device_id{}; ///< Empty for the node itself
+  std::string_view name{};      ///< Metric name, or empty
+};
+
+/**
+ * @brief Hash map key for an edge node, one of its devices, or a metric of either.
+ *
+ * Fields are stored and compared separately, so an id may contain any character
+ * without two keys colliding. Fields a map does not use are left empty.
+ * NodeKeyHash and NodeKeyEqual are transparent: maps can be probed with a
+ * NodeKeyView.
+ */
+struct NodeKey {
+  std::string group_id;
+  std::string edge_node_id;
+  std::string device_id{}; ///< Empty for the node itself
+  std::string name{};      ///< Metric name, or empty
+
+  NodeKey() = default;
+  NodeKey(std::string group,
+          std::string node,
+          std::string device = {},
+          std::string metric = {})
+      : group_id(std::move(group)), edge_node_id(std::move(node)),
+        device_id(std::move(device)), name(std::move(metric)) {
+  }
+  explicit NodeKey(const NodeKeyView& view)
+      : group_id(view.group_id), edge_node_id(view.edge_node_id),
+        device_id(view.device_id), name(view.name) {
+  }
+
+  [[nodiscard]] NodeKeyView view() const noexcept {
+    return {group_id, edge_node_id, device_id, name};
+  }
+
+  [[nodiscard]] bool operator==(const NodeKey& other) const noexcept = default;
+};
+
+struct NodeKeyHash {
+  using is_transparent = void;
+  [[nodiscard]] size_t operator()(const NodeKeyView& key) const noexcept {
+    std::hash<std::string_view> hash;
+    size_t h = hash(key.group_id);
+    for (auto part : {key.edge_node_id, key.device_id, key.name}) {
+      h ^= hash(part) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    }
+    return h;
+  }
+  [[nodiscard]] size_t operator()(const NodeKey& key) const noexcept {
+    return (*this)(key.view());
+  }
+};
+
+struct NodeKeyEqual {
+  using is_transparent = void;
+  [[nodiscard]] bool operator()(const NodeKeyView& lhs,
+                                const NodeKeyView& rhs) const noexcept {
+    return lhs.group_id == rhs.group_id && lhs.edge_node_id == rhs.edge_node_id &&
+           lhs.device_id == rhs.device_id && lhs.name == rhs.name;
+  }
+  [[nodiscard]] bool operator()(const NodeKey& lhs, const NodeKey& rhs) const noexcept {
+    return lhs == rhs;
+  }
+  [[nodiscard]] bool operator()(const NodeKey& lhs,
+                                const NodeKeyView& rhs) const noexcept {
+    return (*this)(lhs.view(), rhs);
+  }
+  [[nodiscard]] bool operator()(const NodeKeyView& lhs,
+                                const NodeKey& rhs) const noexcept {
+    return (*this)(lhs, rhs.view());
+  }
+};
+
+template <typename T>
+using NodeKeyMap = std::unordered_map<NodeKey, T, NodeKeyHash, NodeKeyEqual>;
+
+} // namespace sparkplug::detail
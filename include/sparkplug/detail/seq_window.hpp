@@ -0,0 +1,84 @@
+// include/sparkplug/detail/seq_window.hpp
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace sparkplug::detail {
+
+/**
+ * @brief Sliding window over the 8-bit Sparkplug seq, for duplicate detection.
+ *
+ * One bit per seq value (256 bits). A seq up to 127 ahead of the highest seen
+ * advances the window, clearing the slots it passes over (they last held values
+ * from the previous wrap); any other seq is behind, or 128 or more ahead after a
+ * loss, and the two cannot be told apart. A never-seen one (reordering) is
+ * accepted once. A seen one is a duplicate only if the message is a redelivery
+ * (MQTT dup flag); otherwise it is taken as a jump ahead and restarts the window,
+ * so that lost messages surface as a sequence gap instead of dropped data.
+ *
+ * Reset at each NBIRTH, so the window belongs to one bdSeq session.
+ *
+ * @note Not thread-safe; callers serialize access.
+ */
+class SeqWindow {
+public:
+  /// Starts a new session whose first seq is `seq`.
+  void reset(uint8_t seq) noexcept {
+    bits_ = {};
+    set(seq);
+    highest_ = seq;
+    primed_ = true;
+  }
+
+  /// Forgets the session; the next accept() starts one.
+  void clear() noexcept {
+    primed_ = false;
+  }
+
+  /// Records `seq`; returns false if it was already seen in this session.
+  [[nodiscard]] bool accept(uint8_t seq, bool redelivery) noexcept {
+    if (!primed_) {
+      reset(seq);
+      return true;
+    }
+    auto ahead = static_cast<uint8_t>(seq - highest_);
+    if (ahead == 0) {
+      return false;
+    }
+    if (ahead < 128) {
+      for (uint8_t k = 1; k < ahead; ++k) {
+        unset(static_cast<uint8_t>(highest_ + k));
+      }
+      set(seq);
+      highest_ = seq;
+      return true;
+    }
+    if (!test(seq)) {
+      set(seq);
+      return true;
+    }
+    if (redelivery) {
+      return false;
+    }
+    reset(seq);
+    return true;
+  }
+
+private:
+  [[nodiscard]] bool test(uint8_t seq) const noexcept {
+    return (bits_[seq >> 6] >> (seq & 63)) & 1u;
+  }
+  void set(uint8_t seq) noexcept {
+    bits_[seq >> 6] |= uint64_t{1} << (seq & 63);
+  }
+  void unset(uint8_t seq) noexcept {
+    bits_[seq >> 6] &= ~(uint64_t{1} << (seq & 63));
+  }
+
+  std::array<uint64_t, 4> bits_{};
+  uint8_t highest_{0};
+  bool primed_{false};
+};
+
+} // namespace sparkplug::detail
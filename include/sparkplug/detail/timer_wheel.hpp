@@ -0,0 +1,297 @@
+// include/sparkplug/detail/timer_wheel.hpp
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace sparkplug::detail {
+
+/**
+ * @brief Hierarchical hashed timer wheel.
+ *
+ * Timers hash into the slots of level 0 by expiry tick. Timers further out go
+ * into overflow levels, each covering `slots` times the span of the one below,
+ * and cascade one level down as their time approaches, so a timer is touched at
+ * most once per level rather than once per revolution. Enough levels are kept to
+ * cover any 64-bit tick count, so no expiry is clamped.
+ *
+ * Scheduling and cancellation are O(1) (timers live in a slab and are linked
+ * intrusively into their bucket), and advance() costs O(ticks elapsed + timers
+ * due + timers cascaded), independent of the number of timers.
+ *
+ * Callbacks run inline from advance() and may schedule or cancel timers,
+ * including their own and others due in the same tick (those then do not fire).
+ *
+ * @note Not thread-safe; callers serialize access.
+ */
+class TimerWheel {
+public:
+  using Clock = std::chrono::steady_clock;
+  using Duration = Clock::duration;
+  using Callback = std::function<void()>;
+
+  static constexpr uint32_t kNil = std::numeric_limits<uint32_t>::max();
+
+  /// Handle returned by schedule(); stale handles are ignored by cancel().
+  struct TimerId {
+    uint32_t index{kNil};
+    uint32_t generation{0};
+  };
+
+  /**
+   * @param tick Resolution; expiries are rounded up to a tick
+   * @param slots Slots per level, rounded up to a power of two
+   * @param start Time of tick 0
+   */
+  TimerWheel(Duration tick, size_t slots, Clock::time_point start = Clock::now())
+      : tick_(tick.count() > 0 ? tick : Duration(1)), start_(start),
+        slot_bits_(slot_bits_for(slots)),
+        levels_((64 + slot_bits_ - 1) / slot_bits_),
+        heads_(levels_ << slot_bits_, kNil) {
+  }
+
+  /**
+   * @brief Schedules `callback` after `delay`, then every `period` if non-zero.
+   *
+   * Expiry is rounded up to the next tick.
+   */
+  TimerId
+  schedule(Duration delay, Callback callback, Duration period = Duration::zero()) {
+    return arm(current_tick_ + ticks_for(delay), std::move(callback), period);
+  }
+
+  /**
+   * @brief Schedules a one-shot `callback` at `expiry`, rounded up to a tick.
+   *
+   * Expiries at or before the current tick fire on the next tick.
+   */
+  TimerId schedule_at(Clock::time_point expiry, Callback callback) {
+    uint64_t ticks = 0;
+    if (expiry > start_) {
+      ticks = static_cast<uint64_t>((expiry - start_ + tick_ - Duration(1)) / tick_);
+    }
+    return arm(std::max(ticks, current_tick_ + 1), std::move(callback), Duration::zero());
+  }
+
+  /**
+   * @brief Cancels a pending timer.
+   *
+   * @return false if the timer already fired (one-shot) or was cancelled
+   */
+  bool cancel(TimerId id) {
+    if (id.index >= timers_.size()) {
+      return false;
+    }
+    auto& timer = timers_[id.index];
+    if (timer.generation != id.generation) {
+      return false;
+    }
+    switch (timer.state) {
+    case State::Linked:
+      unlink(id.index);
+      release(id.index);
+      return true;
+    case State::Due:
+      release(id.index); // Skipped by advance(), which checks the state
+      return true;
+    case State::Running:
+      timer.state = State::Cancelled; // Released by advance() after the callback
+      return true;
+    default:
+      return false;
+    }
+  }
+
+  /**
+   * @brief Fires every timer due by `now`.
+   *
+   * @return Number of callbacks run
+   */
+  size_t advance(Clock::time_point now) {
+    if (now < start_) {
+      return 0;
+    }
+    auto target = static_cast<uint64_t>((now - start_) / tick_);
+    size_t fired = 0;
+
+    while (current_tick_ < target) {
+      if (size_ == 0) {
+        current_tick_ = target; // Nothing to cascade or fire on the way
+        break;
+      }
+      current_tick_++;
+
+      // Highest level first, so timers cascading two levels land in a slot that is
+      // cascaded (or fired) later in this same tick
+      for (size_t level = levels_ - 1; level > 0; --level) {
+        uint64_t span_mask = (uint64_t{1} << (slot_bits_ * level)) - 1;
+        if ((current_tick_ & span_mask) == 0) {
+          cascade(level, slot_of(current_tick_, level));
+        }
+      }
+
+      auto& head = heads_[slot_of(current_tick_, 0)];
+      due_.clear();
+      for (uint32_t index = std::exchange(head, kNil); index != kNil;) {
+        auto& timer = timers_[index];
+        uint32_t next = timer.next;
+        timer.prev = timer.next = kNil;
+        timer.state = State::Due;
+        due_.push_back({index, timer.generation});
+        index = next;
+      }
+
+      // Callbacks may schedule timers and grow the slab, so index, never hold
+      // references across a call
+      for (size_t i = 0; i < due_.size(); ++i) {
+        auto [index, generation] = due_[i];
+        if (timers_[index].generation != generation ||
+            timers_[index].state != State::Due) {
+          continue; // Cancelled by an earlier callback in this tick
+        }
+        timers_[index].state = State::Running;
+        auto callback = std::move(timers_[index].callback);
+        callback();
+        fired++;
+
+        auto& timer = timers_[index];
+        if (timer.state == State::Running && timer.period > Duration::zero()) {
+          timer.callback = std::move(callback);
+          timer.expiry = current_tick_ + ticks_for(timer.period);
+          link(index);
+        } else {
+          release(index);
+        }
+      }
+    }
+    return fired;
+  }
+
+  /// Time at which the next tick is processed.
+  [[nodiscard]] Clock::time_point next_tick() const noexcept {
+    return start_ + tick_ * static_cast<Clock::rep>(current_tick_ + 1);
+  }
+
+  /// Number of pending timers.
+  [[nodiscard]] size_t size() const noexcept {
+    return size_;
+  }
+
+private:
+  enum class State : uint8_t { Free, Linked, Due, Running, Cancelled };
+
+  struct Timer {
+    Callback callback;
+    Duration period{};
+    uint64_t expiry{0}; // Absolute tick
+    uint32_t bucket{0};
+    uint32_t prev{kNil};
+    uint32_t next{kNil};
+    uint32_t generation{0};
+    State state{State::Free};
+  };
+
+  static unsigned slot_bits_for(size_t slots) noexcept {
+    unsigned bits = 1;
+    while (bits < 16 && (size_t{1} << bits) < slots) {
+      bits++;
+    }
+    return bits;
+  }
+
+  [[nodiscard]] uint64_t ticks_for(Duration delay) const noexcept {
+    auto ticks = static_cast<uint64_t>((delay + tick_ - Duration(1)) / tick_);
+    return std::max<uint64_t>(ticks, 1);
+  }
+
+  [[nodiscard]] size_t slot_of(uint64_t tick, size_t level) const noexcept {
+    return static_cast<size_t>(tick >> (slot_bits_ * level)) &
+           ((size_t{1} << slot_bits_) - 1);
+  }
+
+  TimerId arm(uint64_t expiry, Callback callback, Duration period) {
+    uint32_t index;
+    if (!free_.empty()) {
+      index = free_.back();
+      free_.pop_back();
+    } else {
+      index = static_cast<uint32_t>(timers_.size());
+      timers_.emplace_back();
+    }
+    auto& timer = timers_[index];
+    timer.callback = std::move(callback);
+    timer.period = period;
+    timer.expiry = expiry;
+    link(index);
+    size_++;
+    return {index, timer.generation};
+  }
+
+  // Places a timer in the lowest level whose span covers its remaining delay
+  void link(uint32_t index) {
+    auto& timer = timers_[index];
+    uint64_t delta = timer.expiry - current_tick_;
+    size_t level = 0;
+    while (level + 1 < levels_ && delta >= (uint64_t{1} << (slot_bits_ * (level + 1)))) {
+      level++;
+    }
+    timer.bucket =
+        static_cast<uint32_t>((level << slot_bits_) + slot_of(timer.expiry, level));
+    timer.prev = kNil;
+    timer.next = heads_[timer.bucket];
+    if (timer.next != kNil) {
+      timers_[timer.next].prev = index;
+    }
+    heads_[timer.bucket] = index;
+    timer.state = State::Linked;
+  }
+
+  void unlink(uint32_t index) {
+    auto& timer = timers_[index];
+    if (timer.prev != kNil) {
+      timers_[timer.prev].next = timer.next;
+    } else {
+      heads_[timer.bucket] = timer.next;
+    }
+    if (timer.next != kNil) {
+      timers_[timer.next].prev = timer.prev;
+    }
+    timer.prev = timer.next = kNil;
+  }
+
+  void cascade(size_t level, size_t slot) {
+    for (uint32_t index = std::exchange(heads_[(level << slot_bits_) + slot], kNil);
+         index != kNil;) {
+      uint32_t next = timers_[index].next;
+      link(index);
+      index = next;
+    }
+  }
+
+  void release(uint32_t index) {
+    auto& timer = timers_[index];
+    timer.callback = nullptr;
+    timer.state = State::Free;
+    timer.generation++;
+    free_.push_back(index);
+    size_--;
+  }
+
+  Duration tick_;
+  Clock::time_point start_;
+  unsigned slot_bits_;
+  size_t levels_;
+  uint64_t current_tick_{0};
+  std::vector<uint32_t> heads_; // levels_ * slots list heads
+  std::vector<Timer> timers_;
+  std::vector<uint32_t> free_;
+  std::vector<TimerId> due_; // Reused by advance()
+  size_t size_{0};
+};
+
+} // namespace sparkplug::detail
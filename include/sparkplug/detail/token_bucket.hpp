@@ -0,0 +1,79 @@
+// include/sparkplug/detail/token_bucket.hpp
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+
+namespace sparkplug::detail {
+
+/**
+ * @brief Classic token bucket: refills at a sustained rate up to a burst capacity.
+ *
+ * A rate of zero means unlimited. A single cost larger than the capacity is
+ * admitted once the bucket is full (the balance then goes negative), so oversized
+ * messages are delayed rather than starved.
+ *
+ * @note Not thread-safe; callers serialize access.
+ */
+class TokenBucket {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  TokenBucket() = default;
+
+  /**
+   * @param rate Tokens added per second (0 = unlimited)
+   * @param capacity Maximum balance; the bucket starts full
+   */
+  TokenBucket(double rate, double capacity, Clock::time_point now = Clock::now())
+      : rate_(std::max(rate, 0.0)), capacity_(std::max(capacity, 1.0)),
+        tokens_(capacity_), last_(now) {
+  }
+
+  [[nodiscard]] bool unlimited() const noexcept {
+    return rate_ == 0.0;
+  }
+
+  /// Credits tokens accrued since the last refill.
+  void refill(Clock::time_point now) noexcept {
+    if (unlimited() || now <= last_) {
+      return;
+    }
+    std::chrono::duration<double> elapsed = now - last_;
+    tokens_ = std::min(capacity_, tokens_ + elapsed.count() * rate_);
+    last_ = now;
+  }
+
+  /// True if `cost` can be consumed now (call refill() first).
+  [[nodiscard]] bool can_consume(double cost) const noexcept {
+    return unlimited() || tokens_ >= cost || tokens_ >= capacity_;
+  }
+
+  void consume(double cost) noexcept {
+    if (!unlimited()) {
+      tokens_ -= cost;
+    }
+  }
+
+  /// Refills and consumes `cost` if available.
+  [[nodiscard]] bool try_consume(double cost, Clock::time_point now) noexcept {
+    refill(now);
+    if (!can_consume(cost)) {
+      return false;
+    }
+    consume(cost);
+    return true;
+  }
+
+  [[nodiscard]] double tokens() const noexcept {
+    return tokens_;
+  }
+
+private:
+  double rate_{0.0};
+  double capacity_{1.0};
+  double tokens_{1.0};
+  Clock::time_point last_{};
+};
+
+} // namespace sparkplug::detail
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "detail/compat.hpp"
+#include "detail/token_bucket.hpp"
 #include "logging.hpp"
 #include "mqtt_handle.hpp"
 #include "payload_builder.hpp"
@@ -8,6 +9,8 @@
 #include "topic.hpp"
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <functional>
 #include <mutex>
 #include <optional>
@@ -29,6 +32,13 @@ namespace sparkplug {
 using CommandCallback =
     std::function<void(const Topic&, const org::eclipse::tahu::protobuf::Payload&)>;
 
+/**
+ * @brief Callback function type for primary host STATE changes.
+ *
+ * @param online True when the primary host declared itself online, false when offline
+ */
+using PrimaryHostCallback = std::function<void(bool online)>;
+
 /**
  * @brief Sparkplug B Edge Node implementing the complete message lifecycle.
  *
@@ -108,6 +118,89 @@ public:
     bool enable_server_cert_auth = true; ///< Verify server certificate (default: true)
   };
 
+  /**
+   * @brief Connect counters and timings, reported by get_connection_stats().
+   *
+   * Connect time runs from the MQTT connect request to CONNACK: the TCP connect,
+   * any TLS handshake and the broker's reply together. It is not a handshake time;
+   * Paho does not expose one.
+   */
+  struct ConnectionStats {
+    uint64_t connects{0}; ///< Successful connects
+    std::chrono::microseconds last_connect_time{0};  ///< Duration of the last connect
+    std::chrono::microseconds max_connect_time{0};   ///< Slowest connect
+    std::chrono::microseconds total_connect_time{0}; ///< Sum over all connects
+  };
+
+  /**
+   * @brief What happens to NDATA/DDATA that exceeds the data lane's rate limit.
+   */
+  enum class RateLimitPolicy {
+    Reject,  ///< publish_*data() fails with "Rate limit exceeded"
+    Conflate ///< Metrics are held per topic (latest value wins) and sent later
+  };
+
+  /**
+   * @brief Per-node token-bucket limits for the data lane (NDATA/DDATA).
+   *
+   * Births, deaths, commands and payloads published on PublishLane::Priority
+   * bypass the limit, so a flooding driver cannot delay session messages.
+   */
+  struct RateLimitOptions {
+    double messages_per_second = 0.0; ///< Sustained data messages/s (0 = unlimited)
+    double bytes_per_second = 0.0;    ///< Sustained data payload bytes/s (0 = unlimited)
+    double burst_seconds = 1.0;       ///< Bucket depth, in seconds of sustained rate
+    RateLimitPolicy policy = RateLimitPolicy::Reject; ///< Handling of excess data
+  };
+
+  /**
+   * @brief Data lane counters, reported by get_rate_limit_stats().
+   */
+  struct RateLimitStats {
+    uint64_t admitted{0};  ///< Data messages admitted by the limiter
+    uint64_t priority{0};  ///< Data messages sent on the priority lane
+    uint64_t rejected{0};  ///< Data messages refused (RateLimitPolicy::Reject)
+    uint64_t conflated{0}; ///< Data messages folded into a pending payload
+    size_t pending{0};     ///< Topics currently holding conflated metrics
+  };
+
+  /**
+   * @brief Lane a data message is published on.
+   */
+  enum class PublishLane {
+    Data,    ///< Subject to Config::rate_limit
+    Priority ///< Bypasses the limit (e.g., command acknowledgements)
+  };
+
+  /**
+   * @brief Bounded in-memory buffering of publishes across short disconnects.
+   *
+   * Maps onto Paho's MQTTAsync_createWithOptions (sendWhileDisconnected). While the
+   * connection is lost, NDATA/DDATA are queued inside the client and sent after the
+   * next connect(), which reuses the client handle. Births, deaths and commands are
+   * never buffered.
+   *
+   * @note Buffered data reaches the broker ahead of the new session's NBIRTH, so a
+   *       strict Sparkplug host treats it as out-of-session; historians and bridges
+   *       still receive it.
+   */
+  struct OfflineBufferOptions {
+    int max_buffered_messages = 1000; ///< Messages held while disconnected
+    bool delete_oldest = true; ///< When full, drop the oldest (else reject the newest)
+    int max_pending_messages = 0; ///< Pending-token depth at which try_publish_*()
+                                  ///< returns WouldBlock (0 = never)
+  };
+
+  /**
+   * @brief Outcome of try_publish_data() / try_publish_device_data().
+   */
+  enum class PublishStatus {
+    Sent,      ///< Handed to the client for immediate transmission
+    Buffered,  ///< Queued in the offline buffer while disconnected
+    Conflated, ///< Held by RateLimitPolicy::Conflate for a later message
+    WouldBlock ///< Not published: pending depth reached max_pending_messages
+  };
+
   /**
    * @brief Configuration parameters for the Sparkplug B Edge Node.
    */
@@ -132,6 +225,15 @@ public:
     std::optional<CommandCallback> command_callback{};
     std::optional<std::string> primary_host_id{};
     std::optional<LogCallback> log_callback{};
+    std::optional<PrimaryHostCallback>
+        primary_host_callback{}; ///< Called on the MQTT thread when the primary host
+                                 ///< goes online or offline (optional)
+    bool auto_birth = false; ///< Hold births until the primary host is online and
+                             ///< republish them whenever it comes back online
+    std::optional<RateLimitOptions>
+        rate_limit{}; ///< Data lane rate limit (optional, unlimited if unset)
+    std::optional<OfflineBufferOptions>
+        offline_buffer{}; ///< Buffer data across disconnects (optional)
   };
 
   /**
@@ -216,6 +318,9 @@ public:
    *       - All metrics with both name and alias (for NDATA to use aliases)
    *       - bdSeq metric (automatically managed if using rebirth())
    *       - Any metadata or properties
+   * @note With Config::auto_birth, a birth made while the primary host is offline
+   *       succeeds and is held until the host's STATE online arrives; data publishes
+   *       fail until then.
    *
    * @warning Must be called after connect() and before any publish_data() calls.
    *
@@ -241,11 +346,35 @@ public:
    * @note Timestamp is automatically added if not explicitly set.
    * @note The library provides the transport mechanism; you provide the RBE logic.
    *
+   * @note With Config::rate_limit set, payloads on the data lane are subject to the
+   *       token bucket. Under RateLimitPolicy::Conflate an over-limit payload returns
+   *       success and its metrics are sent with the next admitted NDATA (or by
+   *       flush_conflated()); metrics pending from earlier payloads are merged into
+   *       `payload`.
+   *
    * @warning Must call publish_birth() before the first publish_data().
    *
    * @see publish_birth() for establishing aliases
    */
-  [[nodiscard]] stdx::expected<void, std::string> publish_data(PayloadBuilder& payload);
+  [[nodiscard]] stdx::expected<void, std::string>
+  publish_data(PayloadBuilder& payload, PublishLane lane = PublishLane::Data);
+
+  /**
+   * @brief Publishes an NDATA message, reporting how it was handled.
+   *
+   * Like publish_data(), but distinguishes a message sent now from one queued in
+   * the offline buffer, and reports WouldBlock instead of queueing once the
+   * client's pending-token depth reaches OfflineBufferOptions::max_pending_messages.
+   * A WouldBlock payload consumes no sequence number; producers should back off
+   * and retry.
+   *
+   * @param payload PayloadBuilder containing changed metrics (by alias only)
+   * @param lane Data (rate limited) or Priority
+   *
+   * @return Publish status on success, error message on failure
+   */
+  [[nodiscard]] stdx::expected<PublishStatus, std::string>
+  try_publish_data(PayloadBuilder& payload, PublishLane lane = PublishLane::Data);
 
   /**
    * @brief Publishes an NDEATH (Node Death) message.
@@ -300,6 +429,15 @@ public:
     return bd_seq_num_;
   }
 
+  /**
+   * @brief Checks if the MQTT connection is up.
+   *
+   * @return true between a successful connect() and disconnect() or connection loss
+   */
+  [[nodiscard]] bool is_connected() const noexcept {
+    return is_connected_.load(std::memory_order_relaxed);
+  }
+
   /**
    * @brief Checks if the primary host application is online.
    *
@@ -314,6 +452,19 @@ public:
     return primary_host_online_;
   }
 
+  /**
+   * @brief Blocks until the primary host is online or the timeout expires.
+   *
+   * Woken directly by the STATE message, so callers see a transition without
+   * polling is_primary_host_online().
+   *
+   * @param timeout Maximum time to wait
+   *
+   * @return true if the primary host is online (or none is configured and the node
+   * is connected), false on timeout
+   */
+  [[nodiscard]] bool wait_for_primary_host(std::chrono::milliseconds timeout) const;
+
   /**
    * @brief Publishes a DBIRTH (Device Birth) message.
    *
@@ -328,6 +479,8 @@ public:
    * @note Device messages share the node's sequence counter. DBIRTH increments the
    *       sequence number from where NBIRTH left it (NBIRTH=0, DBIRTH=1, etc.).
    * @note Must call publish_birth() before publishing any device births.
+   * @note With Config::auto_birth, the DBIRTH is held like the NBIRTH while the
+   *       primary host is offline (DCMD is subscribed right away).
    *
    * @see publish_device_data() for subsequent device updates
    * @see publish_device_death() for device disconnection
@@ -351,11 +504,51 @@ public:
    * @note Sequence number is automatically incremented per device (0-255, wraps at 256).
    * @note Must call publish_device_birth() before the first publish_device_data().
    * @note The library provides the transport mechanism; you provide the RBE logic.
+   * @note Rate limiting applies as for publish_data().
    *
    * @see publish_device_birth() for establishing aliases
    */
   [[nodiscard]] stdx::expected<void, std::string>
-  publish_device_data(std::string_view device_id, PayloadBuilder& payload);
+  publish_device_data(std::string_view device_id,
+                      PayloadBuilder& payload,
+                      PublishLane lane = PublishLane::Data);
+
+  /**
+   * @brief Publishes a DDATA message, reporting how it was handled.
+   *
+   * @see try_publish_data() for the meaning of each status
+   */
+  [[nodiscard]] stdx::expected<PublishStatus, std::string>
+  try_publish_device_data(std::string_view device_id,
+                          PayloadBuilder& payload,
+                          PublishLane lane = PublishLane::Data);
+
+  /**
+   * @brief Returns the number of messages the MQTT client has not yet completed.
+   *
+   * Includes messages held in the offline buffer. Returns 0 before connect().
+   */
+  [[nodiscard]] int get_pending_messages() const;
+
+  /**
+   * @brief Returns connect counters and timings since construction.
+   */
+  [[nodiscard]] ConnectionStats get_connection_stats() const;
+
+  /**
+   * @brief Publishes metrics held back by RateLimitPolicy::Conflate.
+   *
+   * Pending topics are sent while the data lane has tokens; the rest stay pending.
+   * Call periodically when data arrives in bursts and may then go quiet.
+   *
+   * @return Number of messages published, or an error message
+   */
+  [[nodiscard]] stdx::expected<size_t, std::string> flush_conflated();
+
+  /**
+   * @brief Returns the data lane counters.
+   */
+  [[nodiscard]] RateLimitStats get_rate_limit_stats() const;
 
   /**
    * @brief Publishes a DDEATH (Device Death) message.
@@ -446,6 +639,8 @@ private:
 
   // Store last NBIRTH for rebirth command
   std::vector<uint8_t> last_birth_payload_;
+  // Config::auto_birth: the cached births are waiting for the primary host
+  bool births_deferred_{false};
 
   // Hash and equality functors that support heterogeneous lookup (string_view)
   struct StringHash {
@@ -466,9 +661,25 @@ private:
   // Track state of attached devices (device_id -> state, with heterogeneous lookup)
   std::unordered_map<std::string, DeviceState, StringHash, StringEqual> device_states_;
 
+  // Data lane rate limiting (see Config::rate_limit)
+  detail::TokenBucket message_bucket_;
+  detail::TokenBucket byte_bucket_;
+  RateLimitStats rate_limit_stats_;
+  // Conflated metrics per data topic, keyed by device_id ("" for NDATA)
+  std::unordered_map<std::string,
+                     org::eclipse::tahu::protobuf::Payload,
+                     StringHash,
+                     StringEqual>
+      pending_data_;
+
+  ConnectionStats connection_stats_;
+
   std::atomic<bool> is_connected_{false};
+  // Connection lost with an offline buffer configured; data publishes are queued
+  std::atomic<bool> buffering_{false};
   std::atomic<bool> primary_host_online_{
       false}; // True if primary host is online (or no primary host configured)
+  mutable std::condition_variable primary_host_cv_; // Signalled with mutex_ on changes
 
   // Mutex for thread-safe access to all mutable state
   mutable std::mutex mutex_;
@@ -480,6 +691,33 @@ private:
                   int qos,
                   bool retain);
 
+  // True if the pending-token depth has reached max_pending_messages.
+  [[nodiscard]] bool would_block() const;
+
+  // Merges conflated metrics into `payload`, assigns seq and applies the data lane
+  // limit. Returns false if the payload was conflated; `payload_data` is encoded
+  // only for an admitted payload. Caller must hold mutex_.
+  [[nodiscard]] stdx::expected<bool, std::string>
+  admit_data_locked(std::string_view device_id,
+                    PayloadBuilder& payload,
+                    PublishLane lane,
+                    std::vector<uint8_t>& payload_data);
+
+  // Applies a primary host STATE message (MQTT thread)
+  void on_primary_host_state(bool online);
+
+  // Serializes the conflated topics the data lane has tokens for, each with the
+  // next seq, and removes them from pending_data_. Caller must hold mutex_.
+  void take_conflated_locked(
+      std::vector<std::pair<std::string, std::vector<uint8_t>>>& messages);
+
+  // Config::auto_birth: publishes the cached NBIRTH (with the current bdSeq) and
+  // DBIRTHs of online devices, then the conflated data held since. Caller must
+  // hold mutex_.
+  stdx::expected<void, std::string> publish_cached_births_locked();
+  stdx::expected<void, std::string> publish_cached_device_birth_locked(
+      const std::string& device_id, DeviceState& device);
+
   // Static MQTT callback for message arrived (NCMD)
   static int on_message_arrived(void* context,
                                 char* topicName,
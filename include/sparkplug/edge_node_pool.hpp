@@ -0,0 +1,216 @@
+// include/sparkplug/edge_node_pool.hpp
+#pragma once
+
+#include "detail/timer_wheel.hpp"
+#include "edge_node.hpp"
+#include "payload_builder.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sparkplug {
+
+/**
+ * @brief Hosts many EdgeNodes on shared scheduler, worker and connect threads.
+ *
+ * Intended for protocol converters that run one logical edge node per PLC.
+ * Instead of each node driving its own threads and clock reads, the pool runs:
+ * - One scheduler thread with a hashed timer wheel for all periodic scans,
+ *   reading the clock once per tick and sharing the timestamp with every scan
+ *   due in that tick. Scan phases are spread across the period.
+ * - A shared worker pool that runs scan callbacks and encodes/publishes NDATA,
+ *   reusing PayloadBuilders from a shared free list.
+ * - A connect orchestrator that starts at most one connect per
+ *   Options::connect_interval, with at most Options::max_concurrent_connects in
+ *   flight, and retries failures with jittered exponential backoff, so a broker
+ *   restart does not produce a thundering herd of reconnects.
+ *
+ * @par Thread Safety
+ * add_node() and add_scan() must be called before start(). Other methods may be
+ * called from any thread. Callbacks run on pool threads; a scan never runs
+ * concurrently with itself (a tick that finds it still running is skipped).
+ *
+ * @par Example Usage
+ * @code
+ * sparkplug::EdgeNodePool pool({.worker_threads = 4, .max_concurrent_connects = 16});
+ * for (const auto& plc : plcs) {
+ *   auto id = pool.add_node({.broker_url = "tcp://broker:1883",
+ *                            .client_id = plc.name,
+ *                            .group_id = "Plant1",
+ *                            .edge_node_id = plc.name},
+ *                           [&plc](sparkplug::PayloadBuilder& birth) {
+ *                             plc.add_birth_metrics(birth);
+ *                           });
+ *   pool.add_scan(id, std::chrono::milliseconds(500),
+ *                 [&plc](sparkplug::PayloadBuilder& data, uint64_t timestamp) {
+ *                   plc.read_changes(data, timestamp);
+ *                 });
+ * }
+ * pool.start();
+ * @endcode
+ */
+class EdgeNodePool {
+public:
+  /**
+   * @brief Pool sizing and connect pacing.
+   */
+  struct Options {
+    size_t worker_threads = 2;          ///< Threads running scans and publishes
+    size_t max_concurrent_connects = 8; ///< Connects (and births) in flight at once
+    std::chrono::milliseconds connect_interval{20}; ///< Spacing between connect starts
+    std::chrono::milliseconds reconnect_min{1000};  ///< First retry delay
+    std::chrono::milliseconds reconnect_max{60000}; ///< Retry delay cap
+    std::chrono::milliseconds tick{10};             ///< Timer wheel resolution
+    size_t wheel_slots = 1024; ///< Timer wheel slots per level (power of two)
+  };
+
+  /**
+   * @brief Pool-wide counters, reported by get_stats().
+   */
+  struct Stats {
+    size_t nodes{0};              ///< Nodes in the pool
+    size_t online{0};             ///< Nodes connected with NBIRTH published
+    size_t connecting{0};         ///< Connects currently in flight
+    uint64_t connect_failures{0}; ///< Failed connect or birth attempts
+    uint64_t scans{0};            ///< Scan callbacks run
+    uint64_t scans_skipped{0};    ///< Ticks skipped (node offline or scan busy)
+    uint64_t publishes{0};        ///< NDATA messages published by scans
+    uint64_t publish_failures{0}; ///< NDATA publishes that failed
+  };
+
+  using NodeId = size_t;
+
+  /// Fills the NBIRTH payload for a node (called before every birth)
+  using BirthCallback = std::function<void(PayloadBuilder&)>;
+
+  /// Fills an NDATA payload; nothing is published if no metrics are added
+  using ScanCallback = std::function<void(PayloadBuilder&, uint64_t timestamp)>;
+
+  EdgeNodePool();
+  explicit EdgeNodePool(Options options);
+
+  /**
+   * @brief Stops the pool and disconnects all online nodes.
+   */
+  ~EdgeNodePool();
+
+  EdgeNodePool(const EdgeNodePool&) = delete;
+  EdgeNodePool& operator=(const EdgeNodePool&) = delete;
+  EdgeNodePool(EdgeNodePool&&) = delete;
+  EdgeNodePool& operator=(EdgeNodePool&&) = delete;
+
+  /**
+   * @brief Adds a node. It is connected and birthed by the orchestrator after
+   * start().
+   *
+   * @return Id for add_scan(), node() and is_online()
+   */
+  NodeId add_node(EdgeNode::Config config, BirthCallback birth);
+
+  /**
+   * @brief Adds a periodic scan for a node.
+   *
+   * @param node Id returned by add_node()
+   * @param period Scan period (rounded up to the pool tick)
+   * @param scan Called on a worker thread while the node is online
+   */
+  void add_scan(NodeId node, std::chrono::milliseconds period, ScanCallback scan);
+
+  /**
+   * @brief Starts the scheduler, workers and connect orchestration. Idempotent.
+   */
+  void start();
+
+  /**
+   * @brief Stops all pool threads and disconnects online nodes. Idempotent.
+   */
+  void stop();
+
+  /**
+   * @brief Direct access to a node (e.g., for commands or device messages).
+   */
+  [[nodiscard]] EdgeNode& node(NodeId id);
+
+  /**
+   * @brief True once the node is connected and its NBIRTH published.
+   */
+  [[nodiscard]] bool is_online(NodeId id) const;
+
+  /**
+   * @brief Returns a snapshot of the pool counters.
+   */
+  [[nodiscard]] Stats get_stats() const;
+
+private:
+  enum class NodeState { Idle, Queued, Connecting, Online };
+
+  struct Node {
+    std::unique_ptr<EdgeNode> edge_node;
+    BirthCallback birth;
+    std::atomic<NodeState> state{NodeState::Idle};
+    uint32_t failures{0}; // Consecutive failures, drives backoff (mutex_)
+  };
+
+  struct Scan {
+    NodeId node;
+    std::chrono::milliseconds period;
+    ScanCallback callback;
+    std::atomic<bool> busy{false};
+  };
+
+  // Fixed set of threads draining a FIFO of jobs.
+  class Workers {
+  public:
+    void start(size_t threads);
+    void post(std::function<void()> job);
+    void stop();
+
+  private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::function<void()>> jobs_;
+    std::vector<std::thread> threads_;
+    bool stopping_{false};
+  };
+
+  Options options_;
+  std::vector<std::unique_ptr<Node>> nodes_;
+  std::vector<std::unique_ptr<Scan>> scans_;
+
+  mutable std::mutex mutex_; // Timer wheel, connect queue, builder pool, lifecycle
+  std::condition_variable cv_;
+  detail::TimerWheel wheel_;
+  std::deque<NodeId> connect_queue_;
+  std::vector<std::unique_ptr<PayloadBuilder>> free_builders_;
+  uint64_t tick_timestamp_{0}; // Epoch ms read once per scheduler tick
+  bool running_{false};
+  bool stopping_{false};
+  std::thread scheduler_;
+  Workers workers_;
+  Workers connectors_;
+
+  std::atomic<size_t> connecting_{0};
+  std::atomic<uint64_t> connect_failures_{0};
+  std::atomic<uint64_t> scans_run_{0};
+  std::atomic<uint64_t> scans_skipped_{0};
+  std::atomic<uint64_t> publishes_{0};
+  std::atomic<uint64_t> publish_failures_{0};
+
+  void run_scheduler();
+  void dispatch_connects();
+  void connect_node(NodeId id);
+  void schedule_retry_locked(NodeId id);
+  void run_scan(Scan& scan, uint64_t timestamp);
+  std::unique_ptr<PayloadBuilder> acquire_builder(uint64_t timestamp);
+  void release_builder(std::unique_ptr<PayloadBuilder> builder);
+};
+
+} // namespace sparkplug
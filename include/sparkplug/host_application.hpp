@@ -1,20 +1,39 @@
 #pragma once
 
+#include "alarm_engine.hpp"
+#include "alias_table_cache.hpp"
+#include "command_tracker.hpp"
+#include "derived_metrics.hpp"
 #include "detail/compat.hpp"
+#include "detail/node_key.hpp"
+#include "detail/seq_window.hpp"
+#include "json_encoder.hpp"
+#include "lifecycle_events.hpp"
 #include "logging.hpp"
+#include "metric_aggregates.hpp"
 #include "mqtt_handle.hpp"
+#include "node_state_budget.hpp"
 #include "payload_builder.hpp"
+#include "resync_tracker.hpp"
+#include "shm_ring.hpp"
+#include "sink.hpp"
 #include "sparkplug_b.pb.h"
+#include "stale_monitor.hpp"
+#include "subscription_manager.hpp"
 #include "topic.hpp"
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <functional>
 #include <memory>
 #include <mutex>
 #include <optional>
 #include <span>
 #include <string>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 #include <MQTTAsync.h>
 
@@ -30,6 +49,28 @@ namespace sparkplug {
 using MessageCallback =
     std::function<void(const Topic&, const org::eclipse::tahu::protobuf::Payload&)>;
 
+/**
+ * @brief Why an edge node or device was last marked offline.
+ */
+enum class OfflineReason : uint8_t {
+  None,    ///< Online, or never went offline
+  Death,   ///< NDEATH or DDEATH received
+  Timeout, ///< Silent past the stale detection timeout
+};
+
+/**
+ * @brief Callback invoked when an edge node or device goes offline.
+ *
+ * @param group_id The group ID
+ * @param edge_node_id The edge node ID
+ * @param device_id The device ID (empty for the edge node itself)
+ * @param reason Death message or stale timeout
+ */
+using OfflineCallback = std::function<void(std::string_view group_id,
+                                           std::string_view edge_node_id,
+                                           std::string_view device_id,
+                                           OfflineReason reason)>;
+
 /**
  * @brief Sparkplug B Host Application for SCADA/Primary Applications.
  *
@@ -108,6 +149,19 @@ public:
     bool enable_server_cert_auth = true; ///< Verify server certificate (default: true)
   };
 
+  /**
+   * @brief Connect counters and timings, reported by get_connection_stats().
+   *
+   * @see EdgeNode::ConnectionStats
+   */
+  struct ConnectionStats {
+    uint64_t connects{0};   ///< Successful connects
+    uint64_t reconnects{0}; ///< Automatic reconnects (enable_auto_reconnect())
+    std::chrono::microseconds last_connect_time{0};  ///< Duration of the last connect
+    std::chrono::microseconds max_connect_time{0};   ///< Slowest connect
+    std::chrono::microseconds total_connect_time{0}; ///< Sum over all connects
+  };
+
   /**
    * @brief Tracks the state of a device attached to an edge node.
    */
@@ -117,8 +171,9 @@ public:
     bool birth_received{false};    ///< True if DBIRTH has been received
     uint64_t offline_timestamp{0}; ///< Timestamp when device went offline (from DDEATH)
     bool metrics_stale{false};     ///< True if metrics marked stale after DDEATH
-    std::unordered_map<uint64_t, std::string>
-        alias_map; ///< Maps metric alias to name (from DBIRTH)
+    OfflineReason offline_reason{OfflineReason::None}; ///< Why the device went offline
+    AliasTableCache::Handle
+        alias_map; ///< Metric alias to name from DBIRTH, shared (nullptr if none)
   };
 
   /**
@@ -144,10 +199,13 @@ public:
     uint64_t bd_seq{0};          ///< Current birth/death sequence number
     uint64_t birth_timestamp{0}; ///< Timestamp of last NBIRTH
     bool birth_received{false};  ///< True if NBIRTH has been received
+    OfflineReason offline_reason{OfflineReason::None}; ///< Why the node went offline
     std::unordered_map<std::string, DeviceState, TransparentStringHash, std::equal_to<>>
         devices; ///< Attached devices (device_id -> state)
-    std::unordered_map<uint64_t, std::string>
-        alias_map; ///< Maps metric alias to name (from NBIRTH)
+    AliasTableCache::Handle
+        alias_map; ///< Metric alias to name from NBIRTH, shared (nullptr if none)
+    detail::SeqWindow seq_window; ///< Seq values seen since NBIRTH (duplicate filter)
+    bool evicted{false}; ///< Alias tables and devices dropped by the memory budget
   };
 
   /**
@@ -166,6 +224,10 @@ public:
                             ///< (default: 100, paho default: 10)
     bool validate_sequence =
         true; ///< Enable sequence number validation (detects packet loss)
+    size_t subscribe_batch_size = 100; ///< Topic filters per SUBSCRIBE/UNSUBSCRIBE
+    bool suppress_duplicates =
+        true; ///< Drop messages whose seq was already seen (QoS 1 redeliveries);
+              ///< only with validate_sequence
     std::optional<TlsOptions>
         tls{}; ///< TLS/SSL options (required if broker_url uses ssl://)
     std::optional<std::string>
@@ -174,6 +236,9 @@ public:
         password{};                     ///< MQTT password for authentication (optional)
     MessageCallback message_callback{}; ///< Callback for received Sparkplug messages
     LogCallback log_callback{};         ///< Optional callback for library log messages
+    OfflineCallback offline_callback{}; ///< Optional callback for nodes/devices going
+                                        ///< offline (death or stale timeout)
+    AlarmCallback alarm_callback{};     ///< Optional callback for alarm transitions
   };
 
   /**
@@ -235,6 +300,354 @@ public:
    */
   void set_log_callback(LogCallback callback);
 
+  /**
+   * @brief Attaches a batching sink that receives decoded metric records.
+   *
+   * Every validated NBIRTH/NDATA/DBIRTH/DDATA message is flattened into
+   * MetricRecords (alias-resolved) and handed to the sink through a SinkPipeline
+   * running on its own thread. With BackpressurePolicy::Block, a sink that falls
+   * behind past its high-water mark stalls message ingest until it catches up.
+   *
+   * @param sink Sink implementation (e.g., FileSink)
+   * @param options Batch size, flush interval and backpressure options
+   * @return void on success; an error if connect() has been called (message
+   *         callbacks read the sink list without a lock)
+   *
+   * @note Queued records are written when the HostApplication is destroyed.
+   */
+  [[nodiscard]] stdx::expected<void, std::string>
+  add_sink(std::shared_ptr<Sink> sink, SinkOptions options = {});
+
+  /**
+   * @brief Fans validated messages out to local processes through shared memory.
+   *
+   * Every validated Sparkplug message (BIRTH, DATA, DEATH, CMD) is encoded once,
+   * with metric names resolved from the birth alias tables, and written to the
+   * ring. Consumer processes attach with ShmRingReader instead of opening their
+   * own broker subscriptions.
+   *
+   * @param ring Ring writer, or nullptr to detach
+   *
+   * @note Must be called before connect().
+   */
+  void set_shm_ring(std::shared_ptr<ShmRingWriter> ring);
+
+  /**
+   * @brief Measures command-to-effect latency of NCMD/DCMD metric writes.
+   *
+   * Each metric written by publish_node_command() or publish_device_command() is
+   * recorded per (node, device, metric) and completed by the first NDATA/DDATA
+   * from that node or device carrying the metric; see CommandTracker. Node
+   * Control/ and Device Control/ metrics are not tracked (they are answered by
+   * births, not DATA).
+   *
+   * @param options Answer timeout and tracking limit
+   * @return void on success; an error if tracking is already enabled or connect()
+   *         has been called (the tracker is in use from then on)
+   */
+  [[nodiscard]] stdx::expected<void, std::string>
+  enable_command_tracking(CommandTracker::Options options = {});
+
+  /**
+   * @brief Fleet-wide command latency histogram and counters.
+   *
+   * Empty unless enable_command_tracking() was called.
+   */
+  [[nodiscard]] CommandLatencyStats get_command_latency() const;
+
+  /**
+   * @brief Command latency histogram and counters for one edge node and its devices.
+   */
+  [[nodiscard]] CommandLatencyStats
+  get_command_latency(std::string_view group_id, std::string_view edge_node_id) const;
+
+  /**
+   * @brief Registers a group or edge node aggregate over one metric.
+   *
+   * The aggregate combines the latest value of `spec.metric_name` from every node
+   * and device in the group (or under the one edge node) into sum, count, min,
+   * max and mean, updated in O(1) per value as BIRTH/DATA messages arrive. Deaths
+   * withdraw the node's or device's values. Stale timeouts (see
+   * enable_stale_detection()) withdraw them until the node or device resumes, when
+   * its last values count again. See MetricAggregates.
+   *
+   * @param spec Group, optional edge node, and metric name
+   *
+   * @return Id for get_aggregate()
+   *
+   * @note Aggregates start empty; register them before connect() to include births.
+   */
+  MetricAggregates::Id add_aggregate(AggregateSpec spec);
+
+  /**
+   * @brief Current value of an aggregate registered with add_aggregate().
+   *
+   * @return The value, or std::nullopt for an unknown id
+   */
+  [[nodiscard]] std::optional<AggregateValue>
+  get_aggregate(MetricAggregates::Id id) const;
+
+  /**
+   * @brief Registers alarm limits for metrics whose name matches `limits.pattern`.
+   *
+   * Limits are compiled into per-node tables at each NBIRTH/DBIRTH and checked
+   * against every BIRTH/DATA value with about one comparison per limit; level
+   * changes are reported to Config::alarm_callback. The first registration whose
+   * pattern matches a metric applies. See AlarmEngine.
+   *
+   * @param limits Pattern, hi/lo/hihi/lolo limits, deadband and delay-on
+   *
+   * @note Call before connect(): nodes born earlier pick up new limits at rebirth.
+   */
+  void add_alarm_limits(AlarmLimits limits);
+
+  /**
+   * @brief Raises delayed alarms whose delay-on elapsed.
+   *
+   * Also done on every received message; call it periodically as well if values
+   * may stop arriving.
+   *
+   * @return Number of alarm transitions reported
+   */
+  size_t check_alarms();
+
+  /**
+   * @brief Number of metrics currently in alarm (any level other than Normal).
+   */
+  [[nodiscard]] size_t get_active_alarm_count() const;
+
+  /**
+   * @brief Adds a derived (calculated) metric computed from other metrics.
+   *
+   * The expression is compiled for each matching edge node at its NBIRTH and
+   * recomputed only when one of its inputs changes. Changed results are delivered
+   * through Config::message_callback as a synthetic NDATA for the edge node,
+   * marked with DERIVED_PAYLOAD_UUID and carrying no seq; unknown results are
+   * null metrics. See DerivedMetricSpec for the expression syntax.
+   *
+   * @param spec Scope, synthetic metric name and expression
+   *
+   * @return The derived metric Id, or an error if the expression is invalid
+   *
+   * @note Call before connect(): nodes born earlier pick it up at rebirth.
+   */
+  [[nodiscard]] stdx::expected<DerivedMetrics::Id, std::string>
+  add_derived_metric(DerivedMetricSpec spec);
+
+  /**
+   * @brief Current result of a derived metric on an edge node.
+   *
+   * @return The value, or std::nullopt if unknown or not compiled for that node
+   */
+  [[nodiscard]] std::optional<double> get_derived_value(std::string_view group_id,
+                                                        std::string_view edge_node_id,
+                                                        std::string_view name) const;
+
+  /**
+   * @brief Marks nodes and devices offline when they stop publishing without a death.
+   *
+   * An edge node that loses power or network without its broker noticing (no
+   * NDEATH) would otherwise look online forever. With stale detection, a node
+   * that sends nothing for Options::node_timeout (and, if set, a device silent
+   * for Options::device_timeout) is marked offline with OfflineReason::Timeout,
+   * its devices go offline with it, and Config::offline_callback is invoked. The
+   * next message from the node or device brings it back online.
+   *
+   * Expiry is checked on every received message; call check_stale() periodically
+   * as well if all traffic may stop. See StaleMonitor for the cost model.
+   *
+   * @param options Node and device timeouts
+   *
+   * @note Must be called before connect(). Requires Config::validate_sequence
+   * (node state is not tracked otherwise).
+   */
+  void enable_stale_detection(StaleMonitor::Options options = {});
+
+  /**
+   * @brief Expires nodes and devices that have been silent past their timeout.
+   *
+   * @return Number of nodes and devices marked offline
+   */
+  size_t check_stale();
+
+  /**
+   * @brief Starts queueing typed node and device lifecycle events.
+   *
+   * Births (Online/Rebirth), deaths (Offline), stale detection (Stale/Resumed) and
+   * sequence gaps (SeqGap) are recorded in a bounded LifecycleEventQueue that
+   * coalesces per node and device: during a reconnect storm each entity yields one
+   * event, e.g. an offline and online within Options::window become one Bounced.
+   * Drain it at your own pace with drain_lifecycle_events().
+   *
+   * Events come from sequence validation and are not recorded when
+   * Config::validate_sequence is false.
+   *
+   * @param options Coalescing window and capacity
+   *
+   * @note Call before connect().
+   */
+  void enable_lifecycle_events(LifecycleEventQueue::Options options = {});
+
+  /**
+   * @brief Moves up to `max_events` lifecycle events whose window elapsed to `out`.
+   *
+   * @return Number of events appended (0 if lifecycle events are not enabled)
+   */
+  size_t drain_lifecycle_events(std::vector<LifecycleEvent>& out,
+                                size_t max_events = SIZE_MAX);
+
+  /**
+   * @brief Lifecycle transitions dropped because the queue was full.
+   *
+   * A nonzero count means drained events are incomplete; resynchronize with
+   * get_node_state().
+   */
+  [[nodiscard]] uint64_t get_lifecycle_events_dropped() const;
+
+  /**
+   * @brief Reconnects automatically when the broker connection is lost.
+   *
+   * A background thread retries the connection with jittered exponential backoff
+   * between ReconnectOptions::min_delay and max_delay. Every reconnect replays the
+   * subscriptions and, if publish_state_birth() was called after the last
+   * publish_state_death(), publishes the STATE birth again.
+   *
+   * Edge nodes that were online when the connection dropped are not all asked to
+   * rebirth. The next message of each is checked against its last seq: a node
+   * that continues in sequence lost nothing and keeps its state, while a node
+   * with a gap is sent a "Node Control/Rebirth" NCMD, rate limited by
+   * ReconnectOptions::resync. See ResyncTracker.
+   *
+   * @param options Backoff, STATE republishing and rebirth rate limit
+   *
+   * @note May be called before or after connect(); calling it again replaces the
+   *       options. Resync needs Config::validate_sequence.
+   * @note Moving the HostApplication joins the worker and restarts it on the
+   *       destination; a reconnect in progress finishes first.
+   */
+  void enable_auto_reconnect(ReconnectOptions options = {});
+
+  /**
+   * @brief Nodes awaiting a continuity check or a rebirth after a reconnect.
+   *
+   * Empty unless enable_auto_reconnect() was called.
+   */
+  [[nodiscard]] ResyncStats get_resync_stats() const;
+
+  /**
+   * @brief Encodes the complete node state table for a warm-standby host.
+   *
+   * Covers each edge node's online flag, bdSeq, last seq, birth timestamp and
+   * NBIRTH alias table, plus its devices and their DBIRTH alias tables. A standby
+   * that import_state()s this frame (and the deltas that follow) can validate
+   * traffic from the whole fleet after a takeover without requesting rebirths.
+   *
+   * Starts a new replication stream: change tracking is switched on and later
+   * export_state_delta() calls are numbered relative to this snapshot.
+   *
+   * @return Compact binary frame (see ReplicationChannel for a local transport)
+   */
+  [[nodiscard]] std::vector<uint8_t> export_state_snapshot();
+
+  /**
+   * @brief Encodes the node state changed since the previous export.
+   *
+   * Nodes that only received data carry their sequence state; alias tables and
+   * devices are resent only for nodes that sent a birth or death since then. A
+   * changed node this host no longer holds is sent as a removal, and
+   * import_state() drops it.
+   *
+   * @return The frame (empty if nothing changed), or an error if
+   * export_state_snapshot() has not been called
+   */
+  [[nodiscard]] stdx::expected<std::vector<uint8_t>, std::string> export_state_delta();
+
+  /**
+   * @brief Applies a snapshot or delta produced by another host's export.
+   *
+   * A snapshot replaces the whole node state table; deltas must follow it in order.
+   * Malformed frames and gaps in the stream are rejected without changing state.
+   *
+   * @return void on success, error message on failure (after a gap, import a new
+   * snapshot)
+   */
+  [[nodiscard]] stdx::expected<void, std::string>
+  import_state(std::span<const uint8_t> frame);
+
+  /**
+   * @brief Returns counters for each attached sink, in add_sink() order.
+   */
+  [[nodiscard]] std::vector<SinkStats> get_sink_stats() const;
+
+  /**
+   * @brief Returns connect counters and timings since construction.
+   */
+  [[nodiscard]] ConnectionStats get_connection_stats() const;
+
+  /**
+   * @brief Messages dropped as duplicates since construction.
+   *
+   * With QoS 1 the broker may deliver a message twice (a redelivery carries the
+   * MQTT dup flag). With Config::suppress_duplicates, NDATA, DBIRTH, DDATA and
+   * DDEATH messages whose seq was already seen since the node's NBIRTH are
+   * dropped before the payload is decoded: they reach no callback or sink and do
+   * not count as sequence gaps. Requires Config::validate_sequence.
+   *
+   * A seq 128 or more ahead of the node's highest cannot be told from one behind
+   * it; without the dup flag it is taken as new data after a loss, and left to
+   * sequence validation as a gap. Windows restart after a connection loss, and
+   * nodes awaiting the resync check of enable_auto_reconnect() are not filtered.
+   */
+  [[nodiscard]] uint64_t get_duplicates_dropped() const;
+
+  /**
+   * @brief Bounds the memory held for edge nodes that are no longer online.
+   *
+   * Every node ever seen keeps an entry, and by default its NBIRTH alias table
+   * and its devices (with their DBIRTH alias tables) stay after it dies. With a
+   * budget, the estimated size of all node state is tracked, and when it exceeds
+   * `budget_bytes` the offline nodes that have been inactive longest are reduced
+   * to tombstones. A tombstone keeps the scalars of NodeStateSnapshot, so
+   * is_online, bdSeq and offline_reason remain queryable. It drops the alias table
+   * and devices, and it clears birth_received, so data from the node is rejected
+   * until its next NBIRTH rebuilds the state. Online nodes are never evicted.
+   * Eviction also drops the node from aggregates (as its death would), alarm
+   * tables, derived metric graphs, stale detection and pending resyncs, without
+   * emitting events.
+   *
+   * Sizes are estimates (container nodes, buckets and heap strings), recomputed on
+   * births, deaths and timeouts rather than per message. Alias tables are shared
+   * (see get_alias_table_stats()), so each distinct table is counted once, as
+   * NodeMemoryStats::shared_bytes, and a node only for its handle; evicting the
+   * last holder of a table frees it. Sizes cover node state only: what the helpers
+   * above hold per node is freed by eviction but not counted, since it scales with
+   * the registered limits and expressions and is mostly released by the node's
+   * death already. NodeStateSnapshot reports each node's estimate as memory_bytes.
+   * Nodes already held when this is called, or loaded by import_state(), have no
+   * activity history and are ordered arbitrarily among themselves.
+   *
+   * @param budget_bytes Target for node state memory (0 = report usage only)
+   *
+   * @note Call before connect(). Requires Config::validate_sequence.
+   */
+  void enable_memory_budget(size_t budget_bytes);
+
+  /**
+   * @brief Node state memory use and evictions.
+   *
+   * Empty unless enable_memory_budget() was called.
+   */
+  [[nodiscard]] NodeMemoryStats get_memory_stats() const;
+
+  /**
+   * @brief Sharing of birth alias tables across nodes and devices.
+   *
+   * Nodes and devices whose births declare the same (alias, name) pairs hold one
+   * shared, immutable table; a rebirth with a different schema moves only that
+   * node to another table. Always on. O(distinct tables).
+   */
+  [[nodiscard]] AliasTableStats get_alias_table_stats() const;
+
   /**
    * @brief Connects to the MQTT broker.
    *
@@ -318,6 +731,56 @@ public:
   [[nodiscard]] stdx::expected<void, std::string>
   subscribe_state(std::string_view host_id);
 
+  /**
+   * @brief Subscribes to many edge nodes of a group at once.
+   *
+   * Equivalent to subscribe_node() for each node, but sent as SUBSCRIBE packets of
+   * up to Config::subscribe_batch_size topic filters each.
+   *
+   * @param group_id The group ID
+   * @param edge_node_ids The edge node IDs to subscribe to
+   *
+   * @return void on success, error message if a request could not be sent
+   */
+  [[nodiscard]] stdx::expected<void, std::string>
+  subscribe_nodes(std::string_view group_id, std::span<const std::string> edge_node_ids);
+
+  /**
+   * @brief Removes a subscription made with subscribe_group().
+   */
+  [[nodiscard]] stdx::expected<void, std::string>
+  unsubscribe_group(std::string_view group_id);
+
+  /**
+   * @brief Removes a subscription made with subscribe_node() or subscribe_nodes().
+   */
+  [[nodiscard]] stdx::expected<void, std::string>
+  unsubscribe_node(std::string_view group_id, std::string_view edge_node_id);
+
+  /**
+   * @brief Waits until the broker acknowledged every requested subscription.
+   *
+   * The subscribe_* methods return once their SUBSCRIBE is sent; SUBACKs are
+   * tracked per topic filter in the background.
+   *
+   * @param timeout Maximum time to wait
+   *
+   * @return void when all are granted; an error on timeout or if the broker
+   *         refused any topic filter
+   */
+  [[nodiscard]] stdx::expected<void, std::string>
+  wait_for_subscriptions(std::chrono::milliseconds timeout);
+
+  /**
+   * @brief Desired, granted, pending and refused subscription counts.
+   *
+   * The subscribe_* and unsubscribe_* methods maintain a desired set of topic
+   * filters, diffed against what the broker acknowledged and applied with
+   * batched SUBSCRIBE/UNSUBSCRIBE. Every connect() replays the whole set, so
+   * subscriptions survive a reconnect.
+   */
+  [[nodiscard]] SubscriptionStats get_subscription_stats() const;
+
   /**
    * @brief Lightweight snapshot of node state (scalars only, no maps).
    *
@@ -330,6 +793,10 @@ public:
     uint64_t bd_seq{0};
     uint64_t birth_timestamp{0};
     bool birth_received{false};
+    OfflineReason offline_reason{OfflineReason::None};
+    bool evicted{false};    ///< Reduced to a tombstone (see enable_memory_budget())
+    size_t memory_bytes{0}; ///< Estimated memory of the node and its devices,
+                            ///< excluding shared alias tables
   };
 
   /**
@@ -366,6 +833,39 @@ public:
                                                            std::string_view device_id,
                                                            uint64_t alias) const;
 
+  /**
+   * @brief Encodes a message as JSON with metric names resolved from the birth aliases.
+   *
+   * Uses the alias table of the node (or device, if topic.device_id is set) that
+   * HostApplication captured from the last NBIRTH/DBIRTH. Intended for bridging to
+   * REST or log consumers from within the message callback.
+   *
+   * @param topic Parsed topic of the message
+   * @param payload Decoded payload
+   * @param encoder Encoder whose reusable buffer receives the output
+   *
+   * @return JSON text, valid until the next call on encoder
+   *
+   * @see JsonEncoder for the output format
+   */
+  [[nodiscard]] std::string_view
+  encode_json(const Topic& topic,
+              const org::eclipse::tahu::protobuf::Payload& payload,
+              JsonEncoder& encoder) const;
+
+  /**
+   * @brief Encodes a message as JSON straight from its protobuf wire bytes.
+   *
+   * Avoids decoding into a Payload message altogether.
+   *
+   * @return JSON text valid until the next call on encoder, or an error for a
+   * malformed payload
+   */
+  [[nodiscard]] stdx::expected<std::string_view, std::string>
+  encode_json(const Topic& topic,
+              std::span<const uint8_t> payload_data,
+              JsonEncoder& encoder) const;
+
   /**
    * @brief Publishes a STATE birth message to indicate Host Application is online.
    *
@@ -493,58 +993,106 @@ public:
 private:
   Config config_;
   MQTTAsyncHandle client_;
+  ConnectionStats connection_stats_;
+
   std::atomic<bool> is_connected_{false};
 
   // MQTT connection options that must outlive async operations
   MQTTAsync_SSLOptions ssl_opts_{};
 
   // Node state tracking
-  struct NodeKey {
-    std::string group_id;
-    std::string edge_node_id;
+  using NodeKey = detail::NodeKey;
 
-    [[nodiscard]] bool operator==(const NodeKey& other) const noexcept {
-      return group_id == other.group_id && edge_node_id == other.edge_node_id;
-    }
+  detail::NodeKeyMap<NodeState> node_states_;
+  mutable std::mutex node_states_mutex_; // Protects node_states_ only
+  uint64_t duplicates_dropped_{0};       // Guarded by node_states_mutex_
+
+  // Downstream sinks (set up before connect(), read lock-free on the MQTT thread)
+  std::vector<std::unique_ptr<SinkPipeline>> sinks_;
+
+  // Shared-memory fan-out (written on the MQTT thread under node_states_mutex_)
+  std::shared_ptr<ShmRingWriter> shm_ring_;
+
+  // Command-to-effect correlation: set once before connect(), never replaced; the
+  // pointer is read under node_states_mutex_, the tracker locks itself
+  std::unique_ptr<CommandTracker> command_tracker_;
+
+  // Warm-standby replication (guarded by node_states_mutex_). The dirty map value
+  // is true when the node's alias tables or devices changed, not just its seq.
+  bool replication_tracking_{false};
+  uint64_t replication_seq_{0};
+  std::optional<uint64_t> imported_seq_;
+  detail::NodeKeyMap<bool> replication_dirty_;
+
+  // Incremental metric aggregates (guarded by node_states_mutex_)
+  std::unique_ptr<MetricAggregates> aggregates_;
+
+  // Alarm limit evaluation (guarded by node_states_mutex_)
+  std::unique_ptr<AlarmEngine> alarm_engine_;
+
+  // Derived metrics (guarded by node_states_mutex_)
+  std::unique_ptr<DerivedMetrics> derived_metrics_;
+
+  // Coalesced lifecycle events (guarded by node_states_mutex_)
+  std::unique_ptr<LifecycleEventQueue> lifecycle_events_;
+
+  // Post-reconnect sequence continuity checks (guarded by node_states_mutex_)
+  std::unique_ptr<ResyncTracker> resync_;
+
+  // Node state memory budget (guarded by node_states_mutex_)
+  std::unique_ptr<NodeStateBudget> memory_budget_;
+
+  // Birth alias tables shared by schema (guarded by node_states_mutex_)
+  AliasTableCache alias_tables_;
+
+  // Automatic reconnect worker, allocated with the object (only a move replaces
+  // it). Its flags are guarded by its own mutex; options change only while
+  // enable_auto_reconnect() has the worker joined
+  struct Reconnector {
+    ReconnectOptions options;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool wanted{false}; // connect() called and disconnect() not since
+    bool lost{false};   // Connection dropped, not restored yet
+    bool stopping{false};
+    uint32_t failures{0}; // Consecutive failed attempts, drives backoff
+    std::thread thread;
   };
+  std::unique_ptr<Reconnector> reconnector_;
 
-  struct NodeKeyHash {
-    using is_transparent = void;
-    [[nodiscard]] size_t operator()(const NodeKey& key) const noexcept {
-      size_t h1 = std::hash<std::string>{}(key.group_id);
-      size_t h2 = std::hash<std::string>{}(key.edge_node_id);
-      return h1 ^ (h2 << 1);
-    }
-    [[nodiscard]] size_t
-    operator()(std::pair<std::string_view, std::string_view> key) const noexcept {
-      size_t h1 = std::hash<std::string_view>{}(key.first);
-      size_t h2 = std::hash<std::string_view>{}(key.second);
-      return h1 ^ (h2 << 1);
-    }
+  // Silent node detection (set up before connect(), guarded by node_states_mutex_)
+  std::unique_ptr<StaleMonitor> stale_monitor_;
+  std::vector<StaleMonitor::Expired> stale_expired_; // Reused by expire_stale_locked()
+
+  struct OfflineEvent {
+    std::string group_id;
+    std::string edge_node_id;
+    std::string device_id;
+    OfflineReason reason;
   };
 
-  struct NodeKeyEqual {
-    using is_transparent = void;
-    [[nodiscard]] bool operator()(const NodeKey& lhs, const NodeKey& rhs) const noexcept {
-      return lhs == rhs;
-    }
-    [[nodiscard]] bool
-    operator()(const NodeKey& lhs,
-               std::pair<std::string_view, std::string_view> rhs) const noexcept {
-      return lhs.group_id == rhs.first && lhs.edge_node_id == rhs.second;
-    }
-    [[nodiscard]] bool operator()(std::pair<std::string_view, std::string_view> lhs,
-                                  const NodeKey& rhs) const noexcept {
-      return lhs.first == rhs.group_id && lhs.second == rhs.edge_node_id;
-    }
+  // Desired subscriptions and their SUBACK tracking (guarded by mutex_); the
+  // token map ties Paho responses to manager batches
+  struct SubscribeRequest {
+    uint64_t batch;
+    bool unsubscribe;
+    size_t count;
   };
+  SubscriptionManager subscriptions_;
+  std::unordered_map<int, SubscribeRequest> subscribe_requests_;
+  std::condition_variable subscriptions_cv_;
 
-  std::unordered_map<NodeKey, NodeState, NodeKeyHash, NodeKeyEqual> node_states_;
-  mutable std::mutex node_states_mutex_; // Protects node_states_ only
+  // STATE birth published and not withdrawn since (guarded by mutex_)
+  bool state_birth_published_{false};
 
   // Mutex for thread-safe access to config and other mutable state
   mutable std::mutex mutex_;
 
+  // Held for a whole connection attempt (and by disconnect()), so connect() and
+  // the reconnect worker never replace client_ while the other is still using it.
+  // Taken before reconnector_->mutex and mutex_, never while holding either
+  std::mutex connect_mutex_;
+
   [[nodiscard]] stdx::expected<void, std::string>
   publish_raw_message(std::string_view topic,
                       std::span<const uint8_t> payload_data,
@@ -554,9 +1102,103 @@ private:
   [[nodiscard]] stdx::expected<void, std::string>
   publish_command_message(std::string_view topic, std::span<const uint8_t> payload_data);
 
+  // Publishes an NCMD/DCMD, recording its metric writes with the command tracker
+  [[nodiscard]] stdx::expected<void, std::string>
+  publish_tracked_command(const Topic& topic, PayloadBuilder& payload);
+
   bool validate_message(const Topic& topic,
                         const org::eclipse::tahu::protobuf::Payload& payload);
 
+  // Records the raw message's seq in its node's window; true if already seen
+  bool is_duplicate(const Topic& topic, const MQTTAsync_message& message);
+
+  // Alias table for the topic's node or device; caller must hold node_states_mutex_
+  const AliasTable* find_alias_map(const Topic& topic) const;
+
+  // Records a validated message for export_state_delta(); caller holds node_states_mutex_
+  void mark_replication_dirty(const Topic& topic);
+
+  // Applies BIRTH/DATA values and DEATH retractions; caller holds node_states_mutex_
+  void update_aggregates_locked(const Topic& topic,
+                                const org::eclipse::tahu::protobuf::Payload& payload);
+
+  // Withdraws aggregate values of a device, or of a node and all its devices;
+  // caller holds node_states_mutex_
+  void retract_aggregates_locked(std::string_view group_id,
+                                 std::string_view edge_node_id,
+                                 std::string_view device_id,
+                                 const NodeState& state);
+
+  // Updates the desired subscription set and sends the resulting batches
+  [[nodiscard]] stdx::expected<void, std::string>
+  change_subscriptions(std::span<const std::string> add,
+                       std::span<const std::string> remove);
+
+  // Sends the batches planned by subscriptions_; caller holds mutex_
+  [[nodiscard]] stdx::expected<void, std::string> sync_subscriptions_locked();
+
+  // Connects the MQTT client, replacing client_; caller holds connect_mutex_.
+  // connect() also arms automatic reconnect
+  [[nodiscard]] stdx::expected<void, std::string> open_connection();
+
+  // Reconnect worker loop, and its shutdown
+  // Starts the reconnect worker on this object; reconnector_ must be set
+  void start_reconnect();
+  // Joins the reconnect worker; true if one was running
+  bool stop_reconnect();
+  void run_reconnect();
+
+  // Sends the rebirth requests the resync rate limit allows; caller holds no lock
+  void send_rebirths();
+
+  // Settles a node marked for resync from its next message, before validation;
+  // caller holds node_states_mutex_
+  void check_resync_locked(const Topic& topic,
+                           const org::eclipse::tahu::protobuf::Payload& payload);
+
+  // Paho SUBACK/UNSUBACK callbacks (context: this)
+  static void on_subscribe_success(void* context, MQTTAsync_successData* response);
+  static void on_subscribe_failure(void* context, MQTTAsync_failureData* response);
+
+  // Queues a lifecycle transition if enabled; caller holds node_states_mutex_
+  void record_lifecycle_locked(LifecycleEventType type,
+                               std::string_view group_id,
+                               std::string_view edge_node_id,
+                               std::string_view device_id,
+                               uint64_t expected_seq = 0,
+                               uint64_t received_seq = 0);
+
+  // Reports the message's node to the memory budget if its size may have changed;
+  // caller holds node_states_mutex_
+  void account_memory_locked(const Topic& topic);
+
+  // Reports a node's size to the memory budget, then evicts offline nodes while
+  // over it; caller holds node_states_mutex_
+  void account_node_locked(const NodeKey& key, const NodeState& state);
+
+  // Drops what the aggregates, alarm engine, derived metrics, stale monitor and
+  // resync tracker hold for an evicted node; caller holds node_states_mutex_
+  void forget_node_locked(std::string_view group_id,
+                          std::string_view edge_node_id,
+                          const NodeState& state);
+
+  // Feeds a validated message to the stale monitor; caller holds node_states_mutex_
+  void touch_stale_locked(const Topic& topic, StaleMonitor::Clock::time_point now);
+
+  // Marks timed-out nodes/devices offline; caller holds node_states_mutex_
+  void expire_stale_locked(StaleMonitor::Clock::time_point now,
+                           std::vector<OfflineEvent>& events);
+
+  // Invokes Config::alarm_callback; caller holds no lock
+  void notify_alarms(const std::vector<AlarmEvent>& events) const;
+
+  // Delivers derived results as a synthetic NDATA to Config::message_callback;
+  // caller holds no lock
+  void notify_derived(const std::vector<DerivedValue>& values) const;
+
+  // Invokes Config::offline_callback; caller holds no lock
+  void notify_offline(const std::vector<OfflineEvent>& events) const;
+
   // Static MQTT callback for message arrived
   static int on_message_arrived(void* context,
                                 char* topicName,
@@ -0,0 +1,141 @@
+// include/sparkplug/json_encoder.hpp
+#pragma once
+
+#include "detail/compat.hpp"
+#include "sparkplug_b.pb.h"
+#include "topic.hpp"
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace sparkplug {
+
+/**
+ * @brief Purpose-built Sparkplug B payload to JSON encoder.
+ *
+ * A fast alternative to protobuf's reflection-based JsonFormat for bridging
+ * Sparkplug traffic to REST endpoints and log pipelines. Output is compact and
+ * Sparkplug-aware:
+ *
+ * @code{.json}
+ * {"group_id":"Energy","message_type":"NDATA","edge_node_id":"Gateway01",
+ *  "timestamp":1700000000000,"seq":4,
+ *  "metrics":[{"name":"Temperature","alias":1,"timestamp":1700000000000,
+ *              "datatype":10,"value":21.5}]}
+ * @endcode
+ *
+ * - Metric names missing from DATA messages are resolved from an alias table
+ *   (e.g., the one HostApplication captured from NBIRTH/DBIRTH).
+ * - Floating point values use std::to_chars (shortest round-trip form); NaN and
+ *   infinities are emitted as null.
+ * - Bytes/File values are base64 encoded. DataSet, Template and PropertySet values
+ *   are emitted as null.
+ * - The output buffer is owned by the encoder and reused across calls, so steady
+ *   state encoding does not allocate.
+ *
+ * The wire-bytes overloads walk the protobuf encoding directly and never build a
+ * Payload message.
+ *
+ * @par Thread Safety
+ * Not thread-safe. Use one encoder per thread.
+ *
+ * @par Example Usage
+ * @code
+ * sparkplug::JsonEncoder encoder;
+ * auto json = encoder.encode(topic, std::span<const uint8_t>(data, len));
+ * if (json) {
+ *   http_post(*json);  // valid until the next encode() call
+ * }
+ * @endcode
+ */
+class JsonEncoder {
+public:
+  /// Alias table type (alias -> metric name)
+  using AliasMap = std::unordered_map<uint64_t, std::string>;
+
+  JsonEncoder() = default;
+
+  /**
+   * @brief Encodes a decoded payload.
+   *
+   * @param payload Sparkplug payload
+   * @param aliases Alias table used to fill in missing metric names (optional)
+   *
+   * @return JSON text, valid until the next call on this encoder
+   */
+  [[nodiscard]] std::string_view
+  encode(const org::eclipse::tahu::protobuf::Payload& payload,
+         const AliasMap* aliases = nullptr);
+
+  /**
+   * @brief Encodes a decoded payload, prefixed with the topic fields.
+   */
+  [[nodiscard]] std::string_view
+  encode(const Topic& topic,
+         const org::eclipse::tahu::protobuf::Payload& payload,
+         const AliasMap* aliases = nullptr);
+
+  /**
+   * @brief Encodes a payload straight from its protobuf wire bytes.
+   *
+   * @param wire Serialized Sparkplug payload (e.g., MQTTAsync_message::payload)
+   * @param aliases Alias table used to fill in missing metric names (optional)
+   *
+   * @return JSON text valid until the next call, or an error for malformed input
+   */
+  [[nodiscard]] stdx::expected<std::string_view, std::string>
+  encode(std::span<const uint8_t> wire, const AliasMap* aliases = nullptr);
+
+  /**
+   * @brief Encodes wire bytes, prefixed with the topic fields.
+   */
+  [[nodiscard]] stdx::expected<std::string_view, std::string>
+  encode(const Topic& topic,
+         std::span<const uint8_t> wire,
+         const AliasMap* aliases = nullptr);
+
+  /**
+   * @brief Returns the output of the last encode() call.
+   */
+  [[nodiscard]] std::string_view buffer() const noexcept {
+    return out_;
+  }
+
+  /**
+   * @brief Decoded view of one metric, shared by the Payload and wire paths.
+   */
+  struct MetricView {
+    std::string_view name;
+    uint64_t alias{0};
+    uint64_t timestamp{0};
+    uint32_t datatype{0};
+    bool has_name{false};
+    bool has_alias{false};
+    bool has_timestamp{false};
+    bool is_historical{false};
+    bool is_transient{false};
+    bool is_null{false};
+    uint64_t int_bits{0};       // int_value / long_value / boolean_value
+    float float_value{0.0f};    // float_value
+    double double_value{0.0};   // double_value
+    std::string_view bytes;     // string_value / bytes_value
+  };
+
+private:
+  std::string out_;
+  std::vector<MetricView> metrics_; // Reused scratch for the wire path
+
+  void begin(const Topic* topic);
+  void append_metric(const MetricView& metric, const AliasMap* aliases);
+  std::string_view encode_payload(const Topic* topic,
+                                  const org::eclipse::tahu::protobuf::Payload& payload,
+                                  const AliasMap* aliases);
+  stdx::expected<std::string_view, std::string>
+  encode_wire(const Topic* topic, std::span<const uint8_t> wire, const AliasMap* aliases);
+};
+
+} // namespace sparkplug
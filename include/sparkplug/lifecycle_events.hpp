@@ -0,0 +1,129 @@
+// include/sparkplug/lifecycle_events.hpp
+#pragma once
+
+#include "detail/node_key.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace sparkplug {
+
+/**
+ * @brief Kind of node or device lifecycle transition.
+ */
+enum class LifecycleEventType : uint8_t {
+  Online,  ///< First birth, or birth after being offline
+  Rebirth, ///< Birth while already online
+  Offline, ///< NDEATH/DDEATH
+  Stale,   ///< Marked offline after going silent (stale detection)
+  Resumed, ///< Published again after being marked stale
+  Bounced, ///< Went offline and came back within the coalescing window
+  SeqGap,  ///< Sequence number gap (messages lost or reordered)
+};
+
+/**
+ * @brief One (possibly coalesced) lifecycle event of a node or device.
+ */
+struct LifecycleEvent {
+  LifecycleEventType type{LifecycleEventType::Online};
+  std::string group_id;
+  std::string edge_node_id;
+  std::string device_id;    ///< Empty for node events
+  uint64_t timestamp{0};    ///< Milliseconds since epoch of the latest transition
+  uint32_t count{1};        ///< Transitions merged into this event
+  uint64_t expected_seq{0}; ///< SeqGap: seq expected by the latest gap
+  uint64_t received_seq{0}; ///< SeqGap: seq actually received
+};
+
+/**
+ * @brief Bounded, coalescing queue of lifecycle events.
+ *
+ * Each node or device has at most one pending state event (Online, Rebirth,
+ * Offline, Stale, Resumed, Bounced) and one pending SeqGap event. A transition
+ * for an entity that already has a pending event is merged into it instead of
+ * queued: the type becomes the latest transition, except that going down
+ * (Offline/Stale) and back up collapses into Bounced, and count records how many
+ * transitions were merged. A reconnect storm therefore costs one event per
+ * entity, not one per message.
+ *
+ * An event becomes available to drain() once Options::window has passed since
+ * its first transition, giving flaps within the window time to collapse; events
+ * leave in the order their entities first transitioned. At most
+ * Options::capacity events are pending; transitions for further entities are
+ * dropped and counted, and the consumer can resynchronize from
+ * HostApplication::get_node_state().
+ *
+ * HostApplication::enable_lifecycle_events() pushes transitions from the MQTT
+ * thread as it applies them; the application drains them with
+ * HostApplication::drain_lifecycle_events() from its own thread.
+ *
+ * @par Thread Safety
+ * Not thread-safe. push() and drain() may run on different threads only under
+ * a common lock.
+ */
+class LifecycleEventQueue {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  /**
+   * @brief Queue options.
+   */
+  struct Options {
+    std::chrono::milliseconds window{500}; ///< Hold-back for coalescing (0 = none)
+    size_t capacity{10000};                ///< Maximum pending events
+  };
+
+  LifecycleEventQueue();
+  explicit LifecycleEventQueue(Options options);
+
+  /**
+   * @brief Records a transition, merging it into a pending event if possible.
+   *
+   * @return false if the queue was full and the transition was dropped
+   */
+  bool push(LifecycleEvent event, Clock::time_point now = Clock::now());
+
+  /**
+   * @brief Moves up to `max_events` events whose window elapsed to `out`.
+   *
+   * @return Number of events appended
+   */
+  size_t drain(std::vector<LifecycleEvent>& out,
+               size_t max_events = SIZE_MAX,
+               Clock::time_point now = Clock::now());
+
+  /// Events pending, including those still inside their window.
+  [[nodiscard]] size_t size() const noexcept {
+    return pending_.size();
+  }
+
+  /// Transitions dropped because the queue was full.
+  [[nodiscard]] uint64_t dropped() const noexcept {
+    return dropped_;
+  }
+
+  [[nodiscard]] const Options& options() const noexcept {
+    return options_;
+  }
+
+private:
+  struct Pending {
+    LifecycleEvent event;
+    Clock::time_point ready;
+  };
+
+  static void merge(LifecycleEvent& pending, const LifecycleEvent& next);
+
+  Options options_;
+  // FIFO by first transition; index_ maps entity key to position + base_
+  std::deque<Pending> pending_;
+  uint64_t base_{0};
+  detail::NodeKeyMap<uint64_t> index_;
+  uint64_t dropped_{0};
+};
+
+} // namespace sparkplug
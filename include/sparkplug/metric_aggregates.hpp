@@ -0,0 +1,151 @@
+// include/sparkplug/metric_aggregates.hpp
+#pragma once
+
+#include "detail/node_key.hpp"
+#include "sparkplug_b.pb.h"
+#include "topic.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace sparkplug {
+
+/**
+ * @brief Selects the metric values combined by one aggregate.
+ */
+struct AggregateSpec {
+  std::string group_id{};     ///< Group whose nodes contribute
+  std::string edge_node_id{}; ///< Restrict to one edge node and its devices (empty = all)
+  std::string metric_name{};  ///< Metric name as declared in NBIRTH/DBIRTH
+};
+
+/**
+ * @brief Current value of an aggregate, returned by MetricAggregates::value().
+ *
+ * Each node or device publishing the metric contributes its latest value once.
+ * All fields are zero while nothing contributes.
+ */
+struct AggregateValue {
+  uint64_t count{0}; ///< Nodes/devices currently contributing
+  double sum{0.0};   ///< Sum of their latest values
+  double min{0.0};   ///< Smallest latest value
+  double max{0.0};   ///< Largest latest value
+  double mean{0.0};  ///< sum / count
+};
+
+/**
+ * @brief Group and edge node aggregates maintained incrementally from host ingest.
+ *
+ * Each registered aggregate keeps the latest value of its metric per contributing
+ * node or device (BIRTH and DATA; alias-only metrics are resolved through the
+ * birth alias table). An update adjusts sum and count in O(1) and extends min or
+ * max in O(1); only when the current extreme moves back inward is the aggregate
+ * marked for a rescan, which value() performs lazily. A null value, a DDEATH, or
+ * an NDEATH (for the node and all its devices) retracts the contribution. A stale
+ * timeout suspends it instead: the last values come back when the node resumes, as
+ * its next DATA may only carry the metrics that changed.
+ * Historical values and non-numeric metrics are ignored; booleans count as 0/1.
+ *
+ * HostApplication::add_aggregate() feeds it from the MQTT thread and retracts,
+ * suspends or resumes contributors as it tracks deaths and stale timeouts.
+ *
+ * @par Thread Safety
+ * Not thread-safe, and value() is not const: it may rescan. Readers on another
+ * thread than update() must share its lock.
+ */
+class MetricAggregates {
+public:
+  using Id = uint32_t;
+
+  /**
+   * @brief Registers an aggregate; it fills as matching values arrive.
+   */
+  Id add(AggregateSpec spec);
+
+  /**
+   * @brief Applies the metric values of a BIRTH/DATA message.
+   *
+   * @param topic Parsed topic (other message types are ignored)
+   * @param payload Decoded payload
+   * @param alias_map Alias table from the matching birth, for alias-only metrics
+   */
+  void update(const Topic& topic,
+              const org::eclipse::tahu::protobuf::Payload& payload,
+              const std::unordered_map<uint64_t, std::string>* alias_map);
+
+  /**
+   * @brief Withdraws every value contributed by a node (empty device_id) or device.
+   *
+   * A node's devices are separate contributors; retract them individually.
+   */
+  void retract(std::string_view group_id,
+               std::string_view edge_node_id,
+               std::string_view device_id);
+
+  /**
+   * @brief Withdraws a node's (empty device_id) or device's values, keeping them for
+   * resume().
+   *
+   * A later retract(), null value or update of a metric discards what was kept.
+   */
+  void suspend(std::string_view group_id,
+               std::string_view edge_node_id,
+               std::string_view device_id);
+
+  /**
+   * @brief Restores the values kept by suspend(); call before applying new ones.
+   */
+  void resume(std::string_view group_id,
+              std::string_view edge_node_id,
+              std::string_view device_id);
+
+  /**
+   * @brief Current value of aggregate `id`, or std::nullopt for an unknown id.
+   */
+  [[nodiscard]] std::optional<AggregateValue> value(Id id);
+
+  /// Number of registered aggregates.
+  [[nodiscard]] size_t size() const noexcept {
+    return aggregates_.size();
+  }
+
+private:
+  struct Aggregate {
+    AggregateSpec spec;
+    double sum{0.0};
+    uint64_t count{0};
+    double min{0.0};
+    double max{0.0};
+    bool extremes_dirty{false};
+    std::vector<double> values{};                   // Latest value per contributor slot
+    std::vector<bool> present{};                    // Slot currently contributes
+    std::vector<bool> suspended{};                  // Withdrawn by suspend(), kept
+    std::unordered_map<uint32_t, uint32_t> slots{}; // Source id -> slot
+  };
+
+  struct Source {
+    std::vector<Id> aggregates; // Aggregates this source has contributed to
+  };
+
+  uint32_t source_id(const Topic& topic);
+  void apply(Id id, uint32_t source, double value);
+  void withdraw(Id id, uint32_t source, bool keep = false);
+  const Source* find_source(std::string_view group_id,
+                            std::string_view edge_node_id,
+                            std::string_view device_id,
+                            uint32_t& id);
+  static void rescan(Aggregate& aggregate);
+
+  std::vector<Aggregate> aggregates_;
+  // (group, node, metric) -> aggregates; node empty for group-wide aggregates
+  detail::NodeKeyMap<std::vector<Id>> by_metric_;
+  size_t node_scoped_{0};
+  detail::NodeKeyMap<uint32_t> source_ids_; // (group, node, device) -> source id
+  std::vector<Source> sources_;
+};
+
+} // namespace sparkplug
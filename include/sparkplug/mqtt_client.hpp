@@ -0,0 +1,274 @@
+// include/sparkplug/mqtt_client.hpp
+#pragma once
+
+#include "detail/compat.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace sparkplug {
+
+/**
+ * @brief Minimal single-threaded MQTT 3.1.1 client built on epoll (Linux only).
+ *
+ * An alternative to Paho's MQTTAsync for applications that drive their own event
+ * loop and want to avoid its internal threads and per-message copies. Implements
+ * the subset Sparkplug needs: QoS 0 and 1, retained messages, Last Will and
+ * subscriptions over plain TCP.
+ *
+ * - publish() and subscribe() only encode into a send queue. Queued packets are
+ *   written with one gathered (writev-style) send per poll(), so a burst of
+ *   publishes costs one system call instead of one per message.
+ * - Incoming packets are decoded in place from a single receive buffer: the topic
+ *   and payload handed to the message callback point straight into it.
+ * - All I/O, including keepalive, runs inside poll(). fd() is an epoll descriptor
+ *   that becomes readable whenever poll() has work, so it can be registered with
+ *   the application's own event loop (epoll, poll, libuv, ...).
+ *
+ * Not provided: TLS, QoS 2, automatic reconnect, and redelivery of unacknowledged
+ * QoS 1 messages after a reconnect.
+ *
+ * @par Thread Safety
+ * Not thread-safe; use from one thread. The message callback runs inside poll()
+ * and may call publish() or disconnect(), but not poll() or connect().
+ *
+ * @par Example Usage
+ * @code
+ * sparkplug::MqttClient client({.host = "localhost", .client_id = "edge01"});
+ * client.set_message_callback([](std::string_view topic,
+ *                                std::span<const uint8_t> payload, int, bool) {
+ *   org::eclipse::tahu::protobuf::Payload decoded;
+ *   decoded.ParseFromArray(payload.data(), static_cast<int>(payload.size()));
+ * });
+ * if (client.connect()) {
+ *   client.subscribe("spBv1.0/Plant1/NCMD/edge01", 1);
+ *   while (running) {
+ *     client.publish(topic, builder.build());
+ *     client.poll(std::chrono::milliseconds(100));
+ *   }
+ * }
+ * @endcode
+ */
+class MqttClient {
+public:
+  /**
+   * @brief Last Will and Testament, published by the broker if the connection drops.
+   */
+  struct Will {
+    std::string topic;            ///< Will topic
+    std::vector<uint8_t> payload; ///< Will payload
+    int qos = 0;                  ///< Will QoS (0 or 1)
+    bool retained = false;        ///< Will retain flag
+  };
+
+  /**
+   * @brief Connection options.
+   */
+  struct Options {
+    std::string host = "localhost";        ///< Broker host name or address
+    uint16_t port = 1883;                  ///< Broker TCP port
+    std::string client_id;                 ///< MQTT client identifier
+    std::optional<std::string> username{}; ///< Optional username
+    std::optional<std::string> password{}; ///< Optional password
+    int keep_alive_interval = 60;          ///< Keepalive in seconds (0 disables)
+    bool clean_session = true;             ///< MQTT clean session flag
+    std::optional<Will> will{};            ///< Optional Last Will
+    size_t receive_buffer_size = 65536;    ///< Initial receive buffer (grows as needed)
+    size_t max_packet_size = 16777216;     ///< Incoming packets above this drop the link
+    size_t max_queued_bytes = 8388608;     ///< Unsent bytes before publish() fails
+    size_t max_in_flight = 65535; ///< Unacknowledged QoS 1 publishes and subscribes
+                                  ///< before publish() and subscribe() fail (at
+                                  ///< most 65535, the packet identifier space)
+  };
+
+  /**
+   * @brief Counters reported by get_stats().
+   */
+  struct Stats {
+    uint64_t messages_sent{0};      ///< PUBLISH packets queued
+    uint64_t messages_received{0};  ///< PUBLISH packets received
+    uint64_t write_calls{0};        ///< Gathered send system calls
+    uint64_t bytes_sent{0};         ///< Bytes written to the socket
+    uint64_t bytes_received{0};     ///< Bytes read from the socket
+    uint64_t subscribe_failures{0}; ///< Subscriptions rejected by the broker
+  };
+
+  /**
+   * @brief Called for each incoming message.
+   *
+   * @param topic Message topic (valid only during the call)
+   * @param payload Message payload (valid only during the call)
+   * @param qos QoS the message was delivered with
+   * @param retained True if the broker delivered a retained message
+   */
+  using MessageCallback = std::function<void(std::string_view topic,
+                                             std::span<const uint8_t> payload,
+                                             int qos,
+                                             bool retained)>;
+
+  explicit MqttClient(Options options);
+
+  /**
+   * @brief Sends DISCONNECT if connected and releases all descriptors.
+   */
+  ~MqttClient();
+
+  MqttClient(const MqttClient&) = delete;
+  MqttClient& operator=(const MqttClient&) = delete;
+  MqttClient(MqttClient&&) = delete;
+  MqttClient& operator=(MqttClient&&) = delete;
+
+  /**
+   * @brief Sets the callback for incoming messages.
+   */
+  void set_message_callback(MessageCallback callback);
+
+  /**
+   * @brief Connects to the broker and waits for CONNACK.
+   *
+   * @param timeout Time allowed for the TCP connect and CONNACK
+   * @return void on success, error message on failure
+   */
+  [[nodiscard]] stdx::expected<void, std::string>
+  connect(std::chrono::milliseconds timeout = std::chrono::milliseconds(5000));
+
+  /**
+   * @brief Flushes queued packets, sends DISCONNECT and closes the socket.
+   *
+   * The Last Will is not published.
+   */
+  stdx::expected<void, std::string> disconnect();
+
+  /**
+   * @brief Queues a PUBLISH packet; it is sent by the next poll() or flush().
+   *
+   * @return Packet identifier (0 for QoS 0), or an error if not connected, the
+   *         arguments are invalid, Options::max_queued_bytes would be exceeded, or
+   *         a QoS 1 publish would exceed Options::max_in_flight
+   */
+  [[nodiscard]] stdx::expected<uint16_t, std::string>
+  publish(std::string_view topic,
+          std::span<const uint8_t> payload,
+          int qos = 0,
+          bool retained = false);
+
+  /**
+   * @brief Queues a SUBSCRIBE packet for one topic filter.
+   *
+   * Completion is reflected by pending_acks(); rejections are counted in
+   * Stats::subscribe_failures.
+   *
+   * @return Packet identifier, or an error if not connected, the filter is
+   *         invalid, or Options::max_in_flight acks are outstanding
+   */
+  [[nodiscard]] stdx::expected<uint16_t, std::string> subscribe(std::string_view filter,
+                                                                int qos = 1);
+
+  /**
+   * @brief Writes as much of the send queue as the socket accepts without blocking.
+   */
+  stdx::expected<void, std::string> flush();
+
+  /**
+   * @brief Runs one event loop iteration.
+   *
+   * Waits up to `timeout` for socket or keepalive events, dispatches incoming
+   * messages, sends keepalive pings and writes queued packets. Use a zero timeout
+   * when driven from an external loop via fd().
+   *
+   * @return Number of messages dispatched, or an error if the connection was lost
+   *         (the client is then disconnected and may connect() again)
+   */
+  stdx::expected<size_t, std::string> poll(std::chrono::milliseconds timeout);
+
+  /**
+   * @brief Descriptor that is readable whenever poll() has work.
+   *
+   * Stable for the lifetime of the client, across reconnects.
+   */
+  [[nodiscard]] int fd() const noexcept {
+    return epoll_fd_;
+  }
+
+  /**
+   * @brief True between a successful connect() and disconnect or connection loss.
+   */
+  [[nodiscard]] bool is_connected() const noexcept {
+    return state_ == State::Connected;
+  }
+
+  /**
+   * @brief QoS 1 publishes awaiting PUBACK plus subscribes awaiting SUBACK.
+   */
+  [[nodiscard]] size_t pending_acks() const noexcept {
+    return pending_acks_.size();
+  }
+
+  /**
+   * @brief Bytes queued but not yet written to the socket.
+   */
+  [[nodiscard]] size_t queued_bytes() const noexcept {
+    return queued_bytes_;
+  }
+
+  /**
+   * @brief Returns a snapshot of the client counters.
+   */
+  [[nodiscard]] Stats get_stats() const noexcept {
+    return stats_;
+  }
+
+private:
+  enum class State { Disconnected, Connecting, Connected };
+
+  std::vector<uint8_t>& new_frame();
+  bool in_flight_full() const noexcept;
+  uint16_t next_packet_id();
+  stdx::expected<void, std::string> queue_connect();
+  stdx::expected<size_t, std::string> read_packets();
+  stdx::expected<size_t, std::string> handle_packet(uint8_t header,
+                                                    std::span<const uint8_t> body);
+  stdx::expected<void, std::string> on_keepalive();
+  void set_want_write(bool enabled);
+  void arm_keepalive(bool enabled);
+  void close_socket();
+
+  Options options_;
+  MessageCallback message_callback_;
+
+  int epoll_fd_{-1};
+  int timer_fd_{-1};
+  int socket_fd_{-1};
+  State state_{State::Disconnected};
+  bool want_write_{false};
+  uint8_t connack_code_{0};
+
+  // Receive buffer: packets are decoded in place, the unparsed tail is compacted
+  std::vector<uint8_t> rx_;
+  size_t rx_len_{0};
+
+  // Send queue of encoded packets; tx_offset_ bytes of the front one are written
+  std::deque<std::vector<uint8_t>> tx_;
+  std::vector<std::vector<uint8_t>> spare_frames_;
+  size_t tx_offset_{0};
+  size_t queued_bytes_{0};
+
+  std::unordered_set<uint16_t> pending_acks_;
+  uint16_t last_packet_id_{0};
+
+  std::chrono::steady_clock::time_point last_write_;
+  std::chrono::steady_clock::time_point ping_sent_;
+  bool ping_outstanding_{false};
+
+  Stats stats_;
+};
+
+} // namespace sparkplug
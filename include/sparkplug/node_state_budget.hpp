@@ -0,0 +1,135 @@
+// include/sparkplug/node_state_budget.hpp
+#pragma once
+
+#include "detail/node_key.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <string_view>
+
+namespace sparkplug {
+
+/**
+ * @brief Node state memory counters, from NodeStateBudget::stats().
+ */
+struct NodeMemoryStats {
+  size_t budget_bytes{0}; ///< Configured budget (0 = accounting only)
+  size_t used_bytes{0};   ///< Estimated bytes of all tracked node state
+  size_t shared_bytes{0}; ///< Part of used_bytes shared by nodes, counted once
+  size_t nodes{0};        ///< Nodes tracked, including tombstones
+  size_t evictable{0};    ///< Offline nodes whose state can still be evicted
+  size_t tombstones{0};   ///< Nodes reduced to tombstones
+  uint64_t evictions{0};  ///< Offline nodes evicted to tombstones so far
+};
+
+/**
+ * @brief Keeps the estimated memory of host node state under a byte budget.
+ *
+ * The owner reports each node's estimated size whenever it changes (births,
+ * deaths, timeouts) along with its residency: online, offline or tombstone.
+ * Offline nodes are kept in least-recently-active order. While used_bytes()
+ * exceeds the budget, victim() names the offline node to evict first; the owner
+ * drops its heavy state (alias tables, devices) and reports it again as a
+ * Tombstone. Online nodes are never candidates, so the budget is a target: it
+ * can be exceeded when the online fleet alone is larger.
+ *
+ * Memory that nodes share (alias tables) is reported once through
+ * set_shared_bytes() rather than split among the node sizes, so it cannot drift
+ * as holders come and go. It counts toward the budget, and evicting the last
+ * holder of a shared object frees it.
+ *
+ * Every call is one hash lookup plus O(1) list work.
+ *
+ * HostApplication::enable_memory_budget() reports every node it tracks and
+ * evicts the victims; a custom host can drive the same cycle from its own
+ * birth/death handling.
+ *
+ * @par Thread Safety
+ * Not thread-safe. update() and victim() must run under the same lock as the
+ * node state they describe, or the victim may already have changed residency.
+ */
+class NodeStateBudget {
+public:
+  /**
+   * @brief Where a node's state stands with respect to eviction.
+   */
+  enum class Residency : uint8_t {
+    Online,   ///< In use; never evicted
+    Offline,  ///< Heavy state still held; evictable, oldest first
+    Tombstone ///< Heavy state dropped; only scalars remain
+  };
+
+  /**
+   * @brief A node chosen for eviction.
+   */
+  struct Node {
+    std::string group_id;
+    std::string edge_node_id;
+  };
+
+  /// `budget_bytes` of 0 tracks usage without ever naming a victim.
+  explicit NodeStateBudget(size_t budget_bytes);
+
+  /**
+   * @brief Records a node's current estimated size and residency.
+   *
+   * An Offline node moves to the most recently active end of the eviction
+   * order. An Offline to Tombstone transition counts as an eviction.
+   */
+  void update(std::string_view group_id,
+              std::string_view edge_node_id,
+              size_t bytes,
+              Residency residency);
+
+  /// Records the memory shared by nodes; replaces the previous value.
+  void set_shared_bytes(size_t bytes) noexcept {
+    shared_ = bytes;
+  }
+
+  /// Stops tracking a node (its state was removed).
+  void erase(std::string_view group_id, std::string_view edge_node_id);
+
+  /// True if the node has been reported.
+  [[nodiscard]] bool contains(std::string_view group_id,
+                              std::string_view edge_node_id) const;
+
+  /**
+   * @brief The offline node to evict next, or nullptr if within budget or none.
+   */
+  [[nodiscard]] const Node* victim() const;
+
+  /// Forgets every node and the shared memory; the eviction count is kept.
+  void clear();
+
+  [[nodiscard]] size_t used_bytes() const noexcept {
+    return used_ + shared_;
+  }
+
+  [[nodiscard]] size_t budget_bytes() const noexcept {
+    return budget_;
+  }
+
+  [[nodiscard]] NodeMemoryStats stats() const;
+
+private:
+  struct Entry {
+    Node node;
+    size_t bytes{0};
+    Residency residency{Residency::Online};
+    std::list<const Entry*>::iterator lru; // Valid while Offline
+  };
+
+  using EntryMap = detail::NodeKeyMap<Entry>;
+
+  size_t budget_;
+  size_t used_{0};   // Node sizes
+  size_t shared_{0}; // Reported by set_shared_bytes()
+  size_t tombstones_{0};
+  uint64_t evictions_{0};
+  EntryMap entries_;            // Map nodes are stable, so lru_ can point at them
+  std::list<const Entry*> lru_; // Offline entries, least recently active first
+};
+
+} // namespace sparkplug
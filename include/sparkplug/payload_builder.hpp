@@ -363,6 +363,18 @@ public:
     return *this;
   }
 
+  /**
+   * @brief Empties the builder for reuse, as if newly constructed.
+   *
+   * Clears the metrics, the timestamp and the seq, including the flags that tell
+   * Publisher they were set explicitly. The proto keeps its allocations.
+   */
+  void reset() noexcept {
+    payload_.Clear();
+    seq_explicitly_set_ = false;
+    timestamp_explicitly_set_ = false;
+  }
+
   // Query methods
   [[nodiscard]] bool has_seq() const noexcept {
     return seq_explicitly_set_;
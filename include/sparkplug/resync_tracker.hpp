@@ -0,0 +1,146 @@
+// include/sparkplug/resync_tracker.hpp
+#pragma once
+
+#include "detail/node_key.hpp"
+#include "detail/token_bucket.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace sparkplug {
+
+/**
+ * @brief Resync counters, from ResyncTracker::stats().
+ */
+struct ResyncStats {
+  size_t pending{0};        ///< Nodes whose continuity is not known yet
+  size_t queued{0};         ///< Rebirths waiting for the rate limit
+  size_t awaiting_birth{0}; ///< Rebirth requested, NBIRTH not received yet
+  uint64_t resumed{0};      ///< Nodes that continued in sequence (no rebirth)
+  uint64_t rebirths{0};     ///< Rebirth requests issued (including retries)
+};
+
+/**
+ * @brief Decides which edge nodes need a rebirth after the host lost its session.
+ *
+ * After a reconnect every node that was online is mark()ed. Its next message
+ * settles it: a message that continues the node's seq sequence (or a new NBIRTH
+ * or NDEATH) confirm()s it, with no rebirth; a gap means messages were lost and
+ * the node is queued for a rebirth request. poll() releases queued requests
+ * through a token bucket of Options::rebirths_per_second (bursts of up to
+ * Options::burst), so only the nodes that actually lost data rebirth and they do
+ * not all rebirth at once. A node that has not sent an NBIRTH
+ * Options::retry_after after its request is queued again.
+ *
+ * HostApplication::enable_auto_reconnect() marks its online nodes on every
+ * reconnect and sends the requests poll() returns from its reconnect thread.
+ *
+ * @par Thread Safety
+ * Not thread-safe. Calls that settle a node must be ordered with the messages
+ * that settle it, so the caller holds one lock across both.
+ */
+class ResyncTracker {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  /**
+   * @brief Rebirth rate limit options.
+   */
+  struct Options {
+    double rebirths_per_second{20.0};             ///< Sustained rate (0 = unlimited)
+    size_t burst{20};                             ///< Requests allowed back to back
+    std::chrono::milliseconds retry_after{10000}; ///< Re-request without NBIRTH
+  };
+
+  /**
+   * @brief A node to send "Node Control/Rebirth" to.
+   */
+  struct Request {
+    std::string group_id;
+    std::string edge_node_id;
+  };
+
+  ResyncTracker();
+  explicit ResyncTracker(Options options, Clock::time_point start = Clock::now());
+
+  /// Marks a node whose sequence continuity is unknown (e.g. after a reconnect).
+  void mark(std::string_view group_id, std::string_view edge_node_id);
+
+  /// True if the node is marked, queued or awaiting its rebirth.
+  [[nodiscard]] bool tracked(std::string_view group_id,
+                             std::string_view edge_node_id) const;
+
+  /// True if the node is marked and its next message decides whether it rebirths.
+  [[nodiscard]] bool pending(std::string_view group_id,
+                             std::string_view edge_node_id) const;
+
+  /**
+   * @brief The node is in sync again (continued in sequence, NBIRTH or NDEATH).
+   */
+  void confirm(std::string_view group_id, std::string_view edge_node_id);
+
+  /**
+   * @brief The node's sequence broke: queue a rebirth request.
+   *
+   * Ignored for nodes already queued or awaiting a rebirth.
+   */
+  void broken(std::string_view group_id, std::string_view edge_node_id);
+
+  /// Stops tracking a node without counting it as resumed (host memory eviction).
+  void forget(std::string_view group_id, std::string_view edge_node_id);
+
+  /**
+   * @brief Appends the rebirth requests the rate limit allows at `now` to `out`.
+   *
+   * @return Number of requests appended
+   */
+  size_t poll(std::vector<Request>& out, Clock::time_point now = Clock::now());
+
+  /// Nodes tracked in any state.
+  [[nodiscard]] size_t size() const noexcept {
+    return entries_.size();
+  }
+
+  [[nodiscard]] ResyncStats stats() const;
+
+  [[nodiscard]] const Options& options() const noexcept {
+    return options_;
+  }
+
+private:
+  enum class State : uint8_t { Pending, Queued, Requested };
+
+  struct Entry {
+    Request node;
+    State state{State::Pending};
+    Clock::time_point requested_at{};
+  };
+
+  using EntryMap = detail::NodeKeyMap<Entry>;
+
+  Options options_;
+  EntryMap entries_;
+  std::deque<detail::NodeKey> queue_; // Rebirths in request order (lazily pruned)
+  std::deque<std::pair<Clock::time_point, detail::NodeKey>> requested_; // Retry order
+  detail::TokenBucket bucket_;
+  uint64_t resumed_{0};
+  uint64_t rebirths_{0};
+};
+
+/**
+ * @brief Options for HostApplication::enable_auto_reconnect().
+ */
+struct ReconnectOptions {
+  std::chrono::milliseconds min_delay{500};   ///< First retry delay
+  std::chrono::milliseconds max_delay{30000}; ///< Retry delay cap
+  bool republish_state{true};                 ///< Republish a published STATE birth
+  ResyncTracker::Options resync{};            ///< Rebirth policy for nodes that lost data
+};
+
+} // namespace sparkplug
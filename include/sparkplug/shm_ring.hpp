@@ -0,0 +1,221 @@
+// include/sparkplug/shm_ring.hpp
+#pragma once
+
+#include "detail/compat.hpp"
+#include "sink.hpp"
+#include "sparkplug_b.pb.h"
+#include "topic.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+namespace sparkplug {
+
+/**
+ * @brief Metric value as seen by a ShmRingReader (strings point into the reader).
+ */
+using MetricValueView =
+    std::variant<std::monostate, int64_t, uint64_t, double, bool, std::string_view>;
+
+/**
+ * @brief One alias-resolved metric of a message read from a shared-memory ring.
+ */
+struct ShmMetric {
+  std::string_view name;     ///< Metric name (resolved from the birth alias table)
+  uint64_t alias{0};         ///< Metric alias (0 if has_alias is false)
+  bool has_alias{false};     ///< True if the metric carried an alias
+  bool is_historical{false}; ///< True if the metric was flagged historical
+  uint32_t datatype{0};      ///< Sparkplug DataType value
+  uint64_t timestamp{0};     ///< Metric timestamp, or payload timestamp if absent
+  MetricValueView value;     ///< Decoded value
+};
+
+/**
+ * @brief One validated Sparkplug message read from a shared-memory ring.
+ *
+ * All views point into the reader's frame buffer and remain valid until the next
+ * ShmRingReader::try_read() call.
+ */
+struct ShmMessage {
+  std::string_view group_id;       ///< Group ID
+  MessageType message_type;        ///< Message type
+  std::string_view edge_node_id;   ///< Edge node ID
+  std::string_view device_id;      ///< Device ID (empty for node-level messages)
+  uint64_t timestamp{0};           ///< Payload timestamp (0 if absent)
+  std::optional<uint64_t> seq;     ///< Payload sequence number, if present
+  std::span<const ShmMetric> metrics; ///< Decoded metrics
+};
+
+/**
+ * @brief Single-writer side of a shared-memory broadcast ring.
+ *
+ * Lets one ingesting process (typically the HostApplication subscribed to
+ * spBv1.0/#) decode and validate each message once and fan it out to any number
+ * of local consumer processes, instead of every process holding its own broker
+ * subscription.
+ *
+ * Messages are stored as flat, alias-resolved frames. The writer never waits for
+ * readers: a reader that falls more than one ring capacity behind detects the
+ * overrun and skips ahead (see ShmRingReader::overruns()).
+ *
+ * The segment is created with shm_open() and removed when the writer is destroyed.
+ *
+ * @par Thread Safety
+ * Single writer. publish()/write() must not be called concurrently.
+ *
+ * @par Example Usage
+ * @code
+ * auto ring = sparkplug::ShmRingWriter::create("/sparkplug_fanout", 16 << 20);
+ * if (ring) {
+ *   host.set_shm_ring(std::make_shared<sparkplug::ShmRingWriter>(std::move(*ring)));
+ * }
+ * @endcode
+ */
+class ShmRingWriter {
+public:
+  /**
+   * @brief Creates (or replaces) a shared-memory ring.
+   *
+   * @param name POSIX shared memory name (e.g., "/sparkplug_fanout")
+   * @param capacity Data capacity in bytes (rounded up to a power of two)
+   *
+   * @return The writer on success, error message on failure
+   */
+  [[nodiscard]] static stdx::expected<ShmRingWriter, std::string>
+  create(std::string name, size_t capacity);
+
+  ~ShmRingWriter();
+
+  ShmRingWriter(const ShmRingWriter&) = delete;
+  ShmRingWriter& operator=(const ShmRingWriter&) = delete;
+  ShmRingWriter(ShmRingWriter&& other) noexcept;
+  ShmRingWriter& operator=(ShmRingWriter&& other) noexcept;
+
+  /**
+   * @brief Encodes a decoded message into a flat frame and publishes it.
+   *
+   * @param topic Parsed topic
+   * @param payload Decoded payload
+   * @param alias_map Birth alias table used to fill in missing names (may be nullptr)
+   *
+   * @return void on success, error message if the frame exceeds half the capacity
+   */
+  [[nodiscard]] stdx::expected<void, std::string>
+  publish(const Topic& topic,
+          const org::eclipse::tahu::protobuf::Payload& payload,
+          const std::unordered_map<uint64_t, std::string>* alias_map = nullptr);
+
+  /**
+   * @brief Publishes an already encoded frame body.
+   */
+  [[nodiscard]] stdx::expected<void, std::string> write(std::span<const uint8_t> frame);
+
+  /**
+   * @brief Returns the data capacity in bytes.
+   */
+  [[nodiscard]] size_t capacity() const noexcept {
+    return capacity_;
+  }
+
+  /**
+   * @brief Returns the shared memory name.
+   */
+  [[nodiscard]] const std::string& name() const noexcept {
+    return name_;
+  }
+
+private:
+  ShmRingWriter() = default;
+  void release() noexcept;
+
+  std::string name_;
+  void* mapping_{nullptr};
+  size_t mapping_size_{0};
+  size_t capacity_{0};
+  uint64_t position_{0};
+  std::string scratch_; // Reused frame encoding buffer
+};
+
+/**
+ * @brief Reader side of a shared-memory broadcast ring.
+ *
+ * Each consumer process opens its own reader; readers are independent and do not
+ * affect the writer or each other. A reader starts at the current write position
+ * and only sees messages published after open().
+ *
+ * try_read() copies one frame out of the ring (a single memcpy, no protobuf
+ * decoding) and validates afterwards that the writer did not overwrite it
+ * mid-copy. Polling is non-blocking; callers decide how to wait between polls.
+ *
+ * @par Thread Safety
+ * Not thread-safe. Use one reader per thread.
+ *
+ * @par Example Usage
+ * @code
+ * auto reader = sparkplug::ShmRingReader::open("/sparkplug_fanout");
+ * while (running) {
+ *   while (auto msg = reader->try_read()) {
+ *     for (const auto& metric : msg->metrics) { ... }
+ *   }
+ *   std::this_thread::sleep_for(std::chrono::milliseconds(1));
+ * }
+ * @endcode
+ */
+class ShmRingReader {
+public:
+  /**
+   * @brief Attaches to an existing ring (read-only mapping).
+   *
+   * @param name POSIX shared memory name used by the writer
+   *
+   * @return The reader on success, error message on failure
+   */
+  [[nodiscard]] static stdx::expected<ShmRingReader, std::string> open(std::string name);
+
+  ~ShmRingReader();
+
+  ShmRingReader(const ShmRingReader&) = delete;
+  ShmRingReader& operator=(const ShmRingReader&) = delete;
+  ShmRingReader(ShmRingReader&& other) noexcept;
+  ShmRingReader& operator=(ShmRingReader&& other) noexcept;
+
+  /**
+   * @brief Reads the next message, if any.
+   *
+   * @return The message (valid until the next call), or std::nullopt if the reader
+   * is caught up
+   */
+  [[nodiscard]] std::optional<ShmMessage> try_read();
+
+  /**
+   * @brief Reads the next raw frame body, if any (valid until the next call).
+   */
+  [[nodiscard]] std::optional<std::span<const uint8_t>> try_read_frame();
+
+  /**
+   * @brief Number of times this reader fell behind and skipped ahead.
+   */
+  [[nodiscard]] uint64_t overruns() const noexcept {
+    return overruns_;
+  }
+
+private:
+  ShmRingReader() = default;
+  void release() noexcept;
+
+  const void* mapping_{nullptr};
+  size_t mapping_size_{0};
+  size_t capacity_{0};
+  uint64_t position_{0};
+  uint64_t overruns_{0};
+  std::vector<uint8_t> frame_;    // Reused frame copy
+  std::vector<ShmMetric> metrics_; // Reused metric views
+};
+
+} // namespace sparkplug
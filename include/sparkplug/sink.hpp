@@ -0,0 +1,247 @@
+// include/sparkplug/sink.hpp
+#pragma once
+
+#include "detail/compat.hpp"
+#include "logging.hpp"
+#include "sparkplug_b.pb.h"
+#include "topic.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+namespace sparkplug {
+
+/**
+ * @brief Decoded value of a single metric.
+ *
+ * Signed integer types map to int64_t, unsigned integer types (and DateTime) to
+ * uint64_t, Float/Double to double, String/Text/UUID to std::string. Null metrics and
+ * unsupported types (DataSet, Template, Bytes, ...) are std::monostate.
+ */
+using MetricValue =
+    std::variant<std::monostate, int64_t, uint64_t, double, bool, std::string>;
+
+/**
+ * @brief Decodes the value of a single metric according to its datatype.
+ */
+[[nodiscard]] MetricValue
+decode_metric_value(const org::eclipse::tahu::protobuf::Payload::Metric& metric);
+
+/**
+ * @brief Decodes a numeric or boolean metric (booleans as 0/1) as a double.
+ *
+ * @return std::nullopt for null, string and unsupported values
+ */
+[[nodiscard]] std::optional<double>
+decode_metric_number(const org::eclipse::tahu::protobuf::Payload::Metric& metric);
+
+/**
+ * @brief One metric sample flattened out of a Sparkplug payload.
+ *
+ * Records are self-contained so sinks never need access to HostApplication state:
+ * the metric name is already resolved from the birth alias table.
+ */
+struct MetricRecord {
+  std::string group_id;     ///< Group ID of the originating edge node
+  std::string edge_node_id; ///< Edge node ID
+  std::string device_id;    ///< Device ID (empty for node-level metrics)
+  MessageType message_type; ///< NBIRTH, NDATA, DBIRTH or DDATA
+  std::string name;         ///< Metric name (resolved from alias for DATA messages)
+  uint64_t alias{0};        ///< Metric alias (0 if has_alias is false)
+  bool has_alias{false};    ///< True if the metric carried an alias
+  uint32_t datatype{0};     ///< Sparkplug DataType value
+  uint64_t timestamp{0};    ///< Metric timestamp, or payload timestamp if absent
+  bool is_historical{false}; ///< True if the metric was flagged historical
+  MetricValue value;         ///< Decoded value
+};
+
+/**
+ * @brief Flattens the metrics of a BIRTH/DATA payload into MetricRecords.
+ *
+ * @param topic Parsed topic of the message
+ * @param payload Decoded Sparkplug payload
+ * @param alias_map Alias table from the matching NBIRTH/DBIRTH (may be nullptr)
+ * @param out Records are appended to this vector
+ *
+ * @note Other message types (DEATH, CMD, STATE) produce no records.
+ */
+void append_metric_records(const Topic& topic,
+                           const org::eclipse::tahu::protobuf::Payload& payload,
+                           const std::unordered_map<uint64_t, std::string>* alias_map,
+                           std::vector<MetricRecord>& out);
+
+/**
+ * @brief Downstream consumer of batched metric records (database, Kafka, file...).
+ *
+ * Implementations are called from a dedicated SinkPipeline thread, one batch at a
+ * time, so they do not need internal locking.
+ */
+class Sink {
+public:
+  virtual ~Sink() = default;
+
+  /**
+   * @brief Writes a batch of records.
+   *
+   * @return void on success, error message on failure (the batch is counted as
+   * failed and not retried)
+   */
+  [[nodiscard]] virtual stdx::expected<void, std::string>
+  write(std::span<const MetricRecord> batch) = 0;
+
+  /**
+   * @brief Flushes buffered output. Called after each batch and on shutdown.
+   */
+  [[nodiscard]] virtual stdx::expected<void, std::string> flush() {
+    return {};
+  }
+};
+
+/**
+ * @brief What a SinkPipeline does when its queue reaches the high-water mark.
+ */
+enum class BackpressurePolicy {
+  Block,      ///< Block the ingest thread until the queue drains to the low-water mark
+  DropNewest, ///< Discard incoming records
+  DropOldest  ///< Discard the oldest queued records
+};
+
+/**
+ * @brief Batching and backpressure parameters for a SinkPipeline.
+ */
+struct SinkOptions {
+  size_t max_batch_size = 1000; ///< Flush when this many records are queued
+  std::chrono::milliseconds flush_interval{1000}; ///< Flush at least this often
+  size_t high_water_mark = 100000; ///< Queue depth (records) that triggers the policy
+  size_t low_water_mark = 50000;   ///< Queue depth at which a blocked ingest resumes
+  BackpressurePolicy policy = BackpressurePolicy::Block;
+};
+
+/**
+ * @brief Counters describing a SinkPipeline (snapshot).
+ */
+struct SinkStats {
+  uint64_t records_enqueued{0}; ///< Records accepted into the queue
+  uint64_t records_written{0};  ///< Records successfully written by the sink
+  uint64_t records_dropped{0};  ///< Records discarded by DropNewest/DropOldest
+  uint64_t batches_written{0};  ///< Successful Sink::write() calls
+  uint64_t write_errors{0};     ///< Failed Sink::write()/flush() calls
+  uint64_t high_water_events{0}; ///< Times the queue reached the high-water mark
+  size_t queue_depth{0};         ///< Records currently queued
+};
+
+/**
+ * @brief Runs a Sink on a dedicated thread behind a bounded, batching queue.
+ *
+ * Records are flushed to the sink when max_batch_size records are queued or when
+ * flush_interval elapses, whichever comes first. When the queue reaches
+ * high_water_mark the configured BackpressurePolicy applies; with Block, push()
+ * stalls the caller (the MQTT ingest thread when owned by HostApplication) until
+ * the sink catches up, which in turn throttles the broker connection.
+ *
+ * @par Thread Safety
+ * push() and stats() may be called from any thread. The sink itself is only ever
+ * invoked from the pipeline thread.
+ */
+class SinkPipeline {
+public:
+  /**
+   * @brief Starts the pipeline thread.
+   *
+   * @param sink Sink to drive (shared so the caller may keep a handle to it)
+   * @param options Batching and backpressure options
+   * @param log_callback Optional callback for write errors
+   */
+  SinkPipeline(std::shared_ptr<Sink> sink,
+               SinkOptions options,
+               LogCallback log_callback = {});
+
+  /**
+   * @brief Stops the pipeline, writing any queued records first.
+   */
+  ~SinkPipeline();
+
+  SinkPipeline(const SinkPipeline&) = delete;
+  SinkPipeline& operator=(const SinkPipeline&) = delete;
+  SinkPipeline(SinkPipeline&&) = delete;
+  SinkPipeline& operator=(SinkPipeline&&) = delete;
+
+  /**
+   * @brief Enqueues records, applying the backpressure policy.
+   *
+   * @return Number of records accepted (less than records.size() only with DropNewest)
+   */
+  size_t push(std::span<const MetricRecord> records);
+
+  /**
+   * @brief Drains the queue, writes the remaining records and joins the thread.
+   *
+   * Idempotent. After stop(), push() discards everything.
+   */
+  void stop();
+
+  /**
+   * @brief Returns a snapshot of the pipeline counters.
+   */
+  [[nodiscard]] SinkStats stats() const;
+
+private:
+  std::shared_ptr<Sink> sink_;
+  SinkOptions options_;
+  LogCallback log_callback_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable data_cv_;  // Signals the pipeline thread
+  std::condition_variable space_cv_; // Signals producers blocked on high-water
+  std::deque<MetricRecord> queue_;
+  bool stopping_{false};
+  SinkStats stats_;
+
+  std::thread thread_;
+
+  void run();
+  void write_batch(std::vector<MetricRecord>& batch);
+};
+
+/**
+ * @brief Reference Sink that appends records to a CSV file.
+ *
+ * Columns: timestamp,group_id,edge_node_id,device_id,message_type,name,datatype,value
+ * Strings are double-quoted with embedded quotes doubled (RFC 4180).
+ * The file is opened lazily on the first write.
+ */
+class FileSink : public Sink {
+public:
+  /**
+   * @brief Creates a file sink.
+   *
+   * @param path Output file path
+   * @param append Append to an existing file instead of truncating it
+   */
+  explicit FileSink(std::string path, bool append = true);
+
+  [[nodiscard]] stdx::expected<void, std::string>
+  write(std::span<const MetricRecord> batch) override;
+
+  [[nodiscard]] stdx::expected<void, std::string> flush() override;
+
+private:
+  std::string path_;
+  bool append_;
+  std::ofstream out_;
+  std::string line_; // Reused line buffer
+};
+
+} // namespace sparkplug
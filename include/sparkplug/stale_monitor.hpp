@@ -0,0 +1,122 @@
+// include/sparkplug/stale_monitor.hpp
+#pragma once
+
+#include "detail/node_key.hpp"
+#include "detail/timer_wheel.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sparkplug {
+
+/**
+ * @brief Detects edge nodes and devices that stopped publishing without a death.
+ *
+ * Every message from a node or device touch()es its entry, which only records the
+ * arrival time: no timer is moved per message. Each entry owns one timer in a
+ * hierarchical wheel, armed for last-seen + timeout. When it fires, an entry that
+ * was touched in the meantime is simply re-armed for its new deadline; one that
+ * was not is reported by expire() and forgotten until it is touched again.
+ *
+ * Per-message cost is one hash lookup and a store; expiry work is proportional to
+ * the timeouts that elapse, not to the number of watched nodes.
+ *
+ * HostApplication::enable_stale_detection() touches entries as messages arrive
+ * and calls expire() on every message; HostApplication::check_stale() lets the
+ * application expire a fleet that has gone entirely silent.
+ *
+ * @par Thread Safety
+ * Not thread-safe; touch() on the MQTT thread and expire() on the application's
+ * thread need a common lock.
+ */
+class StaleMonitor {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  /**
+   * @brief Timeout options.
+   */
+  struct Options {
+    std::chrono::milliseconds node_timeout{60000}; ///< Silence before a node is stale
+    std::chrono::milliseconds device_timeout{0};   ///< Same for devices (0 = not watched)
+    std::chrono::milliseconds tick{100};           ///< Expiry resolution
+  };
+
+  /**
+   * @brief A node (empty device_id) or device whose timeout elapsed.
+   */
+  struct Expired {
+    std::string group_id;
+    std::string edge_node_id;
+    std::string device_id;
+  };
+
+  StaleMonitor();
+  explicit StaleMonitor(Options options, Clock::time_point start = Clock::now());
+
+  // Wheel callbacks point back at this object
+  StaleMonitor(const StaleMonitor&) = delete;
+  StaleMonitor& operator=(const StaleMonitor&) = delete;
+  StaleMonitor(StaleMonitor&&) = delete;
+  StaleMonitor& operator=(StaleMonitor&&) = delete;
+
+  /**
+   * @brief Records a message from a node (empty device_id) or device.
+   *
+   * Starts watching entries seen for the first time. Device touches are ignored
+   * when Options::device_timeout is zero.
+   */
+  void touch(std::string_view group_id,
+             std::string_view edge_node_id,
+             std::string_view device_id,
+             Clock::time_point now = Clock::now());
+
+  /**
+   * @brief Stops watching a node or device, e.g. after its NDEATH/DDEATH.
+   */
+  void remove(std::string_view group_id,
+              std::string_view edge_node_id,
+              std::string_view device_id);
+
+  /**
+   * @brief Appends entries silent past their timeout at `now` to `out`.
+   *
+   * Reported entries are no longer watched. Returns immediately when called again
+   * within the same tick, so it can run on every message.
+   *
+   * @return Number of entries appended
+   */
+  size_t expire(Clock::time_point now, std::vector<Expired>& out);
+
+  /// Number of watched nodes and devices.
+  [[nodiscard]] size_t size() const noexcept {
+    return index_.size();
+  }
+
+  [[nodiscard]] const Options& options() const noexcept {
+    return options_;
+  }
+
+private:
+  struct Entry {
+    detail::NodeKey key; // Empty while the slot is free
+    Clock::time_point last_seen;
+    detail::TimerWheel::TimerId timer;
+    bool device{false};
+  };
+
+  void arm(uint32_t id, Clock::time_point deadline);
+  void release(uint32_t id);
+
+  Options options_;
+  detail::TimerWheel wheel_;
+  std::vector<Entry> entries_; // Slab of watched nodes and devices
+  std::vector<uint32_t> free_;
+  std::vector<uint32_t> fired_; // Entries whose timer fired, reused by expire()
+  detail::NodeKeyMap<uint32_t> index_; // Probed with a view, so touch() never allocates
+};
+
+} // namespace sparkplug
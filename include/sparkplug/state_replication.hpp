@@ -0,0 +1,125 @@
+// include/sparkplug/state_replication.hpp
+#pragma once
+
+#include "detail/compat.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace sparkplug {
+
+/**
+ * @brief Local transport for HostApplication state replication frames.
+ *
+ * Carries the frames produced by HostApplication::export_state_snapshot() and
+ * export_state_delta() from an active host to a warm standby over a Unix domain
+ * stream socket. Each frame is sent with a 4-byte length prefix.
+ *
+ * The standby listen()s and the active host connect()s. A standby accepts a new
+ * active host at any time (replacing the previous connection), so the active host
+ * should start every connection with a snapshot.
+ *
+ * @par Thread Safety
+ * Not thread-safe. Use one channel per thread.
+ *
+ * @par Example Usage
+ * @code
+ * // Active host, e.g. once a second
+ * auto channel = sparkplug::ReplicationChannel::connect("/run/scada/replica.sock");
+ * channel->send(host.export_state_snapshot());
+ * while (running) {
+ *   if (auto delta = host.export_state_delta(); delta && !delta->empty()) {
+ *     channel->send(*delta);
+ *   }
+ * }
+ *
+ * // Standby
+ * auto channel = sparkplug::ReplicationChannel::listen("/run/scada/replica.sock");
+ * while (!primary_failed) {
+ *   if (auto frame = channel->receive(std::chrono::milliseconds(100)); frame && *frame) {
+ *     standby.import_state(**frame);
+ *   }
+ * }
+ * @endcode
+ */
+class ReplicationChannel {
+public:
+  /**
+   * @brief Creates the standby side: binds and listens on `socket_path`.
+   *
+   * A stale socket file at the path is replaced.
+   */
+  [[nodiscard]] static stdx::expected<ReplicationChannel, std::string>
+  listen(std::string socket_path);
+
+  /**
+   * @brief Creates the active side: connects to a listening standby.
+   */
+  [[nodiscard]] static stdx::expected<ReplicationChannel, std::string>
+  connect(std::string socket_path);
+
+  ~ReplicationChannel();
+
+  ReplicationChannel(const ReplicationChannel&) = delete;
+  ReplicationChannel& operator=(const ReplicationChannel&) = delete;
+  ReplicationChannel(ReplicationChannel&& other) noexcept;
+  ReplicationChannel& operator=(ReplicationChannel&& other) noexcept;
+
+  /**
+   * @brief Sends one frame (active side); blocks until it is written.
+   *
+   * @return void on success, error message if the standby went away
+   */
+  [[nodiscard]] stdx::expected<void, std::string> send(std::span<const uint8_t> frame);
+
+  /**
+   * @brief Waits up to `timeout` for the next frame (standby side).
+   *
+   * Accepts pending connections; a closed connection is dropped (with any partial
+   * frame) and the wait continues for a new one.
+   *
+   * @return The frame (valid until the next call), std::nullopt on timeout, or an
+   * error message on a socket failure
+   */
+  [[nodiscard]] stdx::expected<std::optional<std::span<const uint8_t>>, std::string>
+  receive(std::chrono::milliseconds timeout);
+
+  /**
+   * @brief True while a peer connection is open.
+   */
+  [[nodiscard]] bool is_connected() const noexcept {
+    return peer_fd_ >= 0;
+  }
+
+private:
+  ReplicationChannel() = default;
+  void close_peer() noexcept;
+  void release() noexcept;
+
+  std::string path_;   // Unlinked on destruction by the listening side
+  int listen_fd_{-1};  // Standby only
+  int peer_fd_{-1};    // Connected stream
+  std::vector<uint8_t> rx_;
+  size_t rx_len_{0};   // Buffered bytes in rx_
+  size_t consumed_{0}; // Bytes of the frame returned by the last receive()
+};
+
+/**
+ * @brief Atomically replaces `path` with a replication frame (write, then rename).
+ *
+ * For standbys that share a filesystem with the active host rather than a socket.
+ */
+[[nodiscard]] stdx::expected<void, std::string>
+write_state_file(const std::string& path, std::span<const uint8_t> frame);
+
+/**
+ * @brief Reads a frame written by write_state_file().
+ */
+[[nodiscard]] stdx::expected<std::vector<uint8_t>, std::string>
+read_state_file(const std::string& path);
+
+} // namespace sparkplug
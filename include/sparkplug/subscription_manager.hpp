@@ -0,0 +1,163 @@
+// include/sparkplug/subscription_manager.hpp
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace sparkplug {
+
+/**
+ * @brief Broker-side state of one desired subscription.
+ */
+enum class SubscriptionState : uint8_t {
+  None,     ///< Not desired
+  Pending,  ///< Desired, SUBSCRIBE not sent yet (or to be replayed)
+  InFlight, ///< SUBSCRIBE sent, waiting for the SUBACK
+  Active,   ///< Granted by the broker
+  Failed,   ///< Refused by the broker (SUBACK 0x80) or the request failed
+};
+
+/**
+ * @brief Subscription counts, from SubscriptionManager::stats().
+ */
+struct SubscriptionStats {
+  size_t desired{0};    ///< Topic filters the application asked for
+  size_t active{0};     ///< Granted by the broker
+  size_t pending{0};    ///< Not granted yet (pending or in flight)
+  size_t failed{0};     ///< Refused
+  uint64_t batches{0};  ///< SUBSCRIBE/UNSUBSCRIBE packets planned so far
+  uint64_t refusals{0}; ///< Topic filters refused so far
+};
+
+/**
+ * @brief Desired-vs-active subscription set, applied in batches.
+ *
+ * The application adds and removes topic filters; plan() diffs the desired set
+ * against what the broker has acknowledged and returns the SUBSCRIBE and
+ * UNSUBSCRIBE requests still needed, each carrying up to Options::max_batch
+ * filters (one MQTTAsync_subscribeMany()/unsubscribeMany() call each). The
+ * outcome of each batch is reported back per topic with on_subscribed() (the
+ * granted QoS list of the SUBACK), on_unsubscribed() or on_failed().
+ *
+ * reset() marks the whole desired set for replay, for use after a (re)connect.
+ * Only filters whose state changed since the last plan() are examined, so a
+ * small change to a large set costs a small plan.
+ *
+ * Used by HostApplication; holds no MQTT state itself.
+ *
+ * @par Thread Safety
+ * Not thread-safe; HostApplication serializes access with its client mutex.
+ */
+class SubscriptionManager {
+public:
+  /**
+   * @brief Batching options.
+   */
+  struct Options {
+    size_t max_batch{100}; ///< Topic filters per SUBSCRIBE/UNSUBSCRIBE packet
+  };
+
+  /**
+   * @brief One SUBSCRIBE or UNSUBSCRIBE request to send.
+   */
+  struct Batch {
+    uint64_t id{0};
+    bool unsubscribe{false};
+    std::vector<std::string> topics{};
+    std::vector<int> qos{}; ///< Requested QoS per topic (SUBSCRIBE only)
+  };
+
+  SubscriptionManager();
+  explicit SubscriptionManager(Options options);
+
+  /**
+   * @brief Adds a topic filter to the desired set (or changes its QoS).
+   *
+   * @return true if a SUBSCRIBE is now needed
+   */
+  bool add(std::string_view topic, int qos);
+
+  /**
+   * @brief Removes a topic filter from the desired set.
+   *
+   * @return true if the filter was desired
+   */
+  bool remove(std::string_view topic);
+
+  /**
+   * @brief Appends the requests needed to reach the desired set and marks them
+   * in flight.
+   *
+   * @return Number of batches appended
+   */
+  size_t plan(std::vector<Batch>& out);
+
+  /**
+   * @brief Applies a SUBACK: `granted` holds the granted QoS (or 0x80) per topic.
+   *
+   * An empty span treats every topic of the batch as granted.
+   */
+  void on_subscribed(uint64_t batch_id, std::span<const int> granted);
+
+  /// Applies an UNSUBACK.
+  void on_unsubscribed(uint64_t batch_id);
+
+  /// The batch could not be sent or the broker rejected it as a whole.
+  void on_failed(uint64_t batch_id);
+
+  /**
+   * @brief Forgets in-flight requests and marks every desired filter pending.
+   *
+   * Call after (re)connecting; the next plan() replays the whole set.
+   */
+  void reset();
+
+  [[nodiscard]] SubscriptionState state(std::string_view topic) const;
+
+  [[nodiscard]] SubscriptionStats stats() const;
+
+  /// True when no desired filter is pending or in flight.
+  [[nodiscard]] bool settled() const;
+
+  /// Filters currently refused by the broker.
+  [[nodiscard]] std::vector<std::string> failed_topics() const;
+
+private:
+  struct StringHash {
+    using is_transparent = void;
+    [[nodiscard]] size_t operator()(std::string_view sv) const noexcept {
+      return std::hash<std::string_view>{}(sv);
+    }
+  };
+
+  struct Entry {
+    int qos{0};
+    int requested_qos{-1}; // QoS of the last SUBSCRIBE sent
+    bool desired{true};
+    bool queued{false};        // In dirty_
+    bool unsubscribing{false}; // The in-flight request is an UNSUBSCRIBE
+    SubscriptionState state{SubscriptionState::Pending};
+    uint64_t batch{0};
+  };
+
+  using EntryMap = std::unordered_map<std::string, Entry, StringHash, std::equal_to<>>;
+
+  void enqueue(EntryMap::iterator it);
+  void settle(EntryMap::iterator it);
+
+  Options options_;
+  EntryMap entries_;
+  std::vector<std::string> dirty_;
+  std::unordered_map<uint64_t, std::vector<std::string>> in_flight_;
+  uint64_t next_batch_{1};
+  uint64_t batches_{0};
+  uint64_t refusals_{0};
+};
+
+} // namespace sparkplug
@@ -0,0 +1,244 @@
+// include/sparkplug/tag_table.hpp
+#pragma once
+
+#include "datatype.hpp"
+#include "detail/compat.hpp"
+#include "payload_builder.hpp"
+
+#include <bit>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sparkplug {
+
+/**
+ * @brief Describes one tag (metric) in a shared-memory tag table.
+ */
+struct TagDefinition {
+  std::string name;  ///< Metric name (at most TagTable::kMaxNameLength bytes)
+  DataType datatype; ///< Scalar type: integers, Float, Double, Boolean or DateTime
+  uint64_t alias{0}; ///< Metric alias used in NDATA/DDATA messages
+};
+
+/**
+ * @brief Consistent snapshot of one tag slot.
+ */
+struct TagSample {
+  DataType datatype{DataType::Unknown}; ///< Slot datatype
+  uint64_t bits{0};         ///< Raw value (see TagTable::write() for the encoding)
+  uint64_t timestamp{0};    ///< Timestamp of the last write (ms since epoch)
+  uint64_t change_count{0}; ///< Number of writes to this slot (0 = never written)
+};
+
+/**
+ * @brief Shared-memory table of typed tag slots written by driver processes.
+ *
+ * Lets PLC/field drivers running as separate processes hand tag values to the
+ * process that owns the EdgeNode without sockets or per-update system calls: a
+ * driver stores a value straight into a slot of a shared mapping, and the edge
+ * node scans for changed slots with TagTableSource.
+ *
+ * Each slot is protected by a sequence lock whose counter doubles as the slot's
+ * change counter, so readers never block writers and never observe a torn value.
+ * A table-wide generation counter lets the scanner skip idle tables in O(1).
+ *
+ * Only fixed-size scalar types are supported (no strings or bytes).
+ *
+ * @par Thread Safety
+ * write() and read() may be called concurrently from any thread or process.
+ * Concurrent writes to the same slot are serialized by the slot's sequence lock.
+ * A writer that dies mid-write leaves its slot locked; read() and write() give up
+ * on it after 100 ms instead of hanging, until recover() releases it.
+ *
+ * @par Example Usage
+ * @code
+ * // Edge node process: define the tags
+ * auto table = sparkplug::TagTable::create("/plc_tags", {
+ *     {.name = "Line1/Speed", .datatype = sparkplug::DataType::Double, .alias = 1},
+ *     {.name = "Line1/Running", .datatype = sparkplug::DataType::Boolean, .alias = 2}});
+ *
+ * // Driver process: attach and write
+ * auto tags = sparkplug::TagTable::open("/plc_tags");
+ * auto speed = tags->find("Line1/Speed");
+ * (void)tags->write(*speed, 12.5, now_ms);
+ * @endcode
+ */
+class TagTable {
+public:
+  /// Maximum tag name length in bytes
+  static constexpr size_t kMaxNameLength = 79;
+
+  /**
+   * @brief Creates (or replaces) a tag table with the given tags.
+   *
+   * The segment is removed when the returned table is destroyed.
+   *
+   * @param name POSIX shared memory name (e.g., "/plc_tags")
+   * @param tags Tag definitions; slot indices follow this order
+   *
+   * @return The table on success, error message on failure
+   */
+  [[nodiscard]] static stdx::expected<TagTable, std::string>
+  create(std::string name, std::span<const TagDefinition> tags);
+
+  /**
+   * @brief Attaches to an existing tag table (e.g., from a driver process).
+   */
+  [[nodiscard]] static stdx::expected<TagTable, std::string> open(std::string name);
+
+  ~TagTable();
+
+  TagTable(const TagTable&) = delete;
+  TagTable& operator=(const TagTable&) = delete;
+  TagTable(TagTable&& other) noexcept;
+  TagTable& operator=(TagTable&& other) noexcept;
+
+  /**
+   * @brief Returns the number of slots.
+   */
+  [[nodiscard]] size_t size() const noexcept {
+    return slot_count_;
+  }
+
+  /**
+   * @brief Finds the slot index of a tag by name.
+   */
+  [[nodiscard]] std::optional<size_t> find(std::string_view name) const noexcept;
+
+  /**
+   * @brief Returns the definition of a slot.
+   */
+  [[nodiscard]] TagDefinition definition(size_t slot) const;
+
+  /**
+   * @brief Stores a value into a slot.
+   *
+   * Signed integers are stored sign-extended to 64 bits, Float as its IEEE-754
+   * bits in the low 32 bits, Double as its IEEE-754 bits, Boolean as 0/1.
+   *
+   * @param slot Slot index (from find() or definition order)
+   * @param value Value whose type must match the slot datatype
+   * @param timestamp_ms Sample timestamp in milliseconds since Unix epoch
+   *
+   * @return void on success; error message on a bad slot, a type mismatch, or a
+   *         slot left locked by a writer that died (see recover())
+   */
+  template <typename T>
+    requires SparkplugNumeric<T> || SparkplugBoolean<T>
+  stdx::expected<void, std::string> write(size_t slot, T value, uint64_t timestamp_ms) {
+    using BaseT = std::remove_cvref_t<T>;
+    uint64_t bits;
+    if constexpr (std::is_same_v<BaseT, float>) {
+      bits = std::bit_cast<uint32_t>(value);
+    } else if constexpr (std::is_same_v<BaseT, double>) {
+      bits = std::bit_cast<uint64_t>(value);
+    } else if constexpr (std::is_same_v<BaseT, bool>) {
+      bits = value ? 1 : 0;
+    } else if constexpr (SparkplugSignedInteger<T>) {
+      bits = static_cast<uint64_t>(static_cast<int64_t>(value));
+    } else {
+      bits = static_cast<uint64_t>(value);
+    }
+    return store(slot, detail::get_datatype<T>(), bits, timestamp_ms);
+  }
+
+  /**
+   * @brief Reads a consistent snapshot of a slot.
+   *
+   * @return std::nullopt for a bad slot, or one left locked by a writer that died
+   *         (see recover())
+   */
+  [[nodiscard]] std::optional<TagSample> read(size_t slot) const noexcept;
+
+  /**
+   * @brief Releases a slot left locked by a writer that died mid-write.
+   *
+   * The interrupted write counts as a change, and its value may be partial (new
+   * value with the old timestamp, or the reverse) until the next write. Call only
+   * once the writer is known to be gone: releasing a live writer's lock lets
+   * readers see a torn value.
+   *
+   * @return true if the slot was locked and is now released
+   */
+  bool recover(size_t slot) noexcept;
+
+  /**
+   * @brief Returns the table-wide write counter (increments on every write).
+   */
+  [[nodiscard]] uint64_t generation() const noexcept;
+
+private:
+  TagTable() = default;
+  void release() noexcept;
+
+  stdx::expected<void, std::string>
+  store(size_t slot, DataType datatype, uint64_t bits, uint64_t timestamp_ms);
+
+  std::string name_;
+  void* mapping_{nullptr};
+  size_t mapping_size_{0};
+  size_t slot_count_{0};
+  bool owner_{false};
+};
+
+/**
+ * @brief EdgeNode metric source backed by a TagTable.
+ *
+ * Builds NBIRTH/DBIRTH metrics from the tag definitions and encodes changed slots
+ * directly into a PayloadBuilder for NDATA/DDATA, tracking each slot's change
+ * counter so every write is reported once.
+ *
+ * @par Example Usage
+ * @code
+ * sparkplug::TagTableSource source(*table);
+ * sparkplug::PayloadBuilder birth;
+ * source.add_birth_metrics(birth);
+ * (void)edge_node.connect();
+ * (void)edge_node.publish_birth(birth);
+ *
+ * while (running) {
+ *   sparkplug::PayloadBuilder data;
+ *   if (source.collect_changes(data) > 0) {
+ *     (void)edge_node.publish_data(data);
+ *   }
+ *   std::this_thread::sleep_for(scan_interval);
+ * }
+ * @endcode
+ *
+ * @par Thread Safety
+ * Not thread-safe. Use one source per publishing thread.
+ */
+class TagTableSource {
+public:
+  /**
+   * @brief Creates a source over a table; the table must outlive the source.
+   */
+  explicit TagTableSource(const TagTable& table);
+
+  /**
+   * @brief Adds every tag with its name, alias and current value (for BIRTH).
+   *
+   * Tags that were never written are added with is_null set. Resets change
+   * tracking, so collect_changes() only reports writes after this call.
+   */
+  void add_birth_metrics(PayloadBuilder& builder);
+
+  /**
+   * @brief Adds every tag written since the last call, by alias (for DATA).
+   *
+   * @return Number of metrics added (0 if nothing changed)
+   */
+  size_t collect_changes(PayloadBuilder& builder);
+
+private:
+  const TagTable* table_;
+  std::vector<TagDefinition> definitions_;
+  std::vector<uint64_t> seen_; // Change count last reported, per slot
+  std::optional<uint64_t> generation_;
+};
+
+} // namespace sparkplug
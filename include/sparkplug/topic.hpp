@@ -32,6 +32,11 @@ enum class MessageType {
   STATE   ///< Primary Application State (not part of spBv1.0 namespace)
 };
 
+/**
+ * @brief Returns the topic token for a message type (e.g., "NBIRTH").
+ */
+[[nodiscard]] std::string_view message_type_to_string(MessageType type) noexcept;
+
 /**
  * @brief Represents a parsed Sparkplug B MQTT topic.
  *
@@ -55,7 +60,8 @@ struct Topic {
    *
    * @return Formatted topic string (e.g., "spBv1.0/Energy/NBIRTH/Gateway01")
    *
-   * @note May throw if std::format throws (e.g., out of memory), but this is rare.
+   * @note Built with a single allocation (called on every publish); throws only
+   * std::bad_alloc.
    */
   [[nodiscard]] std::string to_string() const;
 
@@ -0,0 +1,184 @@
+// include/sparkplug/window_aggregator.hpp
+#pragma once
+
+#include "payload_builder.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sparkplug {
+
+/**
+ * @brief Statistics published for each aggregation window.
+ *
+ * Enabled outputs get consecutive aliases starting at WindowSpec::alias, in the
+ * order min, max, mean, last, count. Min/Max/Mean/Last are Double metrics named
+ * "<name>/min" etc.; Count is a UInt64 metric named "<name>/count".
+ */
+struct WindowOutputs {
+  bool min = true;   ///< Smallest sample in the window
+  bool max = true;   ///< Largest sample in the window
+  bool mean = true;  ///< Arithmetic mean of the window's samples
+  bool last = true;  ///< Most recent sample
+  bool count = true; ///< Number of samples in the window
+};
+
+/**
+ * @brief Describes one aggregated signal.
+ */
+struct WindowSpec {
+  std::string name;  ///< Base metric name (e.g., "Motor/Vibration")
+  uint64_t alias{0}; ///< Alias of the first enabled output
+  std::chrono::milliseconds window{1000}; ///< Window length
+  WindowOutputs outputs{};                ///< Statistics to publish
+};
+
+/**
+ * @brief Edge-side windowed aggregation of high-rate signals.
+ *
+ * Samples are fed at full sensor rate with add_sample(), which is lock-free and
+ * touches only the window's own cache lines (a few relaxed atomic operations, no
+ * allocation). Once per window, collect() (or the built-in scheduler thread)
+ * turns each elapsed window into min/max/mean/last/count metrics addressed by
+ * alias, ready for EdgeNode::publish_data().
+ *
+ * Each window double-buffers its accumulator: collect() flips producers to the
+ * other buffer, waits for in-flight samples to land, and drains the old one, so
+ * no sample is lost or counted twice across window boundaries.
+ *
+ * @par Thread Safety
+ * add_sample() may be called concurrently from any number of threads. add_window()
+ * must be called before sampling or start(). collect() and the scheduler thread
+ * are serialized internally.
+ *
+ * @par Example Usage
+ * @code
+ * sparkplug::WindowAggregator agg;
+ * auto vib = agg.add_window({.name = "Motor/Vibration", .alias = 100,
+ *                            .window = std::chrono::seconds(1)});
+ *
+ * sparkplug::PayloadBuilder birth;
+ * agg.add_birth_metrics(birth);
+ * (void)edge_node.publish_birth(birth);
+ *
+ * agg.start([&](sparkplug::PayloadBuilder& data) {
+ *   (void)edge_node.publish_data(data);
+ * });
+ *
+ * // 1 kHz sampling loop
+ * agg.add_sample(vib, read_accelerometer());
+ * @endcode
+ */
+class WindowAggregator {
+public:
+  /// Callback receiving the aggregated metrics of all windows that closed together
+  using EmitCallback = std::function<void(PayloadBuilder&)>;
+
+  WindowAggregator() = default;
+
+  /**
+   * @brief Stops the scheduler thread, if running.
+   */
+  ~WindowAggregator();
+
+  WindowAggregator(const WindowAggregator&) = delete;
+  WindowAggregator& operator=(const WindowAggregator&) = delete;
+  WindowAggregator(WindowAggregator&&) = delete;
+  WindowAggregator& operator=(WindowAggregator&&) = delete;
+
+  /**
+   * @brief Registers a signal to aggregate.
+   *
+   * @return Handle to pass to add_sample()
+   *
+   * @note Must be called before add_sample() and start().
+   */
+  size_t add_window(WindowSpec spec);
+
+  /**
+   * @brief Feeds one sample. Lock-free; NaN samples are ignored.
+   *
+   * @param handle Handle returned by add_window()
+   * @param value Sample value
+   */
+  void add_sample(size_t handle, double value) noexcept;
+
+  /**
+   * @brief Adds the output metrics of every window (for NBIRTH/DBIRTH).
+   *
+   * Outputs are added with their names and aliases and is_null set, since no
+   * window has closed yet.
+   */
+  void add_birth_metrics(PayloadBuilder& builder) const;
+
+  /**
+   * @brief Emits metrics for every window that has elapsed by now.
+   *
+   * Windows without samples emit nothing.
+   *
+   * @param builder Output metrics are appended by alias
+   * @param now Current time (windows are scheduled on the steady clock)
+   *
+   * @return Number of metrics added
+   */
+  size_t collect(PayloadBuilder& builder,
+                 std::chrono::steady_clock::time_point now =
+                     std::chrono::steady_clock::now());
+
+  /**
+   * @brief Starts a scheduler thread that calls collect() as windows close.
+   *
+   * @param emit Called with a non-empty builder each time windows close
+   *
+   * @note The thread wakes at the earliest window deadline, so one thread serves
+   * all windows.
+   */
+  void start(EmitCallback emit);
+
+  /**
+   * @brief Stops the scheduler thread. Idempotent.
+   */
+  void stop();
+
+private:
+  struct alignas(64) Accumulator {
+    std::atomic<uint32_t> in_flight{0};
+    std::atomic<uint64_t> count{0};
+    std::atomic<double> sum{0.0};
+    std::atomic<double> min;
+    std::atomic<double> max;
+    std::atomic<double> last{0.0};
+
+    Accumulator();
+    void reset() noexcept;
+  };
+
+  struct Window {
+    WindowSpec spec;
+    std::array<Accumulator, 2> banks;
+    std::atomic<uint32_t> active{0};
+    std::chrono::steady_clock::time_point deadline{};
+  };
+
+  std::vector<std::unique_ptr<Window>> windows_;
+
+  std::mutex mutex_; // Serializes collect() and scheduler start/stop
+  std::condition_variable cv_;
+  bool stopping_{false};
+  std::thread thread_;
+
+  size_t collect_locked(PayloadBuilder& builder,
+                        std::chrono::steady_clock::time_point now);
+  void run(EmitCallback emit);
+};
+
+} // namespace sparkplug
@@ -5,6 +5,12 @@
 # Prerequisites (Alpine):
 #   apk add build-base cmake git bash linux-headers \
 #           openssl-dev openssl-libs-static zlib-static samurai
+#
+# Options (environment):
+#   MIMALLOC=ON   Bundle mimalloc in place of musl's malloc, and check that a
+#                 static link against the bundle resolves malloc to it
+#   BENCHMARK=ON  Build examples/payload_benchmark_c.c statically against the
+#                 bundle and run it (encode/decode throughput)
 
 set -e
 
@@ -13,11 +19,19 @@ PROJECT_ROOT="$(cd "${SCRIPT_DIR}/.." && pwd)"
 VERSION="${VERSION:-$(git -C "${PROJECT_ROOT}" describe --tags --always)}"
 PLATFORM="linux-musl"
 ARCH="${ARCH:-$(uname -m)}"
+MIMALLOC="${MIMALLOC:-OFF}"
+BENCHMARK="${BENCHMARK:-OFF}"
+if [ "${MIMALLOC}" = "ON" ]; then
+    ALLOCATOR="mimalloc (v2.1.7)"
+else
+    ALLOCATOR="musl malloc"
+fi
 
 echo "Building sparkplug-cpp static musl bundle"
 echo "  Version: ${VERSION}"
 echo "  Platform: ${PLATFORM}"
 echo "  Arch: ${ARCH}"
+echo "  Allocator: ${ALLOCATOR}"
 
 BUILD_DIR="${PROJECT_ROOT}/build-static-musl"
 PACKAGE_NAME="sparkplug-c-${VERSION}-${PLATFORM}-${ARCH}-static"
@@ -32,6 +46,7 @@ echo "Configuring CMake for static bundle..."
 cmake -S "${PROJECT_ROOT}" -B "${BUILD_DIR}" \
     -DCMAKE_BUILD_TYPE=Release \
     -DBUILD_STATIC_BUNDLE=ON \
+    -DSPARKPLUG_BUNDLE_MIMALLOC="${MIMALLOC}" \
     -DBUILD_SHARED_LIBS=OFF \
     -DCMAKE_FIND_LIBRARY_SUFFIXES=".a"
 
@@ -199,6 +214,7 @@ Build Date: $(date -u +"%Y-%m-%d %H:%M:%S UTC")
 Build Host: $(hostname)
 Compiler: $(${CC:-cc} --version 2>/dev/null | head -1 || echo "unknown")
 C Library: musl (static linking)
+Allocator: ${ALLOCATOR}
 
 Library Contents:
 - Sparkplug C API
@@ -210,6 +226,68 @@ External Dependencies:
 - OpenSSL (dynamically linked or can be statically linked)
 EOF
 
+# The allocator must come from the bundle, not from musl's libc.a, in a static link
+if [ "${MIMALLOC}" = "ON" ]; then
+    echo "Checking that a static link resolves malloc to mimalloc..."
+    cat > "${BUILD_DIR}/malloc_check.c" << 'EOF'
+#include <sparkplug/sparkplug_c.h>
+#include <stdlib.h>
+
+int main(void) {
+    void* p = malloc(64);
+    sparkplug_payload_t* payload = sparkplug_payload_create();
+    sparkplug_payload_destroy(payload);
+    free(p);
+    return p == NULL;
+}
+EOF
+    ALLOC_SYMBOLS="malloc free calloc realloc aligned_alloc posix_memalign"
+    TRACE_FLAGS=""
+    for symbol in ${ALLOC_SYMBOLS}; do
+        TRACE_FLAGS="${TRACE_FLAGS} -Wl,--trace-symbol=${symbol}"
+    done
+    ${CC:-cc} -static "${BUILD_DIR}/malloc_check.c" \
+        -I"${PROJECT_ROOT}/include" -L"${PACKAGE_DIR}/lib" ${TRACE_FLAGS} \
+        -lsparkplug_c_static_bundle -lssl -lcrypto -lstdc++ -lm -lpthread \
+        -o "${BUILD_DIR}/malloc_check" > "${BUILD_DIR}/malloc_check.trace" 2>&1 || {
+        cat "${BUILD_DIR}/malloc_check.trace"
+        echo "ERROR: static link with the mimalloc bundle failed"
+        exit 1
+    }
+    for symbol in ${ALLOC_SYMBOLS}; do
+        definitions=$(grep ": definition of ${symbol}\$" "${BUILD_DIR}/malloc_check.trace" || true)
+        if ! echo "${definitions}" | grep -q "libsparkplug_c_static_bundle.a"; then
+            cat "${BUILD_DIR}/malloc_check.trace"
+            echo "ERROR: ${symbol} is not defined by the bundle"
+            exit 1
+        fi
+        if echo "${definitions}" | grep -v "libsparkplug_c_static_bundle.a" | grep -q .; then
+            cat "${BUILD_DIR}/malloc_check.trace"
+            echo "ERROR: ${symbol} is also defined outside the bundle"
+            exit 1
+        fi
+    done
+    # mimalloc reports its options on stderr at startup when verbose
+    if ! MIMALLOC_VERBOSE=1 "${BUILD_DIR}/malloc_check" 2>&1 | grep -q "^mimalloc: "; then
+        echo "ERROR: mimalloc did not initialize in the static binary"
+        exit 1
+    fi
+    echo "  malloc, free, calloc, realloc, aligned_alloc, posix_memalign: mimalloc"
+fi
+
+# Encode/decode throughput of the bundle as built (compare MIMALLOC=ON and OFF)
+if [ "${BENCHMARK}" = "ON" ]; then
+    echo "Building payload benchmark..."
+    ${CC:-cc} -O2 -static "${PROJECT_ROOT}/examples/payload_benchmark_c.c" \
+        -I"${PROJECT_ROOT}/include" -L"${PACKAGE_DIR}/lib" \
+        -lsparkplug_c_static_bundle -lssl -lcrypto -lstdc++ -lm -lpthread \
+        -o "${BUILD_DIR}/payload_benchmark_c"
+    echo "Payload benchmark (${ALLOCATOR}):"
+    THREADS="$(nproc 2>/dev/null || echo 4)"
+    "${BUILD_DIR}/payload_benchmark_c" 1 | tee "${PACKAGE_DIR}/BENCHMARK.txt"
+    "${BUILD_DIR}/payload_benchmark_c" "${THREADS}" | tee -a "${PACKAGE_DIR}/BENCHMARK.txt"
+fi
+
 # Create tarball
 echo "Creating tarball..."
 cd "${BUILD_DIR}"
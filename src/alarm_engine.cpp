@@ -0,0 +1,402 @@
+// src/alarm_engine.cpp
+#include "sparkplug/alarm_engine.hpp"
+
+#include "sparkplug/sink.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace sparkplug {
+
+namespace {
+
+constexpr double kInf = std::numeric_limits<double>::infinity();
+
+// Alias ranges up to this multiple of the slot count are indexed directly
+constexpr uint64_t kDenseAliasFactor = 4;
+constexpr uint64_t kDenseAliasSlack = 64;
+
+bool is_worse(int8_t level, int8_t current) {
+  if (level == 0) {
+    return false;
+  }
+  return current == 0 || (level > 0) != (current > 0) ||
+         std::abs(level) > std::abs(current);
+}
+
+} // namespace
+
+uint32_t AlarmEngine::Table::slot_of(
+    const org::eclipse::tahu::protobuf::Payload::Metric& metric) const {
+  // Births without aliases leave both maps empty; such metrics match by name
+  if (metric.has_alias() && (!by_alias.empty() || !sparse_alias.empty())) {
+    uint64_t alias = metric.alias();
+    uint32_t slot = kNoSlot;
+    if (!by_alias.empty()) {
+      slot = alias < by_alias.size() ? by_alias[alias] : kNoSlot;
+    } else if (auto it = sparse_alias.find(alias); it != sparse_alias.end()) {
+      slot = it->second;
+    }
+    if (slot != kNoSlot || !metric.has_name()) {
+      return slot;
+    }
+  }
+  if (metric.has_name()) {
+    auto it = by_name.find(metric.name());
+    return it != by_name.end() ? it->second : kNoSlot;
+  }
+  return kNoSlot;
+}
+
+void AlarmEngine::Table::apply_level(uint32_t slot) noexcept {
+  int8_t c = level[slot];
+  double db = deadband[slot];
+  hihi_at[slot] = c >= 2 ? hihi[slot] - db : hihi[slot];
+  hi_at[slot] = c >= 1 ? hi[slot] - db : hi[slot];
+  lo_at[slot] = c <= -1 ? lo[slot] + db : lo[slot];
+  lolo_at[slot] = c <= -2 ? lolo[slot] + db : lolo[slot];
+}
+
+void AlarmEngine::add_limits(AlarmLimits limits) {
+  rules_.push_back(std::move(limits));
+  rule_cache_.clear(); // Earlier names may now match the new rule
+}
+
+detail::NodeKeyView AlarmEngine::table_key(const Topic& topic, bool device) {
+  return {topic.group_id, topic.edge_node_id,
+          device ? topic.device_id : std::string_view{}};
+}
+
+bool AlarmEngine::glob_match(std::string_view pattern, std::string_view name) {
+  // Iterative matcher: backtracks only to the most recent '*'
+  size_t p = 0;
+  size_t n = 0;
+  size_t star = std::string_view::npos;
+  size_t resume = 0;
+  while (n < name.size()) {
+    if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == name[n])) {
+      p++;
+      n++;
+    } else if (p < pattern.size() && pattern[p] == '*') {
+      star = p++;
+      resume = n;
+    } else if (star != std::string_view::npos) {
+      p = star + 1;
+      n = ++resume;
+    } else {
+      return false;
+    }
+  }
+  while (p < pattern.size() && pattern[p] == '*') {
+    p++;
+  }
+  return p == pattern.size();
+}
+
+int32_t AlarmEngine::rule_for(const std::string& name) {
+  auto it = rule_cache_.find(name);
+  if (it != rule_cache_.end()) {
+    return it->second;
+  }
+  int32_t rule = -1;
+  for (size_t i = 0; i < rules_.size(); ++i) {
+    if (glob_match(rules_[i].pattern, name)) {
+      rule = static_cast<int32_t>(i);
+      break;
+    }
+  }
+  rule_cache_.emplace(name, rule);
+  return rule;
+}
+
+void AlarmEngine::compile(const Topic& topic,
+                          const org::eclipse::tahu::protobuf::Payload& payload) {
+  bool device = topic.message_type == MessageType::DBIRTH;
+  auto key = table_key(topic, device);
+
+  Table table;
+  std::vector<std::pair<uint64_t, uint32_t>> aliases;
+  uint64_t max_alias = 0;
+  for (const auto& metric : payload.metrics()) {
+    if (!metric.has_name()) {
+      continue;
+    }
+    int32_t rule = rule_for(metric.name());
+    if (rule < 0) {
+      continue;
+    }
+    const auto& limits = rules_[static_cast<size_t>(rule)];
+    auto slot = static_cast<uint32_t>(table.names.size());
+    table.names.push_back(metric.name());
+    table.hihi.push_back(limits.hihi.value_or(kInf));
+    // A lone HiHi (LoLo) also sets the inner level, so crossing it counts twice
+    table.hi.push_back(limits.hi.value_or(limits.hihi.value_or(kInf)));
+    table.lo.push_back(limits.lo.value_or(limits.lolo.value_or(-kInf)));
+    table.lolo.push_back(limits.lolo.value_or(-kInf));
+    table.deadband.push_back(std::max(limits.deadband, 0.0));
+    table.delay_on.push_back(limits.delay_on);
+    if (metric.has_alias()) {
+      aliases.emplace_back(metric.alias(), slot);
+      max_alias = std::max(max_alias, metric.alias());
+    }
+  }
+
+  size_t count = table.names.size();
+  table.level.assign(count, 0);
+  table.pending.assign(count, 0);
+  table.pending_since.assign(count, Clock::time_point{});
+  for (uint32_t slot = 0; slot < count; ++slot) {
+    table.by_name.emplace(table.names[slot], slot);
+  }
+  if (!aliases.empty()) {
+    if (max_alias < kDenseAliasFactor * count + kDenseAliasSlack) {
+      table.by_alias.assign(max_alias + 1, kNoSlot);
+      for (auto [alias, slot] : aliases) {
+        table.by_alias[alias] = slot;
+      }
+    } else {
+      table.sparse_alias.insert(aliases.begin(), aliases.end());
+    }
+  }
+
+  auto existing = tables_.find(key);
+  if (existing != tables_.end()) {
+    // A rebirth keeps the alarm level of every metric it declares again
+    auto& old = existing->second;
+    for (uint32_t slot = 0; slot < count; ++slot) {
+      auto it = old.by_name.find(table.names[slot]);
+      if (it != old.by_name.end()) {
+        table.level[slot] = old.level[it->second];
+      }
+    }
+    for (int8_t level : old.level) {
+      active_ -= level != 0 ? 1 : 0;
+    }
+    slots_ -= old.names.size();
+    table.devices = std::move(old.devices);
+  }
+  table.hihi_at = table.hihi;
+  table.hi_at = table.hi;
+  table.lo_at = table.lo;
+  table.lolo_at = table.lolo;
+  for (uint32_t slot = 0; slot < count; ++slot) {
+    if (table.level[slot] != 0) {
+      table.apply_level(slot);
+    }
+  }
+
+  for (int8_t level : table.level) {
+    active_ += level != 0 ? 1 : 0;
+  }
+  slots_ += count;
+  if (existing != tables_.end()) {
+    existing->second = std::move(table);
+    return;
+  }
+  tables_.emplace(detail::NodeKey(key), std::move(table));
+  if (device) {
+    auto node_key = table_key(topic, false);
+    auto node = tables_.find(node_key);
+    if (node == tables_.end()) {
+      node = tables_.emplace(detail::NodeKey(node_key), Table{}).first;
+    }
+    node->second.devices.push_back(topic.device_id);
+  }
+}
+
+void AlarmEngine::drop(const detail::NodeKeyView& key) {
+  auto it = tables_.find(key);
+  if (it == tables_.end()) {
+    return;
+  }
+  for (int8_t level : it->second.level) {
+    active_ -= level != 0 ? 1 : 0;
+  }
+  slots_ -= it->second.names.size();
+  tables_.erase(it);
+  // Pending entries for the dropped table are discarded when they come due
+}
+
+void AlarmEngine::forget(std::string_view group_id, std::string_view edge_node_id) {
+  auto node = tables_.find(detail::NodeKeyView{group_id, edge_node_id});
+  if (node != tables_.end()) {
+    auto devices = std::move(node->second.devices);
+    drop({group_id, edge_node_id});
+    for (const auto& device_id : devices) {
+      drop({group_id, edge_node_id, device_id});
+    }
+  }
+}
+
+size_t AlarmEngine::process(const Topic& topic,
+                            const org::eclipse::tahu::protobuf::Payload& payload,
+                            std::vector<AlarmEvent>& out,
+                            Clock::time_point now) {
+  size_t before = out.size();
+  bool device = !topic.device_id.empty();
+  switch (topic.message_type) {
+  case MessageType::NBIRTH:
+  case MessageType::DBIRTH:
+    if (rules_.empty()) {
+      return 0;
+    }
+    compile(topic, payload);
+    break;
+  case MessageType::NDATA:
+  case MessageType::DDATA:
+    break;
+  case MessageType::NDEATH:
+    forget(topic.group_id, topic.edge_node_id);
+    return 0;
+  case MessageType::DDEATH: {
+    drop(table_key(topic, true));
+    // Unlist the device, so a DBIRTH after each DDEATH does not list it again
+    auto node = tables_.find(table_key(topic, false));
+    if (node != tables_.end()) {
+      std::erase(node->second.devices, topic.device_id);
+    }
+    return 0;
+  }
+  default:
+    return 0;
+  }
+
+  auto it = tables_.find(table_key(topic, device));
+  if (it != tables_.end() && !it->second.names.empty()) {
+    evaluate(it->second, it->first, payload, now, out);
+  }
+  return out.size() - before;
+}
+
+void AlarmEngine::evaluate(Table& table,
+                           const detail::NodeKey& key,
+                           const org::eclipse::tahu::protobuf::Payload& payload,
+                           Clock::time_point now,
+                           std::vector<AlarmEvent>& out) {
+  scratch_slots_.clear();
+  scratch_values_.clear();
+  scratch_timestamps_.clear();
+  for (const auto& metric : payload.metrics()) {
+    if (metric.is_historical()) {
+      continue;
+    }
+    uint32_t slot = table.slot_of(metric);
+    if (slot == kNoSlot) {
+      continue;
+    }
+    auto value = decode_metric_number(metric);
+    if (!value || std::isnan(*value)) {
+      continue;
+    }
+    scratch_slots_.push_back(slot);
+    scratch_values_.push_back(*value);
+    scratch_timestamps_.push_back(metric.has_timestamp() ? metric.timestamp()
+                                                         : payload.timestamp());
+  }
+
+  // Branch-free level computation against thresholds that already include the
+  // deadband for the current level (Table::apply_level())
+  size_t count = scratch_slots_.size();
+  scratch_levels_.resize(count);
+  const uint32_t* slots = scratch_slots_.data();
+  const double* values = scratch_values_.data();
+  const double* hihi = table.hihi_at.data();
+  const double* hi = table.hi_at.data();
+  const double* lo = table.lo_at.data();
+  const double* lolo = table.lolo_at.data();
+  int8_t* levels = scratch_levels_.data();
+  for (size_t i = 0; i < count; ++i) {
+    uint32_t s = slots[i];
+    double v = values[i];
+    int up = static_cast<int>(v >= hi[s]) + static_cast<int>(v >= hihi[s]);
+    int down = static_cast<int>(v <= lo[s]) + static_cast<int>(v <= lolo[s]);
+    levels[i] = static_cast<int8_t>(up - down);
+  }
+
+  for (size_t i = 0; i < count; ++i) {
+    uint32_t s = slots[i];
+    if (levels[i] != table.level[s] || table.pending[s] != 0) {
+      transition(table, key, s, levels[i], values[i], scratch_timestamps_[i], now, out);
+    }
+  }
+}
+
+void AlarmEngine::transition(Table& table,
+                             const detail::NodeKey& key,
+                             uint32_t slot,
+                             int8_t level,
+                             double value,
+                             uint64_t timestamp,
+                             Clock::time_point now,
+                             std::vector<AlarmEvent>& out) {
+  if (level == table.level[slot]) {
+    table.pending[slot] = 0; // Fell back before the delay elapsed
+    return;
+  }
+  auto delay = table.delay_on[slot];
+  if (is_worse(level, table.level[slot]) && delay > Clock::duration::zero()) {
+    if (table.pending[slot] != level) {
+      table.pending[slot] = level;
+      table.pending_since[slot] = now;
+      pending_.push({.due = now + delay,
+                     .since = now,
+                     .key = key,
+                     .slot = slot,
+                     .value = value,
+                     .timestamp = timestamp});
+      return;
+    }
+    if (now - table.pending_since[slot] < delay) {
+      return;
+    }
+  }
+  emit(table, key, slot, level, value, timestamp, out);
+}
+
+void AlarmEngine::emit(Table& table,
+                       const detail::NodeKey& key,
+                       uint32_t slot,
+                       int8_t level,
+                       double value,
+                       uint64_t timestamp,
+                       std::vector<AlarmEvent>& out) {
+  int8_t previous = table.level[slot];
+  active_ += (level != 0 ? 1 : 0) - (previous != 0 ? 1 : 0);
+  table.level[slot] = level;
+  table.pending[slot] = 0;
+  table.apply_level(slot);
+
+  out.push_back({.group_id = key.group_id,
+                 .edge_node_id = key.edge_node_id,
+                 .device_id = key.device_id,
+                 .metric_name = table.names[slot],
+                 .previous = static_cast<AlarmLevel>(previous),
+                 .level = static_cast<AlarmLevel>(level),
+                 .value = value,
+                 .timestamp = timestamp});
+}
+
+size_t AlarmEngine::poll(Clock::time_point now, std::vector<AlarmEvent>& out) {
+  size_t before = out.size();
+  while (!pending_.empty() && pending_.top().due <= now) {
+    Pending entry = pending_.top();
+    pending_.pop();
+    auto it = tables_.find(entry.key);
+    if (it == tables_.end() || entry.slot >= it->second.names.size()) {
+      continue;
+    }
+    auto& table = it->second;
+    // Stale unless the same pending level is still waiting
+    if (table.pending[entry.slot] == 0 ||
+        table.pending_since[entry.slot] != entry.since) {
+      continue;
+    }
+    emit(table, it->first, entry.slot, table.pending[entry.slot], entry.value,
+         entry.timestamp, out);
+  }
+  return out.size() - before;
+}
+
+} // namespace sparkplug
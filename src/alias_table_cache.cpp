@@ -0,0 +1,155 @@
+// src/alias_table_cache.cpp
+#include "sparkplug/alias_table_cache.hpp"
+
+#include "sparkplug/detail/memory_estimate.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <string_view>
+#include <utility>
+
+namespace sparkplug {
+
+namespace {
+
+// Per-entry hash, summed so that the table hash does not depend on metric order
+uint64_t entry_hash(uint64_t alias, std::string_view name) noexcept {
+  uint64_t x = alias * 0x9e3779b97f4a7c15ULL ^ std::hash<std::string_view>{}(name);
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+uint64_t table_hash(const AliasTable& table) noexcept {
+  uint64_t hash = 0;
+  for (const auto& [alias, name] : table) {
+    hash += entry_hash(alias, name);
+  }
+  return hash;
+}
+
+} // namespace
+
+AliasTableCache::Handle
+AliasTableCache::intern(const org::eclipse::tahu::protobuf::Payload& payload) {
+  uint64_t hash = 0;
+  size_t count = 0;
+  for (const auto& metric : payload.metrics()) {
+    if (metric.has_alias() && metric.has_name()) {
+      hash += entry_hash(metric.alias(), metric.name());
+      count++;
+    }
+  }
+  if (count == 0) {
+    return nullptr;
+  }
+
+  // Hit: compare against the payload directly, no table is built
+  auto [begin, end] = tables_.equal_range(hash);
+  for (auto it = begin; it != end; ++it) {
+    auto table = it->second.lock();
+    if (!table || table->size() != count) {
+      continue;
+    }
+    bool equal = true;
+    for (const auto& metric : payload.metrics()) {
+      if (metric.has_alias() && metric.has_name()) {
+        auto entry = table->find(metric.alias());
+        if (entry == table->end() || entry->second != metric.name()) {
+          equal = false;
+          break;
+        }
+      }
+    }
+    if (equal) {
+      hits_++;
+      return table;
+    }
+  }
+
+  AliasTable table;
+  table.reserve(count);
+  for (const auto& metric : payload.metrics()) {
+    if (metric.has_alias() && metric.has_name()) {
+      table.insert_or_assign(metric.alias(), metric.name());
+    }
+  }
+  // Repeated aliases make the built table differ from what was hashed
+  if (table.size() != count) {
+    hash = table_hash(table);
+    if (auto existing = find(hash, table)) {
+      hits_++;
+      return existing;
+    }
+  }
+  return insert(hash, std::move(table));
+}
+
+AliasTableCache::Handle AliasTableCache::intern(Handle table) {
+  if (!table || table->empty()) {
+    return nullptr;
+  }
+  uint64_t hash = table_hash(*table);
+  if (auto existing = find(hash, *table)) {
+    hits_++;
+    return existing;
+  }
+  return insert(hash, *table);
+}
+
+size_t AliasTableCache::table_bytes(const AliasTable& table) noexcept {
+  size_t bytes = sizeof(table) + detail::map_bytes(table);
+  for (const auto& [alias, name] : table) {
+    bytes += detail::heap_bytes(name);
+  }
+  return bytes;
+}
+
+AliasTableStats AliasTableCache::stats() const {
+  AliasTableStats stats{.hits = hits_, .misses = misses_};
+  for (const auto& [hash, weak] : tables_) {
+    auto table = weak.lock();
+    if (!table) {
+      continue;
+    }
+    auto holders = static_cast<size_t>(table.use_count() - 1);
+    auto bytes = table_bytes(*table);
+    stats.tables++;
+    stats.references += holders;
+    stats.bytes += bytes;
+    stats.unshared_bytes += bytes * holders;
+  }
+  return stats;
+}
+
+AliasTableCache::Handle AliasTableCache::find(uint64_t hash, const AliasTable& table) {
+  auto [begin, end] = tables_.equal_range(hash);
+  for (auto it = begin; it != end; ++it) {
+    auto existing = it->second.lock();
+    if (existing && *existing == table) {
+      return existing;
+    }
+  }
+  return nullptr;
+}
+
+AliasTableCache::Handle AliasTableCache::insert(uint64_t hash, AliasTable table) {
+  misses_++;
+  if (tables_.size() >= sweep_at_) {
+    std::erase_if(tables_, [](const auto& entry) { return entry.second.expired(); });
+    sweep_at_ = std::max<size_t>(64, tables_.size() * 2);
+  }
+  auto* created = new AliasTable(std::move(table));
+  auto bytes = table_bytes(*created);
+  live_bytes_->fetch_add(bytes, std::memory_order_relaxed);
+  Handle handle(created, [live = live_bytes_, bytes](const AliasTable* released) {
+    live->fetch_sub(bytes, std::memory_order_relaxed);
+    delete released;
+  });
+  tables_.emplace(hash, handle);
+  return handle;
+}
+
+} // namespace sparkplug
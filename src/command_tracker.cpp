@@ -0,0 +1,222 @@
+// src/command_tracker.cpp
+#include "sparkplug/command_tracker.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace sparkplug {
+
+void LatencyHistogram::record(std::chrono::microseconds latency) noexcept {
+  auto us = static_cast<uint64_t>(std::max<int64_t>(latency.count(), 0));
+  size_t bucket = us == 0 ? 0 : static_cast<size_t>(std::bit_width(us) - 1);
+  buckets[std::min(bucket, kBuckets - 1)]++;
+  if (count == 0 || latency < min) {
+    min = latency;
+  }
+  max = std::max(max, latency);
+  total += latency;
+  count++;
+}
+
+std::chrono::microseconds LatencyHistogram::percentile(double q) const noexcept {
+  if (count == 0) {
+    return std::chrono::microseconds(0);
+  }
+  auto rank = static_cast<uint64_t>(std::ceil(std::clamp(q, 0.0, 1.0) * count));
+  rank = std::max<uint64_t>(rank, 1);
+  uint64_t seen = 0;
+  for (size_t i = 0; i < kBuckets; ++i) {
+    seen += buckets[i];
+    if (seen >= rank) {
+      auto upper = std::chrono::microseconds((int64_t{1} << (i + 1)) - 1);
+      return std::min(upper, max);
+    }
+  }
+  return max;
+}
+
+CommandTracker::CommandTracker() : CommandTracker(Options{}) {
+}
+
+CommandTracker::CommandTracker(Options options) : options_(options) {
+}
+
+uint64_t CommandTracker::record_command(std::string_view group_id,
+                                        std::string_view edge_node_id,
+                                        std::string_view device_id,
+                                        std::span<const std::string> metrics,
+                                        Clock::time_point sent) {
+  std::scoped_lock lock(mutex_);
+  expire_locked(sent);
+  uint64_t serial = next_serial_++;
+
+  for (const auto& metric : metrics) {
+    detail::NodeKeyView key{group_id, edge_node_id, device_id, metric};
+    auto& node = node_stats(key);
+    totals_.commands++;
+    node.commands++;
+
+    auto it = outstanding_.find(key);
+    if (it != outstanding_.end()) {
+      // Only the newest write counts; its deadline entry replaces the old one
+      totals_.superseded++;
+      node.superseded++;
+      it->second = {.sent = sent,
+                    .serial = serial,
+                    .superseded_sent = it->second.sent,
+                    .superseded_serial = it->second.serial};
+    } else {
+      if (outstanding_.size() >= options_.max_outstanding) {
+        totals_.untracked++;
+        node.untracked++;
+        continue;
+      }
+      outstanding_.emplace(detail::NodeKey(key),
+                           Outstanding{.sent = sent, .serial = serial});
+      totals_.outstanding++;
+      node.outstanding++;
+    }
+    deadlines_.push_back({.expires = sent + options_.timeout,
+                          .key = detail::NodeKey(key),
+                          .serial = serial});
+  }
+  return serial;
+}
+
+void CommandTracker::cancel_command(std::string_view group_id,
+                                    std::string_view edge_node_id,
+                                    std::string_view device_id,
+                                    std::span<const std::string> metrics,
+                                    uint64_t command) {
+  std::scoped_lock lock(mutex_);
+  auto now = Clock::now();
+  expire_locked(now);
+  for (const auto& metric : metrics) {
+    detail::NodeKeyView key{group_id, edge_node_id, device_id, metric};
+    auto it = outstanding_.find(key);
+    if (it == outstanding_.end()) {
+      continue; // Answered, timed out or never tracked
+    }
+    auto& write = it->second;
+    auto& node = node_stats(key);
+    if (write.superseded_serial == command) {
+      // A newer write superseded this one in turn; it now supersedes nothing
+      write.superseded_serial = 0;
+      totals_.superseded--;
+      node.superseded--;
+    } else if (write.serial != command) {
+      continue; // A newer command owns the entry
+    } else if (write.superseded_serial != 0) {
+      // The superseded write is still in flight; it counts again
+      totals_.superseded--;
+      node.superseded--;
+      write = {.sent = write.superseded_sent, .serial = write.superseded_serial};
+      if (write.sent + options_.timeout <= now) {
+        // Its deadline entry was skipped while this write held the entry
+        totals_.timed_out++;
+        totals_.outstanding--;
+        node.timed_out++;
+        node.outstanding--;
+        outstanding_.erase(it);
+      }
+    } else {
+      totals_.outstanding--;
+      node.outstanding--;
+      outstanding_.erase(it);
+    }
+    totals_.commands--;
+    node.commands--;
+  }
+}
+
+size_t
+CommandTracker::match_data(const Topic& topic,
+                           const org::eclipse::tahu::protobuf::Payload& payload,
+                           const std::unordered_map<uint64_t, std::string>* alias_map,
+                           Clock::time_point received) {
+  if (topic.message_type != MessageType::NDATA &&
+      topic.message_type != MessageType::DDATA) {
+    return 0;
+  }
+
+  std::scoped_lock lock(mutex_);
+  expire_locked(received);
+  if (outstanding_.empty()) {
+    return 0;
+  }
+
+  size_t matched = 0;
+  for (const auto& metric : payload.metrics()) {
+    std::string_view name = metric.name();
+    if (!metric.has_name() && metric.has_alias() && alias_map) {
+      auto alias_it = alias_map->find(metric.alias());
+      if (alias_it != alias_map->end()) {
+        name = alias_it->second;
+      }
+    }
+    if (name.empty()) {
+      continue;
+    }
+
+    detail::NodeKeyView key{topic.group_id, topic.edge_node_id, topic.device_id, name};
+    auto it = outstanding_.find(key);
+    if (it == outstanding_.end()) {
+      continue;
+    }
+    auto latency =
+        std::chrono::duration_cast<std::chrono::microseconds>(received - it->second.sent);
+    auto& node = node_stats(key);
+    totals_.latency.record(latency);
+    node.latency.record(latency);
+    totals_.matched++;
+    node.matched++;
+    totals_.outstanding--;
+    node.outstanding--;
+    outstanding_.erase(it);
+    matched++;
+  }
+  return matched;
+}
+
+CommandLatencyStats CommandTracker::stats() {
+  std::scoped_lock lock(mutex_);
+  expire_locked(Clock::now());
+  return totals_;
+}
+
+CommandLatencyStats CommandTracker::stats(std::string_view group_id,
+                                          std::string_view edge_node_id) {
+  std::scoped_lock lock(mutex_);
+  expire_locked(Clock::now());
+  auto it = per_node_.find(detail::NodeKeyView{group_id, edge_node_id});
+  return it != per_node_.end() ? it->second : CommandLatencyStats{};
+}
+
+CommandLatencyStats& CommandTracker::node_stats(const detail::NodeKeyView& key) {
+  detail::NodeKeyView node{key.group_id, key.edge_node_id};
+  auto it = per_node_.find(node);
+  if (it == per_node_.end()) {
+    it = per_node_.emplace(detail::NodeKey(node), CommandLatencyStats{}).first;
+  }
+  return it->second;
+}
+
+void CommandTracker::expire_locked(Clock::time_point now) {
+  // Deadlines are in send order (the timeout is fixed), so only the front can be due
+  while (!deadlines_.empty() && deadlines_.front().expires <= now) {
+    auto& deadline = deadlines_.front();
+    auto it = outstanding_.find(deadline.key);
+    if (it != outstanding_.end() && it->second.serial == deadline.serial) {
+      auto& node = node_stats(deadline.key.view());
+      totals_.timed_out++;
+      totals_.outstanding--;
+      node.timed_out++;
+      node.outstanding--;
+      outstanding_.erase(it);
+    }
+    deadlines_.pop_front();
+  }
+}
+
+} // namespace sparkplug
@@ -0,0 +1,556 @@
+// src/derived_metrics.cpp
+#include "sparkplug/derived_metrics.hpp"
+
+#include "sparkplug/sink.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <format>
+#include <utility>
+
+namespace sparkplug {
+
+namespace {
+
+constexpr int MAX_NESTING = 64;
+
+uint64_t now_millis() {
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                   std::chrono::system_clock::now().time_since_epoch())
+                                   .count());
+}
+
+} // namespace
+
+// Recursive descent over the expression grammar, emitting a postfix program:
+//   expr  := term (('+' | '-') term)*
+//   term  := unary (('*' | '/') unary)*
+//   unary := '-' unary | primary
+//   primary := number | '{' ref '}' | name '(' expr (',' expr)* ')' | '(' expr ')'
+class DerivedMetrics::Parser {
+public:
+  Parser(std::string_view text, const std::vector<Spec>& specs, Spec& out)
+      : text_(text), specs_(specs), out_(out) {
+  }
+
+  stdx::expected<void, std::string> parse() {
+    if (expression()) {
+      skip_space();
+      if (pos_ != text_.size()) {
+        fail(std::format("unexpected '{}'", text_[pos_]));
+      }
+    }
+    if (!error_.empty()) {
+      return stdx::unexpected(std::format("Invalid expression '{}' at offset {}: {}",
+                                          text_, pos_, error_));
+    }
+    return {};
+  }
+
+private:
+  bool fail(std::string message) {
+    if (error_.empty()) {
+      error_ = std::move(message);
+    }
+    return false;
+  }
+
+  void skip_space() {
+    while (pos_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[pos_]))) {
+      ++pos_;
+    }
+  }
+
+  bool accept(char c) {
+    skip_space();
+    if (pos_ < text_.size() && text_[pos_] == c) {
+      ++pos_;
+      return true;
+    }
+    return false;
+  }
+
+  void emit(OpCode code, uint32_t input = 0, double constant = 0.0) {
+    switch (code) {
+    case OpCode::Constant:
+    case OpCode::Input:
+      out_.stack_depth = std::max(out_.stack_depth, ++depth_);
+      break;
+    case OpCode::Neg:
+    case OpCode::Abs:
+      break;
+    default:
+      --depth_;
+      break;
+    }
+    out_.program.push_back({.code = code, .input = input, .constant = constant});
+  }
+
+  bool expression() {
+    if (++nesting_ > MAX_NESTING) {
+      return fail("expression nested too deeply");
+    }
+    if (!term()) {
+      return false;
+    }
+    while (true) {
+      if (accept('+')) {
+        if (!term()) {
+          return false;
+        }
+        emit(OpCode::Add);
+      } else if (accept('-')) {
+        if (!term()) {
+          return false;
+        }
+        emit(OpCode::Sub);
+      } else {
+        break;
+      }
+    }
+    --nesting_;
+    return true;
+  }
+
+  bool term() {
+    if (!unary()) {
+      return false;
+    }
+    while (true) {
+      if (accept('*')) {
+        if (!unary()) {
+          return false;
+        }
+        emit(OpCode::Mul);
+      } else if (accept('/')) {
+        if (!unary()) {
+          return false;
+        }
+        emit(OpCode::Div);
+      } else {
+        return true;
+      }
+    }
+  }
+
+  bool unary() {
+    if (accept('-')) {
+      if (++nesting_ > MAX_NESTING) {
+        return fail("expression nested too deeply");
+      }
+      if (!unary()) {
+        return false;
+      }
+      --nesting_;
+      emit(OpCode::Neg);
+      return true;
+    }
+    return primary();
+  }
+
+  bool primary() {
+    skip_space();
+    if (pos_ >= text_.size()) {
+      return fail("unexpected end of expression");
+    }
+    char c = text_[pos_];
+    if (c == '(') {
+      ++pos_;
+      return expression() && (accept(')') || fail("expected ')'"));
+    }
+    if (c == '{') {
+      return reference();
+    }
+    if (std::isdigit(static_cast<unsigned char>(c)) || c == '.') {
+      return number();
+    }
+    if (std::isalpha(static_cast<unsigned char>(c))) {
+      return function();
+    }
+    return fail(std::format("unexpected '{}'", c));
+  }
+
+  bool number() {
+    std::string digits(text_.substr(pos_));
+    char* end = nullptr;
+    double value = std::strtod(digits.c_str(), &end);
+    if (end == digits.c_str()) {
+      return fail("malformed number");
+    }
+    pos_ += static_cast<size_t>(end - digits.c_str());
+    emit(OpCode::Constant, 0, value);
+    return true;
+  }
+
+  bool reference() {
+    size_t close = text_.find('}', ++pos_);
+    if (close == std::string_view::npos) {
+      return fail("expected '}'");
+    }
+    std::string_view ref = text_.substr(pos_, close - pos_);
+    pos_ = close + 1;
+    std::string_view device;
+    if (auto colon = ref.find(':'); colon != std::string_view::npos) {
+      device = ref.substr(0, colon);
+      ref = ref.substr(colon + 1);
+    }
+    if (ref.empty()) {
+      return fail("empty metric reference");
+    }
+
+    int32_t derived = kNoDerived;
+    if (device.empty()) {
+      for (size_t i = specs_.size(); i-- > 0;) {
+        if (specs_[i].spec.name == ref) {
+          derived = static_cast<int32_t>(i);
+          break;
+        }
+      }
+    }
+    auto& refs = out_.refs;
+    auto it = std::find_if(refs.begin(), refs.end(), [&](const Reference& r) {
+      return r.device_id == device && r.metric_name == ref;
+    });
+    if (it == refs.end()) {
+      refs.push_back({std::string(device), std::string(ref), derived});
+      it = refs.end() - 1;
+    }
+    emit(OpCode::Input, static_cast<uint32_t>(it - refs.begin()));
+    return true;
+  }
+
+  bool function() {
+    size_t start = pos_;
+    while (pos_ < text_.size() && std::isalnum(static_cast<unsigned char>(text_[pos_]))) {
+      ++pos_;
+    }
+    std::string_view name = text_.substr(start, pos_ - start);
+    OpCode code;
+    if (name == "min") {
+      code = OpCode::Min;
+    } else if (name == "max") {
+      code = OpCode::Max;
+    } else if (name == "abs") {
+      code = OpCode::Abs;
+    } else {
+      return fail(std::format("unknown function '{}'", name));
+    }
+    if (!accept('(')) {
+      return fail("expected '('");
+    }
+    size_t args = 0;
+    do {
+      if (!expression()) {
+        return false;
+      }
+      if (args++ > 0) {
+        emit(code);
+      }
+    } while (code != OpCode::Abs && accept(','));
+    if (!accept(')')) {
+      return fail("expected ')'");
+    }
+    if (code == OpCode::Abs) {
+      emit(code);
+    }
+    return true;
+  }
+
+  std::string_view text_;
+  const std::vector<Spec>& specs_;
+  Spec& out_;
+  size_t pos_{0};
+  size_t depth_{0};
+  int nesting_{0};
+  std::string error_;
+};
+
+stdx::expected<DerivedMetrics::Id, std::string>
+DerivedMetrics::add(DerivedMetricSpec spec) {
+  if (spec.name.empty()) {
+    return stdx::unexpected("Derived metric name must not be empty");
+  }
+  Spec compiled;
+  auto parsed = Parser(spec.expression, specs_, compiled).parse();
+  if (!parsed) {
+    return stdx::unexpected(parsed.error());
+  }
+  compiled.spec = std::move(spec);
+  specs_.push_back(std::move(compiled));
+  return static_cast<Id>(specs_.size() - 1);
+}
+
+void DerivedMetrics::compile(const Topic& topic) {
+  detail::NodeKeyView key{topic.group_id, topic.edge_node_id};
+  if (auto old = nodes_.find(key); old != nodes_.end()) {
+    instances_ -= old->second.instances.size();
+    nodes_.erase(old);
+  }
+
+  Node node;
+  std::vector<int32_t> instance_of(specs_.size(), -1);
+  for (Id id = 0; id < specs_.size(); ++id) {
+    const auto& spec = specs_[id];
+    if ((!spec.spec.group_id.empty() && spec.spec.group_id != topic.group_id) ||
+        (!spec.spec.edge_node_id.empty() &&
+         spec.spec.edge_node_id != topic.edge_node_id)) {
+      continue;
+    }
+    auto index = static_cast<uint32_t>(node.instances.size());
+    instance_of[id] = static_cast<int32_t>(index);
+    size_t inputs = spec.refs.size();
+    node.instances.push_back({.spec = id,
+                              .inputs = std::vector<double>(inputs, 0.0),
+                              .known = std::vector<uint8_t>(inputs, 0),
+                              .missing = static_cast<uint32_t>(inputs),
+                              .dirty = true}); // Constant expressions need a first pass
+
+    for (uint32_t r = 0; r < inputs; ++r) {
+      const auto& ref = spec.refs[r];
+      Input input{.instance = index, .ref = r};
+      int32_t source = ref.derived != kNoDerived
+                           ? instance_of[static_cast<size_t>(ref.derived)]
+                           : -1;
+      if (source >= 0) {
+        node.instances[static_cast<size_t>(source)].dependents.push_back(input);
+        continue;
+      }
+      // Otherwise a plain metric, including a derived name not compiled for this node
+      auto next = static_cast<uint32_t>(node.inputs.size());
+      auto [it, inserted] =
+          node.by_name.try_emplace(input_key(ref.device_id, ref.metric_name), next);
+      if (inserted) {
+        node.inputs.emplace_back();
+      }
+      node.inputs[it->second].push_back(input);
+    }
+  }
+  if (node.instances.empty()) {
+    return;
+  }
+  for (uint32_t i = 0; i < node.instances.size(); ++i) {
+    dirty_.push(i);
+  }
+  instances_ += node.instances.size();
+  nodes_.emplace(detail::NodeKey(key), std::move(node));
+}
+
+void DerivedMetrics::set_input(Node& node, Input input, std::optional<double> value) {
+  auto& instance = node.instances[input.instance];
+  bool was_known = instance.known[input.ref] != 0;
+  if (value) {
+    if (was_known && instance.inputs[input.ref] == *value) {
+      return;
+    }
+    instance.inputs[input.ref] = *value;
+    if (!was_known) {
+      instance.known[input.ref] = 1;
+      instance.missing--;
+    }
+  } else {
+    if (!was_known) {
+      return;
+    }
+    instance.known[input.ref] = 0;
+    instance.missing++;
+  }
+  if (!instance.dirty) {
+    instance.dirty = true;
+    dirty_.push(input.instance);
+  }
+}
+
+void DerivedMetrics::apply(Node& node,
+                           const Topic& topic,
+                           const org::eclipse::tahu::protobuf::Payload& payload) {
+  bool birth = topic.message_type == MessageType::NBIRTH ||
+               topic.message_type == MessageType::DBIRTH;
+  for (const auto& metric : payload.metrics()) {
+    if (metric.is_historical()) {
+      continue;
+    }
+    uint32_t list = 0;
+    if (metric.has_name()) {
+      auto it =
+          node.by_name.find(detail::NodeKeyView{{}, {}, topic.device_id, metric.name()});
+      if (it == node.by_name.end()) {
+        continue;
+      }
+      list = it->second;
+      if (birth && metric.has_alias()) {
+        node.by_alias[metric.alias()] = list;
+      }
+    } else if (metric.has_alias()) {
+      auto it = node.by_alias.find(metric.alias());
+      if (it == node.by_alias.end()) {
+        continue;
+      }
+      list = it->second;
+    } else {
+      continue;
+    }
+
+    std::optional<double> value;
+    if (!metric.has_is_null() || !metric.is_null()) {
+      value = decode_metric_number(metric);
+      if (!value || std::isnan(*value)) {
+        continue;
+      }
+    }
+    for (Input input : node.inputs[list]) {
+      set_input(node, input, value);
+    }
+  }
+}
+
+void DerivedMetrics::forget_device(Node& node, std::string_view device_id) {
+  for (const auto& [key, list] : node.by_name) {
+    if (key.device_id == device_id) {
+      for (Input input : node.inputs[list]) {
+        set_input(node, input, std::nullopt);
+      }
+    }
+  }
+}
+
+double DerivedMetrics::evaluate(const Spec& spec, const Instance& instance) {
+  scratch_stack_.resize(std::max<size_t>(spec.stack_depth, 1));
+  double* stack = scratch_stack_.data();
+  size_t top = 0;
+  for (const auto& op : spec.program) {
+    switch (op.code) {
+    case OpCode::Constant:
+      stack[top++] = op.constant;
+      break;
+    case OpCode::Input:
+      stack[top++] = instance.inputs[op.input];
+      break;
+    case OpCode::Add:
+      --top;
+      stack[top - 1] += stack[top];
+      break;
+    case OpCode::Sub:
+      --top;
+      stack[top - 1] -= stack[top];
+      break;
+    case OpCode::Mul:
+      --top;
+      stack[top - 1] *= stack[top];
+      break;
+    case OpCode::Div:
+      --top;
+      stack[top - 1] /= stack[top];
+      break;
+    case OpCode::Neg:
+      stack[top - 1] = -stack[top - 1];
+      break;
+    case OpCode::Min:
+      --top;
+      stack[top - 1] = std::min(stack[top - 1], stack[top]);
+      break;
+    case OpCode::Max:
+      --top;
+      stack[top - 1] = std::max(stack[top - 1], stack[top]);
+      break;
+    case OpCode::Abs:
+      stack[top - 1] = std::abs(stack[top - 1]);
+      break;
+    }
+  }
+  return stack[0];
+}
+
+size_t DerivedMetrics::recompute(Node& node,
+                                 const Topic& topic,
+                                 uint64_t timestamp,
+                                 std::vector<DerivedValue>& out) {
+  size_t before = out.size();
+  // Dependents always follow their sources, so ascending order is topological
+  while (!dirty_.empty()) {
+    uint32_t index = dirty_.top();
+    dirty_.pop();
+    auto& instance = node.instances[index];
+    instance.dirty = false;
+
+    std::optional<double> result;
+    if (instance.missing == 0) {
+      double value = evaluate(specs_[instance.spec], instance);
+      if (std::isfinite(value)) {
+        result = value;
+      }
+    }
+    if (result == instance.value) {
+      continue;
+    }
+    instance.value = result;
+    out.push_back({.group_id = topic.group_id,
+                   .edge_node_id = topic.edge_node_id,
+                   .name = specs_[instance.spec].spec.name,
+                   .value = result,
+                   .timestamp = timestamp});
+    for (Input dependent : instance.dependents) {
+      set_input(node, dependent, result);
+    }
+  }
+  return out.size() - before;
+}
+
+void DerivedMetrics::forget(std::string_view group_id, std::string_view edge_node_id) {
+  if (auto it = nodes_.find(detail::NodeKeyView{group_id, edge_node_id});
+      it != nodes_.end()) {
+    instances_ -= it->second.instances.size();
+    nodes_.erase(it);
+  }
+}
+
+size_t DerivedMetrics::process(const Topic& topic,
+                               const org::eclipse::tahu::protobuf::Payload& payload,
+                               std::vector<DerivedValue>& out) {
+  switch (topic.message_type) {
+  case MessageType::NBIRTH:
+    compile(topic);
+    break;
+  case MessageType::NDEATH:
+    forget(topic.group_id, topic.edge_node_id);
+    return 0;
+  case MessageType::DBIRTH:
+  case MessageType::NDATA:
+  case MessageType::DDATA:
+  case MessageType::DDEATH:
+    break;
+  default:
+    return 0;
+  }
+
+  auto it = nodes_.find(detail::NodeKeyView{topic.group_id, topic.edge_node_id});
+  if (it == nodes_.end()) {
+    return 0;
+  }
+  if (topic.message_type == MessageType::DDEATH) {
+    forget_device(it->second, topic.device_id);
+  } else {
+    apply(it->second, topic, payload);
+  }
+  uint64_t timestamp = payload.has_timestamp() ? payload.timestamp() : now_millis();
+  return recompute(it->second, topic, timestamp, out);
+}
+
+std::optional<double> DerivedMetrics::value(std::string_view group_id,
+                                            std::string_view edge_node_id,
+                                            std::string_view name) const {
+  auto it = nodes_.find(detail::NodeKeyView{group_id, edge_node_id});
+  if (it == nodes_.end()) {
+    return std::nullopt;
+  }
+  for (const auto& instance : it->second.instances) {
+    if (specs_[instance.spec].spec.name == name) {
+      return instance.value;
+    }
+  }
+  return std::nullopt;
+}
+
+} // namespace sparkplug
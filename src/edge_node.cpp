@@ -1,6 +1,7 @@
 // src/edge_node.cpp
 #include "sparkplug/edge_node.hpp"
 
+#include <algorithm>
 #include <cstring>
 #include <format>
 #include <future>
@@ -81,6 +82,9 @@ void EdgeNode::on_connection_lost(void* context, char* cause) {
   }
 
   edge_node->is_connected_.store(false, std::memory_order_relaxed);
+  if (edge_node->config_.offline_buffer) {
+    edge_node->buffering_.store(true, std::memory_order_relaxed);
+  }
   (void)cause;
 }
 
@@ -97,6 +101,13 @@ void MQTTAsyncHandle::reset() noexcept {
 
 EdgeNode::EdgeNode(Config config) : config_(std::move(config)) {
   will_opts_ = MQTTAsync_willOptions_initializer;
+  if (config_.rate_limit) {
+    const auto& limit = *config_.rate_limit;
+    message_bucket_ = detail::TokenBucket(
+        limit.messages_per_second, limit.messages_per_second * limit.burst_seconds);
+    byte_bucket_ = detail::TokenBucket(limit.bytes_per_second,
+                                       limit.bytes_per_second * limit.burst_seconds);
+  }
 }
 
 int EdgeNode::on_message_arrived(void* context,
@@ -117,7 +128,7 @@ int EdgeNode::on_message_arrived(void* context,
                             message->payloadlen);
 
     if (auto online = parse_state_online(payload_str)) {
-      edge_node->primary_host_online_.store(*online, std::memory_order_relaxed);
+      edge_node->on_primary_host_state(*online);
     }
 
     MQTTAsync_freeMessage(&message);
@@ -148,6 +159,126 @@ int EdgeNode::on_message_arrived(void* context,
   return 1;
 }
 
+void EdgeNode::on_primary_host_state(bool online) {
+  bool changed = false;
+  stdx::expected<void, std::string> births;
+  {
+    std::scoped_lock lock(mutex_);
+    changed = primary_host_online_.exchange(online, std::memory_order_relaxed) != online;
+    if (changed && online && config_.auto_birth) {
+      births = publish_cached_births_locked();
+    }
+  }
+  primary_host_cv_.notify_all();
+
+  if (!births) {
+    log(LogLevel::WARN, std::format("Automatic birth failed: {}", births.error()));
+  }
+  if (changed && config_.primary_host_callback) {
+    config_.primary_host_callback.value()(online);
+  }
+}
+
+stdx::expected<void, std::string> EdgeNode::publish_cached_births_locked() {
+  births_deferred_ = false;
+  if (!is_connected_ || last_birth_payload_.empty()) {
+    return {};
+  }
+
+  org::eclipse::tahu::protobuf::Payload proto_payload;
+  if (!proto_payload.ParseFromArray(last_birth_payload_.data(),
+                                    static_cast<int>(last_birth_payload_.size()))) {
+    return stdx::unexpected("Failed to parse stored birth payload");
+  }
+  // The session may have changed since the birth was cached
+  for (auto& metric : *proto_payload.mutable_metrics()) {
+    if (metric.name() == "bdSeq") {
+      metric.set_long_value(bd_seq_num_);
+      break;
+    }
+  }
+  proto_payload.set_seq(0);
+
+  std::vector<uint8_t> payload_data(proto_payload.ByteSizeLong());
+  (void)proto_payload.SerializeToArray(payload_data.data(),
+                                       static_cast<int>(payload_data.size()));
+
+  Topic topic{.group_id = config_.group_id,
+              .message_type = MessageType::NBIRTH,
+              .edge_node_id = config_.edge_node_id,
+              .device_id = ""};
+
+  // Published under mutex_ (sendMessage does not block) so no NDATA can slip in
+  // between the NBIRTH and the DBIRTHs
+  auto result = publish_message(client_.get(), topic.to_string(), payload_data,
+                                config_.data_qos, false);
+  if (!result) {
+    return result;
+  }
+  last_birth_payload_ = std::move(payload_data);
+  seq_num_ = 0;
+
+  for (auto& [device_id, device] : device_states_) {
+    if (device.is_online && !device.last_birth_payload.empty()) {
+      if (auto device_result = publish_cached_device_birth_locked(device_id, device);
+          !device_result) {
+        return device_result;
+      }
+    }
+  }
+
+  // The cached births carry the values of the original birth; conflated metrics
+  // held since are newer, so they follow right away (as far as the data lane
+  // allows; the rest waits for flush_conflated())
+  std::vector<std::pair<std::string, std::vector<uint8_t>>> messages;
+  take_conflated_locked(messages);
+  for (const auto& [topic_str, data] : messages) {
+    if (auto data_result =
+            publish_message(client_.get(), topic_str, data, config_.data_qos, false);
+        !data_result) {
+      return data_result;
+    }
+  }
+  return {};
+}
+
+stdx::expected<void, std::string>
+EdgeNode::publish_cached_device_birth_locked(const std::string& device_id,
+                                             DeviceState& device) {
+  org::eclipse::tahu::protobuf::Payload proto_payload;
+  if (!proto_payload.ParseFromArray(device.last_birth_payload.data(),
+                                    static_cast<int>(device.last_birth_payload.size()))) {
+    return stdx::unexpected(
+        std::format("Failed to parse stored DBIRTH payload for '{}'", device_id));
+  }
+  uint64_t seq = (seq_num_ + 1) % SEQ_NUMBER_MAX;
+  proto_payload.set_seq(seq);
+
+  std::vector<uint8_t> payload_data(proto_payload.ByteSizeLong());
+  (void)proto_payload.SerializeToArray(payload_data.data(),
+                                       static_cast<int>(payload_data.size()));
+
+  Topic topic{.group_id = config_.group_id,
+              .message_type = MessageType::DBIRTH,
+              .edge_node_id = config_.edge_node_id,
+              .device_id = device_id};
+  auto result = publish_message(client_.get(), topic.to_string(), payload_data,
+                                config_.data_qos, false);
+  if (!result) {
+    return result;
+  }
+  seq_num_ = seq;
+  device.last_birth_payload = std::move(payload_data);
+  return {};
+}
+
+bool EdgeNode::wait_for_primary_host(std::chrono::milliseconds timeout) const {
+  std::unique_lock lock(mutex_);
+  return primary_host_cv_.wait_for(lock, timeout, [this] {
+    return primary_host_online_.load(std::memory_order_relaxed);
+  });
+}
+
 EdgeNode::~EdgeNode() {
   if (client_) {
     // Clear callbacks first to prevent callbacks during destruction
@@ -169,13 +300,22 @@ EdgeNode::EdgeNode(EdgeNode&& other) noexcept {
   bd_seq_num_ = other.bd_seq_num_;
   death_payload_data_ = std::move(other.death_payload_data_);
   last_birth_payload_ = std::move(other.last_birth_payload_);
+  births_deferred_ = other.births_deferred_;
   device_states_ = std::move(other.device_states_);
+  message_bucket_ = other.message_bucket_;
+  byte_bucket_ = other.byte_bucket_;
+  rate_limit_stats_ = other.rate_limit_stats_;
+  pending_data_ = std::move(other.pending_data_);
+  connection_stats_ = other.connection_stats_;
   is_connected_.store(other.is_connected_.load(std::memory_order_relaxed),
                       std::memory_order_relaxed);
   primary_host_online_.store(other.primary_host_online_.load(std::memory_order_relaxed),
                              std::memory_order_relaxed);
+  buffering_.store(other.buffering_.load(std::memory_order_relaxed),
+                   std::memory_order_relaxed);
   other.is_connected_.store(false, std::memory_order_relaxed);
   other.primary_host_online_.store(false, std::memory_order_relaxed);
+  other.buffering_.store(false, std::memory_order_relaxed);
 }
 
 EdgeNode& EdgeNode::operator=(EdgeNode&& other) noexcept {
@@ -189,13 +329,22 @@ EdgeNode& EdgeNode::operator=(EdgeNode&& other) noexcept {
     bd_seq_num_ = other.bd_seq_num_;
     death_payload_data_ = std::move(other.death_payload_data_);
     last_birth_payload_ = std::move(other.last_birth_payload_);
+    births_deferred_ = other.births_deferred_;
     device_states_ = std::move(other.device_states_);
+    message_bucket_ = other.message_bucket_;
+    byte_bucket_ = other.byte_bucket_;
+    rate_limit_stats_ = other.rate_limit_stats_;
+    pending_data_ = std::move(other.pending_data_);
+    connection_stats_ = other.connection_stats_;
     is_connected_.store(other.is_connected_.load(std::memory_order_relaxed),
                         std::memory_order_relaxed);
     primary_host_online_.store(other.primary_host_online_.load(std::memory_order_relaxed),
                                std::memory_order_relaxed);
+    buffering_.store(other.buffering_.load(std::memory_order_relaxed),
+                     std::memory_order_relaxed);
     other.is_connected_.store(false, std::memory_order_relaxed);
     other.primary_host_online_.store(false, std::memory_order_relaxed);
+    other.buffering_.store(false, std::memory_order_relaxed);
   }
   return *this;
 }
@@ -227,18 +376,30 @@ stdx::expected<void, std::string> EdgeNode::connect() {
   std::string group_id;
   std::string edge_node_id;
   std::optional<std::string> primary_host_id;
-
+  std::chrono::steady_clock::time_point connect_start;
   {
     std::scoped_lock lock(mutex_);
 
-    MQTTAsync raw_client = nullptr;
-    int rc =
-        MQTTAsync_create(&raw_client, config_.broker_url.c_str(),
-                         config_.client_id.c_str(), MQTTCLIENT_PERSISTENCE_NONE, nullptr);
-    if (rc != MQTTASYNC_SUCCESS) {
-      return stdx::unexpected(std::format("Failed to create client: {}", rc));
+    // With an offline buffer, an existing client is kept so that messages it
+    // buffered while disconnected are sent after the reconnect.
+    int rc = MQTTASYNC_SUCCESS;
+    if (!config_.offline_buffer || !client_) {
+      MQTTAsync_createOptions create_opts = MQTTAsync_createOptions_initializer;
+      if (config_.offline_buffer) {
+        create_opts.sendWhileDisconnected = 1;
+        create_opts.maxBufferedMessages = config_.offline_buffer->max_buffered_messages;
+        create_opts.deleteOldestMessages = config_.offline_buffer->delete_oldest ? 1 : 0;
+      }
+
+      MQTTAsync raw_client = nullptr;
+      rc = MQTTAsync_createWithOptions(
+          &raw_client, config_.broker_url.c_str(), config_.client_id.c_str(),
+          MQTTCLIENT_PERSISTENCE_NONE, nullptr, &create_opts);
+      if (rc != MQTTASYNC_SUCCESS) {
+        return stdx::unexpected(std::format("Failed to create client: {}", rc));
+      }
+      client_ = MQTTAsyncHandle(raw_client);
     }
-    client_ = MQTTAsyncHandle(raw_client);
 
     rc = MQTTAsync_setCallbacks(client_.get(), this, on_connection_lost,
                                 on_message_arrived, nullptr);
@@ -249,6 +410,13 @@ stdx::expected<void, std::string> EdgeNode::connect() {
     // Increment bdSeq for this session
     bd_seq_num_++;
 
+    // With auto_birth the new session births on the STATE message that the
+    // subscription below delivers, rather than on a stale online flag
+    if (config_.auto_birth && config_.primary_host_id.has_value()) {
+      primary_host_online_.store(false, std::memory_order_relaxed);
+      births_deferred_ = !last_birth_payload_.empty();
+    }
+
     PayloadBuilder death_payload;
     death_payload.add_metric("bdSeq", bd_seq_num_);
     death_payload_data_ = death_payload.build();
@@ -297,6 +465,7 @@ stdx::expected<void, std::string> EdgeNode::connect() {
     conn_opts.onSuccess = on_connect_success;
     conn_opts.onFailure = on_connect_failure;
 
+    connect_start = std::chrono::steady_clock::now();
     rc = MQTTAsync_connect(client_.get(), &conn_opts);
     if (rc != MQTTASYNC_SUCCESS) {
       return stdx::unexpected(std::format("Failed to connect: {}", rc));
@@ -323,15 +492,30 @@ stdx::expected<void, std::string> EdgeNode::connect() {
   } catch (const std::exception& e) {
     return stdx::unexpected(e.what());
   }
+  auto connect_time = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - connect_start);
 
   // Phase 3: Update connected state atomically.
   // on_connection_lost() may have fired between Phase 2 and now.
   if (!MQTTAsync_isConnected(client_handle)) {
     return stdx::unexpected("Connection lost during setup");
   }
+  {
+    std::scoped_lock lock(mutex_);
+    connection_stats_.connects++;
+    connection_stats_.last_connect_time = connect_time;
+    connection_stats_.max_connect_time =
+        std::max(connection_stats_.max_connect_time, connect_time);
+    connection_stats_.total_connect_time += connect_time;
+  }
   is_connected_.store(true, std::memory_order_relaxed);
+  buffering_.store(false, std::memory_order_relaxed);
   if (!primary_host_id.has_value()) {
-    primary_host_online_.store(true, std::memory_order_relaxed);
+    {
+      std::scoped_lock lock(mutex_);
+      primary_host_online_.store(true, std::memory_order_relaxed);
+    }
+    primary_host_cv_.notify_all();
   }
 
   // Phase 4: Subscribe to NCMD (no lock held)
@@ -437,6 +621,7 @@ stdx::expected<void, std::string> EdgeNode::disconnect() {
   }
 
   is_connected_.store(false, std::memory_order_relaxed);
+  buffering_.store(false, std::memory_order_relaxed);
   return {};
 }
 
@@ -459,6 +644,9 @@ EdgeNode::publish_message(MQTTAsync client,
   MQTTAsync_responseOptions opts = MQTTAsync_responseOptions_initializer;
 
   int rc = MQTTAsync_sendMessage(client, topic_str.c_str(), &msg, &opts);
+  if (rc == MQTTASYNC_MAX_BUFFERED_MESSAGES) {
+    return stdx::unexpected("Failed to publish: offline buffer full");
+  }
   if (rc != MQTTASYNC_SUCCESS) {
     return stdx::unexpected(std::format("Failed to publish: {}", rc));
   }
@@ -479,7 +667,8 @@ stdx::expected<void, std::string> EdgeNode::publish_birth(PayloadBuilder& payloa
       return stdx::unexpected("Not connected");
     }
 
-    if (!primary_host_online_) {
+    bool defer = !primary_host_online_;
+    if (defer && !config_.auto_birth) {
       return stdx::unexpected("Primary host is not online");
     }
 
@@ -514,6 +703,13 @@ stdx::expected<void, std::string> EdgeNode::publish_birth(PayloadBuilder& payloa
     payload_data = payload.build();
     client = client_.get();
     qos = config_.data_qos;
+
+    if (defer) {
+      // Sent by publish_cached_births_locked() when the primary host comes online
+      last_birth_payload_ = std::move(payload_data);
+      births_deferred_ = true;
+      return {};
+    }
   }
 
   auto result = publish_message(client, topic_str, payload_data, qos, false);
@@ -525,28 +721,49 @@ stdx::expected<void, std::string> EdgeNode::publish_birth(PayloadBuilder& payloa
     std::scoped_lock lock(mutex_);
     last_birth_payload_ = std::move(payload_data);
     seq_num_ = 0;
+    pending_data_.clear(); // The new session's birth carries current values
   }
 
   return {};
 }
 
-stdx::expected<void, std::string> EdgeNode::publish_data(PayloadBuilder& payload) {
+stdx::expected<void, std::string> EdgeNode::publish_data(PayloadBuilder& payload,
+                                                         PublishLane lane) {
+  return try_publish_data(payload, lane).and_then(
+      [](PublishStatus status) -> stdx::expected<void, std::string> {
+        if (status == PublishStatus::WouldBlock) {
+          return stdx::unexpected("Publish would block: too many pending messages");
+        }
+        return {};
+      });
+}
+
+stdx::expected<EdgeNode::PublishStatus, std::string>
+EdgeNode::try_publish_data(PayloadBuilder& payload, PublishLane lane) {
+  if (would_block()) {
+    return PublishStatus::WouldBlock;
+  }
+
   MQTTAsync client = nullptr;
   std::string topic_str;
   std::vector<uint8_t> payload_data;
   int qos = 0;
+  bool buffered = false;
 
   {
     std::scoped_lock lock(mutex_);
 
-    if (!is_connected_) {
+    buffered = !is_connected_;
+    if (buffered && !(buffering_ && client_ && !last_birth_payload_.empty())) {
       return stdx::unexpected("Not connected");
     }
 
-    seq_num_ = (seq_num_ + 1) % SEQ_NUMBER_MAX;
-
-    if (!payload.has_seq()) {
-      payload.set_seq(seq_num_);
+    auto admitted = admit_data_locked("", payload, lane, payload_data);
+    if (!admitted) {
+      return stdx::unexpected(admitted.error());
+    }
+    if (!*admitted) {
+      return PublishStatus::Conflated;
     }
 
     Topic topic{.group_id = config_.group_id,
@@ -555,12 +772,213 @@ stdx::expected<void, std::string> EdgeNode::publish_data(PayloadBuilder& payload
                 .device_id = ""};
 
     topic_str = topic.to_string();
-    payload_data = payload.build();
     client = client_.get();
     qos = config_.data_qos;
   }
 
-  return publish_message(client, topic_str, payload_data, qos, false);
+  return publish_message(client, topic_str, payload_data, qos, false).transform([&] {
+    return buffered ? PublishStatus::Buffered : PublishStatus::Sent;
+  });
+}
+
+bool EdgeNode::would_block() const {
+  MQTTAsync client = nullptr;
+  int limit = 0;
+  {
+    std::scoped_lock lock(mutex_);
+    if (!config_.offline_buffer || config_.offline_buffer->max_pending_messages <= 0) {
+      return false;
+    }
+    limit = config_.offline_buffer->max_pending_messages;
+    client = client_.get();
+  }
+  return client && get_pending_messages() >= limit;
+}
+
+EdgeNode::ConnectionStats EdgeNode::get_connection_stats() const {
+  std::scoped_lock lock(mutex_);
+  return connection_stats_;
+}
+
+int EdgeNode::get_pending_messages() const {
+  MQTTAsync client = nullptr;
+  {
+    std::scoped_lock lock(mutex_);
+    client = client_.get();
+  }
+  if (!client) {
+    return 0;
+  }
+
+  MQTTAsync_token* tokens = nullptr;
+  if (MQTTAsync_getPendingTokens(client, &tokens) != MQTTASYNC_SUCCESS || !tokens) {
+    return 0;
+  }
+  int count = 0;
+  while (tokens[count] != -1) {
+    count++;
+  }
+  MQTTAsync_free(tokens);
+  return count;
+}
+
+stdx::expected<bool, std::string>
+EdgeNode::admit_data_locked(std::string_view device_id,
+                            PayloadBuilder& payload,
+                            PublishLane lane,
+                            std::vector<uint8_t>& payload_data) {
+  if (births_deferred_) {
+    return stdx::unexpected("Births are waiting for the primary host to come online");
+  }
+
+  auto& proto = payload.mutable_payload();
+
+  // Older conflated metrics go first; metrics in this payload supersede them
+  auto pending = pending_data_.find(device_id);
+  if (pending != pending_data_.end()) {
+    google::protobuf::RepeatedPtrField<org::eclipse::tahu::protobuf::Payload::Metric>
+        merged;
+    for (auto& old_metric : *pending->second.mutable_metrics()) {
+      bool superseded = std::ranges::any_of(proto.metrics(), [&](const auto& metric) {
+        return old_metric.has_alias() ? metric.has_alias() &&
+                                            metric.alias() == old_metric.alias()
+                                      : metric.name() == old_metric.name();
+      });
+      if (!superseded) {
+        merged.Add(std::move(old_metric));
+      }
+    }
+    for (auto& metric : *proto.mutable_metrics()) {
+      merged.Add(std::move(metric));
+    }
+    proto.mutable_metrics()->Swap(&merged);
+    pending_data_.erase(pending);
+  }
+
+  // The seq goes on the proto only; the builder is marked once the message is
+  // admitted, so a caller retrying a refused builder gets a fresh seq
+  uint64_t next_seq = (seq_num_ + 1) % SEQ_NUMBER_MAX;
+  bool assign_seq = !payload.has_seq();
+  if (assign_seq) {
+    proto.set_seq(next_seq);
+  }
+
+  // Encoded only once admitted; the byte bucket needs just the size, and a
+  // message refused by the message bucket needs neither
+  if (lane == PublishLane::Priority) {
+    rate_limit_stats_.priority++;
+  } else if (config_.rate_limit) {
+    auto now = detail::TokenBucket::Clock::now();
+    message_bucket_.refill(now);
+    byte_bucket_.refill(now);
+    double bytes = 0.0;
+    bool admit = message_bucket_.can_consume(1.0);
+    if (admit && !byte_bucket_.unlimited()) {
+      bytes = static_cast<double>(proto.ByteSizeLong());
+      admit = byte_bucket_.can_consume(bytes);
+    }
+    if (!admit) {
+      if (assign_seq) {
+        proto.clear_seq(); // Seq is only consumed by messages that go out
+      }
+      if (config_.rate_limit->policy == RateLimitPolicy::Reject) {
+        rate_limit_stats_.rejected++;
+        return stdx::unexpected("Rate limit exceeded");
+      }
+      rate_limit_stats_.conflated++;
+      pending_data_.insert_or_assign(std::string(device_id), proto);
+      return false;
+    }
+    message_bucket_.consume(1.0);
+    byte_bucket_.consume(bytes);
+    rate_limit_stats_.admitted++;
+  }
+
+  payload_data = payload.build();
+  if (assign_seq) {
+    payload.set_seq(next_seq);
+  }
+  seq_num_ = next_seq;
+  return true;
+}
+
+stdx::expected<size_t, std::string> EdgeNode::flush_conflated() {
+  MQTTAsync client = nullptr;
+  std::vector<std::pair<std::string, std::vector<uint8_t>>> messages;
+  int qos = 0;
+
+  {
+    std::scoped_lock lock(mutex_);
+
+    if (!is_connected_) {
+      return stdx::unexpected("Not connected");
+    }
+    if (births_deferred_) {
+      return 0; // Nothing may precede the held births
+    }
+
+    take_conflated_locked(messages);
+    client = client_.get();
+    qos = config_.data_qos;
+  }
+
+  for (const auto& [topic_str, payload_data] : messages) {
+    auto result = publish_message(client, topic_str, payload_data, qos, false);
+    if (!result) {
+      return stdx::unexpected(result.error());
+    }
+  }
+  return messages.size();
+}
+
+void EdgeNode::take_conflated_locked(
+    std::vector<std::pair<std::string, std::vector<uint8_t>>>& messages) {
+  auto now = detail::TokenBucket::Clock::now();
+  message_bucket_.refill(now);
+  byte_bucket_.refill(now);
+
+  for (auto it = pending_data_.begin(); it != pending_data_.end();) {
+    const auto& device_id = it->first;
+    if (!device_id.empty()) {
+      auto device = device_states_.find(device_id);
+      if (device == device_states_.end() || !device->second.is_online) {
+        it = pending_data_.erase(it); // Device went away; its metrics are stale
+        continue;
+      }
+    }
+
+    auto& proto = it->second;
+    uint64_t next_seq = (seq_num_ + 1) % SEQ_NUMBER_MAX;
+    proto.set_seq(next_seq);
+    std::vector<uint8_t> payload_data(proto.ByteSizeLong());
+    (void)proto.SerializeToArray(payload_data.data(),
+                                 static_cast<int>(payload_data.size()));
+
+    auto bytes = static_cast<double>(payload_data.size());
+    if (!message_bucket_.can_consume(1.0) || !byte_bucket_.can_consume(bytes)) {
+      proto.clear_seq();
+      break;
+    }
+    message_bucket_.consume(1.0);
+    byte_bucket_.consume(bytes);
+    rate_limit_stats_.admitted++;
+    seq_num_ = next_seq;
+
+    Topic topic{.group_id = config_.group_id,
+                .message_type =
+                    device_id.empty() ? MessageType::NDATA : MessageType::DDATA,
+                .edge_node_id = config_.edge_node_id,
+                .device_id = device_id};
+    messages.emplace_back(topic.to_string(), std::move(payload_data));
+    it = pending_data_.erase(it);
+  }
+}
+
+EdgeNode::RateLimitStats EdgeNode::get_rate_limit_stats() const {
+  std::scoped_lock lock(mutex_);
+  auto stats = rate_limit_stats_;
+  stats.pending = pending_data_.size();
+  return stats;
 }
 
 stdx::expected<void, std::string> EdgeNode::publish_death() {
@@ -608,6 +1026,7 @@ stdx::expected<void, std::string> EdgeNode::rebirth() {
   std::vector<uint8_t> payload_data;
   std::string topic_str;
   int qos = 0;
+  bool auto_births = false;
 
   {
     std::scoped_lock lock(mutex_);
@@ -649,6 +1068,12 @@ stdx::expected<void, std::string> EdgeNode::rebirth() {
 
     topic_str = topic.to_string();
     qos = config_.data_qos;
+    auto_births = config_.auto_birth && config_.primary_host_id.has_value();
+  }
+
+  if (auto_births) {
+    // The new session's NBIRTH and DBIRTHs follow the primary host's STATE
+    return disconnect().and_then([this]() { return connect(); });
   }
 
   auto result = disconnect()
@@ -680,6 +1105,7 @@ EdgeNode::publish_device_birth(std::string_view device_id, PayloadBuilder& paylo
   std::string topic_str;
   std::vector<uint8_t> payload_data;
   int qos = 0;
+  bool defer = false;
 
   {
     std::scoped_lock lock(mutex_);
@@ -688,7 +1114,8 @@ EdgeNode::publish_device_birth(std::string_view device_id, PayloadBuilder& paylo
       return stdx::unexpected("Not connected");
     }
 
-    if (!primary_host_online_) {
+    defer = !primary_host_online_;
+    if (defer && !config_.auto_birth) {
       return stdx::unexpected("Primary host is not online");
     }
 
@@ -696,8 +1123,10 @@ EdgeNode::publish_device_birth(std::string_view device_id, PayloadBuilder& paylo
       return stdx::unexpected("Must publish NBIRTH before DBIRTH");
     }
 
-    seq_num_ = (seq_num_ + 1) % SEQ_NUMBER_MAX;
-    payload.set_seq(seq_num_);
+    if (!defer) {
+      seq_num_ = (seq_num_ + 1) % SEQ_NUMBER_MAX;
+      payload.set_seq(seq_num_);
+    }
 
     Topic topic{.group_id = config_.group_id,
                 .message_type = MessageType::DBIRTH,
@@ -744,6 +1173,20 @@ EdgeNode::publish_device_birth(std::string_view device_id, PayloadBuilder& paylo
     return stdx::unexpected(std::format("DCMD subscription failed: {}", e.what()));
   }
 
+  if (defer) {
+    std::scoped_lock lock(mutex_);
+    auto [it, inserted] = device_states_.try_emplace(std::string(device_id));
+    it->second.last_birth_payload = std::move(payload_data);
+    it->second.is_online = true;
+    // The primary host may have come online (and the node births gone out) while
+    // DCMD was being subscribed
+    if (primary_host_online_ && !births_deferred_) {
+      pending_data_.erase(it->first); // This birth was built with current values
+      return publish_cached_device_birth_locked(it->first, it->second);
+    }
+    return {};
+  }
+
   auto result = publish_message(client, topic_str, payload_data, qos, false);
   if (!result) {
     return result;
@@ -754,22 +1197,46 @@ EdgeNode::publish_device_birth(std::string_view device_id, PayloadBuilder& paylo
     auto& device_state = device_states_[std::string(device_id)];
     device_state.last_birth_payload = std::move(payload_data);
     device_state.is_online = true;
+    if (auto pending = pending_data_.find(device_id); pending != pending_data_.end()) {
+      pending_data_.erase(pending);
+    }
   }
 
   return {};
 }
 
 stdx::expected<void, std::string>
-EdgeNode::publish_device_data(std::string_view device_id, PayloadBuilder& payload) {
+EdgeNode::publish_device_data(std::string_view device_id,
+                              PayloadBuilder& payload,
+                              PublishLane lane) {
+  return try_publish_device_data(device_id, payload, lane)
+      .and_then([](PublishStatus status) -> stdx::expected<void, std::string> {
+        if (status == PublishStatus::WouldBlock) {
+          return stdx::unexpected("Publish would block: too many pending messages");
+        }
+        return {};
+      });
+}
+
+stdx::expected<EdgeNode::PublishStatus, std::string>
+EdgeNode::try_publish_device_data(std::string_view device_id,
+                                  PayloadBuilder& payload,
+                                  PublishLane lane) {
+  if (would_block()) {
+    return PublishStatus::WouldBlock;
+  }
+
   MQTTAsync client = nullptr;
   std::string topic_str;
   std::vector<uint8_t> payload_data;
   int qos = 0;
+  bool buffered = false;
 
   {
     std::scoped_lock lock(mutex_);
 
-    if (!is_connected_) {
+    buffered = !is_connected_;
+    if (buffered && !(buffering_ && client_ && !last_birth_payload_.empty())) {
       return stdx::unexpected("Not connected");
     }
 
@@ -779,10 +1246,12 @@ EdgeNode::publish_device_data(std::string_view device_id, PayloadBuilder& payloa
           std::format("Must publish DBIRTH for device '{}' before DDATA", device_id));
     }
 
-    seq_num_ = (seq_num_ + 1) % SEQ_NUMBER_MAX;
-
-    if (!payload.has_seq()) {
-      payload.set_seq(seq_num_);
+    auto admitted = admit_data_locked(device_id, payload, lane, payload_data);
+    if (!admitted) {
+      return stdx::unexpected(admitted.error());
+    }
+    if (!*admitted) {
+      return PublishStatus::Conflated;
     }
 
     Topic topic{.group_id = config_.group_id,
@@ -791,12 +1260,13 @@ EdgeNode::publish_device_data(std::string_view device_id, PayloadBuilder& payloa
                 .device_id = std::string(device_id)};
 
     topic_str = topic.to_string();
-    payload_data = payload.build();
     client = client_.get();
     qos = config_.data_qos;
   }
 
-  return publish_message(client, topic_str, payload_data, qos, false);
+  return publish_message(client, topic_str, payload_data, qos, false).transform([&] {
+    return buffered ? PublishStatus::Buffered : PublishStatus::Sent;
+  });
 }
 
 stdx::expected<void, std::string>
@@ -848,6 +1318,9 @@ EdgeNode::publish_device_death(std::string_view device_id) {
     if (it != device_states_.end()) {
       it->second.is_online = false;
     }
+    if (auto pending = pending_data_.find(device_id); pending != pending_data_.end()) {
+      pending_data_.erase(pending);
+    }
   }
 
   return {};
@@ -0,0 +1,337 @@
+// src/edge_node_pool.cpp
+#include "sparkplug/edge_node_pool.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <utility>
+
+namespace sparkplug {
+
+namespace {
+
+uint64_t now_epoch_ms() {
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                   std::chrono::system_clock::now().time_since_epoch())
+                                   .count());
+}
+
+// Uniform in [0.5, 1.0): "equal jitter" keeps retries spread but bounded below
+double jitter() {
+  thread_local std::minstd_rand rng{std::random_device{}()};
+  return std::uniform_real_distribution<double>(0.5, 1.0)(rng);
+}
+
+} // namespace
+
+void EdgeNodePool::Workers::start(size_t threads) {
+  std::scoped_lock lock(mutex_);
+  stopping_ = false;
+  for (size_t i = 0; i < std::max<size_t>(threads, 1); ++i) {
+    threads_.emplace_back([this] {
+      std::unique_lock lock(mutex_);
+      while (true) {
+        cv_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+        if (stopping_) {
+          return;
+        }
+        auto job = std::move(jobs_.front());
+        jobs_.pop_front();
+        lock.unlock();
+        job();
+        lock.lock();
+      }
+    });
+  }
+}
+
+void EdgeNodePool::Workers::post(std::function<void()> job) {
+  {
+    std::scoped_lock lock(mutex_);
+    if (stopping_) {
+      return;
+    }
+    jobs_.push_back(std::move(job));
+  }
+  cv_.notify_one();
+}
+
+void EdgeNodePool::Workers::stop() {
+  {
+    std::scoped_lock lock(mutex_);
+    stopping_ = true;
+    jobs_.clear(); // Queued jobs are dropped; running ones finish
+  }
+  cv_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+  threads_.clear();
+}
+
+EdgeNodePool::EdgeNodePool() : EdgeNodePool(Options{}) {
+}
+
+EdgeNodePool::EdgeNodePool(Options options)
+    : options_(options), wheel_(options.tick, options.wheel_slots) {
+}
+
+EdgeNodePool::~EdgeNodePool() {
+  stop();
+}
+
+EdgeNodePool::NodeId EdgeNodePool::add_node(EdgeNode::Config config,
+                                            BirthCallback birth) {
+  std::scoped_lock lock(mutex_);
+  auto node = std::make_unique<Node>();
+  node->edge_node = std::make_unique<EdgeNode>(std::move(config));
+  node->birth = std::move(birth);
+  nodes_.push_back(std::move(node));
+  return nodes_.size() - 1;
+}
+
+void EdgeNodePool::add_scan(NodeId node,
+                            std::chrono::milliseconds period,
+                            ScanCallback scan) {
+  std::scoped_lock lock(mutex_);
+  if (node >= nodes_.size()) {
+    return;
+  }
+  auto entry = std::make_unique<Scan>();
+  entry->node = node;
+  entry->period = std::max(period, std::chrono::milliseconds(1));
+  entry->callback = std::move(scan);
+  scans_.push_back(std::move(entry));
+}
+
+EdgeNode& EdgeNodePool::node(NodeId id) {
+  return *nodes_.at(id)->edge_node;
+}
+
+bool EdgeNodePool::is_online(NodeId id) const {
+  return id < nodes_.size() && nodes_[id]->state == NodeState::Online;
+}
+
+EdgeNodePool::Stats EdgeNodePool::get_stats() const {
+  Stats stats;
+  stats.nodes = nodes_.size();
+  stats.online = static_cast<size_t>(std::ranges::count_if(
+      nodes_, [](const auto& node) { return node->state == NodeState::Online; }));
+  stats.connecting = connecting_.load();
+  stats.connect_failures = connect_failures_.load();
+  stats.scans = scans_run_.load();
+  stats.scans_skipped = scans_skipped_.load();
+  stats.publishes = publishes_.load();
+  stats.publish_failures = publish_failures_.load();
+  return stats;
+}
+
+void EdgeNodePool::start() {
+  std::scoped_lock lock(mutex_);
+  if (running_) {
+    return;
+  }
+  running_ = true;
+  stopping_ = false;
+  wheel_ = detail::TimerWheel(options_.tick, options_.wheel_slots);
+
+  workers_.start(options_.worker_threads);
+  connectors_.start(options_.max_concurrent_connects);
+
+  for (NodeId id = 0; id < nodes_.size(); ++id) {
+    nodes_[id]->state = NodeState::Queued;
+    nodes_[id]->failures = 0;
+    connect_queue_.push_back(id);
+  }
+
+  // Connect pacing and liveness checks share the wheel with the scans
+  wheel_.schedule(
+      options_.connect_interval, [this] { dispatch_connects(); },
+      options_.connect_interval);
+  wheel_.schedule(
+      options_.reconnect_min,
+      [this] {
+        for (NodeId id = 0; id < nodes_.size(); ++id) {
+          auto& node = *nodes_[id];
+          auto online = NodeState::Online;
+          if (!node.edge_node->is_connected() &&
+              node.state.compare_exchange_strong(online, NodeState::Idle)) {
+            schedule_retry_locked(id);
+          }
+        }
+      },
+      options_.reconnect_min);
+
+  // Spread scan phases over their period (golden-ratio sequence) so that nodes
+  // with equal periods do not all fire on the same tick.
+  constexpr double kPhaseStep = 0.6180339887498949;
+  for (size_t i = 0; i < scans_.size(); ++i) {
+    auto* scan = scans_[i].get();
+    double fraction = std::fmod(static_cast<double>(i) * kPhaseStep, 1.0);
+    auto phase = std::chrono::duration_cast<detail::TimerWheel::Duration>(
+        scan->period * fraction);
+    wheel_.schedule(
+        phase,
+        [this, scan] {
+          if (nodes_[scan->node]->state != NodeState::Online ||
+              scan->busy.exchange(true)) {
+            scans_skipped_++;
+            return;
+          }
+          workers_.post(
+              [this, scan, timestamp = tick_timestamp_] { run_scan(*scan, timestamp); });
+        },
+        scan->period);
+  }
+
+  scheduler_ = std::thread([this] { run_scheduler(); });
+}
+
+void EdgeNodePool::stop() {
+  {
+    std::scoped_lock lock(mutex_);
+    if (!running_ || stopping_) {
+      return;
+    }
+    stopping_ = true;
+  }
+  cv_.notify_all();
+  if (scheduler_.joinable()) {
+    scheduler_.join();
+  }
+  connectors_.stop();
+  workers_.stop();
+
+  for (auto& node : nodes_) {
+    if (node->state == NodeState::Online) {
+      (void)node->edge_node->disconnect();
+    }
+    node->state = NodeState::Idle;
+  }
+  for (auto& scan : scans_) {
+    scan->busy = false;
+  }
+
+  std::scoped_lock lock(mutex_);
+  connect_queue_.clear();
+  connecting_ = 0;
+  running_ = false;
+}
+
+void EdgeNodePool::run_scheduler() {
+  std::unique_lock lock(mutex_);
+  while (!stopping_) {
+    tick_timestamp_ = now_epoch_ms(); // One clock read shared by every scan this tick
+    wheel_.advance(std::chrono::steady_clock::now());
+    cv_.wait_until(lock, wheel_.next_tick(), [this] { return stopping_; });
+  }
+}
+
+void EdgeNodePool::dispatch_connects() {
+  // Called from the wheel with mutex_ held: start at most one connect per interval
+  if (connect_queue_.empty() || connecting_ >= options_.max_concurrent_connects) {
+    return;
+  }
+  NodeId id = connect_queue_.front();
+  connect_queue_.pop_front();
+  nodes_[id]->state = NodeState::Connecting;
+  connecting_++;
+  connectors_.post([this, id] { connect_node(id); });
+}
+
+void EdgeNodePool::connect_node(NodeId id) {
+  auto& node = *nodes_[id];
+
+  auto result = node.edge_node->connect().and_then([&] {
+    PayloadBuilder birth;
+    if (node.birth) {
+      node.birth(birth);
+    }
+    return node.edge_node->publish_birth(birth);
+  });
+
+  if (!result) {
+    connect_failures_++;
+    if (node.edge_node->is_connected()) {
+      (void)node.edge_node->disconnect();
+    }
+  }
+
+  std::scoped_lock lock(mutex_);
+  connecting_--;
+  if (result) {
+    node.failures = 0;
+    node.state = NodeState::Online;
+  } else {
+    node.state = NodeState::Idle;
+    schedule_retry_locked(id);
+  }
+}
+
+void EdgeNodePool::schedule_retry_locked(NodeId id) {
+  if (stopping_) {
+    return;
+  }
+  auto& node = *nodes_[id];
+  auto exponent = std::min<uint32_t>(node.failures++, 20);
+  auto delay =
+      std::min(options_.reconnect_max, options_.reconnect_min * (1u << exponent));
+  auto jittered = std::chrono::duration_cast<detail::TimerWheel::Duration>(
+      delay * jitter());
+
+  wheel_.schedule(jittered, [this, id] {
+    nodes_[id]->state = NodeState::Queued;
+    connect_queue_.push_back(id);
+  });
+}
+
+void EdgeNodePool::run_scan(Scan& scan, uint64_t timestamp) {
+  auto& node = *nodes_[scan.node];
+  auto builder = acquire_builder(timestamp);
+
+  scan.callback(*builder, timestamp);
+  scans_run_++;
+
+  if (builder->payload().metrics_size() > 0) {
+    if (node.edge_node->publish_data(*builder)) {
+      publishes_++;
+    } else {
+      publish_failures_++;
+      auto online = NodeState::Online;
+      if (!node.edge_node->is_connected() &&
+          node.state.compare_exchange_strong(online, NodeState::Idle)) {
+        std::scoped_lock lock(mutex_);
+        schedule_retry_locked(scan.node);
+      }
+    }
+  }
+
+  release_builder(std::move(builder));
+  scan.busy = false;
+}
+
+std::unique_ptr<PayloadBuilder> EdgeNodePool::acquire_builder(uint64_t timestamp) {
+  std::unique_ptr<PayloadBuilder> builder;
+  {
+    std::scoped_lock lock(mutex_);
+    if (!free_builders_.empty()) {
+      builder = std::move(free_builders_.back());
+      free_builders_.pop_back();
+    }
+  }
+  if (!builder) {
+    builder = std::make_unique<PayloadBuilder>();
+  }
+  // reset() keeps the metric objects allocated for reuse by the next scan, and
+  // drops the seq the previous publish assigned so the node assigns a new one
+  builder->reset();
+  builder->set_timestamp(timestamp);
+  return builder;
+}
+
+void EdgeNodePool::release_builder(std::unique_ptr<PayloadBuilder> builder) {
+  std::scoped_lock lock(mutex_);
+  free_builders_.push_back(std::move(builder));
+}
+
+} // namespace sparkplug
@@ -1,11 +1,17 @@
 // src/host_application.cpp
 #include "sparkplug/host_application.hpp"
 
+#include "sparkplug/detail/memory_estimate.hpp"
 #include "sparkplug/topic.hpp"
 
+#include <algorithm>
+#include <array>
+#include <charconv>
 #include <cstring>
 #include <format>
 #include <future>
+#include <random>
+#include <thread>
 #include <utility>
 
 #include <MQTTAsync.h>
@@ -16,6 +22,31 @@ namespace {
 constexpr int CONNECTION_TIMEOUT_MS = 10000; // Increased from 5s to 10s
 constexpr int DISCONNECT_TIMEOUT_MS = 11000;
 constexpr uint64_t SEQ_NUMBER_MAX = 256;
+constexpr auto REBIRTH_POLL_INTERVAL = std::chrono::milliseconds(50);
+constexpr std::string_view STATE_TOPIC_PREFIX = "spBv1.0/STATE/"; // Checked per message
+static_assert(STATE_TOPIC_PREFIX.starts_with(NAMESPACE));
+
+// {"online":<online>,"timestamp":<timestamp>} without going through std::format
+std::vector<uint8_t> state_payload(bool online, uint64_t timestamp) {
+  constexpr std::string_view timestamp_key = ",\"timestamp\":";
+  std::string_view head = online ? "{\"online\":true" : "{\"online\":false";
+  std::array<char, 20> digits{};
+  auto [end, ec] = std::to_chars(digits.data(), digits.data() + digits.size(), timestamp);
+  (void)ec; // 20 digits hold any uint64_t
+  std::vector<uint8_t> payload;
+  payload.reserve(head.size() + timestamp_key.size() + (end - digits.data()) + 1);
+  payload.insert(payload.end(), head.begin(), head.end());
+  payload.insert(payload.end(), timestamp_key.begin(), timestamp_key.end());
+  payload.insert(payload.end(), digits.data(), end);
+  payload.push_back('}');
+  return payload;
+}
+
+// Uniform in [0.5, 1.0): "equal jitter" keeps retries spread but bounded below
+double jitter() {
+  thread_local std::minstd_rand rng{std::random_device{}()};
+  return std::uniform_real_distribution<double>(0.5, 1.0)(rng);
+}
 
 void on_connect_success(void* context, MQTTAsync_successData* response) {
   (void)response;
@@ -47,76 +78,1215 @@ void on_disconnect_failure(void* context, MQTTAsync_failureData* response) {
   promise->set_exception(std::make_exception_ptr(std::runtime_error(error)));
 }
 
+// State replication frame: magic, version, kind, stream seq, node count, nodes
+constexpr std::array<uint8_t, 4> REPLICATION_MAGIC{'S', 'P', 'R', 'S'};
+constexpr uint8_t REPLICATION_VERSION = 1;
+constexpr uint8_t REPLICATION_SNAPSHOT = 0;
+constexpr uint8_t REPLICATION_DELTA = 1;
+constexpr uint8_t STATE_ONLINE = 0x01;
+constexpr uint8_t STATE_BIRTH_RECEIVED = 0x02;
+constexpr uint8_t STATE_TABLES = 0x04;        // Node: alias table and devices follow
+constexpr uint8_t STATE_METRICS_STALE = 0x08; // Device only
+constexpr uint8_t STATE_REMOVED = 0x10;       // Node: delete it (delta only)
+constexpr size_t MIN_ENCODED_NODE = 6;        // Two empty strings, flags, three varints
+
+void put_varint(std::vector<uint8_t>& out, uint64_t value) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<uint8_t>(value));
+}
+
+void put_string(std::vector<uint8_t>& out, std::string_view value) {
+  put_varint(out, value.size());
+  out.insert(out.end(), value.begin(), value.end());
+}
+
+void put_aliases(std::vector<uint8_t>& out, const AliasTableCache::Handle& aliases) {
+  if (!aliases) {
+    put_varint(out, 0);
+    return;
+  }
+  put_varint(out, aliases->size());
+  for (const auto& [alias, name] : *aliases) {
+    put_varint(out, alias);
+    put_string(out, name);
+  }
+}
+
+void put_header(std::vector<uint8_t>& out, uint8_t kind, uint64_t seq, uint64_t count) {
+  out.insert(out.end(), REPLICATION_MAGIC.begin(), REPLICATION_MAGIC.end());
+  out.push_back(REPLICATION_VERSION);
+  out.push_back(kind);
+  put_varint(out, seq);
+  put_varint(out, count);
+}
+
+void put_node(std::vector<uint8_t>& out,
+              std::string_view group_id,
+              std::string_view edge_node_id,
+              const HostApplication::NodeState& state,
+              bool tables) {
+  put_string(out, group_id);
+  put_string(out, edge_node_id);
+  out.push_back(static_cast<uint8_t>((state.is_online ? STATE_ONLINE : 0) |
+                                     (state.birth_received ? STATE_BIRTH_RECEIVED : 0) |
+                                     (tables ? STATE_TABLES : 0)));
+  put_varint(out, state.last_seq);
+  put_varint(out, state.bd_seq);
+  put_varint(out, state.birth_timestamp);
+  if (!tables) {
+    return;
+  }
+
+  put_aliases(out, state.alias_map);
+  put_varint(out, state.devices.size());
+  for (const auto& [device_id, device] : state.devices) {
+    put_string(out, device_id);
+    int flags = (device.is_online ? STATE_ONLINE : 0) |
+                (device.birth_received ? STATE_BIRTH_RECEIVED : 0) |
+                (device.metrics_stale ? STATE_METRICS_STALE : 0);
+    out.push_back(static_cast<uint8_t>(flags));
+    put_varint(out, device.last_seq);
+    put_varint(out, device.offline_timestamp);
+    put_aliases(out, device.alias_map);
+  }
+}
+
+// Node record for a node the exporting host no longer holds; zero scalars keep
+// the record the same shape as any other
+void put_removed(std::vector<uint8_t>& out,
+                 std::string_view group_id,
+                 std::string_view edge_node_id) {
+  put_string(out, group_id);
+  put_string(out, edge_node_id);
+  out.push_back(STATE_REMOVED);
+  put_varint(out, 0);
+  put_varint(out, 0);
+  put_varint(out, 0);
+}
+
+// Bounds-checked decoding of replication frames
+class StateReader {
+public:
+  explicit StateReader(std::span<const uint8_t> data) : data_(data) {
+  }
+
+  [[nodiscard]] bool byte(uint8_t& value) noexcept {
+    if (pos_ >= data_.size()) {
+      return false;
+    }
+    value = data_[pos_++];
+    return true;
+  }
+
+  [[nodiscard]] bool varint(uint64_t& value) noexcept {
+    value = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+      uint8_t b = 0;
+      if (!byte(b)) {
+        return false;
+      }
+      value |= static_cast<uint64_t>(b & 0x7f) << shift;
+      if ((b & 0x80) == 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  [[nodiscard]] bool skip(uint64_t count) noexcept {
+    if (data_.size() - pos_ < count) {
+      return false;
+    }
+    pos_ += count;
+    return true;
+  }
+
+  [[nodiscard]] bool string(std::string& value) {
+    uint64_t len = 0;
+    if (!varint(len) || data_.size() - pos_ < len) {
+      return false;
+    }
+    value.assign(reinterpret_cast<const char*>(data_.data() + pos_), len);
+    pos_ += len;
+    return true;
+  }
+
+  // Unshared until the importer interns it
+  [[nodiscard]] bool aliases(AliasTableCache::Handle& out) {
+    uint64_t count = 0;
+    if (!varint(count) || count > remaining() / 2) { // Alias and name length
+      return false;
+    }
+    AliasTable table;
+    table.reserve(count);
+    for (uint64_t i = 0; i < count; ++i) {
+      uint64_t alias = 0;
+      std::string name;
+      if (!varint(alias) || !string(name)) {
+        return false;
+      }
+      table.insert_or_assign(alias, std::move(name));
+    }
+    out = table.empty() ? nullptr : std::make_shared<const AliasTable>(std::move(table));
+    return true;
+  }
+
+  [[nodiscard]] size_t remaining() const noexcept {
+    return data_.size() - pos_;
+  }
+
+private:
+  std::span<const uint8_t> data_;
+  size_t pos_{0};
+};
+
+// Reads the Payload seq field (3, varint) without decoding the message: top-level
+// fields are walked and skipped, metrics included, by their wire type
+std::optional<uint64_t> peek_seq(std::span<const uint8_t> data) {
+  constexpr uint64_t kSeqField = 3;
+  StateReader reader(data);
+  while (reader.remaining() > 0) {
+    uint64_t tag = 0;
+    uint64_t value = 0;
+    if (!reader.varint(tag)) {
+      return std::nullopt;
+    }
+    bool ok = false;
+    switch (tag & 7) {
+    case 0: // Varint
+      ok = reader.varint(value);
+      if (ok && (tag >> 3) == kSeqField) {
+        return value;
+      }
+      break;
+    case 1: // 64-bit
+      ok = reader.skip(8);
+      break;
+    case 2: // Length-delimited
+      ok = reader.varint(value) && reader.skip(value);
+      break;
+    case 5: // 32-bit
+      ok = reader.skip(4);
+      break;
+    default:
+      break;
+    }
+    if (!ok) {
+      return std::nullopt;
+    }
+  }
+  return std::nullopt;
+}
+
+// Estimated memory of one node_states_ entry, including its devices. Alias tables
+// are shared, so only their handles count here (see AliasTableCache::bytes()).
+size_t node_state_bytes(const std::string& group_id,
+                        const std::string& edge_node_id,
+                        const HostApplication::NodeState& state) {
+  size_t bytes = sizeof(detail::NodeKey) + sizeof(state) + 2 * sizeof(void*) +
+                 detail::heap_bytes(group_id) + detail::heap_bytes(edge_node_id);
+  bytes += detail::map_bytes(state.devices);
+  for (const auto& [device_id, device] : state.devices) {
+    bytes += detail::heap_bytes(device_id);
+  }
+  return bytes;
+}
+
 } // namespace
 
-HostApplication::HostApplication(Config config) : config_(std::move(config)) {
+HostApplication::HostApplication(Config config)
+    : config_(std::move(config)), reconnector_(std::make_unique<Reconnector>()) {
+  subscriptions_ = SubscriptionManager({.max_batch = config_.subscribe_batch_size});
 }
 
 HostApplication::~HostApplication() {
+  stop_reconnect();
   if (client_) {
     MQTTAsync_setCallbacks(client_.get(), nullptr, nullptr, nullptr, nullptr);
     MQTTAsync_disconnectOptions opts = MQTTAsync_disconnectOptions_initializer;
     opts.timeout = 1000;
     (void)MQTTAsync_disconnect(client_.get(), &opts);
+    // Destroy the client while the members its pending callbacks use still exist
+    client_.reset();
   }
 }
 
 HostApplication::HostApplication(HostApplication&& other) noexcept {
+  // The reconnect worker runs on `other`; join it before its state moves
+  bool reconnecting = other.stop_reconnect();
   std::scoped_lock lock(other.mutex_, other.node_states_mutex_);
   config_ = std::move(other.config_);
   client_ = std::move(other.client_);
   is_connected_.store(other.is_connected_.load(std::memory_order_relaxed),
                       std::memory_order_relaxed);
   node_states_ = std::move(other.node_states_);
+  sinks_ = std::move(other.sinks_);
+  shm_ring_ = std::move(other.shm_ring_);
+  command_tracker_ = std::move(other.command_tracker_);
+  replication_tracking_ = other.replication_tracking_;
+  replication_seq_ = other.replication_seq_;
+  imported_seq_ = other.imported_seq_;
+  replication_dirty_ = std::move(other.replication_dirty_);
+  stale_monitor_ = std::move(other.stale_monitor_);
+  aggregates_ = std::move(other.aggregates_);
+  alarm_engine_ = std::move(other.alarm_engine_);
+  derived_metrics_ = std::move(other.derived_metrics_);
+  lifecycle_events_ = std::move(other.lifecycle_events_);
+  subscriptions_ = std::move(other.subscriptions_);
+  subscribe_requests_ = std::move(other.subscribe_requests_);
+  resync_ = std::move(other.resync_);
+  memory_budget_ = std::move(other.memory_budget_);
+  alias_tables_ = std::move(other.alias_tables_);
+  reconnector_ = std::move(other.reconnector_);
+  state_birth_published_ = other.state_birth_published_;
+  connection_stats_ = other.connection_stats_;
+  duplicates_dropped_ = other.duplicates_dropped_;
   other.is_connected_.store(false, std::memory_order_relaxed);
+  if (reconnecting) {
+    start_reconnect();
+  }
 }
 
-HostApplication& HostApplication::operator=(HostApplication&& other) noexcept {
-  if (this != &other) {
-    // Lock all four mutexes with automatic deadlock avoidance
-    std::scoped_lock lock(mutex_, node_states_mutex_, other.mutex_,
-                          other.node_states_mutex_);
+HostApplication& HostApplication::operator=(HostApplication&& other) noexcept {
+  if (this != &other) {
+    // Both reconnect workers run on their own object; join them before moving
+    (void)stop_reconnect();
+    bool reconnecting = other.stop_reconnect();
+
+    // Lock all four mutexes with automatic deadlock avoidance
+    std::scoped_lock lock(mutex_, node_states_mutex_, other.mutex_,
+                          other.node_states_mutex_);
+
+    config_ = std::move(other.config_);
+    client_ = std::move(other.client_);
+    is_connected_.store(other.is_connected_.load(std::memory_order_relaxed),
+                        std::memory_order_relaxed);
+    node_states_ = std::move(other.node_states_);
+    sinks_ = std::move(other.sinks_);
+    shm_ring_ = std::move(other.shm_ring_);
+    command_tracker_ = std::move(other.command_tracker_);
+    replication_tracking_ = other.replication_tracking_;
+    replication_seq_ = other.replication_seq_;
+    imported_seq_ = other.imported_seq_;
+    replication_dirty_ = std::move(other.replication_dirty_);
+    stale_monitor_ = std::move(other.stale_monitor_);
+    aggregates_ = std::move(other.aggregates_);
+    alarm_engine_ = std::move(other.alarm_engine_);
+    derived_metrics_ = std::move(other.derived_metrics_);
+    lifecycle_events_ = std::move(other.lifecycle_events_);
+    subscriptions_ = std::move(other.subscriptions_);
+    subscribe_requests_ = std::move(other.subscribe_requests_);
+    resync_ = std::move(other.resync_);
+    memory_budget_ = std::move(other.memory_budget_);
+    alias_tables_ = std::move(other.alias_tables_);
+    reconnector_ = std::move(other.reconnector_);
+    state_birth_published_ = other.state_birth_published_;
+    ssl_opts_ = other.ssl_opts_;
+    connection_stats_ = other.connection_stats_;
+    duplicates_dropped_ = other.duplicates_dropped_;
+    other.is_connected_.store(false, std::memory_order_relaxed);
+    if (reconnecting) {
+      start_reconnect();
+    }
+  }
+  return *this;
+}
+
+void HostApplication::set_credentials(std::optional<std::string> username,
+                                      std::optional<std::string> password) {
+  std::scoped_lock lock(mutex_);
+  config_.username = std::move(username);
+  config_.password = std::move(password);
+}
+
+void HostApplication::set_tls(std::optional<TlsOptions> tls) {
+  std::scoped_lock lock(mutex_);
+  config_.tls = std::move(tls);
+}
+
+void HostApplication::set_message_callback(MessageCallback callback) {
+  std::scoped_lock lock(mutex_);
+  config_.message_callback = std::move(callback);
+}
+
+void HostApplication::set_log_callback(LogCallback callback) {
+  std::scoped_lock lock(mutex_);
+  config_.log_callback = std::move(callback);
+}
+
+stdx::expected<void, std::string>
+HostApplication::add_sink(std::shared_ptr<Sink> sink, SinkOptions options) {
+  std::scoped_lock lock(mutex_);
+  if (client_) {
+    return stdx::unexpected("Sinks must be added before connect()");
+  }
+  sinks_.push_back(
+      std::make_unique<SinkPipeline>(std::move(sink), options, config_.log_callback));
+  return {};
+}
+
+void HostApplication::set_shm_ring(std::shared_ptr<ShmRingWriter> ring) {
+  std::scoped_lock lock(mutex_, node_states_mutex_);
+  shm_ring_ = std::move(ring);
+}
+
+HostApplication::ConnectionStats HostApplication::get_connection_stats() const {
+  std::scoped_lock lock(mutex_);
+  return connection_stats_;
+}
+
+uint64_t HostApplication::get_duplicates_dropped() const {
+  std::scoped_lock lock(node_states_mutex_);
+  return duplicates_dropped_;
+}
+
+void HostApplication::enable_memory_budget(size_t budget_bytes) {
+  std::scoped_lock lock(node_states_mutex_);
+  memory_budget_ = std::make_unique<NodeStateBudget>(budget_bytes);
+  for (const auto& [key, state] : node_states_) {
+    account_node_locked(key, state);
+  }
+}
+
+NodeMemoryStats HostApplication::get_memory_stats() const {
+  std::scoped_lock lock(node_states_mutex_);
+  return memory_budget_ ? memory_budget_->stats() : NodeMemoryStats{};
+}
+
+AliasTableStats HostApplication::get_alias_table_stats() const {
+  std::scoped_lock lock(node_states_mutex_);
+  return alias_tables_.stats();
+}
+
+void HostApplication::account_memory_locked(const Topic& topic) {
+  // Data and commands never resize a node that is already accounted
+  switch (topic.message_type) {
+  case MessageType::NDATA:
+  case MessageType::DDATA:
+  case MessageType::NCMD:
+  case MessageType::DCMD:
+  case MessageType::STATE:
+    if (memory_budget_->contains(topic.group_id, topic.edge_node_id)) {
+      return;
+    }
+    break;
+  case MessageType::NBIRTH:
+  case MessageType::NDEATH:
+  case MessageType::DBIRTH:
+  case MessageType::DDEATH:
+    break;
+  }
+  auto it = node_states_.find(detail::NodeKeyView{topic.group_id, topic.edge_node_id});
+  if (it != node_states_.end()) {
+    account_node_locked(it->first, it->second);
+  }
+}
+
+void HostApplication::account_node_locked(const NodeKey& key, const NodeState& state) {
+  using Residency = NodeStateBudget::Residency;
+  bool heavy = state.alias_map || !state.devices.empty();
+  memory_budget_->set_shared_bytes(alias_tables_.bytes());
+  memory_budget_->update(key.group_id, key.edge_node_id,
+                         node_state_bytes(key.group_id, key.edge_node_id, state),
+                         state.is_online ? Residency::Online
+                         : heavy         ? Residency::Offline
+                                         : Residency::Tombstone);
+
+  while (const auto* victim = memory_budget_->victim()) {
+    auto it =
+        node_states_.find(detail::NodeKeyView{victim->group_id, victim->edge_node_id});
+    if (it == node_states_.end()) {
+      memory_budget_->erase(victim->group_id, victim->edge_node_id);
+      continue;
+    }
+    // Keep the scalars; the next NBIRTH rebuilds the rest
+    auto& evicted = it->second;
+    forget_node_locked(it->first.group_id, it->first.edge_node_id, evicted);
+    evicted.alias_map.reset();
+    evicted.devices = decltype(evicted.devices){};
+    evicted.birth_received = false;
+    evicted.seq_window.clear();
+    evicted.evicted = true;
+    if (replication_tracking_) {
+      replication_dirty_[it->first] = true;
+    }
+    memory_budget_->set_shared_bytes(alias_tables_.bytes());
+    memory_budget_->update(it->first.group_id, it->first.edge_node_id,
+                           node_state_bytes(it->first.group_id, it->first.edge_node_id,
+                                            evicted),
+                           Residency::Tombstone);
+  }
+}
+
+void HostApplication::forget_node_locked(std::string_view group_id,
+                                         std::string_view edge_node_id,
+                                         const NodeState& state) {
+  // As after an NDEATH, except that nothing is emitted: the node is already offline
+  if (aggregates_) {
+    retract_aggregates_locked(group_id, edge_node_id, "", state);
+  }
+  if (alarm_engine_) {
+    alarm_engine_->forget(group_id, edge_node_id);
+  }
+  if (derived_metrics_) {
+    derived_metrics_->forget(group_id, edge_node_id);
+  }
+  if (stale_monitor_) {
+    stale_monitor_->remove(group_id, edge_node_id, "");
+    for (const auto& [device_id, device] : state.devices) {
+      stale_monitor_->remove(group_id, edge_node_id, device_id);
+    }
+  }
+  if (resync_) {
+    resync_->forget(group_id, edge_node_id);
+  }
+}
+
+stdx::expected<void, std::string>
+HostApplication::enable_command_tracking(CommandTracker::Options options) {
+  // Set once and never replaced: publish_tracked_command() keeps using the
+  // tracker after releasing the lock
+  std::scoped_lock lock(mutex_, node_states_mutex_);
+  if (command_tracker_) {
+    return stdx::unexpected("Command tracking is already enabled");
+  }
+  if (client_) {
+    return stdx::unexpected("Command tracking must be enabled before connect()");
+  }
+  command_tracker_ = std::make_unique<CommandTracker>(options);
+  return {};
+}
+
+CommandLatencyStats HostApplication::get_command_latency() const {
+  std::scoped_lock lock(node_states_mutex_);
+  return command_tracker_ ? command_tracker_->stats() : CommandLatencyStats{};
+}
+
+CommandLatencyStats
+HostApplication::get_command_latency(std::string_view group_id,
+                                     std::string_view edge_node_id) const {
+  std::scoped_lock lock(node_states_mutex_);
+  return command_tracker_ ? command_tracker_->stats(group_id, edge_node_id)
+                          : CommandLatencyStats{};
+}
+
+MetricAggregates::Id HostApplication::add_aggregate(AggregateSpec spec) {
+  std::scoped_lock lock(node_states_mutex_);
+  if (!aggregates_) {
+    aggregates_ = std::make_unique<MetricAggregates>();
+  }
+  return aggregates_->add(std::move(spec));
+}
+
+std::optional<AggregateValue>
+HostApplication::get_aggregate(MetricAggregates::Id id) const {
+  std::scoped_lock lock(node_states_mutex_);
+  return aggregates_ ? aggregates_->value(id) : std::nullopt;
+}
+
+void HostApplication::retract_aggregates_locked(std::string_view group_id,
+                                                std::string_view edge_node_id,
+                                                std::string_view device_id,
+                                                const NodeState& state) {
+  aggregates_->retract(group_id, edge_node_id, device_id);
+  if (device_id.empty()) {
+    for (const auto& [id, device] : state.devices) {
+      aggregates_->retract(group_id, edge_node_id, id);
+    }
+  }
+}
+
+void HostApplication::add_alarm_limits(AlarmLimits limits) {
+  std::scoped_lock lock(node_states_mutex_);
+  if (!alarm_engine_) {
+    alarm_engine_ = std::make_unique<AlarmEngine>();
+  }
+  alarm_engine_->add_limits(std::move(limits));
+}
+
+size_t HostApplication::check_alarms() {
+  std::vector<AlarmEvent> events;
+  {
+    std::scoped_lock lock(node_states_mutex_);
+    if (alarm_engine_) {
+      alarm_engine_->poll(AlarmEngine::Clock::now(), events);
+    }
+  }
+  notify_alarms(events);
+  return events.size();
+}
+
+size_t HostApplication::get_active_alarm_count() const {
+  std::scoped_lock lock(node_states_mutex_);
+  return alarm_engine_ ? alarm_engine_->active() : 0;
+}
+
+stdx::expected<DerivedMetrics::Id, std::string>
+HostApplication::add_derived_metric(DerivedMetricSpec spec) {
+  std::scoped_lock lock(node_states_mutex_);
+  if (!derived_metrics_) {
+    derived_metrics_ = std::make_unique<DerivedMetrics>();
+  }
+  return derived_metrics_->add(std::move(spec));
+}
+
+std::optional<double> HostApplication::get_derived_value(std::string_view group_id,
+                                                         std::string_view edge_node_id,
+                                                         std::string_view name) const {
+  std::scoped_lock lock(node_states_mutex_);
+  return derived_metrics_ ? derived_metrics_->value(group_id, edge_node_id, name)
+                          : std::nullopt;
+}
+
+void HostApplication::notify_derived(const std::vector<DerivedValue>& values) const {
+  if (values.empty() || !config_.message_callback) {
+    return;
+  }
+  // One message's results all belong to its edge node
+  org::eclipse::tahu::protobuf::Payload payload;
+  payload.set_uuid(std::string(DERIVED_PAYLOAD_UUID));
+  payload.set_timestamp(values.front().timestamp);
+  for (const auto& derived : values) {
+    auto* metric = payload.add_metrics();
+    metric->set_name(derived.name);
+    metric->set_timestamp(derived.timestamp);
+    metric->set_datatype(static_cast<uint32_t>(DataType::Double));
+    if (derived.value) {
+      metric->set_double_value(*derived.value);
+    } else {
+      metric->set_is_null(true);
+    }
+  }
+  Topic topic{.group_id = values.front().group_id,
+              .message_type = MessageType::NDATA,
+              .edge_node_id = values.front().edge_node_id,
+              .device_id = ""};
+  try {
+    config_.message_callback(topic, payload);
+  } catch (...) {
+  }
+}
+
+void HostApplication::notify_alarms(const std::vector<AlarmEvent>& events) const {
+  if (!config_.alarm_callback) {
+    return;
+  }
+  for (const auto& event : events) {
+    try {
+      config_.alarm_callback(event);
+    } catch (...) {
+    }
+  }
+}
+
+void HostApplication::update_aggregates_locked(
+    const Topic& topic,
+    const org::eclipse::tahu::protobuf::Payload& payload) {
+  if (topic.message_type != MessageType::NDEATH &&
+      topic.message_type != MessageType::DDEATH) {
+    aggregates_->update(topic, payload, find_alias_map(topic));
+    return;
+  }
+  auto it = node_states_.find(detail::NodeKeyView{topic.group_id, topic.edge_node_id});
+  if (it != node_states_.end()) {
+    retract_aggregates_locked(topic.group_id, topic.edge_node_id, topic.device_id,
+                              it->second);
+  } else {
+    aggregates_->retract(topic.group_id, topic.edge_node_id, topic.device_id);
+  }
+}
+
+void HostApplication::enable_stale_detection(StaleMonitor::Options options) {
+  std::scoped_lock lock(node_states_mutex_);
+  stale_monitor_ = std::make_unique<StaleMonitor>(options);
+}
+
+size_t HostApplication::check_stale() {
+  std::vector<OfflineEvent> events;
+  {
+    std::scoped_lock lock(node_states_mutex_);
+    if (stale_monitor_) {
+      expire_stale_locked(StaleMonitor::Clock::now(), events);
+    }
+  }
+  notify_offline(events);
+  return events.size();
+}
+
+void HostApplication::touch_stale_locked(const Topic& topic,
+                                         StaleMonitor::Clock::time_point now) {
+  auto it = node_states_.find(detail::NodeKeyView{topic.group_id, topic.edge_node_id});
+  if (it == node_states_.end()) {
+    return; // Sequence validation is off
+  }
+  auto& state = it->second;
+
+  switch (topic.message_type) {
+  case MessageType::NDEATH:
+    stale_monitor_->remove(topic.group_id, topic.edge_node_id, "");
+    for (const auto& [device_id, device] : state.devices) {
+      stale_monitor_->remove(topic.group_id, topic.edge_node_id, device_id);
+    }
+    return;
+  case MessageType::DDEATH:
+    stale_monitor_->remove(topic.group_id, topic.edge_node_id, topic.device_id);
+    return;
+  case MessageType::NBIRTH:
+  case MessageType::NDATA:
+  case MessageType::DBIRTH:
+  case MessageType::DDATA:
+    break;
+  case MessageType::NCMD:
+  case MessageType::DCMD:
+  case MessageType::STATE:
+    return;
+  }
+
+  // Any message from a node shows it is alive, including one timed out earlier
+  stale_monitor_->touch(topic.group_id, topic.edge_node_id, "", now);
+  if (state.offline_reason == OfflineReason::Timeout) {
+    state.is_online = true;
+    state.offline_reason = OfflineReason::None;
+    if (aggregates_) {
+      aggregates_->resume(topic.group_id, topic.edge_node_id, "");
+    }
+    record_lifecycle_locked(LifecycleEventType::Resumed, topic.group_id,
+                            topic.edge_node_id, "");
+    log(LogLevel::INFO, std::format("Node {}/{} resumed publishing", topic.group_id,
+                                    topic.edge_node_id));
+  }
+
+  if (topic.device_id.empty()) {
+    return;
+  }
+  auto device_it = state.devices.find(topic.device_id);
+  if (device_it == state.devices.end()) {
+    return;
+  }
+  auto& device = device_it->second;
+  stale_monitor_->touch(topic.group_id, topic.edge_node_id, topic.device_id, now);
+  if (device.offline_reason == OfflineReason::Timeout) {
+    device.is_online = true;
+    device.metrics_stale = false;
+    device.offline_reason = OfflineReason::None;
+    if (aggregates_) {
+      aggregates_->resume(topic.group_id, topic.edge_node_id, topic.device_id);
+    }
+    record_lifecycle_locked(LifecycleEventType::Resumed, topic.group_id,
+                            topic.edge_node_id, topic.device_id);
+  }
+}
+
+void HostApplication::expire_stale_locked(StaleMonitor::Clock::time_point now,
+                                          std::vector<OfflineEvent>& events) {
+  stale_expired_.clear();
+  if (stale_monitor_->expire(now, stale_expired_) == 0) {
+    return;
+  }
+
+  for (const auto& expired : stale_expired_) {
+    auto it =
+        node_states_.find(detail::NodeKeyView{expired.group_id, expired.edge_node_id});
+    if (it == node_states_.end()) {
+      continue;
+    }
+    auto& state = it->second;
+    Topic topic{.group_id = expired.group_id,
+                .message_type = MessageType::DDEATH,
+                .edge_node_id = expired.edge_node_id,
+                .device_id = expired.device_id};
+
+    if (expired.device_id.empty()) {
+      if (!state.is_online) {
+        continue;
+      }
+      state.is_online = false;
+      state.offline_reason = OfflineReason::Timeout;
+      events.push_back({expired.group_id, expired.edge_node_id, "",
+                        OfflineReason::Timeout});
+      record_lifecycle_locked(LifecycleEventType::Stale, expired.group_id,
+                              expired.edge_node_id, "");
+      // Kept for resume: the next DATA may only carry the metrics that changed
+      if (aggregates_) {
+        aggregates_->suspend(expired.group_id, expired.edge_node_id, "");
+      }
+      // Devices cannot outlive their node
+      for (auto& [device_id, device] : state.devices) {
+        stale_monitor_->remove(expired.group_id, expired.edge_node_id, device_id);
+        if (device.is_online) {
+          device.is_online = false;
+          device.metrics_stale = true;
+          device.offline_reason = OfflineReason::Timeout;
+          if (aggregates_) {
+            aggregates_->suspend(expired.group_id, expired.edge_node_id, device_id);
+          }
+        }
+      }
+      log(LogLevel::WARN,
+          std::format("Node {}/{} silent for {} ms, marked offline", expired.group_id,
+                      expired.edge_node_id,
+                      stale_monitor_->options().node_timeout.count()));
+      if (memory_budget_) {
+        account_node_locked(it->first, state);
+      }
+    } else {
+      auto device_it = state.devices.find(expired.device_id);
+      if (device_it == state.devices.end() || !device_it->second.is_online) {
+        continue;
+      }
+      auto& device = device_it->second;
+      device.is_online = false;
+      device.metrics_stale = true;
+      device.offline_reason = OfflineReason::Timeout;
+      events.push_back({expired.group_id, expired.edge_node_id, expired.device_id,
+                        OfflineReason::Timeout});
+      record_lifecycle_locked(LifecycleEventType::Stale, expired.group_id,
+                              expired.edge_node_id, expired.device_id);
+      if (aggregates_) {
+        aggregates_->suspend(expired.group_id, expired.edge_node_id, expired.device_id);
+      }
+      log(LogLevel::WARN,
+          std::format("Device '{}' on {}/{} silent for {} ms, marked offline",
+                      expired.device_id, expired.group_id, expired.edge_node_id,
+                      stale_monitor_->options().device_timeout.count()));
+    }
+
+    // Online flags and device tables are replicated state
+    if (replication_tracking_) {
+      mark_replication_dirty(topic);
+    }
+  }
+}
+
+void HostApplication::enable_lifecycle_events(LifecycleEventQueue::Options options) {
+  std::scoped_lock lock(node_states_mutex_);
+  lifecycle_events_ = std::make_unique<LifecycleEventQueue>(options);
+}
+
+size_t HostApplication::drain_lifecycle_events(std::vector<LifecycleEvent>& out,
+                                               size_t max_events) {
+  std::scoped_lock lock(node_states_mutex_);
+  return lifecycle_events_ ? lifecycle_events_->drain(out, max_events) : 0;
+}
+
+uint64_t HostApplication::get_lifecycle_events_dropped() const {
+  std::scoped_lock lock(node_states_mutex_);
+  return lifecycle_events_ ? lifecycle_events_->dropped() : 0;
+}
+
+void HostApplication::enable_auto_reconnect(ReconnectOptions options) {
+  stop_reconnect();
+  {
+    std::scoped_lock lock(node_states_mutex_);
+    resync_ = std::make_unique<ResyncTracker>(options.resync);
+  }
+  // The Reconnector lives as long as this object: the Paho thread and connect()
+  // may use it concurrently, so only its fields change, under its mutex. wanted and
+  // lost are tracked from construction, so a drop before this call is picked up.
+  {
+    std::scoped_lock lock(reconnector_->mutex);
+    reconnector_->options = options;
+    reconnector_->failures = 0;
+  }
+  start_reconnect();
+}
+
+ResyncStats HostApplication::get_resync_stats() const {
+  std::scoped_lock lock(node_states_mutex_);
+  return resync_ ? resync_->stats() : ResyncStats{};
+}
+
+void HostApplication::start_reconnect() {
+  {
+    std::scoped_lock lock(reconnector_->mutex);
+    reconnector_->stopping = false;
+  }
+  reconnector_->thread = std::thread([this] { run_reconnect(); });
+}
+
+bool HostApplication::stop_reconnect() {
+  if (!reconnector_ || !reconnector_->thread.joinable()) {
+    return false;
+  }
+  {
+    std::scoped_lock lock(reconnector_->mutex);
+    reconnector_->stopping = true;
+  }
+  reconnector_->cv.notify_all();
+  reconnector_->thread.join();
+  return true;
+}
+
+void HostApplication::run_reconnect() {
+  auto& reconnector = *reconnector_;
+  const auto& options = reconnector.options;
+  std::unique_lock lock(reconnector.mutex);
+  while (!reconnector.stopping) {
+    if (!reconnector.lost) {
+      // Connected (or not wanted): pace the rebirth requests
+      lock.unlock();
+      send_rebirths();
+      lock.lock();
+      reconnector.cv.wait_for(lock, REBIRTH_POLL_INTERVAL, [&reconnector] {
+        return reconnector.stopping || reconnector.lost;
+      });
+      continue;
+    }
+
+    auto exponent = std::min<uint32_t>(reconnector.failures, 20);
+    auto delay = std::min(options.max_delay, options.min_delay * (1u << exponent));
+    auto jittered =
+        std::chrono::duration_cast<std::chrono::milliseconds>(delay * jitter());
+    if (reconnector.cv.wait_for(lock, jittered, [&reconnector] {
+          return reconnector.stopping || !reconnector.lost;
+        })) {
+      continue;
+    }
+
+    lock.unlock();
+    std::unique_lock connecting(connect_mutex_);
+    lock.lock();
+    if (reconnector.stopping || !reconnector.lost) {
+      continue; // connect() ran while this attempt waited for it
+    }
+    lock.unlock();
+    auto result = open_connection();
+    connecting.unlock();
+    bool republish = false;
+    if (result) {
+      std::scoped_lock state_lock(mutex_);
+      connection_stats_.reconnects++;
+      republish = options.republish_state && state_birth_published_;
+    }
+    lock.lock();
+
+    if (!result) {
+      reconnector.failures++;
+      lock.unlock();
+      log(LogLevel::WARN, std::format("Reconnect failed: {}", result.error()));
+      lock.lock();
+      continue;
+    }
+    reconnector.failures = 0;
+    bool wanted = reconnector.wanted;
+    reconnector.lost = false;
+    lock.unlock();
+
+    if (!wanted) {
+      (void)disconnect(); // disconnect() was called while reconnecting
+    } else {
+      log(LogLevel::INFO, "Reconnected");
+      if (republish) {
+        auto now = std::chrono::system_clock::now().time_since_epoch();
+        auto timestamp = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(now).count());
+        if (auto state = publish_state_birth(timestamp); !state) {
+          log(LogLevel::WARN,
+              std::format("Failed to republish STATE birth: {}", state.error()));
+        }
+      }
+    }
+    lock.lock();
+  }
+}
+
+void HostApplication::send_rebirths() {
+  if (!is_connected_.load(std::memory_order_relaxed)) {
+    return;
+  }
+  std::vector<ResyncTracker::Request> requests;
+  {
+    std::scoped_lock lock(node_states_mutex_);
+    if (!resync_ || resync_->size() == 0) {
+      return;
+    }
+    resync_->poll(requests);
+  }
+  for (const auto& request : requests) {
+    PayloadBuilder cmd;
+    cmd.add_metric("Node Control/Rebirth", true);
+    auto result = publish_node_command(request.group_id, request.edge_node_id, cmd);
+    if (!result) {
+      log(LogLevel::WARN, std::format("Failed to request rebirth from {}/{}: {}",
+                                      request.group_id, request.edge_node_id,
+                                      result.error()));
+    } else {
+      log(LogLevel::INFO, std::format("Requested rebirth from {}/{} (seq gap after "
+                                      "reconnect)",
+                                      request.group_id, request.edge_node_id));
+    }
+  }
+}
+
+void HostApplication::check_resync_locked(
+    const Topic& topic,
+    const org::eclipse::tahu::protobuf::Payload& payload) {
+  switch (topic.message_type) {
+  case MessageType::NBIRTH:
+  case MessageType::NDEATH:
+    resync_->confirm(topic.group_id, topic.edge_node_id);
+    return;
+  case MessageType::NDATA:
+  case MessageType::DBIRTH:
+  case MessageType::DDATA:
+  case MessageType::DDEATH:
+    break;
+  default:
+    return;
+  }
+  if (!resync_->pending(topic.group_id, topic.edge_node_id) || !payload.has_seq()) {
+    return;
+  }
+  auto it = node_states_.find(detail::NodeKeyView{topic.group_id, topic.edge_node_id});
+  if (it != node_states_.end() &&
+      payload.seq() == (it->second.last_seq + 1) % SEQ_NUMBER_MAX) {
+    resync_->confirm(topic.group_id, topic.edge_node_id);
+  } else {
+    resync_->broken(topic.group_id, topic.edge_node_id);
+  }
+}
+
+void HostApplication::record_lifecycle_locked(LifecycleEventType type,
+                                              std::string_view group_id,
+                                              std::string_view edge_node_id,
+                                              std::string_view device_id,
+                                              uint64_t expected_seq,
+                                              uint64_t received_seq) {
+  if (!lifecycle_events_) {
+    return;
+  }
+  auto now = std::chrono::system_clock::now().time_since_epoch();
+  lifecycle_events_->push(
+      {.type = type,
+       .group_id = std::string(group_id),
+       .edge_node_id = std::string(edge_node_id),
+       .device_id = std::string(device_id),
+       .timestamp = static_cast<uint64_t>(
+           std::chrono::duration_cast<std::chrono::milliseconds>(now).count()),
+       .count = 1,
+       .expected_seq = expected_seq,
+       .received_seq = received_seq});
+}
+
+void HostApplication::notify_offline(const std::vector<OfflineEvent>& events) const {
+  if (!config_.offline_callback) {
+    return;
+  }
+  for (const auto& event : events) {
+    try {
+      config_.offline_callback(event.group_id, event.edge_node_id, event.device_id,
+                               event.reason);
+    } catch (...) {
+    }
+  }
+}
+
+std::vector<uint8_t> HostApplication::export_state_snapshot() {
+  std::scoped_lock lock(node_states_mutex_);
+  replication_tracking_ = true;
+  replication_seq_ = 0;
+  replication_dirty_.clear();
+
+  std::vector<uint8_t> out;
+  put_header(out, REPLICATION_SNAPSHOT, replication_seq_, node_states_.size());
+  for (const auto& [key, state] : node_states_) {
+    put_node(out, key.group_id, key.edge_node_id, state, true);
+  }
+  return out;
+}
+
+stdx::expected<std::vector<uint8_t>, std::string> HostApplication::export_state_delta() {
+  std::scoped_lock lock(node_states_mutex_);
+  if (!replication_tracking_) {
+    return stdx::unexpected(
+        "export_state_snapshot() must be called before export_state_delta()");
+  }
+  if (replication_dirty_.empty()) {
+    return std::vector<uint8_t>{};
+  }
+
+  std::vector<uint8_t> body;
+  uint64_t count = 0;
+  for (const auto& [key, tables] : replication_dirty_) {
+    auto it = node_states_.find(key);
+    if (it != node_states_.end()) {
+      put_node(body, key.group_id, key.edge_node_id, it->second, tables);
+    } else {
+      put_removed(body, key.group_id, key.edge_node_id);
+    }
+    count++;
+  }
+  replication_dirty_.clear();
+
+  std::vector<uint8_t> out;
+  put_header(out, REPLICATION_DELTA, ++replication_seq_, count);
+  out.insert(out.end(), body.begin(), body.end());
+  return out;
+}
+
+stdx::expected<void, std::string>
+HostApplication::import_state(std::span<const uint8_t> frame) {
+  struct ImportedNode {
+    NodeKey key;
+    NodeState state;
+    bool tables{false};
+    bool removed{false};
+  };
+
+  // Decode everything first so a bad frame leaves the current state untouched
+  StateReader reader(frame);
+  std::array<uint8_t, 4> magic{};
+  for (auto& b : magic) {
+    if (!reader.byte(b)) {
+      return stdx::unexpected("Not a state replication frame");
+    }
+  }
+  uint8_t version = 0;
+  uint8_t kind = 0;
+  uint64_t seq = 0;
+  uint64_t count = 0;
+  if (magic != REPLICATION_MAGIC || !reader.byte(version)) {
+    return stdx::unexpected("Not a state replication frame");
+  }
+  if (version != REPLICATION_VERSION) {
+    return stdx::unexpected(
+        std::format("Unsupported state replication version {}", version));
+  }
+  if (!reader.byte(kind) || (kind != REPLICATION_SNAPSHOT && kind != REPLICATION_DELTA) ||
+      !reader.varint(seq) || !reader.varint(count) ||
+      count > reader.remaining() / MIN_ENCODED_NODE) {
+    return stdx::unexpected("Malformed state replication frame header");
+  }
+
+  std::vector<ImportedNode> nodes(count);
+  for (auto& node : nodes) {
+    uint8_t flags = 0;
+    if (!reader.string(node.key.group_id) || !reader.string(node.key.edge_node_id) ||
+        !reader.byte(flags) || !reader.varint(node.state.last_seq) ||
+        !reader.varint(node.state.bd_seq) || !reader.varint(node.state.birth_timestamp)) {
+      return stdx::unexpected("Truncated state replication frame");
+    }
+    node.state.is_online = (flags & STATE_ONLINE) != 0;
+    node.state.birth_received = (flags & STATE_BIRTH_RECEIVED) != 0;
+    node.tables = (flags & STATE_TABLES) != 0;
+    node.removed = (flags & STATE_REMOVED) != 0;
+    if (node.removed && kind != REPLICATION_DELTA) {
+      return stdx::unexpected("Node removal in a state replication snapshot");
+    }
+    if (node.removed || !node.tables) {
+      continue;
+    }
 
-    config_ = std::move(other.config_);
-    client_ = std::move(other.client_);
-    is_connected_.store(other.is_connected_.load(std::memory_order_relaxed),
-                        std::memory_order_relaxed);
-    node_states_ = std::move(other.node_states_);
-    ssl_opts_ = other.ssl_opts_;
-    other.is_connected_.store(false, std::memory_order_relaxed);
+    uint64_t device_count = 0;
+    if (!reader.aliases(node.state.alias_map) || !reader.varint(device_count) ||
+        device_count > reader.remaining()) {
+      return stdx::unexpected("Truncated state replication frame");
+    }
+    for (uint64_t i = 0; i < device_count; ++i) {
+      std::string device_id;
+      DeviceState device;
+      uint8_t device_flags = 0;
+      if (!reader.string(device_id) || !reader.byte(device_flags) ||
+          !reader.varint(device.last_seq) || !reader.varint(device.offline_timestamp) ||
+          !reader.aliases(device.alias_map)) {
+        return stdx::unexpected("Truncated state replication frame");
+      }
+      device.is_online = (device_flags & STATE_ONLINE) != 0;
+      device.birth_received = (device_flags & STATE_BIRTH_RECEIVED) != 0;
+      device.metrics_stale = (device_flags & STATE_METRICS_STALE) != 0;
+      node.state.devices.insert_or_assign(std::move(device_id), std::move(device));
+    }
+  }
+  if (reader.remaining() != 0) {
+    return stdx::unexpected("Trailing bytes in state replication frame");
   }
-  return *this;
-}
 
-void HostApplication::set_credentials(std::optional<std::string> username,
-                                      std::optional<std::string> password) {
-  std::scoped_lock lock(mutex_);
-  config_.username = std::move(username);
-  config_.password = std::move(password);
-}
+  std::scoped_lock lock(node_states_mutex_);
+  // Before the current state is dropped, so tables it already shares are reused
+  for (auto& node : nodes) {
+    node.state.alias_map = alias_tables_.intern(std::move(node.state.alias_map));
+    for (auto& [device_id, device] : node.state.devices) {
+      device.alias_map = alias_tables_.intern(std::move(device.alias_map));
+    }
+  }
+  if (kind == REPLICATION_DELTA) {
+    if (!imported_seq_) {
+      return stdx::unexpected("State delta received before a snapshot");
+    }
+    if (seq != *imported_seq_ + 1) {
+      return stdx::unexpected(std::format(
+          "State replication gap (expected delta {}, got {})", *imported_seq_ + 1, seq));
+    }
+  } else {
+    node_states_.clear();
+  }
 
-void HostApplication::set_tls(std::optional<TlsOptions> tls) {
-  std::scoped_lock lock(mutex_);
-  config_.tls = std::move(tls);
+  for (auto& node : nodes) {
+    if (node.removed) {
+      if (auto it = node_states_.find(node.key); it != node_states_.end()) {
+        node_states_.erase(it);
+      }
+      continue;
+    }
+    if (node.tables) {
+      node_states_.insert_or_assign(std::move(node.key), std::move(node.state));
+      continue;
+    }
+    // Seq-only update: keep the alias tables and devices from earlier frames. A
+    // node the standby never got a full record for has none to keep; skip it
+    // rather than invent one
+    auto it = node_states_.find(node.key);
+    if (it == node_states_.end()) {
+      continue;
+    }
+    auto& state = it->second;
+    state.is_online = node.state.is_online;
+    state.birth_received = node.state.birth_received;
+    state.last_seq = node.state.last_seq;
+    state.bd_seq = node.state.bd_seq;
+    state.birth_timestamp = node.state.birth_timestamp;
+  }
+  if (memory_budget_) {
+    memory_budget_->clear();
+    for (const auto& [key, state] : node_states_) {
+      account_node_locked(key, state);
+    }
+  }
+  imported_seq_ = seq;
+  return {};
 }
 
-void HostApplication::set_message_callback(MessageCallback callback) {
+std::vector<SinkStats> HostApplication::get_sink_stats() const {
   std::scoped_lock lock(mutex_);
-  config_.message_callback = std::move(callback);
+  std::vector<SinkStats> stats;
+  stats.reserve(sinks_.size());
+  for (const auto& sink : sinks_) {
+    stats.push_back(sink->stats());
+  }
+  return stats;
 }
 
-void HostApplication::set_log_callback(LogCallback callback) {
-  std::scoped_lock lock(mutex_);
-  config_.log_callback = std::move(callback);
+stdx::expected<void, std::string> HostApplication::connect() {
+  std::scoped_lock connecting(connect_mutex_);
+  if (reconnector_) {
+    std::scoped_lock lock(reconnector_->mutex);
+    reconnector_->wanted = true;
+    reconnector_->lost = false; // A worker waiting for connect_mutex_ stands down
+  }
+  return open_connection();
 }
 
-stdx::expected<void, std::string> HostApplication::connect() {
+stdx::expected<void, std::string> HostApplication::open_connection() {
   // Phase 1: Prepare client and initiate async connect under lock.
   // Lock is released before blocking waits to avoid holding mutex_
   // while Paho callbacks (which may call log()) could fire.
   std::promise<void> connect_promise;
   auto connect_future = connect_promise.get_future();
   MQTTAsync client_handle = nullptr;
+  std::chrono::steady_clock::time_point connect_start;
 
   {
     std::scoped_lock lock(mutex_);
@@ -131,7 +1301,7 @@ stdx::expected<void, std::string> HostApplication::connect() {
     client_ = MQTTAsyncHandle(raw_client);
 
     rc = MQTTAsync_setCallbacks(client_.get(), this, on_connection_lost,
-                                on_message_arrived, nullptr);
+                                    on_message_arrived, nullptr);
     if (rc != MQTTASYNC_SUCCESS) {
       return stdx::unexpected(std::format("Failed to set callbacks: {}", rc));
     }
@@ -166,6 +1336,7 @@ stdx::expected<void, std::string> HostApplication::connect() {
     conn_opts.onSuccess = on_connect_success;
     conn_opts.onFailure = on_connect_failure;
 
+    connect_start = std::chrono::steady_clock::now();
     rc = MQTTAsync_connect(client_.get(), &conn_opts);
     if (rc != MQTTASYNC_SUCCESS) {
       MQTTAsync_setCallbacks(client_.get(), nullptr, nullptr, nullptr, nullptr);
@@ -191,16 +1362,46 @@ stdx::expected<void, std::string> HostApplication::connect() {
     MQTTAsync_setCallbacks(client_handle, nullptr, nullptr, nullptr, nullptr);
     return stdx::unexpected(e.what());
   }
+  auto connect_time = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - connect_start);
 
   // Phase 3: Update connected state atomically
   if (!MQTTAsync_isConnected(client_handle)) {
     return stdx::unexpected("Connection lost during setup");
   }
+  {
+    std::scoped_lock lock(mutex_);
+    connection_stats_.connects++;
+    connection_stats_.last_connect_time = connect_time;
+    connection_stats_.max_connect_time =
+        std::max(connection_stats_.max_connect_time, connect_time);
+    connection_stats_.total_connect_time += connect_time;
+  }
   is_connected_.store(true, std::memory_order_relaxed);
+
+  // Restore the subscriptions of the previous session (none on first connect)
+  stdx::expected<void, std::string> restored;
+  {
+    std::scoped_lock lock(mutex_);
+    subscriptions_.reset();
+    subscribe_requests_.clear();
+    restored = sync_subscriptions_locked();
+  }
+  if (!restored) {
+    log(LogLevel::WARN, restored.error());
+  }
   return {};
 }
 
 stdx::expected<void, std::string> HostApplication::disconnect() {
+  // Waits out a reconnect attempt, whose client it would otherwise race
+  std::scoped_lock connecting(connect_mutex_);
+  if (reconnector_) {
+    std::scoped_lock lock(reconnector_->mutex);
+    reconnector_->wanted = false;
+    reconnector_->lost = false;
+  }
+
   // Phase 1: Check state under lock
   MQTTAsync client_handle = nullptr;
   {
@@ -253,11 +1454,14 @@ HostApplication::publish_state_birth(uint64_t timestamp) {
       return stdx::unexpected("Not connected");
     }
 
-    std::string json_payload =
-        std::format("{{\"online\":true,\"timestamp\":{}}}", timestamp);
+    state_birth_published_ = true;
 
-    topic = std::format("{}/STATE/{}", NAMESPACE, config_.host_id);
-    payload_data.assign(json_payload.begin(), json_payload.end());
+    Topic state_topic{.group_id = "",
+                      .message_type = MessageType::STATE,
+                      .edge_node_id = config_.host_id,
+                      .device_id = ""};
+    topic = state_topic.to_string();
+    payload_data = state_payload(true, timestamp);
     qos = config_.qos;
   }
 
@@ -277,11 +1481,14 @@ HostApplication::publish_state_death(uint64_t timestamp) {
       return stdx::unexpected("Not connected");
     }
 
-    std::string json_payload =
-        std::format("{{\"online\":false,\"timestamp\":{}}}", timestamp);
+    state_birth_published_ = false;
 
-    topic = std::format("{}/STATE/{}", NAMESPACE, config_.host_id);
-    payload_data.assign(json_payload.begin(), json_payload.end());
+    Topic state_topic{.group_id = "",
+                      .message_type = MessageType::STATE,
+                      .edge_node_id = config_.host_id,
+                      .device_id = ""};
+    topic = state_topic.to_string();
+    payload_data = state_payload(false, timestamp);
     qos = config_.qos;
   }
 
@@ -292,25 +1499,11 @@ stdx::expected<void, std::string>
 HostApplication::publish_node_command(std::string_view group_id,
                                       std::string_view target_edge_node_id,
                                       PayloadBuilder& payload) {
-  std::string topic_str;
-  std::vector<uint8_t> payload_data;
-  {
-    std::scoped_lock lock(mutex_);
-
-    if (!is_connected_) {
-      return stdx::unexpected("Not connected");
-    }
-
-    Topic topic{.group_id = std::string(group_id),
-                .message_type = MessageType::NCMD,
-                .edge_node_id = std::string(target_edge_node_id),
-                .device_id = ""};
-
-    topic_str = topic.to_string();
-    payload_data = payload.build();
-  }
-
-  return publish_command_message(topic_str, payload_data);
+  Topic topic{.group_id = std::string(group_id),
+              .message_type = MessageType::NCMD,
+              .edge_node_id = std::string(target_edge_node_id),
+              .device_id = ""};
+  return publish_tracked_command(topic, payload);
 }
 
 stdx::expected<void, std::string>
@@ -318,6 +1511,15 @@ HostApplication::publish_device_command(std::string_view group_id,
                                         std::string_view target_edge_node_id,
                                         std::string_view target_device_id,
                                         PayloadBuilder& payload) {
+  Topic topic{.group_id = std::string(group_id),
+              .message_type = MessageType::DCMD,
+              .edge_node_id = std::string(target_edge_node_id),
+              .device_id = std::string(target_device_id)};
+  return publish_tracked_command(topic, payload);
+}
+
+stdx::expected<void, std::string>
+HostApplication::publish_tracked_command(const Topic& topic, PayloadBuilder& payload) {
   std::string topic_str;
   std::vector<uint8_t> payload_data;
   {
@@ -327,16 +1529,46 @@ HostApplication::publish_device_command(std::string_view group_id,
       return stdx::unexpected("Not connected");
     }
 
-    Topic topic{.group_id = std::string(group_id),
-                .message_type = MessageType::DCMD,
-                .edge_node_id = std::string(target_edge_node_id),
-                .device_id = std::string(target_device_id)};
-
     topic_str = topic.to_string();
     payload_data = payload.build();
   }
 
-  return publish_command_message(topic_str, payload_data);
+  // Written metric names, resolved through the birth aliases for alias-only writes
+  std::vector<std::string> written;
+  CommandTracker* tracker = nullptr;
+  {
+    std::scoped_lock lock(node_states_mutex_);
+    tracker = command_tracker_.get();
+    if (tracker) {
+      const auto* alias_map = find_alias_map(topic);
+      for (const auto& metric : payload.payload().metrics()) {
+        std::string_view name = metric.name();
+        if (!metric.has_name() && metric.has_alias() && alias_map) {
+          auto alias_it = alias_map->find(metric.alias());
+          if (alias_it != alias_map->end()) {
+            name = alias_it->second;
+          }
+        }
+        if (!name.empty() && !name.starts_with("Node Control/") &&
+            !name.starts_with("Device Control/")) {
+          written.emplace_back(name);
+        }
+      }
+    }
+  }
+
+  // Recorded before sending so that a fast answer cannot arrive untracked
+  uint64_t command = 0;
+  if (!written.empty()) {
+    command = tracker->record_command(topic.group_id, topic.edge_node_id,
+                                      topic.device_id, written);
+  }
+  auto result = publish_command_message(topic_str, payload_data);
+  if (!result && !written.empty()) {
+    tracker->cancel_command(topic.group_id, topic.edge_node_id, topic.device_id,
+                            written, command);
+  }
+  return result;
 }
 
 stdx::expected<void, std::string>
@@ -413,98 +1645,203 @@ HostApplication::publish_command_message(std::string_view topic,
 }
 
 stdx::expected<void, std::string> HostApplication::subscribe_all_groups() {
-  std::scoped_lock lock(mutex_);
-
-  if (!client_) {
-    return stdx::unexpected("Not connected");
-  }
-
   std::string topic = std::format("{}/#", NAMESPACE);
-
-  MQTTAsync_responseOptions opts = MQTTAsync_responseOptions_initializer;
-
-  int rc = MQTTAsync_subscribe(client_.get(), topic.c_str(), config_.qos, &opts);
-  if (rc != MQTTASYNC_SUCCESS) {
-    return stdx::unexpected(std::format("Failed to subscribe: {}", rc));
-  }
-
-  return {};
+  return change_subscriptions(std::span(&topic, 1), {});
 }
 
 stdx::expected<void, std::string>
 HostApplication::subscribe_group(std::string_view group_id) {
-  std::scoped_lock lock(mutex_);
-
-  if (!client_) {
-    return stdx::unexpected("Not connected");
-  }
-
   std::string topic = std::format("{}/{}/#", NAMESPACE, group_id);
-
-  MQTTAsync_responseOptions opts = MQTTAsync_responseOptions_initializer;
-
-  int rc = MQTTAsync_subscribe(client_.get(), topic.c_str(), config_.qos, &opts);
-  if (rc != MQTTASYNC_SUCCESS) {
-    return stdx::unexpected(std::format("Failed to subscribe: {}", rc));
-  }
-
-  return {};
+  return change_subscriptions(std::span(&topic, 1), {});
 }
 
 stdx::expected<void, std::string>
 HostApplication::subscribe_node(std::string_view group_id,
                                 std::string_view edge_node_id) {
-  std::scoped_lock lock(mutex_);
+  std::string topic = std::format("{}/{}/+/{}/#", NAMESPACE, group_id, edge_node_id);
+  return change_subscriptions(std::span(&topic, 1), {});
+}
 
-  if (!client_) {
-    return stdx::unexpected("Not connected");
+stdx::expected<void, std::string>
+HostApplication::subscribe_nodes(std::string_view group_id,
+                                 std::span<const std::string> edge_node_ids) {
+  std::vector<std::string> topics;
+  topics.reserve(edge_node_ids.size());
+  for (const auto& edge_node_id : edge_node_ids) {
+    topics.push_back(std::format("{}/{}/+/{}/#", NAMESPACE, group_id, edge_node_id));
   }
+  return change_subscriptions(topics, {});
+}
 
-  std::string topic = std::format("{}/{}/+/{}/#", NAMESPACE, group_id, edge_node_id);
+stdx::expected<void, std::string>
+HostApplication::subscribe_state(std::string_view host_id) {
+  std::string topic = std::format("{}/STATE/{}", NAMESPACE, host_id);
+  return change_subscriptions(std::span(&topic, 1), {});
+}
 
-  MQTTAsync_responseOptions opts = MQTTAsync_responseOptions_initializer;
+stdx::expected<void, std::string>
+HostApplication::unsubscribe_group(std::string_view group_id) {
+  std::string topic = std::format("{}/{}/#", NAMESPACE, group_id);
+  return change_subscriptions({}, std::span(&topic, 1));
+}
 
-  int rc = MQTTAsync_subscribe(client_.get(), topic.c_str(), config_.qos, &opts);
-  if (rc != MQTTASYNC_SUCCESS) {
-    return stdx::unexpected(std::format("Failed to subscribe: {}", rc));
-  }
+stdx::expected<void, std::string>
+HostApplication::unsubscribe_node(std::string_view group_id,
+                                  std::string_view edge_node_id) {
+  std::string topic = std::format("{}/{}/+/{}/#", NAMESPACE, group_id, edge_node_id);
+  return change_subscriptions({}, std::span(&topic, 1));
+}
 
+stdx::expected<void, std::string>
+HostApplication::wait_for_subscriptions(std::chrono::milliseconds timeout) {
+  std::unique_lock lock(mutex_);
+  if (!subscriptions_cv_.wait_for(lock, timeout,
+                                  [this] { return subscriptions_.settled(); })) {
+    return stdx::unexpected(std::format("Timed out waiting for {} subscription(s)",
+                                        subscriptions_.stats().pending));
+  }
+  auto failed = subscriptions_.failed_topics();
+  if (!failed.empty()) {
+    return stdx::unexpected(std::format("Broker refused {} subscription(s), first: {}",
+                                        failed.size(), failed.front()));
+  }
   return {};
 }
 
+SubscriptionStats HostApplication::get_subscription_stats() const {
+  std::scoped_lock lock(mutex_);
+  return subscriptions_.stats();
+}
+
 stdx::expected<void, std::string>
-HostApplication::subscribe_state(std::string_view host_id) {
+HostApplication::change_subscriptions(std::span<const std::string> add,
+                                      std::span<const std::string> remove) {
   std::scoped_lock lock(mutex_);
 
   if (!client_) {
     return stdx::unexpected("Not connected");
   }
 
-  std::string topic = std::format("{}/STATE/{}", NAMESPACE, host_id);
+  for (const auto& topic : add) {
+    subscriptions_.add(topic, config_.qos);
+  }
+  for (const auto& topic : remove) {
+    subscriptions_.remove(topic);
+  }
+  return sync_subscriptions_locked();
+}
 
-  MQTTAsync_responseOptions opts = MQTTAsync_responseOptions_initializer;
+stdx::expected<void, std::string> HostApplication::sync_subscriptions_locked() {
+  std::vector<SubscriptionManager::Batch> batches;
+  subscriptions_.plan(batches);
 
-  int rc = MQTTAsync_subscribe(client_.get(), topic.c_str(), config_.qos, &opts);
-  if (rc != MQTTASYNC_SUCCESS) {
-    return stdx::unexpected(std::format("Failed to subscribe: {}", rc));
-  }
+  std::string error;
+  std::vector<char*> topics;
+  for (auto& batch : batches) {
+    topics.clear();
+    for (auto& topic : batch.topics) {
+      topics.push_back(topic.data());
+    }
+    int count = static_cast<int>(topics.size());
 
+    MQTTAsync_responseOptions opts = MQTTAsync_responseOptions_initializer;
+    opts.context = this;
+    opts.onSuccess = on_subscribe_success;
+    opts.onFailure = on_subscribe_failure;
+
+    int rc = batch.unsubscribe
+                 ? MQTTAsync_unsubscribeMany(client_.get(), count, topics.data(), &opts)
+                 : MQTTAsync_subscribeMany(client_.get(), count, topics.data(),
+                                           batch.qos.data(), &opts);
+    if (rc != MQTTASYNC_SUCCESS) {
+      subscriptions_.on_failed(batch.id);
+      if (error.empty()) {
+        error = std::format("Failed to {}: {}",
+                            batch.unsubscribe ? "unsubscribe" : "subscribe", rc);
+      }
+      continue;
+    }
+    subscribe_requests_[opts.token] = {.batch = batch.id,
+                                       .unsubscribe = batch.unsubscribe,
+                                       .count = batch.topics.size()};
+  }
+  if (!error.empty()) {
+    subscriptions_cv_.notify_all();
+    return stdx::unexpected(std::move(error));
+  }
   return {};
 }
 
+void HostApplication::on_subscribe_success(void* context,
+                                           MQTTAsync_successData* response) {
+  auto* host_app = static_cast<HostApplication*>(context);
+  if (!host_app || !response) {
+    return;
+  }
+  stdx::expected<void, std::string> follow_up;
+  {
+    std::scoped_lock lock(host_app->mutex_);
+    auto it = host_app->subscribe_requests_.find(response->token);
+    if (it == host_app->subscribe_requests_.end()) {
+      return;
+    }
+    auto request = it->second;
+    host_app->subscribe_requests_.erase(it);
+    if (request.unsubscribe) {
+      host_app->subscriptions_.on_unsubscribed(request.batch);
+    } else if (request.count == 1) {
+      host_app->subscriptions_.on_subscribed(request.batch,
+                                             std::span(&response->alt.qos, 1));
+    } else {
+      host_app->subscriptions_.on_subscribed(
+          request.batch,
+          std::span<const int>(response->alt.qosList, request.count));
+    }
+    // Changes made while the request was in flight
+    follow_up = host_app->sync_subscriptions_locked();
+  }
+  host_app->subscriptions_cv_.notify_all();
+  if (!follow_up) {
+    host_app->log(LogLevel::WARN, follow_up.error());
+  }
+}
+
+void HostApplication::on_subscribe_failure(void* context,
+                                           MQTTAsync_failureData* response) {
+  auto* host_app = static_cast<HostApplication*>(context);
+  if (!host_app || !response) {
+    return;
+  }
+  {
+    std::scoped_lock lock(host_app->mutex_);
+    auto it = host_app->subscribe_requests_.find(response->token);
+    if (it == host_app->subscribe_requests_.end()) {
+      return;
+    }
+    host_app->subscriptions_.on_failed(it->second.batch);
+    host_app->subscribe_requests_.erase(it);
+  }
+  // No retry here: this also runs while the client is torn down
+  host_app->subscriptions_cv_.notify_all();
+}
+
 std::optional<HostApplication::NodeStateSnapshot>
 HostApplication::get_node_state(std::string_view group_id,
                                 std::string_view edge_node_id) const {
   std::scoped_lock lock(node_states_mutex_);
 
-  auto it = node_states_.find(std::make_pair(group_id, edge_node_id));
+  auto it = node_states_.find(detail::NodeKeyView{group_id, edge_node_id});
   if (it != node_states_.end()) {
     const auto& ns = it->second;
     return NodeStateSnapshot{.is_online = ns.is_online,
                              .last_seq = ns.last_seq,
                              .bd_seq = ns.bd_seq,
                              .birth_timestamp = ns.birth_timestamp,
-                             .birth_received = ns.birth_received};
+                             .birth_received = ns.birth_received,
+                             .offline_reason = ns.offline_reason,
+                             .evicted = ns.evicted,
+                             .memory_bytes = node_state_bytes(
+                                 it->first.group_id, it->first.edge_node_id, ns)};
   }
   return std::nullopt;
 }
@@ -515,7 +1852,7 @@ std::optional<std::string> HostApplication::get_metric_name(std::string_view gro
                                                             uint64_t alias) const {
   std::scoped_lock lock(node_states_mutex_);
 
-  auto it = node_states_.find(std::make_pair(group_id, edge_node_id));
+  auto it = node_states_.find(detail::NodeKeyView{group_id, edge_node_id});
   if (it == node_states_.end()) {
     return std::nullopt;
   }
@@ -528,21 +1865,85 @@ std::optional<std::string> HostApplication::get_metric_name(std::string_view gro
       return std::nullopt;
     }
 
-    const auto& device_state = device_it->second;
-    auto alias_it = device_state.alias_map.find(alias);
-    if (alias_it != device_state.alias_map.end()) {
+    const auto& device_aliases = device_it->second.alias_map;
+    if (!device_aliases) {
+      return std::nullopt;
+    }
+    auto alias_it = device_aliases->find(alias);
+    if (alias_it != device_aliases->end()) {
       return alias_it->second;
     }
     return std::nullopt;
   }
 
-  auto alias_it = node_state.alias_map.find(alias);
-  if (alias_it != node_state.alias_map.end()) {
+  if (!node_state.alias_map) {
+    return std::nullopt;
+  }
+  auto alias_it = node_state.alias_map->find(alias);
+  if (alias_it != node_state.alias_map->end()) {
     return alias_it->second;
   }
   return std::nullopt;
 }
 
+const AliasTable* HostApplication::find_alias_map(const Topic& topic) const {
+  auto it = node_states_.find(detail::NodeKeyView{topic.group_id, topic.edge_node_id});
+  if (it == node_states_.end()) {
+    return nullptr;
+  }
+  if (topic.device_id.empty()) {
+    return it->second.alias_map.get();
+  }
+  auto device_it = it->second.devices.find(topic.device_id);
+  if (device_it == it->second.devices.end()) {
+    return nullptr;
+  }
+  return device_it->second.alias_map.get();
+}
+
+void HostApplication::mark_replication_dirty(const Topic& topic) {
+  bool tables = false;
+  switch (topic.message_type) {
+  case MessageType::NBIRTH:
+  case MessageType::DBIRTH:
+  case MessageType::DDEATH:
+    tables = true;
+    break;
+  case MessageType::NDEATH:
+  case MessageType::NDATA:
+  case MessageType::DDATA:
+    break;
+  case MessageType::NCMD:
+  case MessageType::DCMD:
+  case MessageType::STATE:
+    return;
+  }
+
+  auto it =
+      replication_dirty_.find(detail::NodeKeyView{topic.group_id, topic.edge_node_id});
+  if (it == replication_dirty_.end()) {
+    replication_dirty_.emplace(NodeKey{topic.group_id, topic.edge_node_id}, tables);
+  } else {
+    it->second = it->second || tables;
+  }
+}
+
+std::string_view
+HostApplication::encode_json(const Topic& topic,
+                             const org::eclipse::tahu::protobuf::Payload& payload,
+                             JsonEncoder& encoder) const {
+  std::scoped_lock lock(node_states_mutex_);
+  return encoder.encode(topic, payload, find_alias_map(topic));
+}
+
+stdx::expected<std::string_view, std::string>
+HostApplication::encode_json(const Topic& topic,
+                             std::span<const uint8_t> payload_data,
+                             JsonEncoder& encoder) const {
+  std::scoped_lock lock(node_states_mutex_);
+  return encoder.encode(topic, payload_data, find_alias_map(topic));
+}
+
 void HostApplication::log(LogLevel level, std::string_view message) const noexcept {
   LogCallback cb;
   {
@@ -589,18 +1990,20 @@ bool HostApplication::validate_message(
       return false;
     }
 
+    record_lifecycle_locked(state.birth_received && state.is_online
+                                ? LifecycleEventType::Rebirth
+                                : LifecycleEventType::Online,
+                            topic.group_id, topic.edge_node_id, "");
     state.bd_seq = bd_seq;
     state.last_seq = 0;
+    state.seq_window.reset(0);
     state.is_online = true;
     state.birth_received = true;
     state.birth_timestamp = payload.timestamp();
+    state.offline_reason = OfflineReason::None;
+    state.evicted = false;
 
-    state.alias_map.clear();
-    for (const auto& metric : payload.metrics()) {
-      if (metric.has_alias() && metric.has_name()) {
-        state.alias_map[metric.alias()] = metric.name();
-      }
-    }
+    state.alias_map = alias_tables_.intern(payload);
 
     return true;
   }
@@ -621,6 +2024,10 @@ bool HostApplication::validate_message(
     }
 
     state.is_online = false;
+    state.offline_reason = OfflineReason::Death;
+    state.seq_window.clear();
+    record_lifecycle_locked(LifecycleEventType::Offline, topic.group_id,
+                            topic.edge_node_id, "");
     return true;
   }
 
@@ -638,6 +2045,8 @@ bool HostApplication::validate_message(
         log(LogLevel::WARN,
             std::format("Sequence number gap for {} (got {}, expected {})", node_id, seq,
                         expected_seq));
+        record_lifecycle_locked(LifecycleEventType::SeqGap, topic.group_id,
+                                topic.edge_node_id, "", expected_seq, seq);
       }
 
       state.last_seq = seq;
@@ -662,23 +2071,25 @@ bool HostApplication::validate_message(
             std::format(
                 "Sequence number gap for DBIRTH device '{}' on {} (got {}, expected {})",
                 topic.device_id, node_id, seq, expected_seq));
+        record_lifecycle_locked(LifecycleEventType::SeqGap, topic.group_id,
+                                topic.edge_node_id, "", expected_seq, seq);
       }
 
       state.last_seq = seq;
     }
 
     auto& device_state = state.devices[topic.device_id];
+    record_lifecycle_locked(device_state.birth_received && device_state.is_online
+                                ? LifecycleEventType::Rebirth
+                                : LifecycleEventType::Online,
+                            topic.group_id, topic.edge_node_id, topic.device_id);
     device_state.is_online = true;
     device_state.birth_received = true;
     device_state.metrics_stale = false;
     device_state.offline_timestamp = 0;
+    device_state.offline_reason = OfflineReason::None;
 
-    device_state.alias_map.clear();
-    for (const auto& metric : payload.metrics()) {
-      if (metric.has_alias() && metric.has_name()) {
-        device_state.alias_map[metric.alias()] = metric.name();
-      }
-    }
+    device_state.alias_map = alias_tables_.intern(payload);
 
     return true;
   }
@@ -707,6 +2118,8 @@ bool HostApplication::validate_message(
         log(LogLevel::WARN,
             std::format("Sequence number gap for device '{}' on {} (got {}, expected {})",
                         topic.device_id, node_id, seq, expected_seq));
+        record_lifecycle_locked(LifecycleEventType::SeqGap, topic.group_id,
+                                topic.edge_node_id, "", expected_seq, seq);
       }
 
       state.last_seq = seq;
@@ -723,6 +2136,9 @@ bool HostApplication::validate_message(
         device_it->second.offline_timestamp = payload.timestamp();
       }
       device_it->second.metrics_stale = true;
+      device_it->second.offline_reason = OfflineReason::Death;
+      record_lifecycle_locked(LifecycleEventType::Offline, topic.group_id,
+                              topic.edge_node_id, topic.device_id);
       log(LogLevel::DEBUG, std::format("Device {} offline, metrics stale on {}",
                                        topic.device_id, node_id));
     } else {
@@ -740,6 +2156,40 @@ bool HostApplication::validate_message(
   std::unreachable();
 }
 
+bool HostApplication::is_duplicate(const Topic& topic,
+                                   const MQTTAsync_message& message) {
+  switch (topic.message_type) {
+  case MessageType::NDATA:
+  case MessageType::DBIRTH:
+  case MessageType::DDATA:
+  case MessageType::DDEATH:
+    break;
+  default:
+    return false; // NBIRTH starts a session; the rest carry no node seq
+  }
+  auto seq = peek_seq({static_cast<const uint8_t*>(message.payload),
+                       static_cast<size_t>(std::max(message.payloadlen, 0))});
+  if (!seq || *seq >= SEQ_NUMBER_MAX) {
+    return false; // Left to validate_message()
+  }
+  {
+    std::scoped_lock lock(node_states_mutex_);
+    auto it = node_states_.find(detail::NodeKeyView{topic.group_id, topic.edge_node_id});
+    // check_resync_locked() must see every message of a node whose continuity
+    // after a reconnect is not settled yet, or a loss could pass as continuity
+    if (it == node_states_.end() || !it->second.birth_received ||
+        (resync_ && resync_->pending(topic.group_id, topic.edge_node_id)) ||
+        it->second.seq_window.accept(static_cast<uint8_t>(*seq), message.dup != 0)) {
+      return false;
+    }
+    duplicates_dropped_++;
+  }
+  log(LogLevel::DEBUG,
+      std::format("Dropped duplicate seq {} on {}{}", *seq, topic.to_string(),
+                  message.dup ? " (redelivery)" : ""));
+  return true;
+}
+
 int HostApplication::on_message_arrived(void* context,
                                         char* topicName,
                                         int topicLen,
@@ -756,15 +2206,14 @@ int HostApplication::on_message_arrived(void* context,
 
   std::string topic_str(topicName, topicLen > 0 ? topicLen : strlen(topicName));
 
-  std::string state_prefix = std::format("{}/STATE/", NAMESPACE);
-  if (topic_str.starts_with(state_prefix)) {
+  if (topic_str.starts_with(STATE_TOPIC_PREFIX)) {
     std::string state_value(static_cast<char*>(message->payload), message->payloadlen);
 
     org::eclipse::tahu::protobuf::Payload dummy_payload;
 
     Topic state_topic{.group_id = "",
                       .message_type = MessageType::STATE,
-                      .edge_node_id = topic_str.substr(state_prefix.length()),
+                      .edge_node_id = topic_str.substr(STATE_TOPIC_PREFIX.size()),
                       .device_id = ""};
 
     if (host_app->config_.message_callback) {
@@ -789,6 +2238,14 @@ int HostApplication::on_message_arrived(void* context,
     return 1;
   }
 
+  // The seq window is kept by sequence validation; without it nothing is dropped
+  if (host_app->config_.suppress_duplicates && host_app->config_.validate_sequence &&
+      host_app->is_duplicate(*topic_result, *message)) {
+    MQTTAsync_freeMessage(&message);
+    MQTTAsync_free(topicName);
+    return 1;
+  }
+
   org::eclipse::tahu::protobuf::Payload payload;
   if (!payload.ParseFromArray(message->payload, message->payloadlen)) {
     host_app->log(LogLevel::ERROR, "Failed to parse Sparkplug B payload");
@@ -797,9 +2254,73 @@ int HostApplication::on_message_arrived(void* context,
     return 1;
   }
 
+  std::vector<MetricRecord> records;
+  std::vector<OfflineEvent> offline;
+  std::vector<AlarmEvent> alarms;
+  std::vector<DerivedValue> derived;
+  stdx::expected<void, std::string> ring_result;
   {
     std::scoped_lock lock(host_app->node_states_mutex_);
-    host_app->validate_message(*topic_result, payload);
+    if (host_app->resync_ && host_app->resync_->size() > 0) {
+      host_app->check_resync_locked(*topic_result, payload);
+    }
+    bool valid = host_app->validate_message(*topic_result, payload);
+    if (host_app->memory_budget_) {
+      host_app->account_memory_locked(*topic_result);
+    }
+
+    if (valid && (topic_result->message_type == MessageType::NDEATH ||
+                  topic_result->message_type == MessageType::DDEATH)) {
+      offline.push_back({topic_result->group_id, topic_result->edge_node_id,
+                         topic_result->device_id, OfflineReason::Death});
+    }
+    if (host_app->stale_monitor_ || host_app->alarm_engine_) {
+      auto now = std::chrono::steady_clock::now();
+      if (host_app->stale_monitor_) {
+        if (valid) {
+          host_app->touch_stale_locked(*topic_result, now);
+        }
+        host_app->expire_stale_locked(now, offline);
+      }
+      if (host_app->alarm_engine_) {
+        if (valid) {
+          host_app->alarm_engine_->process(*topic_result, payload, alarms, now);
+        }
+        host_app->alarm_engine_->poll(now, alarms);
+      }
+    }
+
+    if (valid && !host_app->sinks_.empty()) {
+      append_metric_records(*topic_result, payload,
+                            host_app->find_alias_map(*topic_result), records);
+    }
+    if (valid && host_app->shm_ring_) {
+      ring_result = host_app->shm_ring_->publish(*topic_result, payload,
+                                                 host_app->find_alias_map(*topic_result));
+    }
+    if (valid && host_app->command_tracker_) {
+      host_app->command_tracker_->match_data(*topic_result, payload,
+                                             host_app->find_alias_map(*topic_result));
+    }
+    if (valid && host_app->replication_tracking_) {
+      host_app->mark_replication_dirty(*topic_result);
+    }
+    if (valid && host_app->aggregates_) {
+      host_app->update_aggregates_locked(*topic_result, payload);
+    }
+    if (valid && host_app->derived_metrics_) {
+      host_app->derived_metrics_->process(*topic_result, payload, derived);
+    }
+  }
+
+  if (!ring_result) {
+    host_app->log(LogLevel::WARN,
+                  std::format("Shared-memory fan-out failed: {}", ring_result.error()));
+  }
+
+  // Pushed without node_states_mutex_ held: a Block-policy sink may stall here
+  for (const auto& sink : host_app->sinks_) {
+    sink->push(records);
   }
 
   if (host_app->config_.message_callback) {
@@ -808,6 +2329,9 @@ int HostApplication::on_message_arrived(void* context,
     } catch (...) {
     }
   }
+  host_app->notify_derived(derived);
+  host_app->notify_offline(offline);
+  host_app->notify_alarms(alarms);
 
   MQTTAsync_freeMessage(&message);
   MQTTAsync_free(topicName);
@@ -827,6 +2351,27 @@ void HostApplication::on_connection_lost(void* context, char* cause) {
   } else {
     host_app->log(LogLevel::WARN, "Connection lost");
   }
+
+  // Messages published while disconnected are lost (clean session): every online
+  // node's continuity is checked on its next message, and the seq windows no
+  // longer describe what comes next
+  {
+    std::scoped_lock lock(host_app->node_states_mutex_);
+    for (auto& [key, state] : host_app->node_states_) {
+      state.seq_window.clear();
+      if (host_app->resync_ && state.is_online) {
+        host_app->resync_->mark(key.group_id, key.edge_node_id);
+      }
+    }
+  }
+  if (host_app->reconnector_) {
+    auto& reconnector = *host_app->reconnector_;
+    {
+      std::scoped_lock lock(reconnector.mutex);
+      reconnector.lost = reconnector.wanted;
+    }
+    reconnector.cv.notify_all();
+  }
 }
 
 } // namespace sparkplug
@@ -0,0 +1,583 @@
+// src/json_encoder.cpp
+#include "sparkplug/json_encoder.hpp"
+
+#include "sparkplug/datatype.hpp"
+
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <optional>
+#include <type_traits>
+
+namespace sparkplug {
+
+namespace {
+
+using PayloadMetric = org::eclipse::tahu::protobuf::Payload::Metric;
+
+constexpr char kHexDigits[] = "0123456789abcdef";
+constexpr char kBase64Chars[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+void append_escaped(std::string& out, std::string_view str) {
+  out += '"';
+  size_t run_start = 0;
+  for (size_t i = 0; i < str.size(); ++i) {
+    auto c = static_cast<unsigned char>(str[i]);
+    if (c >= 0x20 && c != '"' && c != '\\') {
+      continue;
+    }
+    out.append(str.data() + run_start, i - run_start);
+    run_start = i + 1;
+    switch (c) {
+    case '"':
+      out += "\\\"";
+      break;
+    case '\\':
+      out += "\\\\";
+      break;
+    case '\n':
+      out += "\\n";
+      break;
+    case '\r':
+      out += "\\r";
+      break;
+    case '\t':
+      out += "\\t";
+      break;
+    default:
+      out += "\\u00";
+      out += kHexDigits[c >> 4];
+      out += kHexDigits[c & 0x0F];
+      break;
+    }
+  }
+  out.append(str.data() + run_start, str.size() - run_start);
+  out += '"';
+}
+
+void append_base64(std::string& out, std::string_view data) {
+  out += '"';
+  size_t i = 0;
+  for (; i + 3 <= data.size(); i += 3) {
+    uint32_t n = (static_cast<uint32_t>(static_cast<uint8_t>(data[i])) << 16) |
+                 (static_cast<uint32_t>(static_cast<uint8_t>(data[i + 1])) << 8) |
+                 static_cast<uint8_t>(data[i + 2]);
+    out += kBase64Chars[(n >> 18) & 0x3F];
+    out += kBase64Chars[(n >> 12) & 0x3F];
+    out += kBase64Chars[(n >> 6) & 0x3F];
+    out += kBase64Chars[n & 0x3F];
+  }
+  if (size_t rest = data.size() - i; rest > 0) {
+    uint32_t n = static_cast<uint32_t>(static_cast<uint8_t>(data[i])) << 16;
+    if (rest == 2) {
+      n |= static_cast<uint32_t>(static_cast<uint8_t>(data[i + 1])) << 8;
+    }
+    out += kBase64Chars[(n >> 18) & 0x3F];
+    out += kBase64Chars[(n >> 12) & 0x3F];
+    out += rest == 2 ? kBase64Chars[(n >> 6) & 0x3F] : '=';
+    out += '=';
+  }
+  out += '"';
+}
+
+template <typename T>
+void append_number(std::string& out, T value) {
+  if constexpr (std::is_floating_point_v<T>) {
+    if (!std::isfinite(value)) {
+      out += "null"; // JSON has no NaN/Infinity
+      return;
+    }
+  }
+  char buf[32];
+  auto [ptr, ec] = std::to_chars(buf, buf + sizeof(buf), value);
+  out.append(buf, ptr);
+}
+
+void append_key(std::string& out, std::string_view key) {
+  out += '"';
+  out += key;
+  out += "\":";
+}
+
+void append_value(std::string& out, const JsonEncoder::MetricView& metric) {
+  if (metric.is_null) {
+    out += "null";
+    return;
+  }
+
+  switch (static_cast<DataType>(metric.datatype)) {
+  case DataType::Int8:
+    append_number(out, static_cast<int8_t>(metric.int_bits));
+    break;
+  case DataType::Int16:
+    append_number(out, static_cast<int16_t>(metric.int_bits));
+    break;
+  case DataType::Int32:
+    append_number(out, static_cast<int32_t>(metric.int_bits));
+    break;
+  case DataType::Int64:
+    append_number(out, static_cast<int64_t>(metric.int_bits));
+    break;
+  case DataType::UInt8:
+  case DataType::UInt16:
+  case DataType::UInt32:
+    append_number(out, static_cast<uint32_t>(metric.int_bits));
+    break;
+  case DataType::UInt64:
+  case DataType::DateTime:
+    append_number(out, metric.int_bits);
+    break;
+  case DataType::Float:
+    append_number(out, metric.float_value);
+    break;
+  case DataType::Double:
+    append_number(out, metric.double_value);
+    break;
+  case DataType::Boolean:
+    out += metric.int_bits != 0 ? "true" : "false";
+    break;
+  case DataType::String:
+  case DataType::Text:
+  case DataType::UUID:
+    append_escaped(out, metric.bytes);
+    break;
+  case DataType::Bytes:
+  case DataType::File:
+    append_base64(out, metric.bytes);
+    break;
+  default:
+    out += "null";
+    break;
+  }
+}
+
+JsonEncoder::MetricView to_view(const PayloadMetric& metric) {
+  JsonEncoder::MetricView view;
+  view.name = metric.name();
+  view.alias = metric.alias();
+  view.timestamp = metric.timestamp();
+  view.datatype = metric.datatype();
+  view.has_name = metric.has_name();
+  view.has_alias = metric.has_alias();
+  view.has_timestamp = metric.has_timestamp();
+  view.is_historical = metric.is_historical();
+  view.is_transient = metric.is_transient();
+  view.is_null = metric.is_null();
+
+  switch (metric.value_case()) {
+  case PayloadMetric::kIntValue:
+    view.int_bits = metric.int_value();
+    break;
+  case PayloadMetric::kLongValue:
+    view.int_bits = metric.long_value();
+    break;
+  case PayloadMetric::kBooleanValue:
+    view.int_bits = metric.boolean_value() ? 1 : 0;
+    break;
+  case PayloadMetric::kFloatValue:
+    view.float_value = metric.float_value();
+    break;
+  case PayloadMetric::kDoubleValue:
+    view.double_value = metric.double_value();
+    break;
+  case PayloadMetric::kStringValue:
+    view.bytes = metric.string_value();
+    break;
+  case PayloadMetric::kBytesValue:
+    view.bytes = metric.bytes_value();
+    break;
+  default:
+    break;
+  }
+  return view;
+}
+
+// Minimal protobuf wire-format reader over a byte span.
+class WireReader {
+public:
+  explicit WireReader(std::span<const uint8_t> data) noexcept
+      : pos_(data.data()), end_(data.data() + data.size()) {
+  }
+
+  [[nodiscard]] bool done() const noexcept {
+    return pos_ >= end_;
+  }
+
+  bool read_varint(uint64_t& value) noexcept {
+    value = 0;
+    for (int shift = 0; shift < 64 && pos_ < end_; shift += 7) {
+      uint8_t byte = *pos_++;
+      value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+      if ((byte & 0x80) == 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool read_fixed32(uint32_t& value) noexcept {
+    if (end_ - pos_ < 4) {
+      return false;
+    }
+    value = static_cast<uint32_t>(pos_[0]) | (static_cast<uint32_t>(pos_[1]) << 8) |
+            (static_cast<uint32_t>(pos_[2]) << 16) |
+            (static_cast<uint32_t>(pos_[3]) << 24);
+    pos_ += 4;
+    return true;
+  }
+
+  bool read_fixed64(uint64_t& value) noexcept {
+    uint32_t lo = 0;
+    uint32_t hi = 0;
+    if (!read_fixed32(lo) || !read_fixed32(hi)) {
+      return false;
+    }
+    value = (static_cast<uint64_t>(hi) << 32) | lo;
+    return true;
+  }
+
+  bool read_bytes(std::span<const uint8_t>& value) noexcept {
+    uint64_t len = 0;
+    if (!read_varint(len) || len > static_cast<uint64_t>(end_ - pos_)) {
+      return false;
+    }
+    value = std::span<const uint8_t>(pos_, static_cast<size_t>(len));
+    pos_ += len;
+    return true;
+  }
+
+  bool skip(uint32_t wire_type) noexcept {
+    uint64_t ignored = 0;
+    uint32_t ignored32 = 0;
+    std::span<const uint8_t> ignored_bytes;
+    switch (wire_type) {
+    case 0:
+      return read_varint(ignored);
+    case 1:
+      return read_fixed64(ignored);
+    case 2:
+      return read_bytes(ignored_bytes);
+    case 5:
+      return read_fixed32(ignored32);
+    default:
+      return false; // Groups are not used by Sparkplug
+    }
+  }
+
+private:
+  const uint8_t* pos_;
+  const uint8_t* end_;
+};
+
+std::string_view as_string_view(std::span<const uint8_t> bytes) noexcept {
+  return {reinterpret_cast<const char*>(bytes.data()), bytes.size()};
+}
+
+bool parse_metric(std::span<const uint8_t> data, JsonEncoder::MetricView& view) {
+  WireReader reader(data);
+  while (!reader.done()) {
+    uint64_t tag = 0;
+    if (!reader.read_varint(tag)) {
+      return false;
+    }
+    auto field = static_cast<uint32_t>(tag >> 3);
+    auto wire_type = static_cast<uint32_t>(tag & 0x07);
+
+    uint64_t varint = 0;
+    std::span<const uint8_t> bytes;
+    bool ok = true;
+
+    switch (field) {
+    case 1: // name
+      ok = wire_type == 2 && reader.read_bytes(bytes);
+      view.name = as_string_view(bytes);
+      view.has_name = true;
+      break;
+    case 2: // alias
+      ok = wire_type == 0 && reader.read_varint(view.alias);
+      view.has_alias = true;
+      break;
+    case 3: // timestamp
+      ok = wire_type == 0 && reader.read_varint(view.timestamp);
+      view.has_timestamp = true;
+      break;
+    case 4: // datatype
+      ok = wire_type == 0 && reader.read_varint(varint);
+      view.datatype = static_cast<uint32_t>(varint);
+      break;
+    case 5: // is_historical
+    case 6: // is_transient
+    case 7: // is_null
+      ok = wire_type == 0 && reader.read_varint(varint);
+      (field == 5 ? view.is_historical : field == 6 ? view.is_transient : view.is_null) =
+          varint != 0;
+      break;
+    case 10: // int_value (uint32)
+      ok = wire_type == 0 && reader.read_varint(varint);
+      view.int_bits = static_cast<uint32_t>(varint);
+      break;
+    case 11: // long_value
+      ok = wire_type == 0 && reader.read_varint(view.int_bits);
+      break;
+    case 12: { // float_value
+      uint32_t bits = 0;
+      ok = wire_type == 5 && reader.read_fixed32(bits);
+      view.float_value = std::bit_cast<float>(bits);
+      break;
+    }
+    case 13: // double_value
+      ok = wire_type == 1 && reader.read_fixed64(varint);
+      view.double_value = std::bit_cast<double>(varint);
+      break;
+    case 14: // boolean_value
+      ok = wire_type == 0 && reader.read_varint(varint);
+      view.int_bits = varint != 0 ? 1 : 0;
+      break;
+    case 15: // string_value
+    case 16: // bytes_value
+      ok = wire_type == 2 && reader.read_bytes(bytes);
+      view.bytes = as_string_view(bytes);
+      break;
+    default: // metadata, properties, dataset, template, extension
+      ok = reader.skip(wire_type);
+      break;
+    }
+
+    if (!ok) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+std::string_view JsonEncoder::encode(const org::eclipse::tahu::protobuf::Payload& payload,
+                                     const AliasMap* aliases) {
+  return encode_payload(nullptr, payload, aliases);
+}
+
+std::string_view JsonEncoder::encode(const Topic& topic,
+                                     const org::eclipse::tahu::protobuf::Payload& payload,
+                                     const AliasMap* aliases) {
+  return encode_payload(&topic, payload, aliases);
+}
+
+stdx::expected<std::string_view, std::string>
+JsonEncoder::encode(std::span<const uint8_t> wire, const AliasMap* aliases) {
+  return encode_wire(nullptr, wire, aliases);
+}
+
+stdx::expected<std::string_view, std::string>
+JsonEncoder::encode(const Topic& topic,
+                    std::span<const uint8_t> wire,
+                    const AliasMap* aliases) {
+  return encode_wire(&topic, wire, aliases);
+}
+
+void JsonEncoder::begin(const Topic* topic) {
+  out_.clear();
+  out_ += '{';
+  if (!topic) {
+    return;
+  }
+
+  append_key(out_, "group_id");
+  append_escaped(out_, topic->group_id);
+  out_ += ',';
+  append_key(out_, "message_type");
+  out_ += '"';
+  out_ += message_type_to_string(topic->message_type);
+  out_ += "\",";
+  append_key(out_, "edge_node_id");
+  append_escaped(out_, topic->edge_node_id);
+  out_ += ',';
+  if (!topic->device_id.empty()) {
+    append_key(out_, "device_id");
+    append_escaped(out_, topic->device_id);
+    out_ += ',';
+  }
+}
+
+void JsonEncoder::append_metric(const MetricView& metric, const AliasMap* aliases) {
+  out_ += '{';
+
+  std::string_view name = metric.name;
+  bool has_name = metric.has_name;
+  if (!has_name && metric.has_alias && aliases) {
+    auto it = aliases->find(metric.alias);
+    if (it != aliases->end()) {
+      name = it->second;
+      has_name = true;
+    }
+  }
+  if (has_name) {
+    append_key(out_, "name");
+    append_escaped(out_, name);
+    out_ += ',';
+  }
+  if (metric.has_alias) {
+    append_key(out_, "alias");
+    append_number(out_, metric.alias);
+    out_ += ',';
+  }
+  if (metric.has_timestamp) {
+    append_key(out_, "timestamp");
+    append_number(out_, metric.timestamp);
+    out_ += ',';
+  }
+  append_key(out_, "datatype");
+  append_number(out_, metric.datatype);
+  out_ += ',';
+  if (metric.is_historical) {
+    out_ += "\"is_historical\":true,";
+  }
+  if (metric.is_transient) {
+    out_ += "\"is_transient\":true,";
+  }
+  append_key(out_, "value");
+  append_value(out_, metric);
+
+  out_ += '}';
+}
+
+std::string_view
+JsonEncoder::encode_payload(const Topic* topic,
+                            const org::eclipse::tahu::protobuf::Payload& payload,
+                            const AliasMap* aliases) {
+  begin(topic);
+
+  if (payload.has_timestamp()) {
+    append_key(out_, "timestamp");
+    append_number(out_, payload.timestamp());
+    out_ += ',';
+  }
+  if (payload.has_seq()) {
+    append_key(out_, "seq");
+    append_number(out_, payload.seq());
+    out_ += ',';
+  }
+  if (payload.has_uuid()) {
+    append_key(out_, "uuid");
+    append_escaped(out_, payload.uuid());
+    out_ += ',';
+  }
+  if (payload.has_body()) {
+    append_key(out_, "body");
+    append_base64(out_, payload.body());
+    out_ += ',';
+  }
+
+  append_key(out_, "metrics");
+  out_ += '[';
+  for (int i = 0; i < payload.metrics_size(); ++i) {
+    if (i > 0) {
+      out_ += ',';
+    }
+    append_metric(to_view(payload.metrics(i)), aliases);
+  }
+  out_ += "]}";
+
+  return out_;
+}
+
+stdx::expected<std::string_view, std::string>
+JsonEncoder::encode_wire(const Topic* topic,
+                         std::span<const uint8_t> wire,
+                         const AliasMap* aliases) {
+  // Payload-level fields may appear in any order relative to the metrics, so the
+  // metrics are collected first and emitted after the header fields.
+  metrics_.clear();
+
+  std::optional<uint64_t> timestamp;
+  std::optional<uint64_t> seq;
+  std::optional<std::string_view> uuid;
+  std::optional<std::string_view> body;
+
+  WireReader reader(wire);
+  while (!reader.done()) {
+    uint64_t tag = 0;
+    if (!reader.read_varint(tag)) {
+      return stdx::unexpected("Malformed payload: truncated field tag");
+    }
+    auto field = static_cast<uint32_t>(tag >> 3);
+    auto wire_type = static_cast<uint32_t>(tag & 0x07);
+
+    uint64_t varint = 0;
+    std::span<const uint8_t> bytes;
+    bool ok = true;
+
+    switch (field) {
+    case 1: // timestamp
+      ok = wire_type == 0 && reader.read_varint(varint);
+      timestamp = varint;
+      break;
+    case 2: // metrics
+      ok = wire_type == 2 && reader.read_bytes(bytes);
+      if (ok) {
+        auto& metric = metrics_.emplace_back();
+        if (!parse_metric(bytes, metric)) {
+          return stdx::unexpected("Malformed payload: invalid metric");
+        }
+      }
+      break;
+    case 3: // seq
+      ok = wire_type == 0 && reader.read_varint(varint);
+      seq = varint;
+      break;
+    case 4: // uuid
+      ok = wire_type == 2 && reader.read_bytes(bytes);
+      uuid = as_string_view(bytes);
+      break;
+    case 5: // body
+      ok = wire_type == 2 && reader.read_bytes(bytes);
+      body = as_string_view(bytes);
+      break;
+    default:
+      ok = reader.skip(wire_type);
+      break;
+    }
+
+    if (!ok) {
+      return stdx::unexpected("Malformed payload: invalid field encoding");
+    }
+  }
+
+  begin(topic);
+
+  if (timestamp) {
+    append_key(out_, "timestamp");
+    append_number(out_, *timestamp);
+    out_ += ',';
+  }
+  if (seq) {
+    append_key(out_, "seq");
+    append_number(out_, *seq);
+    out_ += ',';
+  }
+  if (uuid) {
+    append_key(out_, "uuid");
+    append_escaped(out_, *uuid);
+    out_ += ',';
+  }
+  if (body) {
+    append_key(out_, "body");
+    append_base64(out_, *body);
+    out_ += ',';
+  }
+
+  append_key(out_, "metrics");
+  out_ += '[';
+  for (size_t i = 0; i < metrics_.size(); ++i) {
+    if (i > 0) {
+      out_ += ',';
+    }
+    append_metric(metrics_[i], aliases);
+  }
+  out_ += "]}";
+
+  return std::string_view(out_);
+}
+
+} // namespace sparkplug
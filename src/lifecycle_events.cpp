@@ -0,0 +1,72 @@
+// src/lifecycle_events.cpp
+#include "sparkplug/lifecycle_events.hpp"
+
+#include <utility>
+
+namespace sparkplug {
+
+namespace {
+
+bool is_down(LifecycleEventType type) {
+  return type == LifecycleEventType::Offline || type == LifecycleEventType::Stale;
+}
+
+// State and sequence events of an entity coalesce separately
+detail::NodeKeyView key_of(const LifecycleEvent& event) {
+  return {event.group_id, event.edge_node_id, event.device_id,
+          event.type == LifecycleEventType::SeqGap ? "gap" : "state"};
+}
+
+} // namespace
+
+LifecycleEventQueue::LifecycleEventQueue() : LifecycleEventQueue(Options{}) {
+}
+
+LifecycleEventQueue::LifecycleEventQueue(Options options) : options_(options) {
+}
+
+void LifecycleEventQueue::merge(LifecycleEvent& pending, const LifecycleEvent& next) {
+  if (next.type == LifecycleEventType::SeqGap) {
+    pending.expected_seq = next.expected_seq;
+    pending.received_seq = next.received_seq;
+  } else if ((is_down(pending.type) || pending.type == LifecycleEventType::Bounced) &&
+             !is_down(next.type)) {
+    pending.type = LifecycleEventType::Bounced;
+  } else {
+    pending.type = next.type;
+  }
+  pending.count += next.count;
+  pending.timestamp = next.timestamp;
+}
+
+bool LifecycleEventQueue::push(LifecycleEvent event, Clock::time_point now) {
+  auto it = index_.find(key_of(event));
+  if (it != index_.end()) {
+    merge(pending_[static_cast<size_t>(it->second - base_)].event, event);
+    return true;
+  }
+  if (pending_.size() >= options_.capacity) {
+    dropped_++;
+    return false;
+  }
+  index_.emplace(detail::NodeKey(key_of(event)), base_ + pending_.size());
+  pending_.push_back({std::move(event), now + options_.window});
+  return true;
+}
+
+size_t LifecycleEventQueue::drain(std::vector<LifecycleEvent>& out,
+                                  size_t max_events,
+                                  Clock::time_point now) {
+  size_t appended = 0;
+  while (appended < max_events && !pending_.empty() && pending_.front().ready <= now) {
+    auto& front = pending_.front();
+    index_.erase(index_.find(key_of(front.event)));
+    out.push_back(std::move(front.event));
+    pending_.pop_front();
+    base_++;
+    appended++;
+  }
+  return appended;
+}
+
+} // namespace sparkplug
@@ -0,0 +1,247 @@
+// src/metric_aggregates.cpp
+#include "sparkplug/metric_aggregates.hpp"
+
+#include "sparkplug/sink.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace sparkplug {
+
+MetricAggregates::Id MetricAggregates::add(AggregateSpec spec) {
+  auto id = static_cast<Id>(aggregates_.size());
+  detail::NodeKeyView key{spec.group_id, spec.edge_node_id, {}, spec.metric_name};
+  auto it = by_metric_.find(key);
+  if (it == by_metric_.end()) {
+    it = by_metric_.emplace(detail::NodeKey(key), std::vector<Id>{}).first;
+  }
+  it->second.push_back(id);
+  if (!spec.edge_node_id.empty()) {
+    node_scoped_++;
+  }
+  aggregates_.push_back({.spec = std::move(spec)});
+  return id;
+}
+
+uint32_t MetricAggregates::source_id(const Topic& topic) {
+  detail::NodeKeyView key{topic.group_id, topic.edge_node_id, topic.device_id};
+  auto it = source_ids_.find(key);
+  if (it != source_ids_.end()) {
+    return it->second;
+  }
+  auto id = static_cast<uint32_t>(sources_.size());
+  sources_.emplace_back();
+  source_ids_.emplace(detail::NodeKey(key), id);
+  return id;
+}
+
+void MetricAggregates::update(
+    const Topic& topic,
+    const org::eclipse::tahu::protobuf::Payload& payload,
+    const std::unordered_map<uint64_t, std::string>* alias_map) {
+  switch (topic.message_type) {
+  case MessageType::NBIRTH:
+  case MessageType::NDATA:
+  case MessageType::DBIRTH:
+  case MessageType::DDATA:
+    break;
+  default:
+    return;
+  }
+  if (aggregates_.empty()) {
+    return;
+  }
+
+  std::optional<uint32_t> source; // Interned on the first matching metric
+  for (const auto& metric : payload.metrics()) {
+    if (metric.is_historical()) {
+      continue;
+    }
+    std::string_view name = metric.name();
+    if (!metric.has_name()) {
+      if (!metric.has_alias() || !alias_map) {
+        continue;
+      }
+      auto alias_it = alias_map->find(metric.alias());
+      if (alias_it == alias_map->end()) {
+        continue;
+      }
+      name = alias_it->second;
+    }
+
+    // Group-wide aggregates, then those scoped to this edge node
+    for (int scope = 0; scope < 2; ++scope) {
+      if (scope == 1 && node_scoped_ == 0) {
+        break;
+      }
+      std::string_view node = scope == 0 ? std::string_view{} : topic.edge_node_id;
+      auto it = by_metric_.find(detail::NodeKeyView{topic.group_id, node, {}, name});
+      if (it == by_metric_.end()) {
+        continue;
+      }
+      if (!source) {
+        source = source_id(topic);
+      }
+
+      if (metric.has_is_null() && metric.is_null()) {
+        for (Id id : it->second) {
+          withdraw(id, *source);
+        }
+        continue;
+      }
+      auto value = decode_metric_number(metric);
+      if (!value || std::isnan(*value)) {
+        continue;
+      }
+      for (Id id : it->second) {
+        apply(id, *source, *value);
+      }
+    }
+  }
+}
+
+void MetricAggregates::apply(Id id, uint32_t source, double value) {
+  auto& aggregate = aggregates_[id];
+  auto [it, inserted] =
+      aggregate.slots.try_emplace(source, static_cast<uint32_t>(aggregate.values.size()));
+  if (inserted) {
+    aggregate.values.push_back(0.0);
+    aggregate.present.push_back(false);
+    aggregate.suspended.push_back(false);
+    sources_[source].aggregates.push_back(id);
+  }
+  uint32_t slot = it->second;
+  aggregate.suspended[slot] = false;
+
+  if (!aggregate.present[slot]) {
+    aggregate.present[slot] = true;
+    aggregate.sum += value;
+    if (aggregate.count++ == 0) {
+      aggregate.min = aggregate.max = value;
+    }
+  } else {
+    double old = aggregate.values[slot];
+    aggregate.sum += value - old;
+    // The extreme itself moved inward: the true extreme is unknown until a rescan
+    if ((old == aggregate.min && value > old) || (old == aggregate.max && value < old)) {
+      aggregate.extremes_dirty = true;
+    }
+  }
+  aggregate.values[slot] = value;
+  aggregate.min = std::min(aggregate.min, value);
+  aggregate.max = std::max(aggregate.max, value);
+}
+
+void MetricAggregates::withdraw(Id id, uint32_t source, bool keep) {
+  auto& aggregate = aggregates_[id];
+  auto it = aggregate.slots.find(source);
+  if (it == aggregate.slots.end()) {
+    return;
+  }
+  uint32_t slot = it->second;
+  aggregate.suspended[slot] =
+      keep && (aggregate.present[slot] || aggregate.suspended[slot]);
+  if (!aggregate.present[slot]) {
+    return;
+  }
+  double old = aggregate.values[slot];
+  aggregate.present[slot] = false;
+  if (--aggregate.count == 0) {
+    aggregate.sum = aggregate.min = aggregate.max = 0.0;
+    aggregate.extremes_dirty = false;
+    return;
+  }
+  aggregate.sum -= old;
+  if (old == aggregate.min || old == aggregate.max) {
+    aggregate.extremes_dirty = true;
+  }
+}
+
+const MetricAggregates::Source* MetricAggregates::find_source(
+    std::string_view group_id,
+    std::string_view edge_node_id,
+    std::string_view device_id,
+    uint32_t& id) {
+  auto it = source_ids_.find(detail::NodeKeyView{group_id, edge_node_id, device_id});
+  if (it == source_ids_.end()) {
+    return nullptr;
+  }
+  id = it->second;
+  return &sources_[id];
+}
+
+void MetricAggregates::retract(std::string_view group_id,
+                               std::string_view edge_node_id,
+                               std::string_view device_id) {
+  uint32_t id = 0;
+  if (const auto* source = find_source(group_id, edge_node_id, device_id, id)) {
+    for (Id aggregate : source->aggregates) {
+      withdraw(aggregate, id);
+    }
+  }
+}
+
+void MetricAggregates::suspend(std::string_view group_id,
+                               std::string_view edge_node_id,
+                               std::string_view device_id) {
+  uint32_t id = 0;
+  if (const auto* source = find_source(group_id, edge_node_id, device_id, id)) {
+    for (Id aggregate : source->aggregates) {
+      withdraw(aggregate, id, true);
+    }
+  }
+}
+
+void MetricAggregates::resume(std::string_view group_id,
+                              std::string_view edge_node_id,
+                              std::string_view device_id) {
+  uint32_t id = 0;
+  const auto* source = find_source(group_id, edge_node_id, device_id, id);
+  if (!source) {
+    return;
+  }
+  for (Id aggregate_id : source->aggregates) {
+    const auto& aggregate = aggregates_[aggregate_id];
+    uint32_t slot = aggregate.slots.at(id);
+    if (aggregate.suspended[slot]) {
+      apply(aggregate_id, id, aggregate.values[slot]);
+    }
+  }
+}
+
+void MetricAggregates::rescan(Aggregate& aggregate) {
+  // Also resums, shedding rounding error accumulated by incremental updates
+  bool first = true;
+  aggregate.sum = 0.0;
+  for (size_t slot = 0; slot < aggregate.values.size(); ++slot) {
+    if (!aggregate.present[slot]) {
+      continue;
+    }
+    double value = aggregate.values[slot];
+    aggregate.sum += value;
+    aggregate.min = first ? value : std::min(aggregate.min, value);
+    aggregate.max = first ? value : std::max(aggregate.max, value);
+    first = false;
+  }
+  aggregate.extremes_dirty = false;
+}
+
+std::optional<AggregateValue> MetricAggregates::value(Id id) {
+  if (id >= aggregates_.size()) {
+    return std::nullopt;
+  }
+  auto& aggregate = aggregates_[id];
+  if (aggregate.extremes_dirty) {
+    rescan(aggregate);
+  }
+  return AggregateValue{
+      .count = aggregate.count,
+      .sum = aggregate.sum,
+      .min = aggregate.min,
+      .max = aggregate.max,
+      .mean = aggregate.count > 0 ? aggregate.sum / static_cast<double>(aggregate.count)
+                                  : 0.0};
+}
+
+} // namespace sparkplug
@@ -0,0 +1,698 @@
+// src/mqtt_client.cpp
+#include "sparkplug/mqtt_client.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <utility>
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace sparkplug {
+
+namespace {
+
+// MQTT 3.1.1 control packet types (high nibble of the fixed header)
+constexpr uint8_t CONNECT = 1;
+constexpr uint8_t CONNACK = 2;
+constexpr uint8_t PUBLISH = 3;
+constexpr uint8_t PUBACK = 4;
+constexpr uint8_t SUBSCRIBE = 8;
+constexpr uint8_t SUBACK = 9;
+constexpr uint8_t PINGREQ = 12;
+constexpr uint8_t PINGRESP = 13;
+constexpr uint8_t DISCONNECT = 14;
+
+constexpr size_t MAX_REMAINING_LENGTH = 268435455;
+constexpr size_t MAX_IOVECS = 64;
+constexpr size_t MAX_SPARE_FRAMES = 64;
+constexpr int DISCONNECT_FLUSH_TIMEOUT_MS = 1000;
+constexpr size_t MAX_PACKET_IDS = 65535; // Nonzero 16-bit packet identifiers
+
+void put_u16(std::vector<uint8_t>& out, uint16_t value) {
+  out.push_back(static_cast<uint8_t>(value >> 8));
+  out.push_back(static_cast<uint8_t>(value & 0xFF));
+}
+
+void put_string(std::vector<uint8_t>& out, std::string_view value) {
+  put_u16(out, static_cast<uint16_t>(value.size()));
+  out.insert(out.end(), value.begin(), value.end());
+}
+
+void put_header(std::vector<uint8_t>& out, uint8_t first_byte, size_t remaining) {
+  out.push_back(first_byte);
+  do {
+    auto digit = static_cast<uint8_t>(remaining % 128);
+    remaining /= 128;
+    if (remaining > 0) {
+      digit |= 0x80;
+    }
+    out.push_back(digit);
+  } while (remaining > 0);
+}
+
+uint16_t get_u16(std::span<const uint8_t> data, size_t pos) {
+  return static_cast<uint16_t>((data[pos] << 8) | data[pos + 1]);
+}
+
+std::string errno_string() {
+  return std::strerror(errno);
+}
+
+} // namespace
+
+MqttClient::MqttClient(Options options)
+    : options_(std::move(options)),
+      rx_(std::max<size_t>(options_.receive_buffer_size, 1024)) {
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  timer_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  if (epoll_fd_ >= 0 && timer_fd_ >= 0) {
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = timer_fd_;
+    (void)epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, timer_fd_, &event);
+  }
+}
+
+MqttClient::~MqttClient() {
+  if (socket_fd_ >= 0) {
+    (void)disconnect();
+  }
+  if (timer_fd_ >= 0) {
+    ::close(timer_fd_);
+  }
+  if (epoll_fd_ >= 0) {
+    ::close(epoll_fd_);
+  }
+}
+
+void MqttClient::set_message_callback(MessageCallback callback) {
+  message_callback_ = std::move(callback);
+}
+
+stdx::expected<void, std::string>
+MqttClient::connect(std::chrono::milliseconds timeout) {
+  if (epoll_fd_ < 0 || timer_fd_ < 0) {
+    return stdx::unexpected("Failed to create epoll or timer descriptor");
+  }
+  if (socket_fd_ >= 0) {
+    return stdx::unexpected("Already connected");
+  }
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+  auto remaining_ms = [&deadline] {
+    auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+        deadline - std::chrono::steady_clock::now());
+    return static_cast<int>(std::max<int64_t>(left.count(), 0));
+  };
+
+  addrinfo hints{};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  addrinfo* addresses = nullptr;
+  auto port = std::to_string(options_.port);
+  int rc = getaddrinfo(options_.host.c_str(), port.c_str(), &hints, &addresses);
+  if (rc != 0) {
+    return stdx::unexpected(
+        std::format("Failed to resolve {}: {}", options_.host, gai_strerror(rc)));
+  }
+
+  // Try each address in turn; the non-blocking connect is bounded by the timeout
+  std::string error = "No address to connect to";
+  for (auto* address = addresses; address != nullptr; address = address->ai_next) {
+    int fd = ::socket(address->ai_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                      address->ai_protocol);
+    if (fd < 0) {
+      error = std::format("Failed to create socket: {}", errno_string());
+      continue;
+    }
+    if (::connect(fd, address->ai_addr, address->ai_addrlen) != 0 &&
+        errno != EINPROGRESS) {
+      error = std::format("Failed to connect: {}", errno_string());
+      ::close(fd);
+      continue;
+    }
+    pollfd pfd{.fd = fd, .events = POLLOUT, .revents = 0};
+    int socket_error = 0;
+    socklen_t length = sizeof(socket_error);
+    if (::poll(&pfd, 1, remaining_ms()) != 1 ||
+        getsockopt(fd, SOL_SOCKET, SO_ERROR, &socket_error, &length) != 0 ||
+        socket_error != 0) {
+      error = socket_error != 0
+                  ? std::format("Failed to connect: {}", std::strerror(socket_error))
+                  : std::string("Connection timeout");
+      ::close(fd);
+      continue;
+    }
+    socket_fd_ = fd;
+    break;
+  }
+  freeaddrinfo(addresses);
+  if (socket_fd_ < 0) {
+    return stdx::unexpected(error);
+  }
+
+  int one = 1;
+  (void)setsockopt(socket_fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+  epoll_event event{};
+  event.events = EPOLLIN;
+  event.data.fd = socket_fd_;
+  if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, socket_fd_, &event) != 0) {
+    error = std::format("Failed to register socket: {}", errno_string());
+    close_socket();
+    return stdx::unexpected(error);
+  }
+  want_write_ = false;
+  connack_code_ = 0;
+  state_ = State::Connecting;
+
+  if (auto queued = queue_connect(); !queued) {
+    close_socket();
+    return queued;
+  }
+
+  while (state_ == State::Connecting) {
+    if (remaining_ms() == 0) {
+      close_socket();
+      return stdx::unexpected("Connection timeout");
+    }
+    if (auto result = poll(std::chrono::milliseconds(remaining_ms())); !result) {
+      if (connack_code_ != 0) {
+        break; // Refused; the broker closes the socket after CONNACK
+      }
+      return stdx::unexpected(result.error());
+    }
+  }
+  if (state_ != State::Connected) {
+    close_socket();
+    return stdx::unexpected(std::format("Connection refused: {}", connack_code_));
+  }
+
+  last_write_ = std::chrono::steady_clock::now();
+  arm_keepalive(true);
+  return {};
+}
+
+stdx::expected<void, std::string> MqttClient::disconnect() {
+  if (socket_fd_ < 0) {
+    return stdx::unexpected("Not connected");
+  }
+  put_header(new_frame(), DISCONNECT << 4, 0);
+  queued_bytes_ += 2;
+
+  // Bounded wait for the queue (including DISCONNECT) to drain
+  auto deadline = std::chrono::steady_clock::now() +
+                  std::chrono::milliseconds(DISCONNECT_FLUSH_TIMEOUT_MS);
+  while (!tx_.empty() && std::chrono::steady_clock::now() < deadline) {
+    if (!flush()) {
+      break;
+    }
+    if (!tx_.empty()) {
+      pollfd pfd{.fd = socket_fd_, .events = POLLOUT, .revents = 0};
+      (void)::poll(&pfd, 1, 10);
+    }
+  }
+  close_socket();
+  return {};
+}
+
+stdx::expected<uint16_t, std::string>
+MqttClient::publish(std::string_view topic,
+                    std::span<const uint8_t> payload,
+                    int qos,
+                    bool retained) {
+  if (state_ != State::Connected) {
+    return stdx::unexpected("Not connected");
+  }
+  if (qos < 0 || qos > 1) {
+    return stdx::unexpected("Only QoS 0 and 1 are supported");
+  }
+  if (topic.empty() || topic.size() > 0xFFFF) {
+    return stdx::unexpected("Invalid topic length");
+  }
+  size_t remaining = 2 + topic.size() + (qos > 0 ? 2 : 0) + payload.size();
+  if (remaining > MAX_REMAINING_LENGTH) {
+    return stdx::unexpected("Payload too large");
+  }
+  if (options_.max_queued_bytes > 0 &&
+      queued_bytes_ + remaining + 5 > options_.max_queued_bytes) {
+    return stdx::unexpected("Send queue full");
+  }
+  if (qos > 0 && in_flight_full()) {
+    return stdx::unexpected("Too many in-flight messages");
+  }
+
+  uint16_t packet_id = qos > 0 ? next_packet_id() : 0;
+  auto& frame = new_frame();
+  put_header(frame,
+             static_cast<uint8_t>((PUBLISH << 4) | (qos << 1) | (retained ? 1 : 0)),
+             remaining);
+  put_string(frame, topic);
+  if (qos > 0) {
+    put_u16(frame, packet_id);
+    pending_acks_.insert(packet_id);
+  }
+  frame.insert(frame.end(), payload.begin(), payload.end());
+  queued_bytes_ += frame.size();
+  stats_.messages_sent++;
+  return packet_id;
+}
+
+stdx::expected<uint16_t, std::string> MqttClient::subscribe(std::string_view filter,
+                                                            int qos) {
+  if (state_ != State::Connected) {
+    return stdx::unexpected("Not connected");
+  }
+  if (qos < 0 || qos > 1) {
+    return stdx::unexpected("Only QoS 0 and 1 are supported");
+  }
+  if (filter.empty() || filter.size() > 0xFFFF) {
+    return stdx::unexpected("Invalid topic filter length");
+  }
+  if (in_flight_full()) {
+    return stdx::unexpected("Too many in-flight messages");
+  }
+
+  uint16_t packet_id = next_packet_id();
+  auto& frame = new_frame();
+  put_header(frame, (SUBSCRIBE << 4) | 0x02, 2 + 2 + filter.size() + 1);
+  put_u16(frame, packet_id);
+  put_string(frame, filter);
+  frame.push_back(static_cast<uint8_t>(qos));
+  queued_bytes_ += frame.size();
+  pending_acks_.insert(packet_id);
+  return packet_id;
+}
+
+stdx::expected<void, std::string> MqttClient::flush() {
+  if (socket_fd_ < 0) {
+    return stdx::unexpected("Not connected");
+  }
+
+  while (!tx_.empty()) {
+    std::array<iovec, MAX_IOVECS> iov{};
+    size_t count = 0;
+    for (auto it = tx_.begin(); it != tx_.end() && count < MAX_IOVECS; ++it, ++count) {
+      size_t skip = count == 0 ? tx_offset_ : 0;
+      iov[count].iov_base = it->data() + skip;
+      iov[count].iov_len = it->size() - skip;
+    }
+
+    // sendmsg() is writev() with MSG_NOSIGNAL, so a closed peer cannot raise SIGPIPE
+    msghdr message{};
+    message.msg_iov = iov.data();
+    message.msg_iovlen = count;
+    ssize_t written = ::sendmsg(socket_fd_, &message, MSG_NOSIGNAL);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        set_want_write(true);
+        return {};
+      }
+      return stdx::unexpected(std::format("Write failed: {}", errno_string()));
+    }
+
+    stats_.write_calls++;
+    stats_.bytes_sent += static_cast<uint64_t>(written);
+    queued_bytes_ -= static_cast<size_t>(written);
+    last_write_ = std::chrono::steady_clock::now();
+
+    auto left = static_cast<size_t>(written);
+    while (left > 0) {
+      auto& front = tx_.front();
+      size_t unsent = front.size() - tx_offset_;
+      if (left < unsent) {
+        tx_offset_ += left;
+        break;
+      }
+      left -= unsent;
+      tx_offset_ = 0;
+      if (spare_frames_.size() < MAX_SPARE_FRAMES) {
+        spare_frames_.push_back(std::move(front));
+      }
+      tx_.pop_front();
+    }
+  }
+  set_want_write(false);
+  return {};
+}
+
+stdx::expected<size_t, std::string> MqttClient::poll(std::chrono::milliseconds timeout) {
+  if (socket_fd_ < 0) {
+    return stdx::unexpected("Not connected");
+  }
+
+  auto lost = [this](std::string_view reason) -> stdx::expected<size_t, std::string> {
+    close_socket();
+    return stdx::unexpected(std::format("Connection lost: {}", reason));
+  };
+
+  if (auto flushed = flush(); !flushed) {
+    return lost(flushed.error());
+  }
+
+  std::array<epoll_event, 4> events{};
+  int count = epoll_wait(epoll_fd_, events.data(), static_cast<int>(events.size()),
+                         static_cast<int>(timeout.count()));
+  if (count < 0) {
+    if (errno == EINTR) {
+      return 0;
+    }
+    return stdx::unexpected(std::format("epoll_wait failed: {}", errno_string()));
+  }
+
+  size_t dispatched = 0;
+  for (int i = 0; i < count && socket_fd_ >= 0; ++i) {
+    const auto& event = events[static_cast<size_t>(i)];
+    if (event.data.fd == timer_fd_) {
+      uint64_t expirations = 0;
+      (void)::read(timer_fd_, &expirations, sizeof(expirations));
+      if (auto alive = on_keepalive(); !alive) {
+        return lost(alive.error());
+      }
+      continue;
+    }
+
+    if (event.events & EPOLLIN) {
+      auto received = read_packets();
+      if (!received) {
+        return lost(received.error());
+      }
+      dispatched += *received;
+    } else if (event.events & (EPOLLERR | EPOLLHUP)) {
+      return lost("socket closed");
+    }
+  }
+
+  // Replies and publishes queued by the callbacks go out in the same batch
+  if (socket_fd_ >= 0) {
+    if (auto flushed = flush(); !flushed) {
+      return lost(flushed.error());
+    }
+  }
+  return dispatched;
+}
+
+std::vector<uint8_t>& MqttClient::new_frame() {
+  if (spare_frames_.empty()) {
+    tx_.emplace_back();
+  } else {
+    tx_.push_back(std::move(spare_frames_.back()));
+    spare_frames_.pop_back();
+    tx_.back().clear();
+  }
+  return tx_.back();
+}
+
+bool MqttClient::in_flight_full() const noexcept {
+  // Unacknowledged packets are never expired, so the limit is also what keeps
+  // next_packet_id() from running out of free identifiers
+  return pending_acks_.size() >= std::min(options_.max_in_flight, MAX_PACKET_IDS);
+}
+
+uint16_t MqttClient::next_packet_id() {
+  // Only called below the in-flight limit, so a free identifier exists
+  do {
+    last_packet_id_++;
+  } while (last_packet_id_ == 0 || pending_acks_.contains(last_packet_id_));
+  return last_packet_id_;
+}
+
+stdx::expected<void, std::string> MqttClient::queue_connect() {
+  const auto& will = options_.will;
+  if (options_.client_id.size() > 0xFFFF ||
+      (will && (will->topic.size() > 0xFFFF || will->payload.size() > 0xFFFF)) ||
+      (options_.username && options_.username->size() > 0xFFFF) ||
+      (options_.password && options_.password->size() > 0xFFFF)) {
+    return stdx::unexpected("CONNECT field too long");
+  }
+  if (will && (will->qos < 0 || will->qos > 1)) {
+    return stdx::unexpected("Only QoS 0 and 1 are supported");
+  }
+
+  uint8_t flags = options_.clean_session ? 0x02 : 0x00;
+  size_t remaining = 10 + 2 + options_.client_id.size();
+  if (will) {
+    flags |= static_cast<uint8_t>(0x04 | (will->qos << 3) | (will->retained ? 0x20 : 0));
+    remaining += 2 + will->topic.size() + 2 + will->payload.size();
+  }
+  if (options_.username) {
+    flags |= 0x80;
+    remaining += 2 + options_.username->size();
+  }
+  if (options_.password) {
+    flags |= 0x40;
+    remaining += 2 + options_.password->size();
+  }
+
+  // CONNECT goes ahead of anything left over from a previous session
+  tx_.clear();
+  tx_offset_ = 0;
+  queued_bytes_ = 0;
+  auto& frame = new_frame();
+  put_header(frame, CONNECT << 4, remaining);
+  put_string(frame, "MQTT");
+  frame.push_back(4); // Protocol level 3.1.1
+  frame.push_back(flags);
+  put_u16(frame,
+          static_cast<uint16_t>(std::clamp(options_.keep_alive_interval, 0, 0xFFFF)));
+  put_string(frame, options_.client_id);
+  if (will) {
+    put_string(frame, will->topic);
+    put_u16(frame, static_cast<uint16_t>(will->payload.size()));
+    frame.insert(frame.end(), will->payload.begin(), will->payload.end());
+  }
+  if (options_.username) {
+    put_string(frame, *options_.username);
+  }
+  if (options_.password) {
+    put_string(frame, *options_.password);
+  }
+  queued_bytes_ += frame.size();
+  return {};
+}
+
+stdx::expected<size_t, std::string> MqttClient::read_packets() {
+  size_t dispatched = 0;
+
+  while (socket_fd_ >= 0 && state_ != State::Disconnected) {
+    if (rx_len_ == rx_.size()) {
+      rx_.resize(rx_.size() * 2); // A packet larger than the buffer is arriving
+    }
+    ssize_t n = ::read(socket_fd_, rx_.data() + rx_len_, rx_.size() - rx_len_);
+    if (n == 0) {
+      return stdx::unexpected("closed by broker");
+    }
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        break;
+      }
+      return stdx::unexpected(std::format("Read failed: {}", errno_string()));
+    }
+    rx_len_ += static_cast<size_t>(n);
+    stats_.bytes_received += static_cast<uint64_t>(n);
+
+    // Decode every complete packet in place
+    size_t offset = 0;
+    while (socket_fd_ >= 0) {
+      size_t pos = offset + 1;
+      size_t remaining = 0;
+      size_t multiplier = 1;
+      bool complete = false;
+      for (int i = 0; i < 4 && pos < rx_len_; ++i) {
+        uint8_t digit = rx_[pos++];
+        remaining += (digit & 0x7F) * multiplier;
+        multiplier *= 128;
+        if ((digit & 0x80) == 0) {
+          complete = true;
+          break;
+        }
+        if (i == 3) {
+          return stdx::unexpected("Malformed remaining length");
+        }
+      }
+      if (!complete) {
+        break;
+      }
+      if (remaining > options_.max_packet_size) {
+        return stdx::unexpected(std::format("Packet of {} bytes too large", remaining));
+      }
+      if (rx_len_ - pos < remaining) {
+        if (pos - offset + remaining > rx_.size()) {
+          rx_.resize(pos - offset + remaining);
+        }
+        break;
+      }
+
+      auto handled = handle_packet(rx_[offset], {rx_.data() + pos, remaining});
+      if (!handled) {
+        return stdx::unexpected(handled.error());
+      }
+      dispatched += *handled;
+      offset = pos + remaining;
+    }
+
+    if (socket_fd_ < 0) {
+      break; // Disconnected from a callback
+    }
+    if (offset > 0) {
+      std::memmove(rx_.data(), rx_.data() + offset, rx_len_ - offset);
+      rx_len_ -= offset;
+    }
+  }
+  return dispatched;
+}
+
+stdx::expected<size_t, std::string>
+MqttClient::handle_packet(uint8_t header, std::span<const uint8_t> body) {
+  switch (header >> 4) {
+  case CONNACK:
+    if (body.size() < 2) {
+      return stdx::unexpected("Malformed CONNACK");
+    }
+    connack_code_ = body[1];
+    state_ = connack_code_ == 0 ? State::Connected : State::Disconnected;
+    return 0;
+
+  case PUBLISH: {
+    int qos = (header >> 1) & 0x03;
+    bool retained = (header & 0x01) != 0;
+    if (qos > 1) {
+      return stdx::unexpected("QoS 2 delivery is not supported");
+    }
+    if (body.size() < 2) {
+      return stdx::unexpected("Malformed PUBLISH");
+    }
+    size_t topic_length = get_u16(body, 0);
+    size_t pos = 2 + topic_length;
+    if (body.size() < pos + (qos > 0 ? 2 : 0)) {
+      return stdx::unexpected("Malformed PUBLISH");
+    }
+    std::string_view topic(reinterpret_cast<const char*>(body.data() + 2), topic_length);
+    uint16_t packet_id = 0;
+    if (qos > 0) {
+      packet_id = get_u16(body, pos);
+      pos += 2;
+    }
+
+    stats_.messages_received++;
+    if (message_callback_) {
+      message_callback_(topic, body.subspan(pos), qos, retained);
+    }
+    if (qos == 1 && socket_fd_ >= 0) {
+      auto& frame = new_frame();
+      put_header(frame, PUBACK << 4, 2);
+      put_u16(frame, packet_id);
+      queued_bytes_ += frame.size();
+    }
+    return 1;
+  }
+
+  case PUBACK:
+    if (body.size() < 2) {
+      return stdx::unexpected("Malformed PUBACK");
+    }
+    pending_acks_.erase(get_u16(body, 0));
+    return 0;
+
+  case SUBACK:
+    if (body.size() < 3) {
+      return stdx::unexpected("Malformed SUBACK");
+    }
+    pending_acks_.erase(get_u16(body, 0));
+    if (body[2] == 0x80) {
+      stats_.subscribe_failures++;
+    }
+    return 0;
+
+  case PINGRESP:
+    ping_outstanding_ = false;
+    return 0;
+
+  default:
+    return stdx::unexpected(std::format("Unexpected packet type {}", header >> 4));
+  }
+}
+
+stdx::expected<void, std::string> MqttClient::on_keepalive() {
+  auto now = std::chrono::steady_clock::now();
+  auto keep_alive = std::chrono::seconds(options_.keep_alive_interval);
+  if (ping_outstanding_) {
+    if (now - ping_sent_ >= keep_alive) {
+      return stdx::unexpected("keepalive timeout");
+    }
+    return {};
+  }
+  // Any packet sent resets the broker's keepalive timer; ping only when idle
+  if (now - last_write_ >= keep_alive / 2) {
+    put_header(new_frame(), PINGREQ << 4, 0);
+    queued_bytes_ += 2;
+    ping_outstanding_ = true;
+    ping_sent_ = now;
+  }
+  return {};
+}
+
+void MqttClient::set_want_write(bool enabled) {
+  if (enabled == want_write_ || socket_fd_ < 0) {
+    return;
+  }
+  epoll_event event{};
+  event.events = EPOLLIN | (enabled ? EPOLLOUT : 0u);
+  event.data.fd = socket_fd_;
+  if (epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, socket_fd_, &event) == 0) {
+    want_write_ = enabled;
+  }
+}
+
+void MqttClient::arm_keepalive(bool enabled) {
+  itimerspec spec{};
+  if (enabled && options_.keep_alive_interval > 0) {
+    // Check twice per interval so an idle connection pings well before expiry
+    auto half = std::chrono::milliseconds(options_.keep_alive_interval * 500);
+    spec.it_interval.tv_sec = static_cast<time_t>(half.count() / 1000);
+    spec.it_interval.tv_nsec = static_cast<long>((half.count() % 1000) * 1000000);
+    spec.it_value = spec.it_interval;
+  }
+  (void)timerfd_settime(timer_fd_, 0, &spec, nullptr);
+}
+
+void MqttClient::close_socket() {
+  if (socket_fd_ >= 0) {
+    (void)epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, socket_fd_, nullptr);
+    ::close(socket_fd_);
+    socket_fd_ = -1;
+  }
+  arm_keepalive(false);
+  state_ = State::Disconnected;
+  want_write_ = false;
+  while (!tx_.empty()) {
+    if (spare_frames_.size() < MAX_SPARE_FRAMES) {
+      spare_frames_.push_back(std::move(tx_.front()));
+    }
+    tx_.pop_front();
+  }
+  tx_offset_ = 0;
+  queued_bytes_ = 0;
+  rx_len_ = 0;
+  pending_acks_.clear();
+  ping_outstanding_ = false;
+}
+
+} // namespace sparkplug
@@ -0,0 +1,87 @@
+// src/node_state_budget.cpp
+#include "sparkplug/node_state_budget.hpp"
+
+#include <utility>
+
+namespace sparkplug {
+
+NodeStateBudget::NodeStateBudget(size_t budget_bytes) : budget_(budget_bytes) {
+}
+
+void NodeStateBudget::update(std::string_view group_id,
+                             std::string_view edge_node_id,
+                             size_t bytes,
+                             Residency residency) {
+  detail::NodeKeyView key{group_id, edge_node_id};
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    Entry entry{.node = {std::string(group_id), std::string(edge_node_id)}, .lru = {}};
+    it = entries_.emplace(detail::NodeKey(key), std::move(entry)).first;
+  }
+  auto& entry = it->second;
+  used_ = used_ - entry.bytes + bytes;
+  entry.bytes = bytes;
+
+  if (entry.residency == Residency::Offline) {
+    lru_.erase(entry.lru);
+    if (residency == Residency::Tombstone) {
+      evictions_++;
+    }
+  }
+  if (entry.residency == Residency::Tombstone) {
+    tombstones_--;
+  }
+  if (residency == Residency::Offline) {
+    entry.lru = lru_.insert(lru_.end(), &entry);
+  } else if (residency == Residency::Tombstone) {
+    tombstones_++;
+  }
+  entry.residency = residency;
+}
+
+void NodeStateBudget::erase(std::string_view group_id, std::string_view edge_node_id) {
+  auto it = entries_.find(detail::NodeKeyView{group_id, edge_node_id});
+  if (it == entries_.end()) {
+    return;
+  }
+  auto& entry = it->second;
+  used_ -= entry.bytes;
+  if (entry.residency == Residency::Offline) {
+    lru_.erase(entry.lru);
+  } else if (entry.residency == Residency::Tombstone) {
+    tombstones_--;
+  }
+  entries_.erase(it);
+}
+
+bool NodeStateBudget::contains(std::string_view group_id,
+                               std::string_view edge_node_id) const {
+  return entries_.contains(detail::NodeKeyView{group_id, edge_node_id});
+}
+
+const NodeStateBudget::Node* NodeStateBudget::victim() const {
+  if (budget_ == 0 || used_bytes() <= budget_ || lru_.empty()) {
+    return nullptr;
+  }
+  return &lru_.front()->node;
+}
+
+void NodeStateBudget::clear() {
+  entries_.clear();
+  lru_.clear();
+  used_ = 0;
+  shared_ = 0;
+  tombstones_ = 0;
+}
+
+NodeMemoryStats NodeStateBudget::stats() const {
+  return {.budget_bytes = budget_,
+          .used_bytes = used_bytes(),
+          .shared_bytes = shared_,
+          .nodes = entries_.size(),
+          .evictable = lru_.size(),
+          .tombstones = tombstones_,
+          .evictions = evictions_};
+}
+
+} // namespace sparkplug
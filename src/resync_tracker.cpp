@@ -0,0 +1,132 @@
+// src/resync_tracker.cpp
+#include "sparkplug/resync_tracker.hpp"
+
+#include <utility>
+
+namespace sparkplug {
+
+ResyncTracker::ResyncTracker() : ResyncTracker(Options{}) {
+}
+
+ResyncTracker::ResyncTracker(Options options, Clock::time_point start)
+    : options_(options),
+      bucket_(options.rebirths_per_second, static_cast<double>(options.burst), start) {
+}
+
+void ResyncTracker::mark(std::string_view group_id, std::string_view edge_node_id) {
+  if (entries_.contains(detail::NodeKeyView{group_id, edge_node_id})) {
+    return; // Already owed a rebirth or waiting for one
+  }
+  entries_.emplace(detail::NodeKey(std::string(group_id), std::string(edge_node_id)),
+                   Entry{.node = {std::string(group_id), std::string(edge_node_id)}});
+}
+
+bool ResyncTracker::tracked(std::string_view group_id,
+                            std::string_view edge_node_id) const {
+  return !entries_.empty() &&
+         entries_.contains(detail::NodeKeyView{group_id, edge_node_id});
+}
+
+bool ResyncTracker::pending(std::string_view group_id,
+                            std::string_view edge_node_id) const {
+  if (entries_.empty()) {
+    return false;
+  }
+  auto it = entries_.find(detail::NodeKeyView{group_id, edge_node_id});
+  return it != entries_.end() && it->second.state == State::Pending;
+}
+
+void ResyncTracker::confirm(std::string_view group_id, std::string_view edge_node_id) {
+  if (entries_.empty()) {
+    return;
+  }
+  auto it = entries_.find(detail::NodeKeyView{group_id, edge_node_id});
+  if (it == entries_.end()) {
+    return;
+  }
+  if (it->second.state == State::Pending) {
+    resumed_++;
+  }
+  entries_.erase(it); // Stale queue_/requested_ keys are skipped when reached
+}
+
+void ResyncTracker::forget(std::string_view group_id, std::string_view edge_node_id) {
+  if (entries_.empty()) {
+    return;
+  }
+  if (auto it = entries_.find(detail::NodeKeyView{group_id, edge_node_id});
+      it != entries_.end()) {
+    entries_.erase(it);
+  }
+}
+
+void ResyncTracker::broken(std::string_view group_id, std::string_view edge_node_id) {
+  auto it = entries_.find(detail::NodeKeyView{group_id, edge_node_id});
+  if (it == entries_.end()) {
+    it = entries_
+             .emplace(detail::NodeKey(std::string(group_id), std::string(edge_node_id)),
+                      Entry{.node = {std::string(group_id), std::string(edge_node_id)}})
+             .first;
+  }
+  if (it->second.state != State::Pending) {
+    return;
+  }
+  it->second.state = State::Queued;
+  queue_.push_back(it->first);
+}
+
+size_t ResyncTracker::poll(std::vector<Request>& out, Clock::time_point now) {
+  size_t before = out.size();
+  if (entries_.empty()) {
+    queue_.clear();
+    requested_.clear();
+    return 0;
+  }
+
+  // Requests left unanswered go to the back of the queue
+  while (!requested_.empty() && requested_.front().first + options_.retry_after <= now) {
+    auto it = entries_.find(requested_.front().second);
+    if (it != entries_.end() && it->second.state == State::Requested &&
+        it->second.requested_at == requested_.front().first) {
+      it->second.state = State::Queued;
+      queue_.push_back(it->first);
+    }
+    requested_.pop_front();
+  }
+
+  bucket_.refill(now);
+  while (!queue_.empty() && bucket_.can_consume(1.0)) {
+    auto it = entries_.find(queue_.front());
+    queue_.pop_front();
+    if (it == entries_.end() || it->second.state != State::Queued) {
+      continue;
+    }
+    it->second.state = State::Requested;
+    it->second.requested_at = now;
+    requested_.emplace_back(now, it->first);
+    out.push_back(it->second.node);
+    bucket_.consume(1.0);
+    rebirths_++;
+  }
+  return out.size() - before;
+}
+
+ResyncStats ResyncTracker::stats() const {
+  ResyncStats stats{.resumed = resumed_, .rebirths = rebirths_};
+  for (const auto& [key, entry] : entries_) {
+    switch (entry.state) {
+    case State::Pending:
+      stats.pending++;
+      break;
+    case State::Queued:
+      stats.queued++;
+      break;
+    case State::Requested:
+      stats.awaiting_birth++;
+      break;
+    }
+  }
+  return stats;
+}
+
+} // namespace sparkplug
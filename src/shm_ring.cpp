@@ -0,0 +1,510 @@
+// src/shm_ring.cpp
+#include "sparkplug/shm_ring.hpp"
+
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace sparkplug {
+
+namespace {
+
+constexpr uint64_t kRingMagic = 0x53504252494E4731ULL; // "SPBRING1"
+constexpr uint32_t kRingVersion = 1;
+constexpr size_t kMinCapacity = 4096;
+
+// Shared header at the start of the mapping. The writer reserves a region by
+// advancing reserve_pos before touching it and commits it by advancing write_pos;
+// readers use reserve_pos to detect frames overwritten while they were copying.
+struct RingHeader {
+  uint64_t magic;
+  uint32_t version;
+  uint32_t reserved;
+  uint64_t capacity;
+  alignas(64) std::atomic<uint64_t> reserve_pos;
+  alignas(64) std::atomic<uint64_t> write_pos;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "Shared-memory ring requires lock-free 64-bit atomics");
+
+constexpr size_t kDataOffset = 256;
+static_assert(sizeof(RingHeader) <= kDataOffset);
+
+enum class FrameKind : uint32_t { Message = 1, Padding = 2 };
+
+struct FrameHeader {
+  uint32_t length; // Body length in bytes (excluding this header)
+  FrameKind kind;
+};
+
+constexpr size_t kFrameAlign = 8;
+static_assert(sizeof(FrameHeader) == kFrameAlign);
+
+constexpr size_t frame_size(size_t body_length) noexcept {
+  return (sizeof(FrameHeader) + body_length + kFrameAlign - 1) & ~(kFrameAlign - 1);
+}
+
+// Value kinds follow the MetricValue variant index
+enum class ValueKind : uint8_t {
+  Null = 0,
+  Int = 1,
+  UInt = 2,
+  Double = 3,
+  Bool = 4,
+  String = 5
+};
+
+constexpr uint8_t kMessageHasSeq = 0x01;
+constexpr uint8_t kMetricHasAlias = 0x01;
+constexpr uint8_t kMetricHistorical = 0x02;
+
+template <typename T>
+void put(std::string& out, T value) {
+  static_assert(std::is_trivially_copyable_v<T>);
+  char buf[sizeof(T)];
+  std::memcpy(buf, &value, sizeof(T));
+  out.append(buf, sizeof(T));
+}
+
+void put_string(std::string& out, std::string_view str) {
+  put(out, static_cast<uint32_t>(str.size()));
+  out.append(str);
+}
+
+// Bounds-checked cursor over a frame body
+class FrameCursor {
+public:
+  explicit FrameCursor(std::span<const uint8_t> data) noexcept : data_(data) {
+  }
+
+  template <typename T>
+  bool get(T& value) noexcept {
+    if (data_.size() - pos_ < sizeof(T)) {
+      return false;
+    }
+    std::memcpy(&value, data_.data() + pos_, sizeof(T));
+    pos_ += sizeof(T);
+    return true;
+  }
+
+  bool get_string(std::string_view& value) noexcept {
+    uint32_t len = 0;
+    if (!get(len) || data_.size() - pos_ < len) {
+      return false;
+    }
+    value = {reinterpret_cast<const char*>(data_.data() + pos_), len};
+    pos_ += len;
+    return true;
+  }
+
+private:
+  std::span<const uint8_t> data_;
+  size_t pos_{0};
+};
+
+std::string errno_message() {
+  return std::strerror(errno);
+}
+
+} // namespace
+
+stdx::expected<ShmRingWriter, std::string> ShmRingWriter::create(std::string name,
+                                                                 size_t capacity) {
+  capacity = std::bit_ceil(std::max(capacity, kMinCapacity));
+
+  // Replace any stale segment; readers attached to it keep their old mapping
+  shm_unlink(name.c_str());
+  int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0) {
+    return stdx::unexpected(
+        std::format("Failed to create shared memory '{}': {}", name, errno_message()));
+  }
+
+  size_t mapping_size = kDataOffset + capacity;
+  if (ftruncate(fd, static_cast<off_t>(mapping_size)) != 0) {
+    auto error = errno_message();
+    close(fd);
+    shm_unlink(name.c_str());
+    return stdx::unexpected(
+        std::format("Failed to size shared memory '{}': {}", name, error));
+  }
+
+  void* mapping =
+      mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    auto error = errno_message();
+    shm_unlink(name.c_str());
+    return stdx::unexpected(
+        std::format("Failed to map shared memory '{}': {}", name, error));
+  }
+
+  auto* header = new (mapping) RingHeader{};
+  header->version = kRingVersion;
+  header->capacity = capacity;
+  header->reserve_pos.store(0, std::memory_order_relaxed);
+  header->write_pos.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  header->magic = kRingMagic;
+
+  ShmRingWriter writer;
+  writer.name_ = std::move(name);
+  writer.mapping_ = mapping;
+  writer.mapping_size_ = mapping_size;
+  writer.capacity_ = capacity;
+  return writer;
+}
+
+ShmRingWriter::~ShmRingWriter() {
+  release();
+}
+
+ShmRingWriter::ShmRingWriter(ShmRingWriter&& other) noexcept
+    : name_(std::move(other.name_)),
+      mapping_(std::exchange(other.mapping_, nullptr)),
+      mapping_size_(std::exchange(other.mapping_size_, 0)),
+      capacity_(std::exchange(other.capacity_, 0)),
+      position_(std::exchange(other.position_, 0)),
+      scratch_(std::move(other.scratch_)) {
+}
+
+ShmRingWriter& ShmRingWriter::operator=(ShmRingWriter&& other) noexcept {
+  if (this != &other) {
+    release();
+    name_ = std::move(other.name_);
+    mapping_ = std::exchange(other.mapping_, nullptr);
+    mapping_size_ = std::exchange(other.mapping_size_, 0);
+    capacity_ = std::exchange(other.capacity_, 0);
+    position_ = std::exchange(other.position_, 0);
+    scratch_ = std::move(other.scratch_);
+  }
+  return *this;
+}
+
+void ShmRingWriter::release() noexcept {
+  if (mapping_) {
+    munmap(mapping_, mapping_size_);
+    shm_unlink(name_.c_str());
+    mapping_ = nullptr;
+  }
+}
+
+stdx::expected<void, std::string>
+ShmRingWriter::publish(const Topic& topic,
+                       const org::eclipse::tahu::protobuf::Payload& payload,
+                       const std::unordered_map<uint64_t, std::string>* alias_map) {
+  scratch_.clear();
+  put(scratch_, static_cast<uint8_t>(topic.message_type));
+  put(scratch_, static_cast<uint8_t>(payload.has_seq() ? kMessageHasSeq : 0));
+  put(scratch_, uint16_t{0});
+  put(scratch_, static_cast<uint32_t>(payload.metrics_size()));
+  put(scratch_, payload.timestamp());
+  put(scratch_, payload.seq());
+  put_string(scratch_, topic.group_id);
+  put_string(scratch_, topic.edge_node_id);
+  put_string(scratch_, topic.device_id);
+
+  for (const auto& metric : payload.metrics()) {
+    std::string_view name = metric.name();
+    if (!metric.has_name() && metric.has_alias() && alias_map) {
+      if (auto it = alias_map->find(metric.alias()); it != alias_map->end()) {
+        name = it->second;
+      }
+    }
+
+    auto value = decode_metric_value(metric);
+    uint8_t flags = (metric.has_alias() ? kMetricHasAlias : 0) |
+                    (metric.is_historical() ? kMetricHistorical : 0);
+
+    put_string(scratch_, name);
+    put(scratch_, flags);
+    put(scratch_, static_cast<uint8_t>(value.index()));
+    put(scratch_, uint16_t{0});
+    put(scratch_, metric.datatype());
+    put(scratch_, metric.alias());
+    put(scratch_, metric.has_timestamp() ? metric.timestamp() : payload.timestamp());
+
+    std::visit(
+        [this](const auto& v) {
+          using T = std::decay_t<decltype(v)>;
+          if constexpr (std::is_same_v<T, std::monostate>) {
+            // No value bytes
+          } else if constexpr (std::is_same_v<T, bool>) {
+            put(scratch_, static_cast<uint8_t>(v ? 1 : 0));
+          } else if constexpr (std::is_same_v<T, std::string>) {
+            put_string(scratch_, v);
+          } else {
+            put(scratch_, v);
+          }
+        },
+        value);
+  }
+
+  return write(std::span<const uint8_t>(
+      reinterpret_cast<const uint8_t*>(scratch_.data()), scratch_.size()));
+}
+
+stdx::expected<void, std::string> ShmRingWriter::write(std::span<const uint8_t> frame) {
+  if (!mapping_) {
+    return stdx::unexpected("Shared memory ring is not open");
+  }
+
+  size_t total = frame_size(frame.size());
+  if (total > capacity_ / 2) {
+    return stdx::unexpected(std::format(
+        "Frame of {} bytes exceeds half the ring capacity ({} bytes)", frame.size(),
+        capacity_));
+  }
+
+  auto* header = static_cast<RingHeader*>(mapping_);
+  auto* data = static_cast<uint8_t*>(mapping_) + kDataOffset;
+
+  size_t offset = position_ & (capacity_ - 1);
+  size_t padding = capacity_ - offset < total ? capacity_ - offset : 0;
+  uint64_t end = position_ + padding + total;
+
+  // Announce the region before overwriting it (seqlock-style writer)
+  header->reserve_pos.store(end, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  if (padding > 0) {
+    FrameHeader pad{.length = static_cast<uint32_t>(padding - sizeof(FrameHeader)),
+                    .kind = FrameKind::Padding};
+    std::memcpy(data + offset, &pad, sizeof(pad));
+    offset = 0;
+  }
+
+  FrameHeader frame_header{.length = static_cast<uint32_t>(frame.size()),
+                           .kind = FrameKind::Message};
+  std::memcpy(data + offset, &frame_header, sizeof(frame_header));
+  std::memcpy(data + offset + sizeof(frame_header), frame.data(), frame.size());
+
+  header->write_pos.store(end, std::memory_order_release);
+  position_ = end;
+  return {};
+}
+
+stdx::expected<ShmRingReader, std::string> ShmRingReader::open(std::string name) {
+  int fd = shm_open(name.c_str(), O_RDONLY, 0);
+  if (fd < 0) {
+    return stdx::unexpected(
+        std::format("Failed to open shared memory '{}': {}", name, errno_message()));
+  }
+
+  struct stat st {};
+  if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < kDataOffset) {
+    close(fd);
+    return stdx::unexpected(std::format("Shared memory '{}' is not a ring", name));
+  }
+
+  auto mapping_size = static_cast<size_t>(st.st_size);
+  void* mapping = mmap(nullptr, mapping_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    return stdx::unexpected(
+        std::format("Failed to map shared memory '{}': {}", name, errno_message()));
+  }
+
+  const auto* header = static_cast<const RingHeader*>(mapping);
+  if (header->magic != kRingMagic || header->version != kRingVersion ||
+      header->capacity + kDataOffset != mapping_size) {
+    munmap(mapping, mapping_size);
+    return stdx::unexpected(
+        std::format("Shared memory '{}' has an incompatible ring layout", name));
+  }
+
+  ShmRingReader reader;
+  reader.mapping_ = mapping;
+  reader.mapping_size_ = mapping_size;
+  reader.capacity_ = header->capacity;
+  reader.position_ = header->write_pos.load(std::memory_order_acquire);
+  return reader;
+}
+
+ShmRingReader::~ShmRingReader() {
+  release();
+}
+
+ShmRingReader::ShmRingReader(ShmRingReader&& other) noexcept
+    : mapping_(std::exchange(other.mapping_, nullptr)),
+      mapping_size_(std::exchange(other.mapping_size_, 0)),
+      capacity_(std::exchange(other.capacity_, 0)),
+      position_(std::exchange(other.position_, 0)),
+      overruns_(std::exchange(other.overruns_, 0)),
+      frame_(std::move(other.frame_)),
+      metrics_(std::move(other.metrics_)) {
+}
+
+ShmRingReader& ShmRingReader::operator=(ShmRingReader&& other) noexcept {
+  if (this != &other) {
+    release();
+    mapping_ = std::exchange(other.mapping_, nullptr);
+    mapping_size_ = std::exchange(other.mapping_size_, 0);
+    capacity_ = std::exchange(other.capacity_, 0);
+    position_ = std::exchange(other.position_, 0);
+    overruns_ = std::exchange(other.overruns_, 0);
+    frame_ = std::move(other.frame_);
+    metrics_ = std::move(other.metrics_);
+  }
+  return *this;
+}
+
+void ShmRingReader::release() noexcept {
+  if (mapping_) {
+    munmap(const_cast<void*>(mapping_), mapping_size_);
+    mapping_ = nullptr;
+  }
+}
+
+std::optional<std::span<const uint8_t>> ShmRingReader::try_read_frame() {
+  if (!mapping_) {
+    return std::nullopt;
+  }
+
+  const auto* header = static_cast<const RingHeader*>(mapping_);
+  const auto* data = static_cast<const uint8_t*>(mapping_) + kDataOffset;
+
+  // True if the writer may have overwritten [position_, ...) since we read it
+  auto overwritten = [&] {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return header->reserve_pos.load(std::memory_order_relaxed) - position_ > capacity_;
+  };
+
+  while (true) {
+    uint64_t committed = header->write_pos.load(std::memory_order_acquire);
+    if (committed == position_) {
+      return std::nullopt;
+    }
+    if (committed - position_ > capacity_) {
+      overruns_++;
+      position_ = committed;
+      return std::nullopt;
+    }
+
+    size_t offset = position_ & (capacity_ - 1);
+    FrameHeader frame_header;
+    std::memcpy(&frame_header, data + offset, sizeof(frame_header));
+
+    size_t total = frame_header.kind == FrameKind::Padding
+                       ? capacity_ - offset
+                       : frame_size(frame_header.length);
+    bool well_formed = (frame_header.kind == FrameKind::Message ||
+                        frame_header.kind == FrameKind::Padding) &&
+                       total <= capacity_ - offset;
+
+    if (well_formed && frame_header.kind == FrameKind::Message) {
+      frame_.resize(frame_header.length);
+      std::memcpy(frame_.data(), data + offset + sizeof(frame_header),
+                  frame_header.length);
+    }
+
+    if (!well_formed || overwritten()) {
+      overruns_++;
+      position_ = header->write_pos.load(std::memory_order_acquire);
+      return std::nullopt;
+    }
+
+    position_ += total;
+    if (frame_header.kind == FrameKind::Message) {
+      return std::span<const uint8_t>(frame_);
+    }
+  }
+}
+
+std::optional<ShmMessage> ShmRingReader::try_read() {
+  while (auto frame = try_read_frame()) {
+    FrameCursor cursor(*frame);
+    ShmMessage message{};
+
+    uint8_t message_type = 0;
+    uint8_t flags = 0;
+    uint16_t reserved = 0;
+    uint32_t metric_count = 0;
+    uint64_t seq = 0;
+    bool ok = cursor.get(message_type) && cursor.get(flags) && cursor.get(reserved) &&
+              cursor.get(metric_count) && cursor.get(message.timestamp) &&
+              cursor.get(seq) && cursor.get_string(message.group_id) &&
+              cursor.get_string(message.edge_node_id) &&
+              cursor.get_string(message.device_id);
+    if (!ok) {
+      continue;
+    }
+    message.message_type = static_cast<MessageType>(message_type);
+    if (flags & kMessageHasSeq) {
+      message.seq = seq;
+    }
+
+    metrics_.clear();
+    for (uint32_t i = 0; ok && i < metric_count; ++i) {
+      auto& metric = metrics_.emplace_back();
+      uint8_t metric_flags = 0;
+      uint8_t kind = 0;
+      ok = cursor.get_string(metric.name) && cursor.get(metric_flags) &&
+           cursor.get(kind) && cursor.get(reserved) && cursor.get(metric.datatype) &&
+           cursor.get(metric.alias) && cursor.get(metric.timestamp);
+      if (!ok) {
+        break;
+      }
+      metric.has_alias = metric_flags & kMetricHasAlias;
+      metric.is_historical = metric_flags & kMetricHistorical;
+
+      switch (static_cast<ValueKind>(kind)) {
+      case ValueKind::Null:
+        break;
+      case ValueKind::Int: {
+        int64_t v = 0;
+        ok = cursor.get(v);
+        metric.value = v;
+        break;
+      }
+      case ValueKind::UInt: {
+        uint64_t v = 0;
+        ok = cursor.get(v);
+        metric.value = v;
+        break;
+      }
+      case ValueKind::Double: {
+        double v = 0.0;
+        ok = cursor.get(v);
+        metric.value = v;
+        break;
+      }
+      case ValueKind::Bool: {
+        uint8_t v = 0;
+        ok = cursor.get(v);
+        metric.value = v != 0;
+        break;
+      }
+      case ValueKind::String: {
+        std::string_view v;
+        ok = cursor.get_string(v);
+        metric.value = v;
+        break;
+      }
+      default:
+        ok = false;
+        break;
+      }
+    }
+    if (!ok) {
+      continue;
+    }
+
+    message.metrics = metrics_;
+    return message;
+  }
+  return std::nullopt;
+}
+
+} // namespace sparkplug
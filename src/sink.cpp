@@ -0,0 +1,357 @@
+// src/sink.cpp
+#include "sparkplug/sink.hpp"
+
+#include "sparkplug/datatype.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <format>
+#include <type_traits>
+#include <utility>
+
+namespace sparkplug {
+
+namespace {
+
+void append_csv_string(std::string& line, std::string_view value) {
+  line += '"';
+  for (char c : value) {
+    if (c == '"') {
+      line += '"';
+    }
+    line += c;
+  }
+  line += '"';
+}
+
+template <typename T>
+void append_number(std::string& line, T value) {
+  char buf[32];
+  auto [ptr, ec] = std::to_chars(buf, buf + sizeof(buf), value);
+  if (ec == std::errc{}) {
+    line.append(buf, ptr);
+  }
+}
+
+} // namespace
+
+MetricValue
+decode_metric_value(const org::eclipse::tahu::protobuf::Payload::Metric& metric) {
+  if (metric.has_is_null() && metric.is_null()) {
+    return std::monostate{};
+  }
+
+  switch (static_cast<DataType>(metric.datatype())) {
+  case DataType::Int8:
+    return static_cast<int64_t>(static_cast<int8_t>(metric.int_value()));
+  case DataType::Int16:
+    return static_cast<int64_t>(static_cast<int16_t>(metric.int_value()));
+  case DataType::Int32:
+    return static_cast<int64_t>(static_cast<int32_t>(metric.int_value()));
+  case DataType::Int64:
+    return static_cast<int64_t>(metric.long_value());
+  case DataType::UInt8:
+  case DataType::UInt16:
+  case DataType::UInt32:
+    return static_cast<uint64_t>(metric.int_value());
+  case DataType::UInt64:
+  case DataType::DateTime:
+    return static_cast<uint64_t>(metric.long_value());
+  case DataType::Float:
+    return static_cast<double>(metric.float_value());
+  case DataType::Double:
+    return metric.double_value();
+  case DataType::Boolean:
+    return metric.boolean_value();
+  case DataType::String:
+  case DataType::Text:
+  case DataType::UUID:
+    return metric.string_value();
+  default:
+    return std::monostate{};
+  }
+}
+
+std::optional<double>
+decode_metric_number(const org::eclipse::tahu::protobuf::Payload::Metric& metric) {
+  return std::visit(
+      [](const auto& value) -> std::optional<double> {
+        using T = std::decay_t<decltype(value)>;
+        if constexpr (std::is_same_v<T, bool>) {
+          return value ? 1.0 : 0.0;
+        } else if constexpr (std::is_arithmetic_v<T>) {
+          return static_cast<double>(value);
+        } else {
+          return std::nullopt;
+        }
+      },
+      decode_metric_value(metric));
+}
+
+void append_metric_records(const Topic& topic,
+                           const org::eclipse::tahu::protobuf::Payload& payload,
+                           const std::unordered_map<uint64_t, std::string>* alias_map,
+                           std::vector<MetricRecord>& out) {
+  switch (topic.message_type) {
+  case MessageType::NBIRTH:
+  case MessageType::DBIRTH:
+  case MessageType::NDATA:
+  case MessageType::DDATA:
+    break;
+  default:
+    return;
+  }
+
+  out.reserve(out.size() + static_cast<size_t>(payload.metrics_size()));
+
+  for (const auto& metric : payload.metrics()) {
+    MetricRecord record{.group_id = topic.group_id,
+                        .edge_node_id = topic.edge_node_id,
+                        .device_id = topic.device_id,
+                        .message_type = topic.message_type,
+                        .name = {},
+                        .alias = metric.alias(),
+                        .has_alias = metric.has_alias(),
+                        .datatype = metric.datatype(),
+                        .timestamp = metric.has_timestamp() ? metric.timestamp()
+                                                            : payload.timestamp(),
+                        .is_historical = metric.is_historical(),
+                        .value = decode_metric_value(metric)};
+
+    if (metric.has_name()) {
+      record.name = metric.name();
+    } else if (metric.has_alias() && alias_map) {
+      auto it = alias_map->find(metric.alias());
+      if (it != alias_map->end()) {
+        record.name = it->second;
+      }
+    }
+
+    out.push_back(std::move(record));
+  }
+}
+
+SinkPipeline::SinkPipeline(std::shared_ptr<Sink> sink,
+                           SinkOptions options,
+                           LogCallback log_callback)
+    : sink_(std::move(sink)), options_(options), log_callback_(std::move(log_callback)) {
+  if (options_.max_batch_size == 0) {
+    options_.max_batch_size = 1;
+  }
+  if (options_.high_water_mark == 0) {
+    options_.high_water_mark = options_.max_batch_size;
+  }
+  // A batch larger than the high-water mark would never fill while producers block
+  options_.max_batch_size = std::min(options_.max_batch_size, options_.high_water_mark);
+  if (options_.low_water_mark >= options_.high_water_mark) {
+    options_.low_water_mark = options_.high_water_mark / 2;
+  }
+  thread_ = std::thread([this] { run(); });
+}
+
+SinkPipeline::~SinkPipeline() {
+  stop();
+}
+
+size_t SinkPipeline::push(std::span<const MetricRecord> records) {
+  if (records.empty()) {
+    return 0;
+  }
+
+  size_t accepted = 0;
+  {
+    std::unique_lock lock(mutex_);
+    if (stopping_) {
+      return 0;
+    }
+
+    if (queue_.size() >= options_.high_water_mark) {
+      stats_.high_water_events++;
+
+      switch (options_.policy) {
+      case BackpressurePolicy::Block:
+        data_cv_.notify_one();
+        space_cv_.wait(lock, [this] {
+          return stopping_ || queue_.size() <= options_.low_water_mark;
+        });
+        if (stopping_) {
+          return 0;
+        }
+        break;
+      case BackpressurePolicy::DropNewest:
+        stats_.records_dropped += records.size();
+        return 0;
+      case BackpressurePolicy::DropOldest:
+        break;
+      }
+    }
+
+    for (const auto& record : records) {
+      if (options_.policy == BackpressurePolicy::DropOldest &&
+          queue_.size() >= options_.high_water_mark) {
+        queue_.pop_front();
+        stats_.records_dropped++;
+      }
+      queue_.push_back(record);
+      accepted++;
+    }
+    stats_.records_enqueued += accepted;
+
+    if (queue_.size() < options_.max_batch_size) {
+      return accepted;
+    }
+  }
+
+  data_cv_.notify_one();
+  return accepted;
+}
+
+void SinkPipeline::stop() {
+  {
+    std::scoped_lock lock(mutex_);
+    if (stopping_ && !thread_.joinable()) {
+      return;
+    }
+    stopping_ = true;
+  }
+  data_cv_.notify_all();
+  space_cv_.notify_all();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+SinkStats SinkPipeline::stats() const {
+  std::scoped_lock lock(mutex_);
+  SinkStats snapshot = stats_;
+  snapshot.queue_depth = queue_.size();
+  return snapshot;
+}
+
+void SinkPipeline::run() {
+  std::vector<MetricRecord> batch;
+  batch.reserve(options_.max_batch_size);
+  auto deadline = std::chrono::steady_clock::now() + options_.flush_interval;
+
+  while (true) {
+    bool done = false;
+    {
+      std::unique_lock lock(mutex_);
+      data_cv_.wait_until(lock, deadline, [this] {
+        return stopping_ || queue_.size() >= options_.max_batch_size;
+      });
+
+      size_t n = std::min(queue_.size(), options_.max_batch_size);
+      for (size_t i = 0; i < n; ++i) {
+        batch.push_back(std::move(queue_.front()));
+        queue_.pop_front();
+      }
+      done = stopping_ && queue_.empty();
+    }
+    space_cv_.notify_all();
+
+    if (!batch.empty()) {
+      write_batch(batch);
+      batch.clear();
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if (now >= deadline) {
+      deadline = now + options_.flush_interval;
+    }
+
+    if (done) {
+      break;
+    }
+  }
+
+  if (auto result = sink_->flush(); !result) {
+    std::scoped_lock lock(mutex_);
+    stats_.write_errors++;
+  }
+}
+
+void SinkPipeline::write_batch(std::vector<MetricRecord>& batch) {
+  auto result = sink_->write(batch).and_then([this] { return sink_->flush(); });
+
+  {
+    std::scoped_lock lock(mutex_);
+    if (result) {
+      stats_.records_written += batch.size();
+      stats_.batches_written++;
+    } else {
+      stats_.write_errors++;
+    }
+  }
+
+  if (!result && log_callback_) {
+    log_callback_(LogLevel::ERROR,
+                  std::format("Sink write of {} records failed: {}", batch.size(),
+                              result.error()));
+  }
+}
+
+FileSink::FileSink(std::string path, bool append)
+    : path_(std::move(path)), append_(append) {
+}
+
+stdx::expected<void, std::string> FileSink::write(std::span<const MetricRecord> batch) {
+  if (!out_.is_open()) {
+    out_.open(path_, append_ ? std::ios::app : std::ios::trunc);
+    if (!out_) {
+      return stdx::unexpected(std::format("Failed to open sink file: {}", path_));
+    }
+  }
+
+  for (const auto& record : batch) {
+    line_.clear();
+    append_number(line_, record.timestamp);
+    line_ += ',';
+    append_csv_string(line_, record.group_id);
+    line_ += ',';
+    append_csv_string(line_, record.edge_node_id);
+    line_ += ',';
+    append_csv_string(line_, record.device_id);
+    line_ += ',';
+    line_ += message_type_to_string(record.message_type);
+    line_ += ',';
+    append_csv_string(line_, record.name);
+    line_ += ',';
+    append_number(line_, record.datatype);
+    line_ += ',';
+    std::visit(
+        [this](const auto& value) {
+          using T = std::decay_t<decltype(value)>;
+          if constexpr (std::is_same_v<T, std::monostate>) {
+            // Null/unsupported values are written as an empty field
+          } else if constexpr (std::is_same_v<T, bool>) {
+            line_ += value ? "true" : "false";
+          } else if constexpr (std::is_same_v<T, std::string>) {
+            append_csv_string(line_, value);
+          } else {
+            append_number(line_, value);
+          }
+        },
+        record.value);
+    line_ += '\n';
+    out_.write(line_.data(), static_cast<std::streamsize>(line_.size()));
+  }
+
+  if (!out_) {
+    return stdx::unexpected(std::format("Failed to write sink file: {}", path_));
+  }
+  return {};
+}
+
+stdx::expected<void, std::string> FileSink::flush() {
+  if (!out_.is_open()) {
+    return {};
+  }
+  out_.flush();
+  if (!out_) {
+    return stdx::unexpected(std::format("Failed to flush sink file: {}", path_));
+  }
+  return {};
+}
+
+} // namespace sparkplug
@@ -0,0 +1,99 @@
+// src/stale_monitor.cpp
+#include "sparkplug/stale_monitor.hpp"
+
+namespace sparkplug {
+
+namespace {
+
+constexpr size_t WHEEL_SLOTS = 256; // Per level, 8 bits of the expiry tick each
+
+} // namespace
+
+StaleMonitor::StaleMonitor() : StaleMonitor(Options{}) {
+}
+
+StaleMonitor::StaleMonitor(Options options, Clock::time_point start)
+    : options_(options), wheel_(options.tick, WHEEL_SLOTS, start) {
+}
+
+void StaleMonitor::touch(std::string_view group_id,
+                         std::string_view edge_node_id,
+                         std::string_view device_id,
+                         Clock::time_point now) {
+  bool device = !device_id.empty();
+  if (device && options_.device_timeout.count() <= 0) {
+    return;
+  }
+
+  auto it = index_.find(detail::NodeKeyView{group_id, edge_node_id, device_id});
+  if (it != index_.end()) {
+    // The armed timer notices the new deadline when it fires
+    entries_[it->second].last_seen = now;
+    return;
+  }
+
+  uint32_t id;
+  if (!free_.empty()) {
+    id = free_.back();
+    free_.pop_back();
+  } else {
+    id = static_cast<uint32_t>(entries_.size());
+    entries_.emplace_back();
+  }
+  auto& entry = entries_[id];
+  entry.key = {std::string(group_id), std::string(edge_node_id), std::string(device_id)};
+  entry.last_seen = now;
+  entry.device = device;
+  index_.emplace(entry.key, id);
+  arm(id, now + (device ? options_.device_timeout : options_.node_timeout));
+}
+
+void StaleMonitor::arm(uint32_t id, Clock::time_point deadline) {
+  entries_[id].timer = wheel_.schedule_at(deadline, [this, id] { fired_.push_back(id); });
+}
+
+void StaleMonitor::remove(std::string_view group_id,
+                          std::string_view edge_node_id,
+                          std::string_view device_id) {
+  auto it = index_.find(detail::NodeKeyView{group_id, edge_node_id, device_id});
+  if (it == index_.end()) {
+    return;
+  }
+  uint32_t id = it->second;
+  wheel_.cancel(entries_[id].timer);
+  release(id);
+}
+
+void StaleMonitor::release(uint32_t id) {
+  auto& entry = entries_[id];
+  index_.erase(entry.key);
+  entry.key = {};
+  free_.push_back(id);
+}
+
+size_t StaleMonitor::expire(Clock::time_point now, std::vector<Expired>& out) {
+  if (now < wheel_.next_tick()) {
+    return 0;
+  }
+
+  size_t before = out.size();
+  fired_.clear();
+  wheel_.advance(now);
+  for (uint32_t id : fired_) {
+    auto& entry = entries_[id];
+    auto timeout = entry.device ? options_.device_timeout : options_.node_timeout;
+    auto deadline = entry.last_seen + timeout;
+    if (deadline > now) {
+      arm(id, deadline); // Touched since the timer was armed
+      continue;
+    }
+
+    out.push_back({.group_id = entry.key.group_id,
+                   .edge_node_id = entry.key.edge_node_id,
+                   .device_id = entry.key.device_id});
+    release(id);
+  }
+  return out.size() - before;
+}
+
+} // namespace sparkplug
@@ -0,0 +1,335 @@
+// src/state_replication.cpp
+#include "sparkplug/state_replication.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <utility>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace sparkplug {
+
+namespace {
+
+constexpr size_t kLengthPrefix = sizeof(uint32_t);
+constexpr size_t kMaxFrameSize = size_t{1} << 30;
+constexpr size_t kReadChunk = 65536;
+
+#ifdef MSG_NOSIGNAL
+constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+constexpr int kSendFlags = 0;
+#endif
+
+std::string errno_message() {
+  return std::strerror(errno);
+}
+
+stdx::expected<sockaddr_un, std::string> make_address(const std::string& path) {
+  sockaddr_un addr{};
+  if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+    return stdx::unexpected(std::format("Invalid socket path '{}'", path));
+  }
+  addr.sun_family = AF_UNIX;
+  std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+  return addr;
+}
+
+stdx::expected<void, std::string> write_all(int fd, std::span<const uint8_t> data) {
+  while (!data.empty()) {
+    ssize_t n = ::write(fd, data.data(), data.size());
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return stdx::unexpected(errno_message());
+    }
+    data = data.subspan(static_cast<size_t>(n));
+  }
+  return {};
+}
+
+} // namespace
+
+stdx::expected<ReplicationChannel, std::string>
+ReplicationChannel::listen(std::string socket_path) {
+  auto addr = make_address(socket_path);
+  if (!addr) {
+    return stdx::unexpected(addr.error());
+  }
+
+  ReplicationChannel channel;
+  channel.listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (channel.listen_fd_ < 0) {
+    return stdx::unexpected(std::format("Failed to create socket: {}", errno_message()));
+  }
+
+  ::unlink(socket_path.c_str());
+  if (::bind(channel.listen_fd_, reinterpret_cast<const sockaddr*>(&*addr),
+             sizeof(*addr)) != 0 ||
+      ::listen(channel.listen_fd_, 1) != 0) {
+    return stdx::unexpected(
+        std::format("Failed to listen on '{}': {}", socket_path, errno_message()));
+  }
+  channel.path_ = std::move(socket_path);
+  return channel;
+}
+
+stdx::expected<ReplicationChannel, std::string>
+ReplicationChannel::connect(std::string socket_path) {
+  auto addr = make_address(socket_path);
+  if (!addr) {
+    return stdx::unexpected(addr.error());
+  }
+
+  ReplicationChannel channel;
+  channel.peer_fd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (channel.peer_fd_ < 0) {
+    return stdx::unexpected(std::format("Failed to create socket: {}", errno_message()));
+  }
+  if (::connect(channel.peer_fd_, reinterpret_cast<const sockaddr*>(&*addr),
+                sizeof(*addr)) != 0) {
+    return stdx::unexpected(
+        std::format("Failed to connect to '{}': {}", socket_path, errno_message()));
+  }
+  return channel;
+}
+
+ReplicationChannel::~ReplicationChannel() {
+  release();
+}
+
+ReplicationChannel::ReplicationChannel(ReplicationChannel&& other) noexcept
+    : path_(std::move(other.path_)),
+      listen_fd_(std::exchange(other.listen_fd_, -1)),
+      peer_fd_(std::exchange(other.peer_fd_, -1)),
+      rx_(std::move(other.rx_)),
+      rx_len_(std::exchange(other.rx_len_, 0)),
+      consumed_(std::exchange(other.consumed_, 0)) {
+  other.path_.clear();
+}
+
+ReplicationChannel& ReplicationChannel::operator=(ReplicationChannel&& other) noexcept {
+  if (this != &other) {
+    release();
+    path_ = std::move(other.path_);
+    other.path_.clear();
+    listen_fd_ = std::exchange(other.listen_fd_, -1);
+    peer_fd_ = std::exchange(other.peer_fd_, -1);
+    rx_ = std::move(other.rx_);
+    rx_len_ = std::exchange(other.rx_len_, 0);
+    consumed_ = std::exchange(other.consumed_, 0);
+  }
+  return *this;
+}
+
+void ReplicationChannel::close_peer() noexcept {
+  if (peer_fd_ >= 0) {
+    ::close(peer_fd_);
+    peer_fd_ = -1;
+  }
+  rx_len_ = 0;
+  consumed_ = 0;
+}
+
+void ReplicationChannel::release() noexcept {
+  close_peer();
+  if (listen_fd_ >= 0) {
+    ::close(listen_fd_);
+    listen_fd_ = -1;
+    ::unlink(path_.c_str());
+  }
+}
+
+stdx::expected<void, std::string>
+ReplicationChannel::send(std::span<const uint8_t> frame) {
+  if (peer_fd_ < 0) {
+    return stdx::unexpected("Replication channel is not connected");
+  }
+  if (frame.size() > kMaxFrameSize) {
+    return stdx::unexpected(std::format("Frame of {} bytes is too large", frame.size()));
+  }
+
+  auto length = static_cast<uint32_t>(frame.size());
+  uint8_t prefix[kLengthPrefix];
+  std::memcpy(prefix, &length, kLengthPrefix);
+
+  // Prefix and frame go out in one call; partial writes resume where they stopped
+  size_t sent = 0;
+  size_t total = kLengthPrefix + frame.size();
+  while (sent < total) {
+    iovec iov[2];
+    int count = 0;
+    if (sent < kLengthPrefix) {
+      iov[count++] = {.iov_base = prefix + sent, .iov_len = kLengthPrefix - sent};
+    }
+    size_t frame_offset = sent > kLengthPrefix ? sent - kLengthPrefix : 0;
+    iov[count++] = {.iov_base = const_cast<uint8_t*>(frame.data()) + frame_offset,
+                    .iov_len = frame.size() - frame_offset};
+
+    msghdr msg{};
+    msg.msg_iov = iov;
+    msg.msg_iovlen = static_cast<decltype(msg.msg_iovlen)>(count);
+    ssize_t n = ::sendmsg(peer_fd_, &msg, kSendFlags);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      auto error = errno_message();
+      close_peer();
+      return stdx::unexpected(std::format("Replication send failed: {}", error));
+    }
+    sent += static_cast<size_t>(n);
+  }
+  return {};
+}
+
+stdx::expected<std::optional<std::span<const uint8_t>>, std::string>
+ReplicationChannel::receive(std::chrono::milliseconds timeout) {
+  // Drop the frame handed out by the previous call
+  if (consumed_ > 0) {
+    std::memmove(rx_.data(), rx_.data() + consumed_, rx_len_ - consumed_);
+    rx_len_ -= consumed_;
+    consumed_ = 0;
+  }
+
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (true) {
+    if (rx_len_ >= kLengthPrefix) {
+      uint32_t length = 0;
+      std::memcpy(&length, rx_.data(), kLengthPrefix);
+      if (length > kMaxFrameSize) {
+        close_peer();
+        return stdx::unexpected(
+            std::format("Received frame length {} is invalid", length));
+      }
+      if (rx_len_ >= kLengthPrefix + length) {
+        consumed_ = kLengthPrefix + length;
+        return std::span<const uint8_t>(rx_.data() + kLengthPrefix, length);
+      }
+      rx_.resize(std::max(rx_.size(), kLengthPrefix + length));
+    }
+
+    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+        deadline - std::chrono::steady_clock::now());
+    pollfd fds[2];
+    nfds_t count = 0;
+    if (peer_fd_ >= 0) {
+      fds[count++] = {.fd = peer_fd_, .events = POLLIN, .revents = 0};
+    }
+    if (listen_fd_ >= 0) {
+      fds[count++] = {.fd = listen_fd_, .events = POLLIN, .revents = 0};
+    }
+    if (count == 0) {
+      return stdx::unexpected("Replication channel is not connected");
+    }
+    int wait_ms = static_cast<int>(std::max<int64_t>(remaining.count(), 0));
+    int ready = ::poll(fds, count, wait_ms);
+    if (ready < 0 && errno != EINTR) {
+      return stdx::unexpected(
+          std::format("Replication poll failed: {}", errno_message()));
+    }
+    if (ready <= 0) {
+      if (std::chrono::steady_clock::now() >= deadline) {
+        return std::nullopt;
+      }
+      continue;
+    }
+
+    // A new active host replaces the current connection
+    if (listen_fd_ >= 0 && (fds[count - 1].revents & POLLIN)) {
+      int fd = ::accept(listen_fd_, nullptr, nullptr);
+      if (fd >= 0) {
+        close_peer();
+        peer_fd_ = fd;
+        continue;
+      }
+    }
+
+    if (peer_fd_ >= 0 && fds[0].fd == peer_fd_ && fds[0].revents != 0) {
+      if (rx_.size() - rx_len_ < kReadChunk) {
+        rx_.resize(rx_len_ + kReadChunk);
+      }
+      ssize_t n =
+          ::recv(peer_fd_, rx_.data() + rx_len_, rx_.size() - rx_len_, MSG_DONTWAIT);
+      if (n == 0) {
+        close_peer(); // Keep waiting: a replacement active host may connect
+        continue;
+      }
+      if (n < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+          continue;
+        }
+        auto error = errno_message();
+        close_peer();
+        return stdx::unexpected(std::format("Replication receive failed: {}", error));
+      }
+      rx_len_ += static_cast<size_t>(n);
+    }
+  }
+}
+
+stdx::expected<void, std::string> write_state_file(const std::string& path,
+                                                   std::span<const uint8_t> frame) {
+  std::string tmp_path = path + ".tmp";
+  int fd = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+  if (fd < 0) {
+    return stdx::unexpected(
+        std::format("Failed to create '{}': {}", tmp_path, errno_message()));
+  }
+  auto written = write_all(fd, frame);
+  if (written && ::fsync(fd) != 0) {
+    written = stdx::unexpected(errno_message());
+  }
+  ::close(fd);
+  if (!written) {
+    ::unlink(tmp_path.c_str());
+    return stdx::unexpected(
+        std::format("Failed to write '{}': {}", tmp_path, written.error()));
+  }
+  if (::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    auto error = errno_message();
+    ::unlink(tmp_path.c_str());
+    return stdx::unexpected(std::format("Failed to replace '{}': {}", path, error));
+  }
+  return {};
+}
+
+stdx::expected<std::vector<uint8_t>, std::string>
+read_state_file(const std::string& path) {
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return stdx::unexpected(
+        std::format("Failed to open '{}': {}", path, errno_message()));
+  }
+  std::vector<uint8_t> data;
+  size_t len = 0;
+  while (true) {
+    data.resize(len + kReadChunk);
+    ssize_t n = ::read(fd, data.data() + len, kReadChunk);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n < 0) {
+      auto error = errno_message();
+      ::close(fd);
+      return stdx::unexpected(std::format("Failed to read '{}': {}", path, error));
+    }
+    if (n == 0) {
+      break;
+    }
+    len += static_cast<size_t>(n);
+  }
+  ::close(fd);
+  data.resize(len);
+  return data;
+}
+
+} // namespace sparkplug
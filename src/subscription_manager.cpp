@@ -0,0 +1,263 @@
+// src/subscription_manager.cpp
+#include "sparkplug/subscription_manager.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace sparkplug {
+
+namespace {
+
+constexpr int SUBACK_FAILURE = 0x80;
+
+} // namespace
+
+SubscriptionManager::SubscriptionManager() : SubscriptionManager(Options{}) {
+}
+
+SubscriptionManager::SubscriptionManager(Options options) : options_(options) {
+  options_.max_batch = std::max<size_t>(options_.max_batch, 1);
+}
+
+void SubscriptionManager::enqueue(EntryMap::iterator it) {
+  if (!it->second.queued) {
+    it->second.queued = true;
+    dirty_.push_back(it->first);
+  }
+}
+
+bool SubscriptionManager::add(std::string_view topic, int qos) {
+  auto it = entries_.find(topic);
+  if (it == entries_.end()) {
+    it = entries_.emplace(std::string(topic), Entry{.qos = qos}).first;
+    enqueue(it);
+    return true;
+  }
+  auto& entry = it->second;
+  entry.desired = true;
+  entry.qos = qos;
+  if (entry.state == SubscriptionState::Failed) {
+    entry.state = SubscriptionState::Pending; // Asking again retries
+  }
+  enqueue(it);
+  bool granted_or_asked = entry.state == SubscriptionState::Active ||
+                          (entry.state == SubscriptionState::InFlight &&
+                           !entry.unsubscribing);
+  return !granted_or_asked || entry.requested_qos != qos;
+}
+
+bool SubscriptionManager::remove(std::string_view topic) {
+  auto it = entries_.find(topic);
+  if (it == entries_.end() || !it->second.desired) {
+    return false;
+  }
+  auto& entry = it->second;
+  if (entry.state == SubscriptionState::Pending ||
+      entry.state == SubscriptionState::Failed) {
+    entries_.erase(it); // Nothing to undo on the broker
+    return true;
+  }
+  entry.desired = false;
+  enqueue(it);
+  return true;
+}
+
+size_t SubscriptionManager::plan(std::vector<Batch>& out) {
+  size_t before = out.size();
+  Batch subscribe;
+  Batch unsubscribe;
+  auto flush = [&](Batch& batch) {
+    if (batch.topics.empty()) {
+      return;
+    }
+    in_flight_.emplace(batch.id, batch.topics);
+    out.push_back(std::move(batch));
+    batch = Batch{};
+    batches_++;
+  };
+  auto append = [&](Batch& batch, bool is_unsubscribe, const std::string& topic,
+                    Entry& entry) {
+    if (batch.topics.empty()) {
+      batch.id = next_batch_++;
+      batch.unsubscribe = is_unsubscribe;
+    }
+    batch.topics.push_back(topic);
+    if (!is_unsubscribe) {
+      batch.qos.push_back(entry.qos);
+      entry.requested_qos = entry.qos;
+    }
+    entry.state = SubscriptionState::InFlight;
+    entry.unsubscribing = is_unsubscribe;
+    entry.batch = batch.id;
+    if (batch.topics.size() >= options_.max_batch) {
+      flush(batch);
+    }
+  };
+
+  for (const auto& topic : dirty_) {
+    auto it = entries_.find(topic);
+    if (it == entries_.end()) {
+      continue;
+    }
+    auto& entry = it->second;
+    entry.queued = false;
+    if (entry.state == SubscriptionState::InFlight) {
+      continue; // Revisited when the request completes
+    }
+    if (entry.desired) {
+      bool resubscribe = entry.state == SubscriptionState::Active &&
+                         entry.requested_qos != entry.qos;
+      if (entry.state == SubscriptionState::Pending || resubscribe) {
+        append(subscribe, false, it->first, entry);
+      }
+    } else if (entry.state == SubscriptionState::Active) {
+      append(unsubscribe, true, it->first, entry);
+    } else {
+      entries_.erase(it);
+    }
+  }
+  dirty_.clear();
+  flush(subscribe);
+  flush(unsubscribe);
+  return out.size() - before;
+}
+
+void SubscriptionManager::settle(EntryMap::iterator it) {
+  const auto& entry = it->second;
+  if (!entry.desired ||
+      (entry.state == SubscriptionState::Active && entry.requested_qos != entry.qos)) {
+    enqueue(it);
+  }
+}
+
+void SubscriptionManager::on_subscribed(uint64_t batch_id, std::span<const int> granted) {
+  auto batch = in_flight_.find(batch_id);
+  if (batch == in_flight_.end()) {
+    return; // Superseded by reset()
+  }
+  const auto& topics = batch->second;
+  for (size_t i = 0; i < topics.size(); ++i) {
+    auto it = entries_.find(topics[i]);
+    if (it == entries_.end() || it->second.batch != batch_id ||
+        it->second.state != SubscriptionState::InFlight) {
+      continue;
+    }
+    auto& entry = it->second;
+    int qos = granted.empty() ? entry.requested_qos
+                              : (i < granted.size() ? granted[i] : SUBACK_FAILURE);
+    if (qos < 0 || qos >= SUBACK_FAILURE) {
+      entry.state = SubscriptionState::Failed;
+      refusals_++;
+    } else {
+      entry.state = SubscriptionState::Active;
+    }
+    settle(it);
+  }
+  in_flight_.erase(batch);
+}
+
+void SubscriptionManager::on_unsubscribed(uint64_t batch_id) {
+  auto batch = in_flight_.find(batch_id);
+  if (batch == in_flight_.end()) {
+    return;
+  }
+  for (const auto& topic : batch->second) {
+    auto it = entries_.find(topic);
+    if (it == entries_.end() || it->second.batch != batch_id ||
+        it->second.state != SubscriptionState::InFlight) {
+      continue;
+    }
+    if (it->second.desired) {
+      it->second.state = SubscriptionState::Pending; // Asked for again meanwhile
+      enqueue(it);
+    } else {
+      entries_.erase(it);
+    }
+  }
+  in_flight_.erase(batch);
+}
+
+void SubscriptionManager::on_failed(uint64_t batch_id) {
+  auto batch = in_flight_.find(batch_id);
+  if (batch == in_flight_.end()) {
+    return;
+  }
+  for (const auto& topic : batch->second) {
+    auto it = entries_.find(topic);
+    if (it == entries_.end() || it->second.batch != batch_id ||
+        it->second.state != SubscriptionState::InFlight) {
+      continue;
+    }
+    auto& entry = it->second;
+    // A failed UNSUBSCRIBE leaves the subscription in place
+    entry.state = entry.unsubscribing ? SubscriptionState::Active
+                                      : SubscriptionState::Failed;
+    settle(it);
+  }
+  in_flight_.erase(batch);
+}
+
+void SubscriptionManager::reset() {
+  in_flight_.clear();
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    if (!it->second.desired) {
+      it = entries_.erase(it);
+      continue;
+    }
+    it->second.state = SubscriptionState::Pending;
+    it->second.unsubscribing = false;
+    enqueue(it);
+    ++it;
+  }
+}
+
+SubscriptionState SubscriptionManager::state(std::string_view topic) const {
+  auto it = entries_.find(topic);
+  if (it == entries_.end() || !it->second.desired) {
+    return SubscriptionState::None;
+  }
+  return it->second.state;
+}
+
+SubscriptionStats SubscriptionManager::stats() const {
+  SubscriptionStats stats{.batches = batches_, .refusals = refusals_};
+  for (const auto& [topic, entry] : entries_) {
+    if (!entry.desired) {
+      continue;
+    }
+    stats.desired++;
+    switch (entry.state) {
+    case SubscriptionState::Active:
+      stats.active++;
+      break;
+    case SubscriptionState::Failed:
+      stats.failed++;
+      break;
+    default:
+      stats.pending++;
+      break;
+    }
+  }
+  return stats;
+}
+
+bool SubscriptionManager::settled() const {
+  return std::ranges::none_of(entries_, [](const auto& item) {
+    const auto& entry = item.second;
+    return !entry.desired || entry.state == SubscriptionState::Pending ||
+           entry.state == SubscriptionState::InFlight;
+  });
+}
+
+std::vector<std::string> SubscriptionManager::failed_topics() const {
+  std::vector<std::string> topics;
+  for (const auto& [topic, entry] : entries_) {
+    if (entry.desired && entry.state == SubscriptionState::Failed) {
+      topics.push_back(topic);
+    }
+  }
+  std::ranges::sort(topics);
+  return topics;
+}
+
+} // namespace sparkplug
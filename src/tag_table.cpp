@@ -0,0 +1,431 @@
+// src/tag_table.cpp
+#include "sparkplug/tag_table.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <new>
+#include <thread>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace sparkplug {
+
+namespace {
+
+constexpr uint64_t kTableMagic = 0x5350425441475331ULL; // "SPBTAGS1"
+constexpr uint32_t kTableVersion = 1;
+
+struct TableHeader {
+  uint64_t magic;
+  uint32_t version;
+  uint32_t reserved;
+  uint64_t slot_count;
+  alignas(64) std::atomic<uint64_t> generation;
+};
+
+// One cache-line pair per slot so drivers writing neighbouring tags do not
+// false-share. seq is odd while a write is in progress; seq / 2 is the number of
+// completed writes.
+struct alignas(64) TagSlot {
+  std::atomic<uint64_t> seq;
+  std::atomic<uint64_t> bits;
+  std::atomic<uint64_t> timestamp;
+  uint64_t alias;
+  uint32_t datatype;
+  uint32_t name_length;
+  char name[TagTable::kMaxNameLength + 1];
+};
+
+// A write holds its slot for three stores. A slot still locked after this long
+// belongs to a writer that died mid-write (see TagTable::recover()).
+constexpr auto kLockTimeout = std::chrono::milliseconds(100);
+constexpr unsigned kSpinsBeforeYield = 64;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "Shared-memory tag table requires lock-free 64-bit atomics");
+static_assert(sizeof(TagSlot) == 128);
+
+constexpr size_t kSlotsOffset = 128;
+static_assert(sizeof(TableHeader) <= kSlotsOffset);
+
+bool is_supported(DataType datatype) noexcept {
+  switch (datatype) {
+  case DataType::Int8:
+  case DataType::Int16:
+  case DataType::Int32:
+  case DataType::Int64:
+  case DataType::UInt8:
+  case DataType::UInt16:
+  case DataType::UInt32:
+  case DataType::UInt64:
+  case DataType::Float:
+  case DataType::Double:
+  case DataType::Boolean:
+  case DataType::DateTime:
+    return true;
+  default:
+    return false;
+  }
+}
+
+TableHeader* header_of(void* mapping) noexcept {
+  return static_cast<TableHeader*>(mapping);
+}
+
+TagSlot* slots_of(void* mapping) noexcept {
+  return reinterpret_cast<TagSlot*>(static_cast<char*>(mapping) + kSlotsOffset);
+}
+
+void set_value(org::eclipse::tahu::protobuf::Payload::Metric* metric,
+               DataType datatype,
+               uint64_t bits) {
+  switch (datatype) {
+  case DataType::Int8:
+  case DataType::Int16:
+  case DataType::Int32:
+  case DataType::UInt8:
+  case DataType::UInt16:
+  case DataType::UInt32:
+    metric->set_int_value(static_cast<uint32_t>(bits));
+    break;
+  case DataType::Float:
+    metric->set_float_value(std::bit_cast<float>(static_cast<uint32_t>(bits)));
+    break;
+  case DataType::Double:
+    metric->set_double_value(std::bit_cast<double>(bits));
+    break;
+  case DataType::Boolean:
+    metric->set_boolean_value(bits != 0);
+    break;
+  default: // Int64, UInt64, DateTime
+    metric->set_long_value(bits);
+    break;
+  }
+}
+
+// Waits for an odd (locked) slot seq to become even, reloading `seq`. Spins
+// briefly, then yields; false if the slot stays locked for kLockTimeout.
+bool wait_unlocked(const std::atomic<uint64_t>& slot_seq, uint64_t& seq) noexcept {
+  std::chrono::steady_clock::time_point deadline{};
+  for (unsigned spins = 0; (seq & 1) != 0; ++spins) {
+    if (spins >= kSpinsBeforeYield) {
+      auto now = std::chrono::steady_clock::now();
+      if (spins == kSpinsBeforeYield) {
+        deadline = now + kLockTimeout;
+      } else if (now >= deadline) {
+        return false;
+      }
+      std::this_thread::yield();
+    }
+    seq = slot_seq.load(std::memory_order_acquire);
+  }
+  return true;
+}
+
+std::string errno_message() {
+  return std::strerror(errno);
+}
+
+} // namespace
+
+stdx::expected<TagTable, std::string>
+TagTable::create(std::string name, std::span<const TagDefinition> tags) {
+  for (const auto& tag : tags) {
+    if (tag.name.empty() || tag.name.size() > kMaxNameLength) {
+      return stdx::unexpected(
+          std::format("Tag name '{}' must be 1-{} bytes", tag.name, kMaxNameLength));
+    }
+    if (!is_supported(tag.datatype)) {
+      return stdx::unexpected(std::format("Tag '{}' has unsupported datatype {}",
+                                          tag.name, std::to_underlying(tag.datatype)));
+    }
+  }
+
+  shm_unlink(name.c_str());
+  int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0) {
+    return stdx::unexpected(
+        std::format("Failed to create shared memory '{}': {}", name, errno_message()));
+  }
+
+  size_t mapping_size = kSlotsOffset + tags.size() * sizeof(TagSlot);
+  if (ftruncate(fd, static_cast<off_t>(mapping_size)) != 0) {
+    auto error = errno_message();
+    close(fd);
+    shm_unlink(name.c_str());
+    return stdx::unexpected(
+        std::format("Failed to size shared memory '{}': {}", name, error));
+  }
+
+  void* mapping =
+      mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    auto error = errno_message();
+    shm_unlink(name.c_str());
+    return stdx::unexpected(
+        std::format("Failed to map shared memory '{}': {}", name, error));
+  }
+
+  auto* header = new (mapping) TableHeader{};
+  header->version = kTableVersion;
+  header->slot_count = tags.size();
+  header->generation.store(0, std::memory_order_relaxed);
+
+  auto* slots = slots_of(mapping);
+  for (size_t i = 0; i < tags.size(); ++i) {
+    auto* slot = new (&slots[i]) TagSlot{};
+    slot->alias = tags[i].alias;
+    slot->datatype = std::to_underlying(tags[i].datatype);
+    slot->name_length = static_cast<uint32_t>(tags[i].name.size());
+    std::memcpy(slot->name, tags[i].name.data(), tags[i].name.size());
+  }
+
+  std::atomic_thread_fence(std::memory_order_release);
+  header->magic = kTableMagic;
+
+  TagTable table;
+  table.name_ = std::move(name);
+  table.mapping_ = mapping;
+  table.mapping_size_ = mapping_size;
+  table.slot_count_ = tags.size();
+  table.owner_ = true;
+  return table;
+}
+
+stdx::expected<TagTable, std::string> TagTable::open(std::string name) {
+  int fd = shm_open(name.c_str(), O_RDWR, 0);
+  if (fd < 0) {
+    return stdx::unexpected(
+        std::format("Failed to open shared memory '{}': {}", name, errno_message()));
+  }
+
+  struct stat st {};
+  if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < kSlotsOffset) {
+    close(fd);
+    return stdx::unexpected(std::format("Shared memory '{}' is not a tag table", name));
+  }
+
+  auto mapping_size = static_cast<size_t>(st.st_size);
+  void* mapping =
+      mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    return stdx::unexpected(
+        std::format("Failed to map shared memory '{}': {}", name, errno_message()));
+  }
+
+  const auto* header = header_of(mapping);
+  if (header->magic != kTableMagic || header->version != kTableVersion ||
+      kSlotsOffset + header->slot_count * sizeof(TagSlot) != mapping_size) {
+    munmap(mapping, mapping_size);
+    return stdx::unexpected(
+        std::format("Shared memory '{}' has an incompatible tag table layout", name));
+  }
+
+  TagTable table;
+  table.name_ = std::move(name);
+  table.mapping_ = mapping;
+  table.mapping_size_ = mapping_size;
+  table.slot_count_ = header->slot_count;
+  return table;
+}
+
+TagTable::~TagTable() {
+  release();
+}
+
+TagTable::TagTable(TagTable&& other) noexcept
+    : name_(std::move(other.name_)),
+      mapping_(std::exchange(other.mapping_, nullptr)),
+      mapping_size_(std::exchange(other.mapping_size_, 0)),
+      slot_count_(std::exchange(other.slot_count_, 0)),
+      owner_(std::exchange(other.owner_, false)) {
+}
+
+TagTable& TagTable::operator=(TagTable&& other) noexcept {
+  if (this != &other) {
+    release();
+    name_ = std::move(other.name_);
+    mapping_ = std::exchange(other.mapping_, nullptr);
+    mapping_size_ = std::exchange(other.mapping_size_, 0);
+    slot_count_ = std::exchange(other.slot_count_, 0);
+    owner_ = std::exchange(other.owner_, false);
+  }
+  return *this;
+}
+
+void TagTable::release() noexcept {
+  if (mapping_) {
+    munmap(mapping_, mapping_size_);
+    if (owner_) {
+      shm_unlink(name_.c_str());
+    }
+    mapping_ = nullptr;
+  }
+}
+
+std::optional<size_t> TagTable::find(std::string_view name) const noexcept {
+  if (!mapping_) {
+    return std::nullopt;
+  }
+  const auto* slots = slots_of(mapping_);
+  for (size_t i = 0; i < slot_count_; ++i) {
+    if (std::string_view(slots[i].name, slots[i].name_length) == name) {
+      return i;
+    }
+  }
+  return std::nullopt;
+}
+
+TagDefinition TagTable::definition(size_t slot) const {
+  const auto& s = slots_of(mapping_)[slot];
+  return {.name = std::string(s.name, s.name_length),
+          .datatype = static_cast<DataType>(s.datatype),
+          .alias = s.alias};
+}
+
+stdx::expected<void, std::string>
+TagTable::store(size_t slot, DataType datatype, uint64_t bits, uint64_t timestamp_ms) {
+  if (!mapping_ || slot >= slot_count_) {
+    return stdx::unexpected(std::format("Invalid tag slot {}", slot));
+  }
+
+  auto& s = slots_of(mapping_)[slot];
+  auto slot_type = static_cast<DataType>(s.datatype);
+  // DateTime slots are written as uint64_t
+  if (slot_type != datatype &&
+      !(slot_type == DataType::DateTime && datatype == DataType::UInt64)) {
+    return stdx::unexpected(std::format("Tag slot {} expects datatype {}, got {}", slot,
+                                        s.datatype, std::to_underlying(datatype)));
+  }
+
+  // Acquire the slot's sequence lock (odd = write in progress)
+  uint64_t seq = s.seq.load(std::memory_order_relaxed);
+  do {
+    if (!wait_unlocked(s.seq, seq)) {
+      return stdx::unexpected(
+          std::format("Tag slot {} is held by an unfinished write", slot));
+    }
+  } while (!s.seq.compare_exchange_weak(seq, seq + 1, std::memory_order_acquire,
+                                        std::memory_order_relaxed));
+  std::atomic_thread_fence(std::memory_order_release);
+
+  s.bits.store(bits, std::memory_order_relaxed);
+  s.timestamp.store(timestamp_ms, std::memory_order_relaxed);
+  s.seq.store(seq + 2, std::memory_order_release);
+
+  header_of(mapping_)->generation.fetch_add(1, std::memory_order_release);
+  return {};
+}
+
+std::optional<TagSample> TagTable::read(size_t slot) const noexcept {
+  if (!mapping_ || slot >= slot_count_) {
+    return std::nullopt;
+  }
+
+  const auto& s = slots_of(mapping_)[slot];
+  TagSample sample{.datatype = static_cast<DataType>(s.datatype)};
+  while (true) {
+    uint64_t before = s.seq.load(std::memory_order_acquire);
+    if (!wait_unlocked(s.seq, before)) {
+      return std::nullopt;
+    }
+    sample.bits = s.bits.load(std::memory_order_relaxed);
+    sample.timestamp = s.timestamp.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (s.seq.load(std::memory_order_relaxed) == before) {
+      sample.change_count = before / 2;
+      return sample;
+    }
+  }
+}
+
+bool TagTable::recover(size_t slot) noexcept {
+  if (!mapping_ || slot >= slot_count_) {
+    return false;
+  }
+  auto& s = slots_of(mapping_)[slot];
+  uint64_t seq = s.seq.load(std::memory_order_acquire);
+  if ((seq & 1) == 0 ||
+      !s.seq.compare_exchange_strong(seq, seq + 1, std::memory_order_acq_rel)) {
+    return false;
+  }
+  header_of(mapping_)->generation.fetch_add(1, std::memory_order_release);
+  return true;
+}
+
+uint64_t TagTable::generation() const noexcept {
+  return mapping_ ? header_of(mapping_)->generation.load(std::memory_order_acquire) : 0;
+}
+
+TagTableSource::TagTableSource(const TagTable& table) : table_(&table) {
+  definitions_.reserve(table.size());
+  for (size_t i = 0; i < table.size(); ++i) {
+    definitions_.push_back(table.definition(i));
+  }
+  seen_.assign(table.size(), 0);
+}
+
+void TagTableSource::add_birth_metrics(PayloadBuilder& builder) {
+  generation_ = table_->generation();
+  auto& payload = builder.mutable_payload();
+
+  for (size_t i = 0; i < definitions_.size(); ++i) {
+    const auto& def = definitions_[i];
+    auto sample = table_->read(i);
+
+    auto* metric = payload.add_metrics();
+    metric->set_name(def.name);
+    metric->set_alias(def.alias);
+    metric->set_datatype(std::to_underlying(def.datatype));
+
+    if (sample && sample->change_count > 0) {
+      metric->set_timestamp(sample->timestamp);
+      set_value(metric, def.datatype, sample->bits);
+      seen_[i] = sample->change_count;
+    } else {
+      metric->set_is_null(true);
+      seen_[i] = 0;
+    }
+  }
+}
+
+size_t TagTableSource::collect_changes(PayloadBuilder& builder) {
+  // Read the generation before scanning, so writes racing with the scan are picked
+  // up by the next call
+  uint64_t generation = table_->generation();
+  if (generation_ == generation) {
+    return 0;
+  }
+  generation_ = generation;
+
+  auto& payload = builder.mutable_payload();
+  size_t added = 0;
+
+  for (size_t i = 0; i < definitions_.size(); ++i) {
+    auto sample = table_->read(i);
+    if (!sample || sample->change_count == seen_[i]) {
+      continue;
+    }
+    seen_[i] = sample->change_count;
+
+    auto* metric = payload.add_metrics();
+    metric->set_alias(definitions_[i].alias);
+    metric->set_timestamp(sample->timestamp);
+    metric->set_datatype(std::to_underlying(definitions_[i].datatype));
+    set_value(metric, definitions_[i].datatype, sample->bits);
+    added++;
+  }
+  return added;
+}
+
+} // namespace sparkplug
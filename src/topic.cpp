@@ -11,30 +11,6 @@ namespace {
 
 using namespace std::string_view_literals;
 
-constexpr std::string_view message_type_to_string(MessageType type) noexcept {
-  switch (type) {
-  case MessageType::NBIRTH:
-    return "NBIRTH";
-  case MessageType::NDEATH:
-    return "NDEATH";
-  case MessageType::DBIRTH:
-    return "DBIRTH";
-  case MessageType::DDEATH:
-    return "DDEATH";
-  case MessageType::NDATA:
-    return "NDATA";
-  case MessageType::DDATA:
-    return "DDATA";
-  case MessageType::NCMD:
-    return "NCMD";
-  case MessageType::DCMD:
-    return "DCMD";
-  case MessageType::STATE:
-    return "STATE";
-  }
-  std::unreachable();
-}
-
 stdx::expected<MessageType, std::string> parse_message_type(std::string_view str) {
   if (str == "NBIRTH")
     return MessageType::NBIRTH;
@@ -58,18 +34,47 @@ stdx::expected<MessageType, std::string> parse_message_type(std::string_view str
 }
 } // namespace
 
+std::string_view message_type_to_string(MessageType type) noexcept {
+  switch (type) {
+  case MessageType::NBIRTH:
+    return "NBIRTH";
+  case MessageType::NDEATH:
+    return "NDEATH";
+  case MessageType::DBIRTH:
+    return "DBIRTH";
+  case MessageType::DDEATH:
+    return "DDEATH";
+  case MessageType::NDATA:
+    return "NDATA";
+  case MessageType::DDATA:
+    return "DDATA";
+  case MessageType::NCMD:
+    return "NCMD";
+  case MessageType::DCMD:
+    return "DCMD";
+  case MessageType::STATE:
+    return "STATE";
+  }
+  std::unreachable();
+}
+
 std::string Topic::to_string() const {
+  std::string result;
   if (message_type == MessageType::STATE) {
-    return std::format("{}/STATE/{}", NAMESPACE, edge_node_id);
+    result.reserve(NAMESPACE.size() + 7 + edge_node_id.size());
+    result.append(NAMESPACE).append("/STATE/").append(edge_node_id);
+    return result;
   }
 
-  auto base = std::format("{}/{}/{}/{}", NAMESPACE, group_id,
-                          message_type_to_string(message_type), edge_node_id);
-
+  auto type = message_type_to_string(message_type);
+  result.reserve(NAMESPACE.size() + group_id.size() + type.size() + edge_node_id.size() +
+                 device_id.size() + 4);
+  result.append(NAMESPACE).append("/").append(group_id).append("/").append(type);
+  result.append("/").append(edge_node_id);
   if (!device_id.empty()) {
-    return std::format("{}/{}", base, device_id);
+    result.append("/").append(device_id);
   }
-  return base;
+  return result;
 }
 
 stdx::expected<Topic, std::string> Topic::parse(std::string_view topic_str) {
@@ -0,0 +1,229 @@
+// src/window_aggregator.cpp
+#include "sparkplug/window_aggregator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string_view>
+#include <utility>
+
+namespace sparkplug {
+
+namespace {
+
+using namespace std::string_view_literals;
+
+uint64_t now_epoch_ms() {
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                   std::chrono::system_clock::now().time_since_epoch())
+                                   .count());
+}
+
+} // namespace
+
+WindowAggregator::Accumulator::Accumulator()
+    : min(std::numeric_limits<double>::infinity()),
+      max(-std::numeric_limits<double>::infinity()) {
+}
+
+void WindowAggregator::Accumulator::reset() noexcept {
+  count.store(0, std::memory_order_relaxed);
+  sum.store(0.0, std::memory_order_relaxed);
+  min.store(std::numeric_limits<double>::infinity(), std::memory_order_relaxed);
+  max.store(-std::numeric_limits<double>::infinity(), std::memory_order_relaxed);
+  last.store(0.0, std::memory_order_relaxed);
+}
+
+WindowAggregator::~WindowAggregator() {
+  stop();
+}
+
+size_t WindowAggregator::add_window(WindowSpec spec) {
+  std::scoped_lock lock(mutex_);
+  auto window = std::make_unique<Window>();
+  if (spec.window.count() <= 0) {
+    spec.window = std::chrono::milliseconds(1);
+  }
+  window->deadline = std::chrono::steady_clock::now() + spec.window;
+  window->spec = std::move(spec);
+  windows_.push_back(std::move(window));
+  return windows_.size() - 1;
+}
+
+void WindowAggregator::add_sample(size_t handle, double value) noexcept {
+  if (handle >= windows_.size() || std::isnan(value)) {
+    return;
+  }
+  auto& window = *windows_[handle];
+
+  // Pin the active bank: register as in-flight, then confirm collect() did not
+  // flip banks in between (seq_cst pairs with the flip in collect_locked()).
+  Accumulator* acc;
+  while (true) {
+    uint32_t bank = window.active.load();
+    acc = &window.banks[bank];
+    acc->in_flight.fetch_add(1);
+    if (window.active.load() == bank) {
+      break;
+    }
+    acc->in_flight.fetch_sub(1);
+  }
+
+  acc->count.fetch_add(1, std::memory_order_relaxed);
+
+  double cur = acc->sum.load(std::memory_order_relaxed);
+  while (!acc->sum.compare_exchange_weak(cur, cur + value, std::memory_order_relaxed)) {
+  }
+
+  cur = acc->min.load(std::memory_order_relaxed);
+  while (value < cur &&
+         !acc->min.compare_exchange_weak(cur, value, std::memory_order_relaxed)) {
+  }
+
+  cur = acc->max.load(std::memory_order_relaxed);
+  while (value > cur &&
+         !acc->max.compare_exchange_weak(cur, value, std::memory_order_relaxed)) {
+  }
+
+  acc->last.store(value, std::memory_order_relaxed);
+  acc->in_flight.fetch_sub(1, std::memory_order_release);
+}
+
+void WindowAggregator::add_birth_metrics(PayloadBuilder& builder) const {
+  auto& payload = builder.mutable_payload();
+
+  for (const auto& window : windows_) {
+    const auto& spec = window->spec;
+    const std::pair<bool, std::string_view> outputs[] = {
+        {spec.outputs.min, "min"sv},   {spec.outputs.max, "max"sv},
+        {spec.outputs.mean, "mean"sv}, {spec.outputs.last, "last"sv},
+        {spec.outputs.count, "count"sv}};
+
+    uint64_t alias = spec.alias;
+    for (const auto& [enabled, suffix] : outputs) {
+      if (!enabled) {
+        continue;
+      }
+      auto* metric = payload.add_metrics();
+      metric->set_name(spec.name + "/" + std::string(suffix));
+      metric->set_alias(alias++);
+      metric->set_datatype(std::to_underlying(suffix == "count" ? DataType::UInt64
+                                                                : DataType::Double));
+      metric->set_is_null(true);
+    }
+  }
+}
+
+size_t WindowAggregator::collect(PayloadBuilder& builder,
+                                 std::chrono::steady_clock::time_point now) {
+  std::scoped_lock lock(mutex_);
+  return collect_locked(builder, now);
+}
+
+size_t WindowAggregator::collect_locked(PayloadBuilder& builder,
+                                        std::chrono::steady_clock::time_point now) {
+  size_t added = 0;
+  uint64_t timestamp = now_epoch_ms();
+
+  for (auto& window_ptr : windows_) {
+    auto& window = *window_ptr;
+    if (now < window.deadline) {
+      continue;
+    }
+    window.deadline += window.spec.window;
+    if (window.deadline <= now) {
+      window.deadline = now + window.spec.window; // Missed windows are merged
+    }
+
+    // Flip producers to the other bank and wait for stragglers on the old one
+    uint32_t bank = window.active.load();
+    window.active.store(bank ^ 1);
+    auto& acc = window.banks[bank];
+    while (acc.in_flight.load() != 0) {
+      std::this_thread::yield();
+    }
+
+    uint64_t count = acc.count.load(std::memory_order_relaxed);
+    if (count == 0) {
+      continue;
+    }
+
+    const auto& spec = window.spec;
+    uint64_t alias = spec.alias;
+    if (spec.outputs.min) {
+      builder.add_metric_by_alias(alias++, acc.min.load(std::memory_order_relaxed),
+                                  timestamp);
+    }
+    if (spec.outputs.max) {
+      builder.add_metric_by_alias(alias++, acc.max.load(std::memory_order_relaxed),
+                                  timestamp);
+    }
+    if (spec.outputs.mean) {
+      double mean = acc.sum.load(std::memory_order_relaxed) / static_cast<double>(count);
+      builder.add_metric_by_alias(alias++, mean, timestamp);
+    }
+    if (spec.outputs.last) {
+      builder.add_metric_by_alias(alias++, acc.last.load(std::memory_order_relaxed),
+                                  timestamp);
+    }
+    if (spec.outputs.count) {
+      builder.add_metric_by_alias(alias++, count, timestamp);
+    }
+    added += static_cast<size_t>(alias - spec.alias);
+
+    acc.reset();
+  }
+  return added;
+}
+
+void WindowAggregator::start(EmitCallback emit) {
+  std::scoped_lock lock(mutex_);
+  if (thread_.joinable()) {
+    return;
+  }
+  stopping_ = false;
+  thread_ = std::thread([this, emit = std::move(emit)] { run(emit); });
+}
+
+void WindowAggregator::stop() {
+  {
+    std::scoped_lock lock(mutex_);
+    stopping_ = true;
+  }
+  cv_.notify_all();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+void WindowAggregator::run(EmitCallback emit) {
+  std::unique_lock lock(mutex_);
+  while (!stopping_) {
+    auto next = std::chrono::steady_clock::time_point::max();
+    for (const auto& window : windows_) {
+      next = std::min(next, window->deadline);
+    }
+
+    if (next == std::chrono::steady_clock::time_point::max()) {
+      cv_.wait(lock, [this] { return stopping_; });
+      continue;
+    }
+    if (cv_.wait_until(lock, next, [this] { return stopping_; })) {
+      break;
+    }
+
+    PayloadBuilder builder;
+    if (collect_locked(builder, std::chrono::steady_clock::now()) == 0) {
+      continue;
+    }
+
+    // Emit without the lock so a slow publish does not block collect() callers
+    lock.unlock();
+    if (emit) {
+      emit(builder);
+    }
+    lock.lock();
+  }
+}
+
+} // namespace sparkplug
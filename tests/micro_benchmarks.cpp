@@ -0,0 +1,250 @@
+// tests/micro_benchmarks.cpp
+// Micro-benchmarks for the host ingest helpers. No broker required.
+// Usage: ./micro_benchmarks [name ...]   (default: all)
+//
+// Timings depend on the machine and build type, so these are not registered with
+// ctest; the correctness of each helper is covered by its own test.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <format>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <sparkplug/alarm_engine.hpp>
+#include <sparkplug/alias_table_cache.hpp>
+#include <sparkplug/datatype.hpp>
+#include <sparkplug/derived_metrics.hpp>
+#include <sparkplug/detail/seq_window.hpp>
+#include <sparkplug/node_state_budget.hpp>
+
+using Payload = org::eclipse::tahu::protobuf::Payload;
+
+namespace {
+
+void add_double(Payload& payload, std::string name, uint64_t alias, double value) {
+  auto* metric = payload.add_metrics();
+  if (!name.empty()) {
+    metric->set_name(std::move(name));
+  }
+  metric->set_alias(alias);
+  metric->set_datatype(static_cast<uint32_t>(sparkplug::DataType::Double));
+  metric->set_double_value(value);
+}
+
+// Benchmarks run in release builds, where assert() compiles away
+void check(bool ok, std::string_view what) {
+  if (!ok) {
+    std::cerr << "Check failed: " << what << "\n";
+    std::abort();
+  }
+}
+
+int64_t elapsed_ns(std::chrono::steady_clock::time_point begin) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - begin)
+      .count();
+}
+
+void bench_seq_window() {
+  constexpr int kMessages = 10000000;
+  sparkplug::detail::SeqWindow window;
+  window.reset(0);
+  size_t accepted = 0;
+  auto begin = std::chrono::steady_clock::now();
+  for (int i = 1; i <= kMessages; ++i) {
+    accepted += window.accept(static_cast<uint8_t>(i), false);
+    accepted += window.accept(static_cast<uint8_t>(i - 1), true); // Redelivery
+  }
+  auto ns = elapsed_ns(begin);
+  check(accepted == kMessages, "every duplicate dropped");
+  std::cout << std::format("seq_window: {:.2f} ns per seq check, 32 bytes per node\n",
+                           static_cast<double>(ns) / (2.0 * kMessages));
+}
+
+void bench_memory_budget() {
+  using Residency = sparkplug::NodeStateBudget::Residency;
+  constexpr int kNodes = 100000;
+  constexpr int kRounds = 10;
+  std::vector<std::string> ids;
+  ids.reserve(kNodes);
+  for (int i = 0; i < kNodes; ++i) {
+    ids.push_back(std::format("Edge{:06}", i));
+  }
+
+  // Churn a fleet twice the budget: every offline report may evict the oldest
+  sparkplug::NodeStateBudget budget(kNodes / 2 * 1024);
+  auto begin = std::chrono::steady_clock::now();
+  for (int round = 0; round < kRounds; ++round) {
+    for (const auto& id : ids) {
+      budget.update("Plant", id, 1024, Residency::Offline);
+      while (const auto* victim = budget.victim()) {
+        budget.update(victim->group_id, victim->edge_node_id, 64, Residency::Tombstone);
+      }
+    }
+  }
+  auto ns = elapsed_ns(begin);
+  check(budget.used_bytes() <= budget.budget_bytes(), "within budget");
+  check(budget.stats().nodes == kNodes, "every node tracked");
+  std::cout << std::format("memory_budget: {:.0f} ns per update across {} nodes, {} "
+                           "evictions\n",
+                           static_cast<double>(ns) / (kNodes * kRounds), kNodes,
+                           budget.stats().evictions);
+}
+
+void bench_alias_interning() {
+  constexpr int kBirths = 20000;
+  Payload birth;
+  for (int i = 0; i < 200; ++i) {
+    add_double(birth, std::format("Line/Metric{:03}", i), static_cast<uint64_t>(i + 1),
+               0.0);
+  }
+
+  // Per-node tables, as before sharing
+  auto begin = std::chrono::steady_clock::now();
+  size_t entries = 0;
+  for (int i = 0; i < kBirths; ++i) {
+    sparkplug::AliasTable table;
+    for (const auto& metric : birth.metrics()) {
+      if (metric.has_alias() && metric.has_name()) {
+        table[metric.alias()] = metric.name();
+      }
+    }
+    entries += table.size();
+  }
+  auto copy_ns = elapsed_ns(begin);
+
+  sparkplug::AliasTableCache cache;
+  std::vector<sparkplug::AliasTableCache::Handle> holders;
+  holders.reserve(kBirths);
+  begin = std::chrono::steady_clock::now();
+  for (int i = 0; i < kBirths; ++i) {
+    holders.push_back(cache.intern(birth));
+  }
+  auto intern_ns = elapsed_ns(begin);
+  check(entries == 200u * kBirths, "tables built");
+  check(cache.stats().tables == 1, "one shared table");
+  std::cout << std::format("alias_interning: 200-metric birth, {:.1f} us building a "
+                           "table, {:.1f} us interning\n",
+                           copy_ns / 1e3 / kBirths, intern_ns / 1e3 / kBirths);
+}
+
+void bench_derived_change_rate() {
+  constexpr int kNodes = 10000;
+  constexpr int kMetrics = 50;
+  sparkplug::DerivedMetrics derived;
+  bool added = derived.add({.name = "Efficiency", .expression = "{M0} / {M1}"}) &&
+               derived.add({.name = "Spread",
+                            .expression = "max({M2}, {M3}) - min({M2}, {M3})"}) &&
+               derived.add({.name = "Scaled", .expression = "{Efficiency} * 100"});
+  check(added, "expressions parse");
+  std::vector<sparkplug::DerivedValue> out;
+  std::vector<sparkplug::Topic> topics;
+  for (int n = 0; n < kNodes; ++n) {
+    topics.push_back({.group_id = "Plant",
+                      .message_type = sparkplug::MessageType::NBIRTH,
+                      .edge_node_id = std::format("E{:05}", n),
+                      .device_id = ""});
+    Payload birth;
+    for (int m = 0; m < kMetrics; ++m) {
+      add_double(birth, std::format("M{}", m), static_cast<uint64_t>(m), 1.0 + m);
+    }
+    derived.process(topics.back(), birth, out);
+    topics.back().message_type = sparkplug::MessageType::NDATA;
+  }
+  check(derived.instances() == 3 * kNodes, "expressions compiled");
+  out.clear();
+
+  // Each message changes one input: one unrelated metric, or M0 (two results)
+  Payload unrelated;
+  add_double(unrelated, "", 10, 0.0);
+  Payload input;
+  add_double(input, "", 0, 0.0);
+  auto begin = std::chrono::steady_clock::now();
+  for (int round = 1; round <= 10; ++round) {
+    unrelated.mutable_metrics(0)->set_double_value(round);
+    input.mutable_metrics(0)->set_double_value(100.0 + round);
+    for (const auto& topic : topics) {
+      derived.process(topic, unrelated, out);
+      derived.process(topic, input, out);
+    }
+  }
+  auto ns = elapsed_ns(begin);
+  check(out.size() == 2u * 10 * kNodes, "two results per input change");
+  std::cout << std::format("derived_change_rate: {} nodes x 3 expressions, {} ns per "
+                           "message\n",
+                           kNodes, ns / (2 * 10 * kNodes));
+}
+
+void bench_alarm_evaluation() {
+  constexpr int kNodes = 2000;
+  constexpr int kMetrics = 100;
+  sparkplug::AlarmEngine engine;
+  engine.add_limits({.pattern = "Sensor*",
+                     .hihi = 95.0,
+                     .hi = 90.0,
+                     .lo = 5.0,
+                     .lolo = 1.0,
+                     .deadband = 0.5});
+  std::vector<sparkplug::AlarmEvent> events;
+  std::vector<sparkplug::Topic> topics;
+  for (int n = 0; n < kNodes; ++n) {
+    topics.push_back({.group_id = "Fleet",
+                      .message_type = sparkplug::MessageType::NBIRTH,
+                      .edge_node_id = std::format("Edge{:04}", n),
+                      .device_id = ""});
+    Payload payload;
+    for (int m = 0; m < kMetrics; ++m) {
+      add_double(payload, std::format("Sensor{:03}", m), static_cast<uint64_t>(m), 50.0);
+    }
+    engine.process(topics.back(), payload, events);
+    topics.back().message_type = sparkplug::MessageType::NDATA;
+  }
+  check(engine.size() == static_cast<size_t>(kNodes * kMetrics), "limits compiled");
+
+  Payload update;
+  for (int m = 0; m < kMetrics; ++m) {
+    add_double(update, "", static_cast<uint64_t>(m), 40.0 + m % 10);
+  }
+  auto begin = std::chrono::steady_clock::now();
+  for (int round = 0; round < 5; ++round) {
+    for (const auto& topic : topics) {
+      engine.process(topic, update, events);
+    }
+  }
+  auto ns = elapsed_ns(begin);
+  check(events.empty(), "no transitions");
+  std::cout << std::format("alarm_evaluation: {} limits, {} ns per evaluated value\n",
+                           kNodes * kMetrics, ns / (5 * kNodes * kMetrics));
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  const std::vector<std::pair<std::string_view, std::function<void()>>> benchmarks{
+      {"seq_window", bench_seq_window},
+      {"memory_budget", bench_memory_budget},
+      {"alias_interning", bench_alias_interning},
+      {"derived_change_rate", bench_derived_change_rate},
+      {"alarm_evaluation", bench_alarm_evaluation}};
+
+  std::vector<std::string_view> selected(argv + 1, argv + argc);
+  for (auto name : selected) {
+    if (std::ranges::find(benchmarks, name, &decltype(benchmarks)::value_type::first) ==
+        benchmarks.end()) {
+      std::cerr << "Unknown benchmark: " << name << "\n";
+      return 1;
+    }
+  }
+  for (const auto& [name, run] : benchmarks) {
+    if (selected.empty() || std::ranges::find(selected, name) != selected.end()) {
+      run();
+    }
+  }
+  return 0;
+}
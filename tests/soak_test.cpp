@@ -66,10 +66,12 @@ static auto elapsed_s(std::chrono::steady_clock::time_point start) {
 }
 
 static bool wait_for_host(sparkplug::EdgeNode& node, const std::string& node_id) {
-  for (int i = 0; i < 50 && running && !node.is_primary_host_online(); ++i) {
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  // Short slices keep Ctrl-C responsive; the STATE message wakes the wait at once
+  bool online = false;
+  for (int i = 0; i < 50 && running && !online; ++i) {
+    online = node.wait_for_primary_host(std::chrono::milliseconds(100));
   }
-  if (!node.is_primary_host_online()) {
+  if (!online) {
     log_error(std::format("{}: primary host never came online", node_id));
     return false;
   }
@@ -0,0 +1,264 @@
+// tests/test_alarm_engine.cpp
+// Tests for threshold alarm evaluation on host ingest.
+// The end-to-end test skips when no MQTT broker is on localhost:1883.
+
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sparkplug/alarm_engine.hpp>
+#include <sparkplug/datatype.hpp>
+#include <sparkplug/edge_node.hpp>
+#include <sparkplug/host_application.hpp>
+
+using namespace std::chrono_literals;
+using sparkplug::AlarmEngine;
+using sparkplug::AlarmLevel;
+using Payload = org::eclipse::tahu::protobuf::Payload;
+
+sparkplug::Topic make_topic(sparkplug::MessageType type, std::string device = "") {
+  return {.group_id = "Plant",
+          .message_type = type,
+          .edge_node_id = "Edge01",
+          .device_id = std::move(device)};
+}
+
+void add_double(Payload& payload, std::string name, uint64_t alias, double value) {
+  auto* metric = payload.add_metrics();
+  if (!name.empty()) {
+    metric->set_name(std::move(name));
+  }
+  metric->set_alias(alias);
+  metric->set_datatype(static_cast<uint32_t>(sparkplug::DataType::Double));
+  metric->set_double_value(value);
+}
+
+Payload birth(double temperature, double pressure) {
+  Payload payload;
+  add_double(payload, "Boiler/Temperature", 1, temperature);
+  add_double(payload, "Boiler/Pressure", 2, pressure);
+  add_double(payload, "Uptime", 3, 0.0);
+  return payload;
+}
+
+Payload data(uint64_t alias, double value) {
+  Payload payload;
+  add_double(payload, "", alias, value);
+  return payload;
+}
+
+void test_levels_and_deadband() {
+  AlarmEngine engine;
+  engine.add_limits({.pattern = "*/Temperature",
+                     .hihi = 120.0,
+                     .hi = 100.0,
+                     .lo = 10.0,
+                     .deadband = 2.0});
+  engine.add_limits({.pattern = "Boiler/*", .lolo = 1.0}); // Pressure only
+  std::vector<sparkplug::AlarmEvent> events;
+
+  assert(engine.process(make_topic(sparkplug::MessageType::NBIRTH), birth(50.0, 5.0),
+                        events) == 0);
+  assert(engine.size() == 2);
+
+  auto ndata = make_topic(sparkplug::MessageType::NDATA);
+  assert(engine.process(ndata, data(1, 105.0), events) == 1);
+  assert(events[0].metric_name == "Boiler/Temperature");
+  assert(events[0].previous == AlarmLevel::Normal && events[0].level == AlarmLevel::Hi);
+  assert(events[0].edge_node_id == "Edge01" && events[0].device_id.empty());
+  assert(engine.active() == 1);
+
+  // Inside the deadband the alarm holds; a jump straight to HiHi is one transition
+  assert(engine.process(ndata, data(1, 99.0), events) == 0);
+  assert(engine.process(ndata, data(1, 130.0), events) == 1);
+  assert(events.back().level == AlarmLevel::HiHi);
+  assert(engine.process(ndata, data(1, 119.0), events) == 0);
+  assert(engine.process(ndata, data(1, 117.0), events) == 1);
+  assert(events.back().previous == AlarmLevel::HiHi);
+  assert(events.back().level == AlarmLevel::Hi);
+  assert(engine.process(ndata, data(1, 97.0), events) == 1);
+  assert(events.back().level == AlarmLevel::Normal);
+  assert(engine.active() == 0);
+
+  // Low side, and metrics by name without an alias
+  Payload by_name;
+  auto* pressure = by_name.add_metrics();
+  pressure->set_name("Boiler/Pressure");
+  pressure->set_datatype(static_cast<uint32_t>(sparkplug::DataType::Float));
+  pressure->set_float_value(0.5f);
+  assert(engine.process(ndata, by_name, events) == 1);
+  assert(events.back().metric_name == "Boiler/Pressure");
+  assert(events.back().level == AlarmLevel::LoLo);
+
+  // Unlimited metrics and unknown aliases cost nothing and report nothing
+  assert(engine.process(ndata, data(3, 1e9), events) == 0);
+  assert(engine.process(ndata, data(99, 1e9), events) == 0);
+
+  std::cout << "[OK] Hi/HiHi/Lo/LoLo transitions honour the deadband\n";
+}
+
+void test_delay_on() {
+  AlarmEngine engine;
+  engine.add_limits({.pattern = "Boiler/Temperature", .hi = 100.0, .delay_on = 50ms});
+  std::vector<sparkplug::AlarmEvent> events;
+  auto t0 = AlarmEngine::Clock::now();
+  engine.process(
+      make_topic(sparkplug::MessageType::NBIRTH), birth(50.0, 5.0), events, t0);
+  auto ndata = make_topic(sparkplug::MessageType::NDATA);
+
+  // A short excursion is never raised
+  assert(engine.process(ndata, data(1, 110.0), events, t0 + 10ms) == 0);
+  assert(engine.process(ndata, data(1, 90.0), events, t0 + 20ms) == 0);
+  assert(engine.poll(t0 + 100ms, events) == 0);
+
+  // A sustained one is raised by poll() without another value arriving
+  assert(engine.process(ndata, data(1, 110.0), events, t0 + 200ms) == 0);
+  assert(engine.poll(t0 + 220ms, events) == 0);
+  assert(engine.poll(t0 + 250ms, events) == 1);
+  assert(events.back().level == AlarmLevel::Hi && events.back().value == 110.0);
+
+  // ... or by the next value after the delay; clearing is immediate
+  assert(engine.process(ndata, data(1, 90.0), events, t0 + 300ms) == 1);
+  assert(engine.process(ndata, data(1, 111.0), events, t0 + 400ms) == 0);
+  assert(engine.process(ndata, data(1, 112.0), events, t0 + 460ms) == 1);
+  assert(events.back().value == 112.0);
+  assert(engine.poll(t0 + 1s, events) == 0);
+
+  std::cout << "[OK] Delay-on suppresses short excursions\n";
+}
+
+void test_rebirth_and_death() {
+  AlarmEngine engine;
+  engine.add_limits({.pattern = "*Temperature", .hi = 100.0});
+  std::vector<sparkplug::AlarmEvent> events;
+
+  // Birth values are evaluated; a rebirth keeps the level (no duplicate event)
+  engine.process(make_topic(sparkplug::MessageType::NBIRTH), birth(150.0, 5.0), events);
+  assert(events.size() == 1 && engine.active() == 1);
+  engine.process(make_topic(sparkplug::MessageType::NBIRTH), birth(150.0, 5.0), events);
+  assert(events.size() == 1 && engine.active() == 1);
+
+  // Device tables, with aliases too sparse to index directly
+  Payload device_birth;
+  add_double(device_birth, "Pump/Temperature", 1000000, 20.0);
+  auto dbirth = make_topic(sparkplug::MessageType::DBIRTH, "Pump01");
+  engine.process(dbirth, device_birth, events);
+  auto ddata = make_topic(sparkplug::MessageType::DDATA, "Pump01");
+  assert(engine.process(ddata, data(1000000, 101.0), events) == 1);
+  assert(events.back().device_id == "Pump01");
+  assert(engine.active() == 2 && engine.size() == 2);
+
+  // NDEATH drops the node and its devices without events
+  engine.process(make_topic(sparkplug::MessageType::NDEATH), Payload{}, events);
+  assert(engine.active() == 0 && engine.size() == 0);
+  assert(engine.process(ddata, data(1000000, 200.0), events) == 0);
+
+  // forget() does the same for state evicted without a death
+  engine.process(make_topic(sparkplug::MessageType::NBIRTH), birth(150.0, 5.0), events);
+  engine.process(dbirth, device_birth, events);
+  assert(engine.size() == 2);
+  auto emitted = events.size();
+  engine.forget("Plant", "Edge01");
+  assert(engine.active() == 0 && engine.size() == 0 && events.size() == emitted);
+
+  std::cout << "[OK] Rebirth keeps alarm levels; death discards tables\n";
+}
+
+void test_rebirth_deadband_and_names() {
+  AlarmEngine engine;
+  engine.add_limits({.pattern = "*Temperature", .hi = 100.0, .deadband = 5.0});
+  std::vector<sparkplug::AlarmEvent> events;
+  auto nbirth = make_topic(sparkplug::MessageType::NBIRTH);
+  auto ndata = make_topic(sparkplug::MessageType::NDATA);
+
+  // A level kept across a rebirth keeps its deadband too
+  engine.process(nbirth, birth(150.0, 5.0), events);
+  engine.process(nbirth, birth(150.0, 5.0), events);
+  assert(events.size() == 1);
+  assert(engine.process(ndata, data(1, 97.0), events) == 0);
+  assert(engine.process(ndata, data(1, 94.0), events) == 1);
+  assert(events.back().level == AlarmLevel::Normal);
+
+  // A birth without aliases: data carrying an alias still matches by name
+  Payload unaliased;
+  unaliased.add_metrics()->set_name("Boiler/Temperature");
+  engine.process(nbirth, unaliased, events);
+  Payload named;
+  add_double(named, "Boiler/Temperature", 7, 150.0);
+  assert(engine.process(ndata, named, events) == 1);
+  assert(events.back().level == AlarmLevel::Hi);
+
+  // Devices that die and rebirth repeatedly are still dropped by NDEATH
+  Payload device_birth;
+  add_double(device_birth, "Pump/Temperature", 1, 20.0);
+  auto dbirth = make_topic(sparkplug::MessageType::DBIRTH, "Pump01");
+  auto ddeath = make_topic(sparkplug::MessageType::DDEATH, "Pump01");
+  for (int i = 0; i < 100; ++i) {
+    engine.process(dbirth, device_birth, events);
+    engine.process(ddeath, Payload{}, events);
+  }
+  engine.process(dbirth, device_birth, events);
+  assert(engine.size() == 2);
+  engine.process(make_topic(sparkplug::MessageType::NDEATH), Payload{}, events);
+  assert(engine.size() == 0 && engine.active() == 0);
+
+  std::cout << "[OK] Kept levels keep their deadband; unaliased births match by name\n";
+}
+
+void test_host_alarms() {
+  std::mutex events_mutex;
+  std::vector<sparkplug::AlarmEvent> events;
+  auto on_alarm = [&](const sparkplug::AlarmEvent& event) {
+    std::scoped_lock lock(events_mutex);
+    events.push_back(event);
+  };
+  sparkplug::HostApplication host({.broker_url = "tcp://localhost:1883",
+                                   .client_id = "test_alarm_host",
+                                   .host_id = "AlarmHost",
+                                   .alarm_callback = on_alarm});
+  host.add_alarm_limits({.pattern = "Temperature", .hi = 100.0});
+  if (!host.connect()) {
+    std::cout << "[SKIP] Skipping (no MQTT broker): host alarms\n";
+    return;
+  }
+  assert(host.subscribe_group("AlarmTest").has_value());
+
+  sparkplug::EdgeNode node({.broker_url = "tcp://localhost:1883",
+                            .client_id = "test_alarm_edge",
+                            .group_id = "AlarmTest",
+                            .edge_node_id = "Edge01"});
+  assert(node.connect().has_value());
+  sparkplug::PayloadBuilder birth_payload;
+  birth_payload.add_metric_with_alias("Temperature", 1, 20.0);
+  assert(node.publish_birth(birth_payload).has_value());
+  sparkplug::PayloadBuilder hot;
+  hot.add_metric_by_alias(1, 105.0);
+  assert(node.publish_data(hot).has_value());
+  std::this_thread::sleep_for(300ms);
+
+  {
+    std::scoped_lock lock(events_mutex);
+    assert(events.size() == 1);
+    assert(events[0].group_id == "AlarmTest" && events[0].level == AlarmLevel::Hi);
+  }
+  assert(host.get_active_alarm_count() == 1);
+
+  (void)node.disconnect();
+  (void)host.disconnect();
+  std::cout << "[OK] Host reports alarm transitions from live traffic\n";
+}
+
+int main() {
+  std::cout << "=== Alarm Engine Tests ===\n";
+  test_levels_and_deadband();
+  test_delay_on();
+  test_rebirth_and_death();
+  test_rebirth_deadband_and_names();
+  test_host_alarms();
+  std::cout << "\nAll alarm engine tests passed!\n";
+  return 0;
+}
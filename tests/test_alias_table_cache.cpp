@@ -0,0 +1,158 @@
+// tests/test_alias_table_cache.cpp
+// Tests for sharing birth alias tables across nodes with the same schema.
+// Host state is loaded through import_state(), so no MQTT broker is needed.
+
+#include <cassert>
+#include <format>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <sparkplug/alias_table_cache.hpp>
+#include <sparkplug/host_application.hpp>
+
+using sparkplug::AliasTable;
+using sparkplug::AliasTableCache;
+using Payload = org::eclipse::tahu::protobuf::Payload;
+
+Payload make_birth(int metrics, std::string_view prefix = "Line") {
+  Payload payload;
+  for (int i = 0; i < metrics; ++i) {
+    auto* metric = payload.add_metrics();
+    metric->set_name(std::format("{}/Metric{:03}", prefix, i));
+    metric->set_alias(static_cast<uint64_t>(i + 1));
+    metric->set_datatype(10); // Double
+  }
+  payload.add_metrics()->set_name("bdSeq"); // Unaliased: not part of the table
+  return payload;
+}
+
+void test_sharing() {
+  AliasTableCache cache;
+  auto first = cache.intern(make_birth(20));
+  auto second = cache.intern(make_birth(20));
+  assert(first && first == second);
+  assert(first->size() == 20 && first->at(3) == "Line/Metric002");
+
+  // Same inventory in another order is the same table
+  Payload reversed;
+  auto birth = make_birth(20);
+  for (int i = birth.metrics_size() - 1; i >= 0; --i) {
+    *reversed.add_metrics() = birth.metrics(i);
+  }
+  assert(cache.intern(reversed) == first);
+
+  // Divergence: a different name gets its own table, the shared one is untouched
+  auto diverged = make_birth(20);
+  diverged.mutable_metrics(5)->set_name("Line/Replaced");
+  auto third = cache.intern(diverged);
+  assert(third && third != first);
+  assert(first->at(6) == "Line/Metric005" && third->at(6) == "Line/Replaced");
+
+  // Nothing aliased: no table at all
+  assert(cache.intern(make_birth(0)) == nullptr);
+
+  auto stats = cache.stats();
+  assert(stats.tables == 2 && stats.references == 3);
+  assert(stats.hits == 2 && stats.misses == 2);
+  assert(stats.unshared_bytes > stats.bytes);
+  assert(cache.bytes() == stats.bytes);
+
+  std::cout << "[OK] Equal schemas share one table, divergent ones do not\n";
+}
+
+void test_repeated_aliases_and_expiry() {
+  AliasTableCache cache;
+  // A repeated alias keeps the last name, as the per-node tables always did
+  Payload payload;
+  for (const char* name : {"A", "B"}) {
+    auto* metric = payload.add_metrics();
+    metric->set_name(name);
+    metric->set_alias(1);
+  }
+  auto repeated = cache.intern(payload);
+  assert(repeated->size() == 1 && repeated->at(1) == "B");
+  assert(cache.intern(payload) == repeated);
+
+  // Tables built elsewhere (replication import) join the same pool
+  auto imported = cache.intern(std::make_shared<const AliasTable>(AliasTable{{1, "B"}}));
+  assert(imported == repeated);
+  assert(cache.intern(AliasTableCache::Handle{}) == nullptr);
+
+  // The cache holds no strong reference; dropped schemas are swept as it grows
+  repeated.reset();
+  assert(cache.bytes() > 0);
+  imported.reset();
+  assert(cache.stats().tables == 0 && cache.bytes() == 0);
+  for (int i = 0; i < 1000; ++i) {
+    (void)cache.intern(make_birth(3, std::format("Gen{}", i)));
+  }
+  assert(cache.stats().tables == 0 && cache.stats().misses == 1001);
+  assert(cache.bytes() == 0);
+
+  std::cout << "[OK] Repeated aliases, imported tables and expiry\n";
+}
+
+// Hand-encoded replication snapshot (single-byte varints only), see
+// tests/test_state_replication.cpp
+std::vector<uint8_t> fleet_snapshot(int nodes) {
+  std::vector<uint8_t> bytes = {'S', 'P', 'R', 'S', 1, 0, 0, static_cast<uint8_t>(nodes)};
+  auto str = [&](std::string_view s) {
+    bytes.push_back(static_cast<uint8_t>(s.size()));
+    bytes.insert(bytes.end(), s.begin(), s.end());
+  };
+  for (int i = 0; i < nodes; ++i) {
+    str("Plant");
+    str(std::format("Edge{:03}", i));
+    bytes.insert(bytes.end(), {0x07, 9, 2, 100, 2, 1}); // Online, two aliases
+    str("Line/Temperature/Average");
+    bytes.push_back(2);
+    str("Line/Pressure/Average");
+    bytes.push_back(1); // One device
+    str("Pump01");
+    bytes.insert(bytes.end(), {0x03, 4, 0, 1, 3});
+    str("Pump/Speed/Setpoint/Value");
+  }
+  return bytes;
+}
+
+void test_host_sharing() {
+  sparkplug::HostApplication host({.broker_url = "tcp://localhost:1883",
+                                   .client_id = "test_alias_host",
+                                   .host_id = "AliasHost"});
+  assert(host.import_state(fleet_snapshot(100)).has_value());
+
+  // 100 nodes and 100 devices, two schemas
+  auto stats = host.get_alias_table_stats();
+  assert(stats.tables == 2 && stats.references == 200);
+  assert(stats.unshared_bytes == 100 * stats.bytes);
+  assert(host.get_metric_name("Plant", "Edge042", "", 2) == "Line/Pressure/Average");
+  assert(host.get_metric_name("Plant", "Edge099", "Pump01", 3) ==
+         "Pump/Speed/Setpoint/Value");
+
+  // The memory budget charges the two tables once, not per holder
+  host.enable_memory_budget(0);
+  auto memory = host.get_memory_stats();
+  assert(memory.shared_bytes == stats.bytes);
+  auto node = host.get_node_state("Plant", "Edge042");
+  assert(node && memory.used_bytes == 100 * node->memory_bytes + stats.bytes);
+
+  // A standby that reloads the same fleet reuses the tables already held
+  assert(host.import_state(fleet_snapshot(100)).has_value());
+  auto reloaded = host.get_alias_table_stats();
+  assert(reloaded.tables == 2 && reloaded.misses == stats.misses);
+  assert(host.get_memory_stats().used_bytes == memory.used_bytes);
+
+  std::cout << std::format("[OK] Host holds 2 alias tables for 200 births ({} vs {} "
+                           "bytes unshared)\n",
+                           stats.bytes, stats.unshared_bytes);
+}
+
+int main() {
+  std::cout << "=== Alias Table Cache Tests ===\n";
+  test_sharing();
+  test_repeated_aliases_and_expiry();
+  test_host_sharing();
+  std::cout << "\nAll alias table cache tests passed!\n";
+  return 0;
+}
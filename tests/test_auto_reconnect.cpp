@@ -0,0 +1,271 @@
+// tests/test_auto_reconnect.cpp
+// Tests for post-reconnect resync decisions and the host reconnect worker.
+// End-to-end tests skip when no MQTT broker is on localhost:1883.
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <format>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <sparkplug/edge_node.hpp>
+#include <sparkplug/host_application.hpp>
+#include <sparkplug/resync_tracker.hpp>
+
+using namespace std::chrono_literals;
+using sparkplug::ResyncTracker;
+
+void test_continuity_decides() {
+  auto t0 = ResyncTracker::Clock::now();
+  ResyncTracker tracker({.rebirths_per_second = 10.0, .burst = 10}, t0);
+  for (const char* node : {"Edge01", "Edge02", "Edge03", "Edge04"}) {
+    tracker.mark("Plant", node);
+  }
+  assert(tracker.pending("Plant", "Edge01") && !tracker.pending("Plant", "Other"));
+
+  // In sequence, gap, fresh NBIRTH: only the gap costs a rebirth
+  tracker.confirm("Plant", "Edge01");
+  tracker.broken("Plant", "Edge02");
+  tracker.confirm("Plant", "Edge03");
+  auto stats = tracker.stats();
+  assert(stats.pending == 1 && stats.queued == 1 && stats.resumed == 2);
+
+  std::vector<ResyncTracker::Request> out;
+  assert(tracker.poll(out, t0) == 1);
+  assert(out[0].group_id == "Plant" && out[0].edge_node_id == "Edge02");
+  assert(tracker.stats().awaiting_birth == 1);
+
+  // A second gap while waiting does not ask again; the NBIRTH answers it
+  tracker.broken("Plant", "Edge02");
+  assert(tracker.poll(out, t0 + 1s) == 0);
+  tracker.confirm("Plant", "Edge02");
+  assert(!tracker.tracked("Plant", "Edge02"));
+  assert(tracker.stats().rebirths == 1 && tracker.stats().resumed == 2);
+
+  // An evicted node is dropped without counting as resumed
+  tracker.forget("Plant", "Edge04");
+  assert(!tracker.tracked("Plant", "Edge04") && tracker.size() == 0);
+  assert(tracker.stats().resumed == 2);
+
+  std::cout << "[OK] Only nodes whose seq broke are asked to rebirth\n";
+}
+
+void test_rate_limit_and_retry() {
+  auto t0 = ResyncTracker::Clock::now();
+  ResyncTracker tracker({.rebirths_per_second = 20.0, .burst = 5, .retry_after = 2s}, t0);
+  for (int n = 0; n < 12; ++n) {
+    tracker.broken("Plant", std::format("Edge{:02}", n));
+  }
+  std::vector<ResyncTracker::Request> out;
+  assert(tracker.poll(out, t0) == 5);        // Burst
+  assert(tracker.poll(out, t0 + 50ms) == 1); // Then 20 per second
+  assert(tracker.poll(out, t0 + 1050ms) == 5);
+  assert(out.front().edge_node_id == "Edge00" && out.back().edge_node_id == "Edge10");
+
+  // Answered nodes are done; unanswered ones are asked again after retry_after
+  for (int n = 1; n < 11; ++n) {
+    tracker.confirm("Plant", std::format("Edge{:02}", n));
+  }
+  out.clear();
+  assert(tracker.poll(out, t0 + 2050ms) == 2);
+  assert(out[0].edge_node_id == "Edge11" && out[1].edge_node_id == "Edge00");
+  assert(tracker.stats().awaiting_birth == 2 && tracker.stats().rebirths == 13);
+
+  std::cout << "[OK] Rebirth requests are rate limited and retried\n";
+}
+
+void test_fleet_blip() {
+  constexpr int kNodes = 100000;
+  auto t0 = ResyncTracker::Clock::now();
+  ResyncTracker tracker({}, t0);
+  std::vector<std::string> nodes;
+  for (int n = 0; n < kNodes; ++n) {
+    nodes.push_back(std::format("Edge{:06}", n));
+  }
+
+  // One node in a hundred published during the outage
+  auto begin = std::chrono::steady_clock::now();
+  for (const auto& node : nodes) {
+    tracker.mark("Plant", node);
+  }
+  for (int n = 0; n < kNodes; ++n) {
+    if (n % 100 == 0) {
+      tracker.broken("Plant", nodes[n]);
+    } else {
+      tracker.confirm("Plant", nodes[n]);
+    }
+  }
+  auto elapsed = std::chrono::steady_clock::now() - begin;
+  auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+
+  std::vector<ResyncTracker::Request> out;
+  auto t = t0;
+  while (out.size() < kNodes / 100) {
+    tracker.poll(out, t);
+    t += 50ms;
+  }
+  assert(tracker.stats().rebirths == kNodes / 100);
+  assert(tracker.stats().resumed == kNodes - kNodes / 100);
+  auto seconds = std::chrono::duration<double>(t - t0).count();
+  std::cout << std::format("[OK] {} nodes after a blip: {} rebirths over {:.1f} s, "
+                           "{} ns per node\n",
+                           kNodes, out.size(), seconds, ns / kNodes);
+}
+
+void test_move_with_worker() {
+  // The worker polls its host every 50 ms; after a move it must poll the
+  // destination, never the freed source (caught by ASan if it did)
+  auto source = std::make_unique<sparkplug::HostApplication>(
+      sparkplug::HostApplication::Config{.broker_url = "tcp://localhost:1883",
+                                         .client_id = "test_reconnect_move",
+                                         .host_id = "ReconnectMove"});
+  source->enable_auto_reconnect({.min_delay = 10ms});
+  std::this_thread::sleep_for(60ms);
+
+  auto moved = std::make_unique<sparkplug::HostApplication>(std::move(*source));
+  source.reset();
+  std::this_thread::sleep_for(150ms);
+  assert(moved->get_resync_stats().pending == 0);
+
+  // Move assignment over a host with its own worker
+  sparkplug::HostApplication target({.broker_url = "tcp://localhost:1883",
+                                     .client_id = "test_reconnect_target",
+                                     .host_id = "ReconnectTarget"});
+  target.enable_auto_reconnect({.min_delay = 10ms});
+  target = std::move(*moved);
+  moved.reset();
+  std::this_thread::sleep_for(150ms);
+  assert(target.get_resync_stats().pending == 0);
+
+  std::cout << "[OK] Moving a host restarts its reconnect worker on the destination\n";
+}
+
+void test_host_reconnect() {
+  {
+    // The worker starts and stops cleanly without ever connecting
+    sparkplug::HostApplication idle({.broker_url = "tcp://localhost:1883",
+                                     .client_id = "test_reconnect_idle",
+                                     .host_id = "ReconnectIdle"});
+    idle.enable_auto_reconnect({.min_delay = 10ms});
+    assert(idle.get_resync_stats().pending == 0);
+  }
+
+  sparkplug::HostApplication host({.broker_url = "tcp://localhost:1883",
+                                   .client_id = "test_reconnect_host",
+                                   .host_id = "ReconnectHost"});
+  host.enable_auto_reconnect({.min_delay = 100ms, .max_delay = 1s});
+  if (!host.connect()) {
+    std::cout << "[SKIP] Skipping (no MQTT broker): host auto-reconnect\n";
+    return;
+  }
+  assert(host.subscribe_group("ReconnectTest").has_value());
+  assert(host.publish_state_birth(1).has_value());
+
+  // A deliberate disconnect is not undone by the worker
+  assert(host.disconnect().has_value());
+  std::this_thread::sleep_for(300ms);
+  assert(host.get_connection_stats().reconnects == 0);
+
+  assert(host.connect().has_value());
+  assert(host.wait_for_subscriptions(5s).has_value());
+
+  // Re-enabling while connected swaps the options, not the worker state the
+  // Paho thread may be using
+  host.enable_auto_reconnect({.min_delay = 50ms, .max_delay = 1s});
+  std::this_thread::sleep_for(100ms);
+  assert(host.get_connection_stats().reconnects == 0);
+
+  (void)host.publish_state_death(2);
+  (void)host.disconnect();
+  std::cout << "[OK] Host reconnect worker follows connect()/disconnect()\n";
+}
+
+void test_rebirth_after_long_outage() {
+  // A second client with the same id makes the broker drop the host's connection
+  std::atomic<bool> lost{false};
+  sparkplug::HostApplication host(
+      {.broker_url = "tcp://localhost:1883",
+       .client_id = "test_reconnect_gap_host",
+       .host_id = "ReconnectGapHost",
+       .log_callback = [&](sparkplug::LogLevel, std::string_view message) {
+         if (message.starts_with("Connection lost")) {
+           lost = true;
+         }
+       }});
+  host.enable_auto_reconnect({.min_delay = 1s, .max_delay = 1s});
+  if (!host.connect()) {
+    std::cout << "[SKIP] Skipping (no MQTT broker): rebirth after a long outage\n";
+    return;
+  }
+  assert(host.subscribe_group("ReconnectGap").has_value());
+  assert(host.wait_for_subscriptions(5s).has_value());
+
+  sparkplug::EdgeNode node({.broker_url = "tcp://localhost:1883",
+                            .client_id = "test_reconnect_gap_edge",
+                            .group_id = "ReconnectGap",
+                            .edge_node_id = "Edge01"});
+  assert(node.connect().has_value());
+  sparkplug::PayloadBuilder birth;
+  birth.add_metric("Temperature", 20.0);
+  assert(node.publish_birth(birth).has_value());
+  auto publish = [&](int count) {
+    for (int i = 0; i < count; ++i) {
+      sparkplug::PayloadBuilder data;
+      data.add_metric("Temperature", 20.0 + i);
+      assert(node.publish_data(data).has_value());
+    }
+  };
+  publish(255); // Every seq value seen once
+  std::this_thread::sleep_for(300ms);
+
+  {
+    sparkplug::HostApplication intruder({.broker_url = "tcp://localhost:1883",
+                                         .client_id = "test_reconnect_gap_host",
+                                         .host_id = "ReconnectGapIntruder"});
+    assert(intruder.connect().has_value());
+    auto deadline = std::chrono::steady_clock::now() + 2s;
+    while (!lost && std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::sleep_for(10ms);
+    }
+    assert(lost);
+    publish(150); // Missed by the host: seq jumps 151 ahead
+    (void)intruder.disconnect();
+  }
+
+  auto deadline = std::chrono::steady_clock::now() + 5s;
+  while (host.get_connection_stats().reconnects == 0 &&
+         std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(10ms);
+  }
+  assert(host.wait_for_subscriptions(5s).has_value());
+  publish(1);
+
+  deadline = std::chrono::steady_clock::now() + 3s;
+  while (host.get_resync_stats().rebirths == 0 &&
+         std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(10ms);
+  }
+  auto stats = host.get_resync_stats();
+  assert(stats.rebirths >= 1 && stats.resumed == 0);
+
+  (void)node.disconnect();
+  (void)host.disconnect();
+  std::cout << "[OK] Losing more than 127 messages still requests a rebirth\n";
+}
+
+int main() {
+  std::cout << "=== Auto Reconnect Tests ===\n";
+  test_continuity_decides();
+  test_rate_limit_and_retry();
+  test_fleet_blip();
+  test_move_with_worker();
+  test_host_reconnect();
+  test_rebirth_after_long_outage();
+  std::cout << "\nAll auto reconnect tests passed!\n";
+  return 0;
+}
@@ -0,0 +1,250 @@
+// tests/test_command_tracker.cpp
+// Tests for command-to-effect latency tracking.
+// The end-to-end test skips when no MQTT broker is on localhost:1883.
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sparkplug/command_tracker.hpp>
+#include <sparkplug/edge_node.hpp>
+#include <sparkplug/host_application.hpp>
+
+using namespace std::chrono_literals;
+using sparkplug::CommandTracker;
+
+sparkplug::Topic data_topic(std::string device_id) {
+  return {.group_id = "Plant",
+          .message_type = device_id.empty() ? sparkplug::MessageType::NDATA
+                                            : sparkplug::MessageType::DDATA,
+          .edge_node_id = "Edge01",
+          .device_id = std::move(device_id)};
+}
+
+void test_histogram() {
+  sparkplug::LatencyHistogram histogram;
+  assert(histogram.percentile(0.5).count() == 0);
+
+  for (int i = 0; i < 90; ++i) {
+    histogram.record(1000us); // Bucket [512, 1024)
+  }
+  for (int i = 0; i < 10; ++i) {
+    histogram.record(100000us); // Bucket [65536, 131072)
+  }
+  assert(histogram.count == 100);
+  assert(histogram.min == 1000us);
+  assert(histogram.max == 100000us);
+  assert(histogram.mean() == 10900us);
+  assert(histogram.percentile(0.5) == 1023us);
+  assert(histogram.percentile(0.99) == 100000us); // Clamped to max
+
+  std::cout << "[OK] Latency histogram buckets and percentiles\n";
+}
+
+void test_match_and_timeout() {
+  CommandTracker tracker({.timeout = 100ms});
+  auto t0 = CommandTracker::Clock::now();
+
+  std::vector<std::string> setpoint{"SetPoint"};
+  std::vector<std::string> both{"Speed", "Mode"};
+  tracker.record_command("Plant", "Edge01", "Pump01", setpoint, t0);
+  tracker.record_command("Plant", "Edge01", "", both, t0);
+  assert(tracker.stats().outstanding == 3);
+
+  // DDATA by alias answers the device write; other devices do not
+  std::unordered_map<uint64_t, std::string> aliases{{7, "SetPoint"}};
+  org::eclipse::tahu::protobuf::Payload ddata;
+  auto* metric = ddata.add_metrics();
+  metric->set_alias(7);
+  assert(tracker.match_data(data_topic("Pump02"), ddata, &aliases, t0 + 5ms) == 0);
+  assert(tracker.match_data(data_topic("Pump01"), ddata, &aliases, t0 + 20ms) == 1);
+  assert(tracker.match_data(data_topic("Pump01"), ddata, &aliases, t0 + 30ms) == 0);
+
+  // NDATA answers one of the two node writes; the other times out
+  org::eclipse::tahu::protobuf::Payload ndata;
+  ndata.add_metrics()->set_name("Speed");
+  assert(tracker.match_data(data_topic(""), ndata, nullptr, t0 + 40ms) == 1);
+  assert(tracker.match_data(data_topic(""), ndata, nullptr, t0 + 200ms) == 0);
+
+  auto stats = tracker.stats();
+  assert(stats.commands == 3);
+  assert(stats.matched == 2);
+  assert(stats.timed_out == 1);
+  assert(stats.outstanding == 0);
+  assert(stats.latency.count == 2);
+  assert(stats.latency.min == 20000us);
+  assert(stats.latency.max == 40000us);
+
+  auto node = tracker.stats("Plant", "Edge01");
+  assert(node.matched == 2 && node.timed_out == 1);
+  assert(tracker.stats("Plant", "Edge02").commands == 0);
+
+  std::cout << "[OK] Writes are matched by name or alias and time out\n";
+}
+
+void test_ids_with_separators() {
+  CommandTracker tracker({.timeout = 100ms});
+  auto t0 = CommandTracker::Clock::now();
+
+  // Joined keys made these one write to one node, the second superseding the first
+  std::vector<std::string> setpoint{"SetPoint"};
+  tracker.record_command("Plant\x1f" "Edge01", "Pump01", "", setpoint, t0);
+  tracker.record_command("Plant", "Edge01\x1f" "Pump01", "", setpoint, t0);
+  auto stats = tracker.stats();
+  assert(stats.outstanding == 2 && stats.superseded == 0);
+
+  org::eclipse::tahu::protobuf::Payload ndata;
+  ndata.add_metrics()->set_name("SetPoint");
+  sparkplug::Topic topic{.group_id = "Plant",
+                         .message_type = sparkplug::MessageType::NDATA,
+                         .edge_node_id = "Edge01\x1f" "Pump01",
+                         .device_id = ""};
+  assert(tracker.match_data(topic, ndata, nullptr, t0 + 10ms) == 1);
+  assert(tracker.stats("Plant", "Edge01\x1f" "Pump01").matched == 1);
+  assert(tracker.stats("Plant\x1f" "Edge01", "Pump01").outstanding == 1);
+
+  std::cout << "[OK] Ids containing 0x1F do not collide\n";
+}
+
+void test_supersede_and_cancel() {
+  CommandTracker tracker({.timeout = 100ms, .max_outstanding = 2});
+  auto t0 = CommandTracker::Clock::now();
+
+  std::vector<std::string> setpoint{"SetPoint"};
+  tracker.record_command("Plant", "Edge01", "", setpoint, t0);
+  tracker.record_command("Plant", "Edge01", "", setpoint, t0 + 50ms);
+
+  // The stale deadline of the first write does not expire the second
+  org::eclipse::tahu::protobuf::Payload ndata;
+  ndata.add_metrics()->set_name("SetPoint");
+  assert(tracker.match_data(data_topic(""), ndata, nullptr, t0 + 120ms) == 1);
+
+  auto stats = tracker.stats();
+  assert(stats.superseded == 1);
+  assert(stats.timed_out == 0);
+  assert(stats.latency.max == 70000us); // Measured from the newest write
+
+  std::vector<std::string> three{"A", "B", "C"};
+  auto command = tracker.record_command("Plant", "Edge01", "", three, t0 + 130ms);
+  assert(tracker.stats().untracked == 1);
+  tracker.cancel_command("Plant", "Edge01", "", three, command);
+  stats = tracker.stats();
+  assert(stats.outstanding == 0);
+  assert(stats.commands == 3); // Two SetPoint writes and the untracked C
+
+  std::cout << "[OK] Newer writes supersede older ones; cancelled writes are dropped\n";
+}
+
+void test_cancel_restores_superseded() {
+  CommandTracker tracker({.timeout = 1000ms});
+  auto t0 = CommandTracker::Clock::now();
+
+  // The second write fails to publish: the first is still in flight
+  std::vector<std::string> setpoint{"SetPoint"};
+  auto first = tracker.record_command("Plant", "Edge01", "", setpoint, t0);
+  auto failed = tracker.record_command("Plant", "Edge01", "", setpoint, t0 + 10ms);
+  assert(first != failed);
+  tracker.cancel_command("Plant", "Edge01", "", setpoint, failed);
+  auto stats = tracker.stats();
+  assert(stats.commands == 1 && stats.outstanding == 1 && stats.superseded == 0);
+
+  // Cancelling it again, or a command that no longer owns the entry, does nothing
+  tracker.cancel_command("Plant", "Edge01", "", setpoint, failed);
+  tracker.record_command("Plant", "Edge01", "", setpoint, t0 + 20ms);
+  tracker.cancel_command("Plant", "Edge01", "", setpoint, first);
+  stats = tracker.stats();
+  assert(stats.commands == 1 && stats.outstanding == 1 && stats.superseded == 0);
+
+  org::eclipse::tahu::protobuf::Payload ndata;
+  ndata.add_metrics()->set_name("SetPoint");
+  assert(tracker.match_data(data_topic(""), ndata, nullptr, t0 + 50ms) == 1);
+  assert(tracker.stats().latency.max == 30000us); // Measured from the newer write
+
+  // A restored write whose deadline passed meanwhile times out
+  tracker.record_command("Plant", "Edge01", "Pump01", setpoint, t0 - 2000ms);
+  failed = tracker.record_command("Plant", "Edge01", "Pump01", setpoint, t0);
+  tracker.cancel_command("Plant", "Edge01", "Pump01", setpoint, failed);
+  stats = tracker.stats();
+  assert(stats.outstanding == 0 && stats.timed_out == 1 && stats.superseded == 0);
+
+  std::cout << "[OK] Cancelling a failed write restores the one it superseded\n";
+}
+
+void test_host_round_trip() {
+  sparkplug::HostApplication host({.broker_url = "tcp://localhost:1883",
+                                   .client_id = "test_cmd_latency_host",
+                                   .host_id = "CmdLatencyHost"});
+  assert(host.enable_command_tracking({.timeout = 2000ms}).has_value());
+  assert(!host.enable_command_tracking().has_value()); // The tracker is never replaced
+  if (!host.connect()) {
+    std::cout << "[SKIP] Skipping (no MQTT broker): host round trip\n";
+    return;
+  }
+  assert(host.subscribe_node("CmdLatency", "Edge01").has_value());
+
+  // The edge node reports every written metric back in NDATA
+  sparkplug::EdgeNode* node_ptr = nullptr;
+  std::atomic<int> answered{0};
+  sparkplug::EdgeNode node(
+      {.broker_url = "tcp://localhost:1883",
+       .client_id = "test_cmd_latency_edge",
+       .group_id = "CmdLatency",
+       .edge_node_id = "Edge01",
+       .command_callback = [&](const sparkplug::Topic&,
+                               const org::eclipse::tahu::protobuf::Payload& cmd) {
+         sparkplug::PayloadBuilder data;
+         for (const auto& metric : cmd.metrics()) {
+           if (metric.has_alias()) {
+             data.add_metric_by_alias(metric.alias(), metric.double_value());
+           }
+         }
+         (void)node_ptr->publish_data(data);
+         answered++;
+       }});
+  node_ptr = &node;
+  assert(node.connect().has_value());
+
+  sparkplug::PayloadBuilder birth;
+  birth.add_metric_with_alias("SetPoint", 1, 0.0);
+  assert(node.publish_birth(birth).has_value());
+  std::this_thread::sleep_for(200ms); // Let the host learn the alias
+
+  for (int i = 0; i < 5; ++i) {
+    sparkplug::PayloadBuilder cmd;
+    cmd.add_metric_by_alias(1, static_cast<double>(i));
+    assert(host.publish_node_command("CmdLatency", "Edge01", cmd).has_value());
+    std::this_thread::sleep_for(50ms);
+  }
+
+  auto deadline = std::chrono::steady_clock::now() + 2s;
+  while (host.get_command_latency().matched < 5 &&
+         std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(10ms);
+  }
+
+  auto stats = host.get_command_latency("CmdLatency", "Edge01");
+  assert(stats.commands == 5);
+  assert(stats.matched == 5);
+  assert(stats.latency.count == 5);
+
+  (void)node.disconnect();
+  (void)host.disconnect();
+  std::cout << "[OK] Host measures NCMD-to-NDATA round trips (p50 "
+            << stats.latency.percentile(0.5).count() << "us)\n";
+}
+
+int main() {
+  std::cout << "=== Command Tracker Tests ===\n";
+  test_histogram();
+  test_match_and_timeout();
+  test_ids_with_separators();
+  test_supersede_and_cancel();
+  test_cancel_restores_superseded();
+  test_host_round_trip();
+  std::cout << "\nAll command tracker tests passed!\n";
+  return 0;
+}
@@ -0,0 +1,128 @@
+// tests/test_connection_stats.cpp
+// Tests for connect counts and timings across reconnects.
+// Plain tests skip when no MQTT broker is on localhost:1883; the TLS test skips
+// unless the broker from certs/start_mosquitto_test.sh is on localhost:8883.
+
+#include <cassert>
+#include <iostream>
+
+#include <sparkplug/edge_node.hpp>
+#include <sparkplug/host_application.hpp>
+
+void test_initial_stats() {
+  sparkplug::EdgeNode node({.broker_url = "tcp://127.0.0.1:1", // Nothing listens here
+                            .client_id = "test_connstats_refused",
+                            .group_id = "Test",
+                            .edge_node_id = "ConnStatsNode00"});
+  assert(!node.connect().has_value());
+
+  auto stats = node.get_connection_stats();
+  assert(stats.connects == 0);
+  assert(stats.total_connect_time.count() == 0);
+
+  std::cout << "[OK] Failed connects are not counted\n";
+}
+
+void test_plain_reconnect() {
+  sparkplug::EdgeNode node({.broker_url = "tcp://localhost:1883",
+                            .client_id = "test_connstats_plain",
+                            .group_id = "Test",
+                            .edge_node_id = "ConnStatsNode01"});
+  if (!node.connect()) {
+    std::cout << "[SKIP] Skipping (no MQTT broker): plain reconnect\n";
+    return;
+  }
+  assert(node.disconnect().has_value());
+  assert(node.connect().has_value());
+
+  auto stats = node.get_connection_stats();
+  assert(stats.connects == 2);
+  assert(stats.max_connect_time >= stats.last_connect_time);
+  assert(stats.total_connect_time >= stats.max_connect_time);
+
+  (void)node.disconnect();
+  std::cout << "[OK] Plain reconnects are timed\n";
+}
+
+void test_tls_reconnect() {
+  sparkplug::EdgeNode::TlsOptions tls;
+  tls.trust_store = "certs/ca.crt"; // Relative to the source tree (ctest runs there)
+  sparkplug::EdgeNode node({.broker_url = "ssl://localhost:8883",
+                            .client_id = "test_connstats_tls",
+                            .group_id = "Test",
+                            .edge_node_id = "ConnStatsNode02",
+                            .tls = tls});
+  if (!node.connect()) {
+    std::cout << "[SKIP] Skipping (no TLS MQTT broker): TLS reconnect\n";
+    return;
+  }
+  for (int i = 0; i < 3; ++i) {
+    assert(node.disconnect().has_value());
+    assert(node.connect().has_value());
+  }
+
+  auto stats = node.get_connection_stats();
+  assert(stats.connects == 4);
+  assert(stats.max_connect_time >= stats.last_connect_time);
+
+  (void)node.disconnect();
+  std::cout << "[OK] TLS reconnects are timed (last " << stats.last_connect_time.count()
+            << "us, max " << stats.max_connect_time.count() << "us)\n";
+}
+
+void test_tls_rebirth() {
+  sparkplug::EdgeNode::TlsOptions tls;
+  tls.trust_store = "certs/ca.crt";
+  sparkplug::EdgeNode node({.broker_url = "ssl://localhost:8883",
+                            .client_id = "test_connstats_tls_rebirth",
+                            .group_id = "Test",
+                            .edge_node_id = "ConnStatsNode03",
+                            .tls = tls});
+  if (!node.connect()) {
+    std::cout << "[SKIP] Skipping (no TLS MQTT broker): TLS rebirth\n";
+    return;
+  }
+  sparkplug::PayloadBuilder birth;
+  birth.add_metric("Temperature", 20.5);
+  assert(node.publish_birth(birth).has_value());
+
+  // rebirth() reconnects for the new bdSeq
+  assert(node.rebirth().has_value());
+  assert(node.rebirth().has_value());
+
+  auto stats = node.get_connection_stats();
+  assert(stats.connects == 3);
+
+  (void)node.disconnect();
+  std::cout << "[OK] TLS rebirths are counted as connects\n";
+}
+
+void test_host_reconnect() {
+  sparkplug::HostApplication host({.broker_url = "tcp://localhost:1883",
+                                   .client_id = "test_connstats_host",
+                                   .host_id = "ConnStatsHost"});
+  if (!host.connect()) {
+    std::cout << "[SKIP] Skipping (no MQTT broker): host reconnect\n";
+    return;
+  }
+  assert(host.disconnect().has_value());
+  assert(host.connect().has_value());
+
+  auto stats = host.get_connection_stats();
+  assert(stats.connects == 2);
+  assert(stats.total_connect_time >= stats.last_connect_time);
+
+  (void)host.disconnect();
+  std::cout << "[OK] Host application connects are timed\n";
+}
+
+int main() {
+  std::cout << "=== Connection Stats Tests ===\n";
+  test_initial_stats();
+  test_plain_reconnect();
+  test_tls_reconnect();
+  test_tls_rebirth();
+  test_host_reconnect();
+  std::cout << "\nAll connection stats tests passed!\n";
+  return 0;
+}
@@ -0,0 +1,217 @@
+// tests/test_derived_metrics.cpp
+// Tests for incrementally computed derived metrics.
+// The end-to-end test skips when no MQTT broker is on localhost:1883.
+
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sparkplug/datatype.hpp>
+#include <sparkplug/derived_metrics.hpp>
+#include <sparkplug/edge_node.hpp>
+#include <sparkplug/host_application.hpp>
+
+using namespace std::chrono_literals;
+using sparkplug::DerivedMetrics;
+using Payload = org::eclipse::tahu::protobuf::Payload;
+
+sparkplug::Topic make_topic(sparkplug::MessageType type,
+                            std::string node = "Edge01",
+                            std::string device = "") {
+  return {.group_id = "Plant",
+          .message_type = type,
+          .edge_node_id = std::move(node),
+          .device_id = std::move(device)};
+}
+
+void add_double(Payload& payload, std::string name, uint64_t alias, double value) {
+  auto* metric = payload.add_metrics();
+  if (!name.empty()) {
+    metric->set_name(std::move(name));
+  }
+  metric->set_alias(alias);
+  metric->set_datatype(static_cast<uint32_t>(sparkplug::DataType::Double));
+  metric->set_double_value(value);
+}
+
+Payload data(uint64_t alias, double value) {
+  Payload payload;
+  add_double(payload, "", alias, value);
+  return payload;
+}
+
+void test_parse_errors() {
+  DerivedMetrics derived;
+  assert(derived.add({.name = "A", .expression = "{X} + 2 * (3 - {Y}) / -4"}));
+  assert(derived.add({.name = "B", .expression = "max({X}, {Y}, 0) + abs(min(1, {Z}))"}));
+  assert(derived.size() == 2);
+
+  for (const char* bad : {"", "{X} +", "{}", "{Dev:}", "(1", "{X", "1 2", "sqrt(4)",
+                          "abs(1, 2)", "max()", "{X} % 2"}) {
+    auto result = derived.add({.name = "Bad", .expression = bad});
+    assert(!result.has_value());
+    assert(result.error().starts_with("Invalid expression"));
+  }
+  std::string deep = std::string(100, '(') + "1" + std::string(100, ')');
+  assert(!derived.add({.name = "Deep", .expression = deep}));
+  assert(!derived.add({.name = "", .expression = "1"}));
+  assert(derived.size() == 2);
+
+  std::cout << "[OK] Expressions are validated when added\n";
+}
+
+void test_incremental_updates() {
+  DerivedMetrics derived;
+  assert(derived.add({.group_id = "Plant",
+                      .name = "Efficiency",
+                      .expression = "{Energy/Out} / {Energy/In}"}));
+  assert(derived.add({.name = "Answer", .expression = "2 * 21"}));
+  assert(derived.add({.edge_node_id = "Other", .name = "Scoped", .expression = "1"}));
+  std::vector<sparkplug::DerivedValue> out;
+
+  Payload birth;
+  add_double(birth, "Energy/Out", 1, 45.0);
+  add_double(birth, "Energy/In", 2, 50.0);
+  add_double(birth, "Uptime", 3, 0.0);
+  birth.set_timestamp(1000);
+  assert(derived.process(make_topic(sparkplug::MessageType::NBIRTH), birth, out) == 2);
+  assert(derived.instances() == 2); // Scoped applies to another node
+  assert(out[0].name == "Efficiency" && *out[0].value == 0.9);
+  assert(out[0].edge_node_id == "Edge01" && out[0].timestamp == 1000);
+  assert(out[1].name == "Answer" && *out[1].value == 42.0);
+
+  // Only a changed input of a derived metric produces output
+  auto ndata = make_topic(sparkplug::MessageType::NDATA);
+  assert(derived.process(ndata, data(3, 10.0), out) == 0);
+  assert(derived.process(ndata, data(1, 45.0), out) == 0);
+  assert(derived.process(ndata, data(1, 40.0), out) == 1);
+  assert(*out.back().value == 0.8);
+  assert(*derived.value("Plant", "Edge01", "Efficiency") == 0.8);
+
+  // Division by zero and null inputs make the result unknown
+  assert(derived.process(ndata, data(2, 0.0), out) == 1);
+  assert(!out.back().value.has_value());
+  assert(derived.process(ndata, data(2, 80.0), out) == 1);
+  assert(*out.back().value == 0.5);
+  Payload null_input;
+  null_input.add_metrics()->set_alias(1);
+  null_input.mutable_metrics(0)->set_is_null(true);
+  assert(derived.process(ndata, null_input, out) == 1);
+  assert(!out.back().value.has_value());
+  assert(!derived.value("Plant", "Edge01", "Efficiency").has_value());
+
+  // NDEATH discards the node silently
+  auto ndeath = make_topic(sparkplug::MessageType::NDEATH);
+  assert(derived.process(ndeath, Payload{}, out) == 0);
+  assert(derived.instances() == 0);
+  assert(derived.process(ndata, data(1, 1.0), out) == 0);
+
+  // forget() does the same for state evicted without a death
+  derived.process(make_topic(sparkplug::MessageType::NBIRTH), birth, out);
+  assert(derived.instances() == 2);
+  derived.forget("Plant", "Edge01");
+  assert(derived.instances() == 0);
+
+  std::cout << "[OK] Only affected expressions are recomputed and emitted\n";
+}
+
+void test_devices_and_chaining() {
+  DerivedMetrics derived;
+  assert(derived.add({.name = "Total", .expression = "{Pump01:Power} + {Pump02:Power}"}));
+  assert(derived.add({.name = "Share", .expression = "{Pump01:Power} / {Total}"}));
+  std::vector<sparkplug::DerivedValue> out;
+
+  Payload node_birth;
+  add_double(node_birth, "Power", 1, 999.0); // Node metric, not a device's
+  derived.process(make_topic(sparkplug::MessageType::NBIRTH), node_birth, out);
+  for (const char* device : {"Pump01", "Pump02"}) {
+    Payload birth;
+    add_double(birth, "Power", device == std::string("Pump01") ? 10 : 20, 25.0);
+    derived.process(make_topic(sparkplug::MessageType::DBIRTH, "Edge01", device), birth,
+                    out);
+  }
+  // Total is computed before the expression that reads it
+  assert(out.size() == 2);
+  assert(out[0].name == "Total" && *out[0].value == 50.0);
+  assert(out[1].name == "Share" && *out[1].value == 0.5);
+
+  auto ddata = make_topic(sparkplug::MessageType::DDATA, "Edge01", "Pump02");
+  assert(derived.process(ddata, data(20, 75.0), out) == 2);
+  assert(*out[2].value == 100.0 && *out[3].value == 0.25);
+
+  // A dead device makes everything built on it unknown; its rebirth restores it
+  auto ddeath = make_topic(sparkplug::MessageType::DDEATH, "Edge01", "Pump02");
+  assert(derived.process(ddeath, Payload{}, out) == 2);
+  assert(!out[4].value && !out[5].value);
+  Payload rebirth;
+  add_double(rebirth, "Power", 20, 15.0);
+  auto dbirth = make_topic(sparkplug::MessageType::DBIRTH, "Edge01", "Pump02");
+  assert(derived.process(dbirth, rebirth, out) == 2);
+  assert(*out[6].value == 40.0 && *out[7].value == 25.0 / 40.0);
+
+  std::cout << "[OK] Device references and derived-of-derived chains\n";
+}
+
+void test_host_derived() {
+  std::mutex received_mutex;
+  std::vector<double> received;
+  auto on_message = [&](const sparkplug::Topic& topic, const Payload& payload) {
+    if (payload.uuid() != sparkplug::DERIVED_PAYLOAD_UUID) {
+      return;
+    }
+    assert(topic.message_type == sparkplug::MessageType::NDATA && !payload.has_seq());
+    std::scoped_lock lock(received_mutex);
+    received.push_back(payload.metrics(0).double_value());
+  };
+  sparkplug::HostApplication host({.broker_url = "tcp://localhost:1883",
+                                   .client_id = "test_derived_host",
+                                   .host_id = "DerivedHost",
+                                   .message_callback = on_message});
+  assert(!host.add_derived_metric({.name = "Broken", .expression = "{In} /"}));
+  assert(host.add_derived_metric({.group_id = "DerivedTest",
+                                  .name = "Efficiency",
+                                  .expression = "{Out} / {In}"}));
+  if (!host.connect()) {
+    std::cout << "[SKIP] Skipping (no MQTT broker): host derived metrics\n";
+    return;
+  }
+  assert(host.subscribe_group("DerivedTest").has_value());
+
+  sparkplug::EdgeNode node({.broker_url = "tcp://localhost:1883",
+                            .client_id = "test_derived_edge",
+                            .group_id = "DerivedTest",
+                            .edge_node_id = "Edge01"});
+  assert(node.connect().has_value());
+  sparkplug::PayloadBuilder birth;
+  birth.add_metric_with_alias("Out", 1, 30.0);
+  birth.add_metric_with_alias("In", 2, 40.0);
+  assert(node.publish_birth(birth).has_value());
+  sparkplug::PayloadBuilder update;
+  update.add_metric_by_alias(1, 20.0);
+  assert(node.publish_data(update).has_value());
+  std::this_thread::sleep_for(300ms);
+
+  {
+    std::scoped_lock lock(received_mutex);
+    assert(received.size() == 2 && received[0] == 0.75 && received[1] == 0.5);
+  }
+  assert(*host.get_derived_value("DerivedTest", "Edge01", "Efficiency") == 0.5);
+
+  (void)node.disconnect();
+  (void)host.disconnect();
+  std::cout << "[OK] Host delivers derived metrics as synthetic NDATA\n";
+}
+
+int main() {
+  std::cout << "=== Derived Metric Tests ===\n";
+  test_parse_errors();
+  test_incremental_updates();
+  test_devices_and_chaining();
+  test_host_derived();
+  std::cout << "\nAll derived metric tests passed!\n";
+  return 0;
+}
@@ -0,0 +1,215 @@
+// tests/test_edge_node_pool.cpp
+// Tests for the timer wheel and EdgeNodePool orchestration.
+// The publishing tests skip when no MQTT broker is on localhost:1883.
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <sparkplug/detail/timer_wheel.hpp>
+#include <sparkplug/edge_node_pool.hpp>
+#include <sparkplug/host_application.hpp>
+
+using namespace std::chrono_literals;
+using sparkplug::detail::TimerWheel;
+
+void test_timer_wheel() {
+  auto start = TimerWheel::Clock::now();
+  TimerWheel wheel(10ms, 8, start);
+  std::vector<int> fired;
+
+  wheel.schedule(30ms, [&] { fired.push_back(3); });
+  wheel.schedule(10ms, [&] { fired.push_back(1); });
+  auto far = wheel.schedule(200ms, [&] { fired.push_back(20); }); // > one revolution
+  auto cancelled = wheel.schedule(20ms, [&] { fired.push_back(2); });
+  assert(wheel.size() == 4);
+
+  assert(wheel.cancel(cancelled));
+  assert(!wheel.cancel(cancelled)); // Stale handle
+  assert(wheel.advance(start + 35ms) == 2);
+  assert((fired == std::vector<int>{1, 3}));
+
+  // Multi-round timer does not fire early when its slot comes round
+  assert(wheel.advance(start + 120ms) == 0);
+  assert(wheel.advance(start + 200ms) == 1);
+  assert(fired.back() == 20);
+  assert(!wheel.cancel(far)); // Already fired
+
+  // Periodic timer that cancels itself from its callback
+  int count = 0;
+  TimerWheel::TimerId self;
+  self = wheel.schedule(
+      10ms,
+      [&] {
+        if (++count == 3) {
+          wheel.cancel(self);
+        }
+      },
+      10ms);
+  wheel.advance(start + 400ms);
+  assert(count == 3);
+  assert(wheel.size() == 0);
+
+  // A callback cancelling another timer due in the same tick stops it firing.
+  // Due timers run newest first, so the canceller runs before `second`.
+  TimerWheel::TimerId second;
+  bool second_fired = false;
+  second = wheel.schedule(10ms, [&] { second_fired = true; });
+  wheel.schedule(10ms, [&] { assert(wheel.cancel(second)); });
+  assert(wheel.advance(start + 420ms) == 1);
+  assert(!second_fired && wheel.size() == 0);
+  assert(!wheel.cancel(second));
+
+  std::cout << "[OK] Timer wheel fires in order, handles rounds and cancellation\n";
+}
+
+void test_connect_cap_and_backoff() {
+  sparkplug::EdgeNodePool pool({.worker_threads = 1,
+                                .max_concurrent_connects = 2,
+                                .connect_interval = 5ms,
+                                .reconnect_min = 50ms,
+                                .reconnect_max = 200ms});
+
+  std::atomic<int> births{0};
+  for (int i = 0; i < 6; ++i) {
+    auto name = "PoolRefused" + std::to_string(i);
+    pool.add_node({.broker_url = "tcp://127.0.0.1:1", // Nothing listens here
+                   .client_id = name,
+                   .group_id = "Test",
+                   .edge_node_id = name},
+                  [&](sparkplug::PayloadBuilder&) { births++; });
+  }
+
+  pool.start();
+  auto deadline = std::chrono::steady_clock::now() + 1s;
+  while (std::chrono::steady_clock::now() < deadline) {
+    auto stats = pool.get_stats();
+    assert(stats.connecting <= 2);
+    assert(stats.online == 0);
+    std::this_thread::sleep_for(2ms);
+  }
+  pool.stop();
+
+  auto stats = pool.get_stats();
+  assert(stats.nodes == 6);
+  assert(stats.connect_failures >= 6); // Every node tried, failures are retried
+  assert(births == 0);
+  assert(!pool.is_online(0));
+
+  std::cout << "[OK] Connects are capped, failures retried with backoff\n";
+}
+
+void test_scans_publish() {
+  sparkplug::EdgeNodePool pool({.worker_threads = 2, .connect_interval = 5ms});
+
+  constexpr int kNodes = 5;
+  std::atomic<int> scans{0};
+  for (int i = 0; i < kNodes; ++i) {
+    auto name = "PoolNode" + std::to_string(i);
+    auto id = pool.add_node({.broker_url = "tcp://localhost:1883",
+                             .client_id = "test_pool_" + name,
+                             .group_id = "TestGroup",
+                             .edge_node_id = name},
+                            [](sparkplug::PayloadBuilder& birth) {
+                              birth.add_metric_with_alias("Counter", 1, int64_t{0});
+                            });
+    pool.add_scan(id, 50ms, [&](sparkplug::PayloadBuilder& data, uint64_t timestamp) {
+      assert(data.payload().metrics_size() == 0); // Pooled builders come back cleared
+      assert(data.payload().timestamp() == timestamp);
+      assert(!data.has_seq() && !data.payload().has_seq()); // The node assigns it
+      data.add_metric_by_alias(1, int64_t{scans++}, timestamp);
+    });
+  }
+
+  pool.start();
+  auto deadline = std::chrono::steady_clock::now() + 5s;
+  while (pool.get_stats().online < kNodes &&
+         std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(10ms);
+  }
+  if (pool.get_stats().online < kNodes) {
+    pool.stop();
+    std::cout << "[SKIP] Skipping (no MQTT broker): pooled scans\n";
+    return;
+  }
+
+  std::this_thread::sleep_for(300ms);
+  pool.stop();
+
+  auto stats = pool.get_stats();
+  assert(stats.publishes > 0);
+  assert(stats.publish_failures == 0);
+  assert(stats.online == 0); // Disconnected by stop()
+
+  std::cout << "[OK] Pooled scans publish NDATA for every node\n";
+}
+
+void test_recycled_builder_seq() {
+  std::mutex received_mutex;
+  std::vector<std::pair<bool, uint64_t>> received; // (has seq, seq) per NDATA
+  sparkplug::HostApplication host(
+      {.broker_url = "tcp://localhost:1883",
+       .client_id = "test_pool_seq_host",
+       .host_id = "PoolSeqHost",
+       .message_callback = [&](const sparkplug::Topic& topic,
+                               const org::eclipse::tahu::protobuf::Payload& payload) {
+         if (topic.message_type == sparkplug::MessageType::NDATA) {
+           std::scoped_lock lock(received_mutex);
+           received.emplace_back(payload.has_seq(), payload.seq());
+         }
+       }});
+  if (!host.connect()) {
+    std::cout << "[SKIP] Skipping (no MQTT broker): recycled builder seq\n";
+    return;
+  }
+  assert(host.subscribe_group("PoolSeqTest").has_value());
+  assert(host.wait_for_subscriptions(5s).has_value());
+
+  // One worker and one scan: every publish after the first reuses the same builder
+  sparkplug::EdgeNodePool pool({.worker_threads = 1, .connect_interval = 5ms});
+  auto id = pool.add_node({.broker_url = "tcp://localhost:1883",
+                           .client_id = "test_pool_seq_edge",
+                           .group_id = "PoolSeqTest",
+                           .edge_node_id = "PoolSeqNode"},
+                          [](sparkplug::PayloadBuilder& birth) {
+                            birth.add_metric_with_alias("Counter", 1, int64_t{0});
+                          });
+  std::atomic<int64_t> scans{0};
+  pool.add_scan(id, 20ms, [&](sparkplug::PayloadBuilder& data, uint64_t) {
+    data.add_metric_by_alias(1, scans++);
+  });
+  pool.start();
+  auto deadline = std::chrono::steady_clock::now() + 5s;
+  while (pool.get_stats().publishes < 2 && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(10ms);
+  }
+  pool.stop();
+  std::this_thread::sleep_for(200ms);
+  (void)host.disconnect();
+
+  // Each NDATA carries the next seq after the NBIRTH (seq 0)
+  std::scoped_lock lock(received_mutex);
+  assert(received.size() >= 2);
+  for (size_t i = 0; i < received.size(); ++i) {
+    assert(received[i].first);
+    assert(received[i].second == (i + 1) % 256);
+  }
+
+  std::cout << "[OK] Recycled builders get a fresh seq on every publish\n";
+}
+
+int main() {
+  std::cout << "=== EdgeNodePool Tests ===\n";
+  test_timer_wheel();
+  test_connect_cap_and_backoff();
+  test_scans_publish();
+  test_recycled_builder_seq();
+  std::cout << "\nAll edge node pool tests passed!\n";
+  return 0;
+}
@@ -0,0 +1,152 @@
+// tests/test_json_encoder.cpp
+// Unit tests for JsonEncoder: value formatting, alias resolution, escaping and the
+// wire-bytes path. No broker required.
+
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <sparkplug/json_encoder.hpp>
+#include <sparkplug/payload_builder.hpp>
+
+void test_payload_encoding() {
+  sparkplug::PayloadBuilder builder;
+  builder.set_timestamp(1000).set_seq(4);
+  builder.add_metric_with_alias("Temperature", 1, 21.5, 1000);
+  builder.add_metric("Count", static_cast<int32_t>(-7), 1000);
+  builder.add_metric("Big", static_cast<uint64_t>(18446744073709551615ULL), 1000);
+  builder.add_metric("Ratio", 0.1f, 1000);
+  builder.add_metric("Running", true, 1000);
+
+  sparkplug::JsonEncoder encoder;
+  auto json = encoder.encode(builder.payload());
+
+  assert(json == R"({"timestamp":1000,"seq":4,"metrics":[)"
+                 R"({"name":"Temperature","alias":1,"timestamp":1000,"datatype":10,"value":21.5},)"
+                 R"({"name":"Count","timestamp":1000,"datatype":3,"value":-7},)"
+                 R"({"name":"Big","timestamp":1000,"datatype":8,)"
+                 R"("value":18446744073709551615},)"
+                 R"({"name":"Ratio","timestamp":1000,"datatype":9,"value":0.1},)"
+                 R"({"name":"Running","timestamp":1000,"datatype":11,"value":true}]})");
+
+  std::cout << "[OK] Payload values encoded\n";
+}
+
+void test_alias_resolution_with_topic() {
+  sparkplug::JsonEncoder::AliasMap aliases{{1, "Temperature"}};
+
+  sparkplug::PayloadBuilder data;
+  data.set_timestamp(2000).set_seq(5);
+  data.add_metric_by_alias(1, 22.0, 2000);
+  data.add_metric_by_alias(9, 1.5, 2000);
+
+  sparkplug::Topic topic{.group_id = "Energy",
+                         .message_type = sparkplug::MessageType::DDATA,
+                         .edge_node_id = "Gateway01",
+                         .device_id = "Sensor01"};
+
+  sparkplug::JsonEncoder encoder;
+  auto json = encoder.encode(topic, data.payload(), &aliases);
+
+  assert(json == R"({"group_id":"Energy","message_type":"DDATA","edge_node_id":"Gateway01",)"
+                 R"("device_id":"Sensor01","timestamp":2000,"seq":5,"metrics":[)"
+                 R"({"name":"Temperature","alias":1,"timestamp":2000,"datatype":10,"value":22},)"
+                 R"({"alias":9,"timestamp":2000,"datatype":10,"value":1.5}]})");
+
+  std::cout << "[OK] Aliases resolved and topic fields emitted\n";
+}
+
+void test_escaping_and_special_values() {
+  sparkplug::PayloadBuilder builder;
+  builder.add_metric("Quote\"Back\\slash", std::string("line\nbreak\x01"), 1);
+  builder.add_metric("NaN", std::numeric_limits<double>::quiet_NaN(), 1);
+
+  auto* bytes = builder.mutable_payload().add_metrics();
+  bytes->set_name("Raw");
+  bytes->set_datatype(std::to_underlying(sparkplug::DataType::Bytes));
+  bytes->set_bytes_value(std::string("\x00\xff\x10\x20", 4));
+
+  auto* null_metric = builder.mutable_payload().add_metrics();
+  null_metric->set_name("Missing");
+  null_metric->set_datatype(std::to_underlying(sparkplug::DataType::Int32));
+  null_metric->set_is_null(true);
+
+  sparkplug::JsonEncoder encoder;
+  auto json = encoder.encode(builder.payload());
+
+  assert(json.find(R"("name":"Quote\"Back\\slash")") != std::string_view::npos);
+  assert(json.find(R"("value":"line\nbreak\u0001")") != std::string_view::npos);
+  assert(json.find(R"("name":"NaN","timestamp":1,"datatype":10,"value":null)") !=
+         std::string_view::npos);
+  assert(json.find(R"("value":"AP8QIA==")") != std::string_view::npos);
+  assert(json.find(R"("name":"Missing","datatype":3,"value":null)") !=
+         std::string_view::npos);
+
+  std::cout << "[OK] Strings escaped, NaN/null/bytes handled\n";
+}
+
+void test_wire_path_matches_payload_path() {
+  sparkplug::JsonEncoder::AliasMap aliases{{2, "Pressure"}};
+
+  sparkplug::PayloadBuilder builder;
+  builder.set_timestamp(3000).set_seq(0);
+  builder.add_metric_with_alias("Temperature", 1, 21.5, 3000);
+  builder.add_metric_by_alias(2, 101.325f, 3000);
+  builder.add_metric("Label", std::string("ok"), 3000);
+  builder.add_metric("Level", static_cast<int8_t>(-3), 3000);
+  builder.add_metric("Total", static_cast<int64_t>(-5000000000LL), 3000);
+  builder.add_metric("Flag", false, 3000);
+  builder.add_node_control_rebirth(false);
+  auto bytes = builder.build();
+
+  sparkplug::Topic topic{.group_id = "G",
+                         .message_type = sparkplug::MessageType::NDATA,
+                         .edge_node_id = "N",
+                         .device_id = ""};
+
+  sparkplug::JsonEncoder encoder;
+  std::string from_payload(encoder.encode(topic, builder.payload(), &aliases));
+  auto from_wire = encoder.encode(topic, bytes, &aliases);
+
+  assert(from_wire.has_value());
+  assert(*from_wire == from_payload);
+
+  // Buffer is reused: encoding again yields identical output
+  auto again = encoder.encode(topic, bytes, &aliases);
+  assert(again.has_value() && *again == from_payload);
+
+  std::cout << "[OK] Wire-bytes path matches decoded path\n";
+}
+
+void test_malformed_wire_input() {
+  sparkplug::JsonEncoder encoder;
+
+  // Metrics field (2, LEN) claiming 16 bytes with only 2 present
+  std::vector<uint8_t> truncated{0x12, 0x10, 0x0a, 0x01};
+  assert(!encoder.encode(truncated).has_value());
+
+  // Unterminated varint
+  std::vector<uint8_t> bad_varint{0x08, 0xff};
+  assert(!encoder.encode(bad_varint).has_value());
+
+  // Empty payload is valid
+  std::vector<uint8_t> empty;
+  auto json = encoder.encode(empty);
+  assert(json.has_value() && *json == R"({"metrics":[]})");
+
+  std::cout << "[OK] Malformed wire input rejected\n";
+}
+
+int main() {
+  std::cout << "=== JsonEncoder Tests ===\n";
+  test_payload_encoding();
+  test_alias_resolution_with_topic();
+  test_escaping_and_special_values();
+  test_wire_path_matches_payload_path();
+  test_malformed_wire_input();
+  std::cout << "\nAll JSON encoder tests passed!\n";
+  return 0;
+}
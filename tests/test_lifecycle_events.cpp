@@ -0,0 +1,171 @@
+// tests/test_lifecycle_events.cpp
+// Tests for the coalescing node/device lifecycle event queue.
+// The end-to-end test skips when no MQTT broker is on localhost:1883.
+
+#include <cassert>
+#include <chrono>
+#include <format>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sparkplug/edge_node.hpp>
+#include <sparkplug/host_application.hpp>
+#include <sparkplug/lifecycle_events.hpp>
+
+using namespace std::chrono_literals;
+using sparkplug::LifecycleEvent;
+using sparkplug::LifecycleEventQueue;
+using sparkplug::LifecycleEventType;
+
+LifecycleEvent event(LifecycleEventType type, std::string node, std::string device = "") {
+  return {.type = type,
+          .group_id = "Plant",
+          .edge_node_id = std::move(node),
+          .device_id = std::move(device)};
+}
+
+void test_coalescing() {
+  LifecycleEventQueue queue({.window = 100ms, .capacity = 100});
+  auto t0 = LifecycleEventQueue::Clock::now();
+  std::vector<LifecycleEvent> out;
+
+  // Edge01 flaps; Edge02 comes online; a device of Edge01 is separate
+  queue.push(event(LifecycleEventType::Offline, "Edge01"), t0);
+  queue.push(event(LifecycleEventType::Online, "Edge02"), t0 + 10ms);
+  queue.push(event(LifecycleEventType::Online, "Edge01"), t0 + 20ms);
+  queue.push(event(LifecycleEventType::Offline, "Edge01", "Pump01"), t0 + 30ms);
+  queue.push(event(LifecycleEventType::Rebirth, "Edge01"), t0 + 40ms);
+  assert(queue.size() == 3);
+
+  // Nothing leaves before its window; then in order of first transition
+  assert(queue.drain(out, SIZE_MAX, t0 + 99ms) == 0);
+  assert(queue.drain(out, SIZE_MAX, t0 + 100ms) == 1);
+  assert(out[0].edge_node_id == "Edge01" && out[0].device_id.empty());
+  assert(out[0].type == LifecycleEventType::Bounced && out[0].count == 3);
+  assert(queue.drain(out, SIZE_MAX, t0 + 200ms) == 2);
+  assert(out[1].edge_node_id == "Edge02" && out[1].type == LifecycleEventType::Online);
+  assert(out[2].device_id == "Pump01" && out[2].type == LifecycleEventType::Offline);
+  assert(queue.size() == 0);
+
+  // A drained entity starts a new event; the latest transition wins otherwise
+  queue.push(event(LifecycleEventType::Online, "Edge01"), t0 + 300ms);
+  queue.push(event(LifecycleEventType::Stale, "Edge01"), t0 + 310ms);
+  assert(queue.drain(out, SIZE_MAX, t0 + 400ms) == 1);
+  assert(out.back().type == LifecycleEventType::Stale && out.back().count == 2);
+
+  // Sequence gaps coalesce apart from state events, keeping the latest gap
+  auto gap = event(LifecycleEventType::SeqGap, "Edge02");
+  gap.expected_seq = 5;
+  gap.received_seq = 9;
+  queue.push(gap, t0 + 500ms);
+  queue.push(event(LifecycleEventType::Offline, "Edge02"), t0 + 505ms);
+  gap.expected_seq = 12;
+  gap.received_seq = 14;
+  queue.push(gap, t0 + 510ms);
+  out.clear();
+  assert(queue.drain(out, SIZE_MAX, t0 + 1s) == 2);
+  assert(out[0].type == LifecycleEventType::SeqGap && out[0].count == 2);
+  assert(out[0].expected_seq == 12 && out[0].received_seq == 14);
+  assert(out[1].type == LifecycleEventType::Offline);
+
+  std::cout << "[OK] Per-entity coalescing within the window\n";
+}
+
+void test_bounded_memory() {
+  LifecycleEventQueue queue({.window = 0ms, .capacity = 3});
+  std::vector<LifecycleEvent> out;
+  for (int i = 0; i < 5; ++i) {
+    queue.push(event(LifecycleEventType::Online, std::format("Edge{:02}", i)));
+  }
+  assert(queue.size() == 3 && queue.dropped() == 2);
+
+  // Transitions of queued entities still merge when full
+  assert(queue.push(event(LifecycleEventType::Offline, "Edge00")));
+  assert(queue.dropped() == 2);
+
+  // The consumer takes what it can handle
+  assert(queue.drain(out, 2) == 2);
+  assert(out[0].edge_node_id == "Edge00" && out[0].type == LifecycleEventType::Offline);
+  assert(queue.push(event(LifecycleEventType::Online, "Edge03")));
+  assert(queue.drain(out) == 2);
+  assert(out.back().edge_node_id == "Edge03");
+
+  std::cout << "[OK] Capacity bounds memory and drops are counted\n";
+}
+
+void test_reconnect_storm() {
+  constexpr int kNodes = 100000;
+  constexpr int kFlaps = 10;
+  LifecycleEventQueue queue({.window = 1s, .capacity = kNodes});
+  std::vector<std::string> nodes;
+  for (int n = 0; n < kNodes; ++n) {
+    nodes.push_back(std::format("Edge{:06}", n));
+  }
+  auto t0 = LifecycleEventQueue::Clock::now();
+  auto begin = std::chrono::steady_clock::now();
+  for (int flap = 0; flap < kFlaps; ++flap) {
+    for (const auto& node : nodes) {
+      queue.push(event(LifecycleEventType::Offline, node), t0);
+      queue.push(event(LifecycleEventType::Online, node), t0);
+    }
+  }
+  auto elapsed = std::chrono::steady_clock::now() - begin;
+  auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+  assert(queue.size() == static_cast<size_t>(kNodes) && queue.dropped() == 0);
+
+  std::vector<LifecycleEvent> out;
+  assert(queue.drain(out, SIZE_MAX, t0 + 1s) == static_cast<size_t>(kNodes));
+  assert(out.front().type == LifecycleEventType::Bounced);
+  assert(out.front().count == 2 * kFlaps);
+  std::cout << std::format("[OK] {} transitions -> {} events, {} ns per transition\n",
+                           2 * kFlaps * kNodes, out.size(), ns / (2 * kFlaps * kNodes));
+}
+
+void test_host_lifecycle() {
+  sparkplug::HostApplication host({.broker_url = "tcp://localhost:1883",
+                                   .client_id = "test_lifecycle_host",
+                                   .host_id = "LifecycleHost"});
+  host.enable_lifecycle_events({.window = 200ms});
+  if (!host.connect()) {
+    std::cout << "[SKIP] Skipping (no MQTT broker): host lifecycle events\n";
+    return;
+  }
+  assert(host.subscribe_group("LifecycleTest").has_value());
+
+  sparkplug::EdgeNode node({.broker_url = "tcp://localhost:1883",
+                            .client_id = "test_lifecycle_edge",
+                            .group_id = "LifecycleTest",
+                            .edge_node_id = "Edge01"});
+  assert(node.connect().has_value());
+  sparkplug::PayloadBuilder birth;
+  birth.add_metric("Temperature", 20.0);
+  assert(node.publish_birth(birth).has_value());
+  assert(node.rebirth().has_value());
+  std::this_thread::sleep_for(500ms);
+
+  std::vector<LifecycleEvent> events;
+  assert(host.drain_lifecycle_events(events) == 1);
+  assert(events[0].edge_node_id == "Edge01");
+  assert(events[0].type == LifecycleEventType::Rebirth && events[0].count == 2);
+  assert(host.get_lifecycle_events_dropped() == 0);
+
+  (void)node.disconnect();
+  std::this_thread::sleep_for(500ms);
+  assert(host.drain_lifecycle_events(events) == 1);
+  assert(events[1].type == LifecycleEventType::Offline);
+
+  (void)host.disconnect();
+  std::cout << "[OK] Host queues births, rebirths and deaths\n";
+}
+
+int main() {
+  std::cout << "=== Lifecycle Event Tests ===\n";
+  test_coalescing();
+  test_bounded_memory();
+  test_reconnect_storm();
+  test_host_lifecycle();
+  std::cout << "\nAll lifecycle event tests passed!\n";
+  return 0;
+}
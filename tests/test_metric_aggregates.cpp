@@ -0,0 +1,224 @@
+// tests/test_metric_aggregates.cpp
+// Tests for incremental group/edge node aggregates.
+// The end-to-end test skips when no MQTT broker is on localhost:1883.
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <format>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sparkplug/datatype.hpp>
+#include <sparkplug/edge_node.hpp>
+#include <sparkplug/host_application.hpp>
+#include <sparkplug/metric_aggregates.hpp>
+
+using namespace std::chrono_literals;
+using sparkplug::MetricAggregates;
+using Payload = org::eclipse::tahu::protobuf::Payload;
+
+sparkplug::Topic data_topic(std::string node, std::string device = "") {
+  return {.group_id = "Plant",
+          .message_type = device.empty() ? sparkplug::MessageType::NDATA
+                                         : sparkplug::MessageType::DDATA,
+          .edge_node_id = std::move(node),
+          .device_id = std::move(device)};
+}
+
+Payload double_metric(std::string name, double value) {
+  Payload payload;
+  auto* metric = payload.add_metrics();
+  metric->set_name(std::move(name));
+  metric->set_datatype(static_cast<uint32_t>(sparkplug::DataType::Double));
+  metric->set_double_value(value);
+  return payload;
+}
+
+void test_sum_count_extremes() {
+  MetricAggregates aggregates;
+  auto power = aggregates.add({.group_id = "Plant", .metric_name = "Power"});
+  auto edge01 = aggregates.add(
+      {.group_id = "Plant", .edge_node_id = "Edge01", .metric_name = "Power"});
+  assert(aggregates.value(power)->count == 0);
+  assert(!aggregates.value(99).has_value());
+
+  aggregates.update(data_topic("Edge01"), double_metric("Power", 10.0), nullptr);
+  aggregates.update(data_topic("Edge01", "Pump01"), double_metric("Power", 5.0), nullptr);
+  aggregates.update(data_topic("Edge02"), double_metric("Power", 30.0), nullptr);
+  aggregates.update(data_topic("Edge02"), double_metric("Voltage", 230.0), nullptr);
+
+  auto value = aggregates.value(power);
+  assert(value->count == 3 && value->sum == 45.0);
+  assert(value->min == 5.0 && value->max == 30.0 && value->mean == 15.0);
+  assert(aggregates.value(edge01)->count == 2 && aggregates.value(edge01)->sum == 15.0);
+
+  // Latest value replaces the previous one; the max moving inward forces a rescan
+  aggregates.update(data_topic("Edge02"), double_metric("Power", 8.0), nullptr);
+  value = aggregates.value(power);
+  assert(value->count == 3 && value->sum == 23.0 && value->max == 10.0);
+
+  // Alias-only metrics resolve through the birth table; booleans count as 0/1
+  std::unordered_map<uint64_t, std::string> aliases{{4, "Power"}};
+  Payload by_alias;
+  auto* metric = by_alias.add_metrics();
+  metric->set_alias(4);
+  metric->set_datatype(static_cast<uint32_t>(sparkplug::DataType::Boolean));
+  metric->set_boolean_value(true);
+  aggregates.update(data_topic("Edge01", "Pump01"), by_alias, &aliases);
+  assert(aggregates.value(power)->sum == 19.0);
+  assert(aggregates.value(power)->min == 1.0);
+
+  // Historical values are not current; null retracts
+  Payload historical = double_metric("Power", 1000.0);
+  historical.mutable_metrics(0)->set_is_historical(true);
+  aggregates.update(data_topic("Edge02"), historical, nullptr);
+  assert(aggregates.value(power)->max == 10.0);
+  Payload null_value;
+  null_value.add_metrics()->set_name("Power");
+  null_value.mutable_metrics(0)->set_is_null(true);
+  aggregates.update(data_topic("Edge02"), null_value, nullptr);
+  assert(aggregates.value(power)->count == 2 && aggregates.value(power)->sum == 11.0);
+
+  // Death retracts node and device contributions
+  aggregates.retract("Plant", "Edge01", "Pump01");
+  assert(aggregates.value(edge01)->count == 1 && aggregates.value(edge01)->min == 10.0);
+  aggregates.retract("Plant", "Edge01", "");
+  value = aggregates.value(power);
+  assert(value->count == 0 && value->sum == 0.0 && value->mean == 0.0);
+
+  // A reborn node contributes again
+  aggregates.update(data_topic("Edge01"), double_metric("Power", 12.0), nullptr);
+  assert(aggregates.value(power)->count == 1 && aggregates.value(power)->max == 12.0);
+
+  std::cout << "[OK] Sum, count, min, max, mean with updates and retraction\n";
+}
+
+void test_suspend_and_resume() {
+  MetricAggregates aggregates;
+  auto power = aggregates.add({.group_id = "Plant", .metric_name = "Power"});
+  auto voltage = aggregates.add({.group_id = "Plant", .metric_name = "Voltage"});
+  Payload both = double_metric("Power", 10.0);
+  both.MergeFrom(double_metric("Voltage", 230.0));
+  aggregates.update(data_topic("Edge01"), both, nullptr);
+  aggregates.update(data_topic("Edge01", "Pump01"), double_metric("Power", 5.0), nullptr);
+  aggregates.update(data_topic("Edge02"), double_metric("Power", 30.0), nullptr);
+
+  // A stale timeout withdraws the node and its device
+  aggregates.suspend("Plant", "Edge01", "");
+  aggregates.suspend("Plant", "Edge01", "Pump01");
+  assert(aggregates.value(power)->count == 1 && aggregates.value(voltage)->count == 0);
+
+  // On resume the last values count again; the DATA that resumed it only has Power
+  aggregates.resume("Plant", "Edge01", "");
+  aggregates.update(data_topic("Edge01"), double_metric("Power", 12.0), nullptr);
+  auto value = aggregates.value(power);
+  assert(value->count == 2 && value->sum == 42.0);
+  value = aggregates.value(voltage);
+  assert(value->count == 1 && value->sum == 230.0);
+
+  // A death while suspended discards the kept values
+  aggregates.retract("Plant", "Edge01", "Pump01");
+  aggregates.resume("Plant", "Edge01", "Pump01");
+  assert(aggregates.value(power)->count == 2 && aggregates.value(power)->min == 12.0);
+
+  std::cout << "[OK] Suspended contributions come back on resume, not after death\n";
+}
+
+void test_matches_full_scan() {
+  MetricAggregates aggregates;
+  auto id = aggregates.add({.group_id = "Plant", .metric_name = "Temp"});
+  std::map<std::string, double> latest; // Reference: full recomputation
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<double> values(-50.0, 150.0);
+
+  for (int i = 0; i < 20000; ++i) {
+    auto node = std::format("Edge{:02}", rng() % 40);
+    if (rng() % 20 == 0) {
+      aggregates.retract("Plant", node, "");
+      latest.erase(node);
+    } else {
+      double v = std::round(values(rng));
+      aggregates.update(data_topic(node), double_metric("Temp", v), nullptr);
+      latest[node] = v;
+    }
+    if (i % 97 != 0) {
+      continue;
+    }
+    auto value = aggregates.value(id);
+    assert(value->count == latest.size());
+    if (latest.empty()) {
+      continue;
+    }
+    double sum = 0.0;
+    double lo = latest.begin()->second;
+    double hi = lo;
+    for (const auto& [node_id, v] : latest) {
+      sum += v;
+      lo = std::min(lo, v);
+      hi = std::max(hi, v);
+    }
+    assert(std::abs(value->sum - sum) < 1e-6);
+    assert(value->min == lo && value->max == hi);
+  }
+
+  std::cout << "[OK] Incremental aggregate matches a full scan\n";
+}
+
+void test_host_aggregates() {
+  sparkplug::HostApplication host({.broker_url = "tcp://localhost:1883",
+                                   .client_id = "test_aggregate_host",
+                                   .host_id = "AggregateHost"});
+  auto total = host.add_aggregate({.group_id = "AggTest", .metric_name = "Power"});
+  if (!host.connect()) {
+    std::cout << "[SKIP] Skipping (no MQTT broker): host aggregates\n";
+    return;
+  }
+  assert(host.subscribe_group("AggTest").has_value());
+
+  std::vector<std::unique_ptr<sparkplug::EdgeNode>> nodes;
+  for (int i = 0; i < 3; ++i) {
+    auto id = std::format("Edge{:02}", i);
+    nodes.push_back(std::make_unique<sparkplug::EdgeNode>(
+        sparkplug::EdgeNode::Config{.broker_url = "tcp://localhost:1883",
+                                    .client_id = "test_aggregate_" + id,
+                                    .group_id = "AggTest",
+                                    .edge_node_id = id}));
+    assert(nodes.back()->connect().has_value());
+    sparkplug::PayloadBuilder birth;
+    birth.add_metric_with_alias("Power", 1, 10.0 * (i + 1));
+    assert(nodes.back()->publish_birth(birth).has_value());
+  }
+  std::this_thread::sleep_for(300ms);
+  auto value = host.get_aggregate(total);
+  assert(value && value->count == 3 && value->sum == 60.0);
+
+  sparkplug::PayloadBuilder data;
+  data.add_metric_by_alias(1, 5.0);
+  assert(nodes[2]->publish_data(data).has_value());
+  (void)nodes[0]->disconnect(); // NDEATH retracts its 10.0
+  std::this_thread::sleep_for(300ms);
+  value = host.get_aggregate(total);
+  assert(value && value->count == 2 && value->sum == 25.0 && value->max == 20.0);
+
+  for (auto& node : nodes) {
+    (void)node->disconnect();
+  }
+  (void)host.disconnect();
+  std::cout << "[OK] Host maintains group totals from live traffic\n";
+}
+
+int main() {
+  std::cout << "=== Metric Aggregate Tests ===\n";
+  test_sum_count_extremes();
+  test_suspend_and_resume();
+  test_matches_full_scan();
+  test_host_aggregates();
+  std::cout << "\nAll metric aggregate tests passed!\n";
+  return 0;
+}
@@ -0,0 +1,170 @@
+// tests/test_node_state_budget.cpp
+// Tests for LRU eviction of offline node state under a memory budget.
+// Host state is loaded through import_state(), so no MQTT broker is needed.
+
+#include <cassert>
+#include <format>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <sparkplug/host_application.hpp>
+#include <sparkplug/node_state_budget.hpp>
+
+using sparkplug::NodeStateBudget;
+using Residency = NodeStateBudget::Residency;
+
+void test_lru_order() {
+  NodeStateBudget budget(1000);
+  budget.update("G", "A", 300, Residency::Offline);
+  budget.update("G", "B", 300, Residency::Offline);
+  budget.update("G", "C", 300, Residency::Online);
+  assert(budget.used_bytes() == 900);
+  assert(budget.victim() == nullptr); // Within budget
+
+  budget.update("G", "D", 300, Residency::Offline);
+  assert(budget.victim() != nullptr && budget.victim()->edge_node_id == "A");
+
+  // Activity moves A to the back; B is now the oldest offline node
+  budget.update("G", "A", 300, Residency::Offline);
+  assert(budget.victim()->edge_node_id == "B");
+  budget.update("G", "B", 40, Residency::Tombstone);
+  assert(budget.used_bytes() == 940);
+  assert(budget.victim() == nullptr);
+
+  // Online nodes are never victims, even far over budget
+  budget.update("G", "A", 5000, Residency::Online);
+  assert(budget.victim()->edge_node_id == "D");
+  budget.update("G", "D", 40, Residency::Tombstone);
+  assert(budget.victim() == nullptr);
+
+  auto stats = budget.stats();
+  assert(stats.nodes == 4 && stats.evictable == 0);
+  assert(stats.tombstones == 2 && stats.evictions == 2);
+  assert(stats.used_bytes == 5000 + 300 + 40 + 40);
+
+  std::cout << "[OK] Oldest offline node is the victim, online nodes never\n";
+}
+
+void test_accounting() {
+  NodeStateBudget unlimited(0);
+  unlimited.update("G", "A", 1 << 20, Residency::Offline);
+  assert(unlimited.victim() == nullptr); // 0 = accounting only
+  assert(unlimited.contains("G", "A") && !unlimited.contains("G", "B"));
+
+  // A tombstone that rebirths is no longer a tombstone and was not re-evicted
+  unlimited.update("G", "A", 10, Residency::Tombstone);
+  unlimited.update("G", "A", 500, Residency::Online);
+  auto stats = unlimited.stats();
+  assert(stats.tombstones == 0 && stats.evictions == 1 && stats.used_bytes == 500);
+
+  // Shared memory is counted once, on top of the nodes
+  unlimited.set_shared_bytes(200);
+  assert(unlimited.used_bytes() == 700 && unlimited.stats().shared_bytes == 200);
+  unlimited.set_shared_bytes(0);
+
+  unlimited.erase("G", "A");
+  assert(unlimited.used_bytes() == 0 && !unlimited.contains("G", "A"));
+  unlimited.update("G", "B", 10, Residency::Tombstone);
+  unlimited.clear();
+  stats = unlimited.stats();
+  assert(stats.nodes == 0 && stats.tombstones == 0 && stats.evictions == 1);
+
+  std::cout << "[OK] Usage, tombstones and evictions are counted\n";
+}
+
+// Hand-encoded replication snapshot (single-byte varints only), see
+// tests/test_state_replication.cpp. Metric names differ per node so that no alias
+// table is shared and evicting a node frees its tables.
+std::vector<uint8_t> fleet_snapshot(int offline_nodes) {
+  std::vector<uint8_t> bytes = {'S', 'P', 'R', 'S', 1, 0, 0,
+                                static_cast<uint8_t>(offline_nodes + 1)};
+  auto str = [&](std::string_view s) {
+    bytes.push_back(static_cast<uint8_t>(s.size()));
+    bytes.insert(bytes.end(), s.begin(), s.end());
+  };
+  auto node = [&](const std::string& edge_node_id, uint8_t flags) {
+    str("Plant");
+    str(edge_node_id);
+    bytes.insert(bytes.end(), {flags, 9, 2, 100}); // seq 9, bdSeq 2
+    bytes.insert(bytes.end(), {2, 1});             // Two aliases
+    str(edge_node_id + "/Temperature/Average");
+    bytes.push_back(2);
+    str(edge_node_id + "/Pressure/Average");
+    bytes.push_back(1); // One device
+    str("Pump01");
+    bytes.insert(bytes.end(), {0x02, 4, 0, 1, 3});
+    str(edge_node_id + "/Pump/Speed/Setpoint");
+  };
+  node("Online", 0x07);
+  for (int i = 0; i < offline_nodes; ++i) {
+    node(std::format("Edge{:03}", i), 0x06);
+  }
+  return bytes;
+}
+
+void test_host_eviction() {
+  sparkplug::HostApplication host({.broker_url = "tcp://localhost:1883",
+                                   .client_id = "test_budget_host",
+                                   .host_id = "BudgetHost"});
+  assert(host.import_state(fleet_snapshot(100)).has_value());
+
+  // Accounting only: everything is measured, nothing evicted
+  host.enable_memory_budget(0);
+  auto full = host.get_memory_stats();
+  assert(full.nodes == 101 && full.evictable == 100 && full.evictions == 0);
+  auto before = host.get_node_state("Plant", "Edge000");
+  assert(before && before->memory_bytes > 0 && !before->evicted);
+  assert(full.used_bytes >= 101 * before->memory_bytes / 2);
+
+  // Half the budget: offline nodes become tombstones until it fits
+  host.enable_memory_budget(full.used_bytes / 2);
+  auto stats = host.get_memory_stats();
+  assert(stats.used_bytes <= stats.budget_bytes);
+  assert(stats.evictions > 0 && stats.tombstones == stats.evictions);
+  assert(stats.evictable == 100 - stats.evictions);
+
+  // Imported nodes have no activity history, so look for which ones went
+  std::string evicted_id;
+  std::string kept_id;
+  size_t evicted_count = 0;
+  for (int i = 0; i < 100; ++i) {
+    auto id = std::format("Edge{:03}", i);
+    auto state = host.get_node_state("Plant", id);
+    assert(state.has_value());
+    if (state->evicted) {
+      evicted_count++;
+      evicted_id = id;
+    } else {
+      kept_id = id;
+    }
+  }
+  assert(evicted_count == stats.evictions && !kept_id.empty());
+
+  auto evicted = host.get_node_state("Plant", evicted_id);
+  assert(!evicted->birth_received);
+  assert(evicted->last_seq == 9 && evicted->bd_seq == 2); // Scalars survive
+  assert(evicted->memory_bytes < before->memory_bytes);
+  assert(!host.get_metric_name("Plant", evicted_id, "", 1).has_value());
+  assert(!host.get_metric_name("Plant", evicted_id, "Pump01", 3).has_value());
+  assert(host.get_metric_name("Plant", kept_id, "", 2) == kept_id + "/Pressure/Average");
+
+  // Online nodes stay whole even when the budget cannot be met
+  host.enable_memory_budget(1);
+  assert(host.get_memory_stats().evictable == 0);
+  assert(host.get_metric_name("Plant", "Online", "Pump01", 3) ==
+         "Online/Pump/Speed/Setpoint");
+  assert(!host.get_node_state("Plant", "Online")->evicted);
+
+  std::cout << std::format("[OK] Host evicted {} of 100 offline nodes ({} -> {} bytes)\n",
+                           stats.evictions, full.used_bytes, stats.used_bytes);
+}
+
+int main() {
+  std::cout << "=== Node State Budget Tests ===\n";
+  test_lru_order();
+  test_accounting();
+  test_host_eviction();
+  std::cout << "\nAll node state budget tests passed!\n";
+  return 0;
+}
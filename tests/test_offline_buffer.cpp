@@ -0,0 +1,111 @@
+// tests/test_offline_buffer.cpp
+// Tests for offline buffering and publish status reporting.
+// Broker-dependent tests skip when no MQTT broker is on localhost:1883.
+
+#include <cassert>
+#include <iostream>
+
+#include <sparkplug/edge_node.hpp>
+
+using PublishStatus = sparkplug::EdgeNode::PublishStatus;
+
+void test_not_connected() {
+  sparkplug::EdgeNode::Config config{
+      .broker_url = "tcp://localhost:1883",
+      .client_id = "test_offline_no_conn",
+      .group_id = "Test",
+      .edge_node_id = "OfflineNode01",
+      .offline_buffer = sparkplug::EdgeNode::OfflineBufferOptions{}};
+  sparkplug::EdgeNode node(std::move(config));
+
+  // Nothing to buffer into before the first connect()
+  sparkplug::PayloadBuilder data;
+  data.add_metric("test", 1);
+  assert(!node.try_publish_data(data).has_value());
+  assert(!node.try_publish_device_data("Dev01", data).has_value());
+  assert(node.get_pending_messages() == 0);
+
+  std::cout << "[OK] try_publish_data before connect fails\n";
+}
+
+void test_sent_status() {
+  sparkplug::EdgeNode::Config config{
+      .broker_url = "tcp://localhost:1883",
+      .client_id = "test_offline_sent",
+      .group_id = "Test",
+      .edge_node_id = "OfflineNode02",
+      .offline_buffer = sparkplug::EdgeNode::OfflineBufferOptions{
+          .max_buffered_messages = 10, .delete_oldest = false}};
+  sparkplug::EdgeNode node(std::move(config));
+  if (!node.connect()) {
+    std::cout << "[SKIP] Skipping (no MQTT broker): sent status\n";
+    return;
+  }
+
+  sparkplug::PayloadBuilder birth;
+  birth.add_metric_with_alias("Value", 1, int32_t{0});
+  assert(node.publish_birth(birth).has_value());
+
+  sparkplug::PayloadBuilder data;
+  data.add_metric_by_alias(1, int32_t{1});
+  auto status = node.try_publish_data(data);
+  assert(status.has_value() && *status == PublishStatus::Sent);
+
+  // A reconnect keeps the client (and anything it buffered)
+  assert(node.disconnect().has_value());
+  assert(node.connect().has_value());
+  assert(node.publish_birth(birth).has_value());
+  assert(node.get_seq() == 0);
+
+  (void)node.disconnect();
+  std::cout << "[OK] Connected publishes report Sent; reconnect reuses the client\n";
+}
+
+void test_would_block() {
+  sparkplug::EdgeNode::Config config{
+      .broker_url = "tcp://localhost:1883",
+      .client_id = "test_offline_block",
+      .group_id = "Test",
+      .edge_node_id = "OfflineNode03",
+      .data_qos = 1, // QoS 1 keeps tokens pending until PUBACK
+      .offline_buffer =
+          sparkplug::EdgeNode::OfflineBufferOptions{.max_pending_messages = 4}};
+  sparkplug::EdgeNode node(std::move(config));
+  if (!node.connect()) {
+    std::cout << "[SKIP] Skipping (no MQTT broker): would block\n";
+    return;
+  }
+
+  sparkplug::PayloadBuilder birth;
+  birth.add_metric_with_alias("Value", 1, int32_t{0});
+  assert(node.publish_birth(birth).has_value());
+
+  uint64_t sent = 0;
+  for (int i = 0; i < 200; ++i) {
+    sparkplug::PayloadBuilder data;
+    data.add_metric_by_alias(1, int32_t{i});
+    auto status = node.try_publish_data(data);
+    assert(status.has_value());
+    if (*status == PublishStatus::Sent) {
+      sent++;
+    } else {
+      assert(*status == PublishStatus::WouldBlock);
+      assert(!data.has_seq()); // Nothing was assigned
+    }
+  }
+
+  // WouldBlock never consumes a sequence number
+  assert(node.get_seq() == sent % 256);
+
+  (void)node.disconnect();
+  std::cout << "[OK] Pending depth limit reports WouldBlock without seq gaps\n";
+}
+
+int main() {
+  std::cout << "=== Offline Buffer Tests ===\n";
+  test_not_connected();
+  test_sent_status();
+  test_would_block();
+  std::cout << "\nAll offline buffer tests passed!\n";
+  return 0;
+}
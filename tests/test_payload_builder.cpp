@@ -188,6 +188,18 @@ void test_payload_sequence() {
   std::cout << "[OK] Payload sequence number\n";
 }
 
+void test_reset() {
+  sparkplug::PayloadBuilder payload;
+  payload.set_seq(7).set_timestamp(1000).add_metric("test", 42);
+
+  payload.reset();
+  assert(!payload.has_seq() && !payload.has_timestamp());
+  assert(!payload.payload().has_seq() && !payload.payload().has_timestamp());
+  assert(payload.payload().metrics_size() == 0);
+
+  std::cout << "[OK] Reset clears metrics, seq and timestamp\n";
+}
+
 void test_empty_payload() {
   sparkplug::PayloadBuilder payload;
 
@@ -283,6 +295,7 @@ int main() {
   test_auto_timestamp();
   test_payload_timestamp();
   test_payload_sequence();
+  test_reset();
   test_empty_payload();
   test_multiple_metrics();
   test_method_chaining();
@@ -0,0 +1,226 @@
+// tests/test_primary_host.cpp
+// Tests for primary host STATE notification and automatic births on EdgeNode.
+// Broker-dependent tests skip when no MQTT broker is on localhost:1883.
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <format>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sparkplug/edge_node.hpp>
+#include <sparkplug/host_application.hpp>
+
+using namespace std::chrono_literals;
+
+uint64_t now_ms() {
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                   std::chrono::system_clock::now().time_since_epoch())
+                                   .count());
+}
+
+void test_not_connected() {
+  sparkplug::EdgeNode node({.broker_url = "tcp://localhost:1883",
+                            .client_id = "test_primary_unconnected",
+                            .group_id = "PrimaryTest",
+                            .edge_node_id = "Edge01",
+                            .primary_host_id = "PrimaryHost",
+                            .auto_birth = true});
+  auto start = std::chrono::steady_clock::now();
+  assert(!node.wait_for_primary_host(50ms));
+  assert(std::chrono::steady_clock::now() - start >= 50ms);
+
+  sparkplug::PayloadBuilder birth;
+  birth.add_metric("Temperature", 20.0);
+  assert(!node.publish_birth(birth).has_value());
+
+  std::cout << "[OK] Waiting without a connection times out\n";
+}
+
+void test_auto_birth() {
+  // Messages seen by the host, in arrival order
+  std::mutex seen_mutex;
+  std::vector<std::string> seen;
+  sparkplug::HostApplication host(
+      {.broker_url = "tcp://localhost:1883",
+       .client_id = "test_primary_host",
+       .host_id = "PrimaryHost",
+       .message_callback = [&](const sparkplug::Topic& topic,
+                               const org::eclipse::tahu::protobuf::Payload& payload) {
+         if (topic.group_id != "PrimaryTest") {
+           return;
+         }
+         std::scoped_lock lock(seen_mutex);
+         seen.push_back(std::format("{}:{}", topic.to_string(), payload.seq()));
+       }});
+  if (!host.connect()) {
+    std::cout << "[SKIP] Skipping (no MQTT broker): automatic birth\n";
+    return;
+  }
+  assert(host.subscribe_group("PrimaryTest").has_value());
+  assert(host.publish_state_death(now_ms()).has_value());
+
+  std::atomic<int> online_events{0};
+  std::atomic<int> offline_events{0};
+  sparkplug::EdgeNode node(
+      {.broker_url = "tcp://localhost:1883",
+       .client_id = "test_primary_edge",
+       .group_id = "PrimaryTest",
+       .edge_node_id = "Edge01",
+       .primary_host_id = "PrimaryHost",
+       .primary_host_callback = [&](bool online) { (online ? online_events
+                                                           : offline_events)++; },
+       .auto_birth = true});
+  assert(node.connect().has_value());
+  assert(!node.wait_for_primary_host(200ms));
+
+  // Births are held while the host is offline; data is refused until they go out
+  sparkplug::PayloadBuilder birth;
+  birth.add_metric_with_alias("Temperature", 1, 20.0);
+  assert(node.publish_birth(birth).has_value());
+  sparkplug::PayloadBuilder device_birth;
+  device_birth.add_metric_with_alias("Speed", 2, 100.0);
+  assert(node.publish_device_birth("Motor01", device_birth).has_value());
+  sparkplug::PayloadBuilder early;
+  early.add_metric_by_alias(1, 21.0);
+  assert(!node.publish_data(early).has_value());
+
+  std::this_thread::sleep_for(200ms);
+  {
+    std::scoped_lock lock(seen_mutex);
+    assert(seen.empty());
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  assert(host.publish_state_birth(now_ms()).has_value());
+  assert(node.wait_for_primary_host(2s));
+  auto woke_after = std::chrono::steady_clock::now() - start;
+  assert(online_events == 1);
+
+  sparkplug::PayloadBuilder data;
+  data.add_metric_by_alias(1, 22.0);
+  assert(node.publish_data(data).has_value());
+  std::this_thread::sleep_for(300ms);
+  {
+    std::scoped_lock lock(seen_mutex);
+    assert(seen.size() == 3);
+    assert(seen[0] == "spBv1.0/PrimaryTest/NBIRTH/Edge01:0");
+    assert(seen[1] == "spBv1.0/PrimaryTest/DBIRTH/Edge01/Motor01:1");
+    assert(seen[2] == "spBv1.0/PrimaryTest/NDATA/Edge01:2");
+    seen.clear();
+  }
+
+  // The host going away and coming back triggers a fresh set of births
+  assert(host.publish_state_death(now_ms()).has_value());
+  std::this_thread::sleep_for(200ms);
+  assert(offline_events == 1);
+  assert(!node.is_primary_host_online());
+  assert(host.publish_state_birth(now_ms()).has_value());
+  assert(node.wait_for_primary_host(2s));
+  std::this_thread::sleep_for(300ms);
+  {
+    std::scoped_lock lock(seen_mutex);
+    assert(seen.size() == 2);
+    assert(seen[0] == "spBv1.0/PrimaryTest/NBIRTH/Edge01:0");
+    assert(seen[1] == "spBv1.0/PrimaryTest/DBIRTH/Edge01/Motor01:1");
+  }
+  assert(online_events == 2);
+
+  (void)node.disconnect();
+  (void)host.publish_state_death(now_ms());
+  (void)host.disconnect();
+  std::cout << "[OK] Births follow the primary host STATE (woke after "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(woke_after).count()
+            << " ms)\n";
+}
+
+void test_auto_birth_keeps_conflated() {
+  std::mutex seen_mutex;
+  std::vector<std::string> seen;
+  sparkplug::HostApplication host(
+      {.broker_url = "tcp://localhost:1883",
+       .client_id = "test_primary_conflate_host",
+       .host_id = "ConflateHost",
+       .message_callback = [&](const sparkplug::Topic& topic,
+                               const org::eclipse::tahu::protobuf::Payload& payload) {
+         if (topic.group_id != "PrimaryConflate") {
+           return;
+         }
+         std::string values;
+         for (const auto& metric : payload.metrics()) {
+           if (metric.name() != "bdSeq") {
+             values += std::format(" {}", metric.int_value());
+           }
+         }
+         std::scoped_lock lock(seen_mutex);
+         seen.push_back(std::format("{}:{}", topic.to_string(), payload.seq()) + values);
+       }});
+  if (!host.connect()) {
+    std::cout << "[SKIP] Skipping (no MQTT broker): auto birth with conflation\n";
+    return;
+  }
+  assert(host.subscribe_group("PrimaryConflate").has_value());
+  assert(host.publish_state_birth(now_ms()).has_value());
+
+  sparkplug::EdgeNode node(
+      {.broker_url = "tcp://localhost:1883",
+       .client_id = "test_primary_conflate_edge",
+       .group_id = "PrimaryConflate",
+       .edge_node_id = "Edge01",
+       .primary_host_id = "ConflateHost",
+       .auto_birth = true,
+       .rate_limit = sparkplug::EdgeNode::RateLimitOptions{
+           .messages_per_second = 1.0,
+           .burst_seconds = 1.0,
+           .policy = sparkplug::EdgeNode::RateLimitPolicy::Conflate}});
+  assert(node.connect().has_value());
+  assert(node.wait_for_primary_host(2s));
+
+  sparkplug::PayloadBuilder birth;
+  birth.add_metric_with_alias("Temperature", 1, int32_t{0});
+  assert(node.publish_birth(birth).has_value());
+  sparkplug::PayloadBuilder first;
+  first.add_metric_by_alias(1, int32_t{1});
+  assert(node.publish_data(first).has_value()); // Uses the only token
+  sparkplug::PayloadBuilder second;
+  second.add_metric_by_alias(1, int32_t{2});
+  assert(node.publish_data(second).has_value()); // Conflated
+  assert(node.get_rate_limit_stats().pending == 1);
+
+  // The births republished for the returning host date from the original birth;
+  // the held value must follow them rather than be dropped
+  assert(host.publish_state_death(now_ms()).has_value());
+  std::this_thread::sleep_for(1100ms); // Refills the data lane token
+  {
+    std::scoped_lock lock(seen_mutex);
+    seen.clear();
+  }
+  assert(host.publish_state_birth(now_ms()).has_value());
+  assert(node.wait_for_primary_host(2s));
+  std::this_thread::sleep_for(300ms);
+  {
+    std::scoped_lock lock(seen_mutex);
+    assert(seen.size() == 2);
+    assert(seen[0] == "spBv1.0/PrimaryConflate/NBIRTH/Edge01:0 0");
+    assert(seen[1] == "spBv1.0/PrimaryConflate/NDATA/Edge01:1 2");
+  }
+  assert(node.get_rate_limit_stats().pending == 0);
+
+  (void)node.disconnect();
+  (void)host.publish_state_death(now_ms());
+  (void)host.disconnect();
+  std::cout << "[OK] Automatic births keep conflated data and send it after them\n";
+}
+
+int main() {
+  std::cout << "=== Primary Host Tests ===\n";
+  test_not_connected();
+  test_auto_birth();
+  test_auto_birth_keeps_conflated();
+  std::cout << "\nAll primary host tests passed!\n";
+  return 0;
+}
@@ -0,0 +1,180 @@
+// tests/test_rate_limit.cpp
+// Tests for the token bucket and EdgeNode data lane rate limiting.
+// The EdgeNode tests need an MQTT broker on localhost:1883 and skip without one.
+
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+#include <sparkplug/detail/token_bucket.hpp>
+#include <sparkplug/edge_node.hpp>
+
+using namespace std::chrono_literals;
+using sparkplug::detail::TokenBucket;
+
+void test_token_bucket() {
+  auto start = TokenBucket::Clock::now();
+  TokenBucket bucket(10.0, 5.0, start);
+
+  for (int i = 0; i < 5; ++i) {
+    assert(bucket.try_consume(1.0, start)); // Starts full
+  }
+  assert(!bucket.try_consume(1.0, start));
+  assert(!bucket.try_consume(1.0, start + 50ms)); // Half a token accrued
+  assert(bucket.try_consume(1.0, start + 150ms));
+
+  // Refill is capped at capacity
+  assert(bucket.try_consume(5.0, start + 10s));
+  assert(!bucket.try_consume(1.0, start + 10s));
+
+  // Oversized costs pass once the bucket is full, then leave a debt
+  TokenBucket bytes(100.0, 100.0, start);
+  assert(bytes.try_consume(250.0, start));
+  assert(bytes.tokens() < 0.0);
+  assert(!bytes.try_consume(1.0, start + 1s));
+  assert(bytes.try_consume(1.0, start + 3s));
+
+  TokenBucket unlimited;
+  assert(unlimited.unlimited());
+  assert(unlimited.try_consume(1e9, start));
+
+  std::cout << "[OK] Token bucket refills, caps and admits oversized costs\n";
+}
+
+void test_reject_policy() {
+  sparkplug::EdgeNode::Config config{
+      .broker_url = "tcp://localhost:1883",
+      .client_id = "test_rate_limit_reject",
+      .group_id = "TestGroup",
+      .edge_node_id = "RateLimitReject",
+      .rate_limit = sparkplug::EdgeNode::RateLimitOptions{
+          .messages_per_second = 5.0, .burst_seconds = 1.0}};
+  sparkplug::EdgeNode node(std::move(config));
+  if (!node.connect()) {
+    std::cout << "[SKIP] Skipping (no MQTT broker): reject policy\n";
+    return;
+  }
+
+  sparkplug::PayloadBuilder birth;
+  birth.add_metric_with_alias("Value", 1, int32_t{0});
+  assert(node.publish_birth(birth).has_value());
+
+  int sent = 0;
+  int rejected = 0;
+  for (int i = 0; i < 20; ++i) {
+    sparkplug::PayloadBuilder data;
+    data.add_metric_by_alias(1, int32_t{i});
+    if (node.publish_data(data)) {
+      sent++;
+    } else {
+      rejected++;
+    }
+  }
+  assert(sent >= 5 && sent < 20);
+  assert(rejected > 0);
+
+  // Rejected messages do not consume sequence numbers
+  assert(node.get_seq() == static_cast<uint64_t>(sent));
+
+  // A rejected builder is left untouched, and a retry gets the next seq
+  sparkplug::PayloadBuilder retry;
+  retry.add_metric_by_alias(1, int32_t{100});
+  assert(!node.publish_data(retry).has_value());
+  rejected++;
+  assert(!retry.has_seq() && !retry.payload().has_seq());
+  std::this_thread::sleep_for(300ms);
+  assert(node.publish_data(retry).has_value());
+  assert(retry.payload().has_seq() && retry.payload().seq() == node.get_seq());
+  sent++;
+
+  // The priority lane ignores the exhausted bucket
+  sparkplug::PayloadBuilder ack;
+  ack.add_metric_by_alias(1, int32_t{-1});
+  assert(node.publish_data(ack, sparkplug::EdgeNode::PublishLane::Priority));
+
+  auto stats = node.get_rate_limit_stats();
+  assert(stats.admitted == static_cast<uint64_t>(sent));
+  assert(stats.rejected == static_cast<uint64_t>(rejected));
+  assert(stats.priority == 1);
+
+  (void)node.disconnect();
+  std::cout << "[OK] Reject policy refuses excess data; priority lane bypasses it\n";
+}
+
+void test_conflate_policy() {
+  sparkplug::EdgeNode::Config config{
+      .broker_url = "tcp://localhost:1883",
+      .client_id = "test_rate_limit_conflate",
+      .group_id = "TestGroup",
+      .edge_node_id = "RateLimitConflate",
+      .rate_limit = sparkplug::EdgeNode::RateLimitOptions{
+          .messages_per_second = 1.0,
+          .burst_seconds = 1.0,
+          .policy = sparkplug::EdgeNode::RateLimitPolicy::Conflate}};
+  sparkplug::EdgeNode node(std::move(config));
+  if (!node.connect()) {
+    std::cout << "[SKIP] Skipping (no MQTT broker): conflate policy\n";
+    return;
+  }
+
+  sparkplug::PayloadBuilder birth;
+  birth.add_metric_with_alias("A", 1, int32_t{0});
+  birth.add_metric_with_alias("B", 2, int32_t{0});
+  assert(node.publish_birth(birth).has_value());
+
+  sparkplug::PayloadBuilder first;
+  first.add_metric_by_alias(1, int32_t{1});
+  assert(node.publish_data(first).has_value()); // Uses the only token
+
+  sparkplug::PayloadBuilder second;
+  second.add_metric_by_alias(1, int32_t{2});
+  assert(node.publish_data(second).has_value()); // Conflated
+
+  sparkplug::PayloadBuilder third;
+  third.add_metric_by_alias(1, int32_t{3});
+  third.add_metric_by_alias(2, int32_t{30});
+  assert(node.publish_data(third).has_value()); // Conflated, A=3 supersedes A=2
+
+  auto stats = node.get_rate_limit_stats();
+  assert(stats.conflated == 2);
+  assert(stats.pending == 1);
+  assert(node.get_seq() == 1);
+
+  // The next message that goes out carries the pending metrics along
+  sparkplug::PayloadBuilder ack;
+  ack.add_metric_by_alias(2, int32_t{40});
+  assert(node.publish_data(ack, sparkplug::EdgeNode::PublishLane::Priority));
+  const auto& metrics = ack.payload().metrics();
+  assert(metrics.size() == 2);
+  assert(metrics[0].alias() == 1 && metrics[0].int_value() == 3);
+  assert(metrics[1].alias() == 2 && metrics[1].int_value() == 40);
+  assert(node.get_rate_limit_stats().pending == 0);
+  assert(node.get_seq() == 2);
+
+  // flush_conflated() sends pending metrics once tokens are available
+  sparkplug::PayloadBuilder fourth;
+  fourth.add_metric_by_alias(1, int32_t{4});
+  assert(node.publish_data(fourth).has_value());
+  assert(node.get_rate_limit_stats().pending == 1);
+  auto flushed = node.flush_conflated();
+  assert(flushed.has_value() && *flushed == 0); // Bucket still empty
+
+  std::this_thread::sleep_for(1100ms);
+  flushed = node.flush_conflated();
+  assert(flushed.has_value() && *flushed == 1);
+  assert(node.get_rate_limit_stats().pending == 0);
+  assert(node.get_seq() == 3);
+
+  (void)node.disconnect();
+  std::cout << "[OK] Conflate policy merges excess data and flushes it later\n";
+}
+
+int main() {
+  std::cout << "=== Rate Limit Tests ===\n";
+  test_token_bucket();
+  test_reject_policy();
+  test_conflate_policy();
+  std::cout << "\nAll rate limit tests passed!\n";
+  return 0;
+}
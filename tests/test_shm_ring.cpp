@@ -0,0 +1,192 @@
+// tests/test_shm_ring.cpp
+// Unit tests for the shared-memory fan-out ring (writer and readers in one process).
+// No broker required.
+
+#include <atomic>
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include <sparkplug/payload_builder.hpp>
+#include <sparkplug/shm_ring.hpp>
+
+namespace {
+
+std::string ring_name(std::string_view suffix) {
+  return "/sparkplug_test_" + std::to_string(getpid()) + "_" + std::string(suffix);
+}
+
+} // namespace
+
+void test_publish_and_read() {
+  auto name = ring_name("basic");
+  auto writer = sparkplug::ShmRingWriter::create(name, 64 * 1024);
+  assert(writer.has_value());
+
+  auto reader1 = sparkplug::ShmRingReader::open(name);
+  auto reader2 = sparkplug::ShmRingReader::open(name);
+  assert(reader1.has_value() && reader2.has_value());
+  assert(!reader1->try_read().has_value());
+
+  std::unordered_map<uint64_t, std::string> aliases{{1, "Temperature"}};
+  sparkplug::PayloadBuilder data;
+  data.set_timestamp(5000).set_seq(3);
+  data.add_metric_by_alias(1, 21.5, 4000);
+  data.add_metric("Label", std::string("hello"), 5000);
+  data.add_metric("Running", true, 5000);
+  data.add_metric("Count", static_cast<int32_t>(-2), 5000);
+
+  sparkplug::Topic topic{.group_id = "Energy",
+                         .message_type = sparkplug::MessageType::DDATA,
+                         .edge_node_id = "Gateway01",
+                         .device_id = "Sensor01"};
+  assert(writer->publish(topic, data.payload(), &aliases).has_value());
+
+  for (auto* reader : {&*reader1, &*reader2}) {
+    auto msg = reader->try_read();
+    assert(msg.has_value());
+    assert(msg->group_id == "Energy");
+    assert(msg->message_type == sparkplug::MessageType::DDATA);
+    assert(msg->edge_node_id == "Gateway01");
+    assert(msg->device_id == "Sensor01");
+    assert(msg->timestamp == 5000);
+    assert(msg->seq == 3u);
+    assert(msg->metrics.size() == 4);
+    assert(msg->metrics[0].name == "Temperature");
+    assert(msg->metrics[0].has_alias && msg->metrics[0].alias == 1);
+    assert(msg->metrics[0].timestamp == 4000);
+    assert(std::get<double>(msg->metrics[0].value) == 21.5);
+    assert(std::get<std::string_view>(msg->metrics[1].value) == "hello");
+    assert(std::get<bool>(msg->metrics[2].value));
+    assert(std::get<int64_t>(msg->metrics[3].value) == -2);
+    assert(!reader->try_read().has_value());
+  }
+
+  std::cout << "[OK] Messages fan out to independent readers\n";
+}
+
+void test_wraparound() {
+  auto name = ring_name("wrap");
+  auto writer = sparkplug::ShmRingWriter::create(name, 4096);
+  assert(writer.has_value());
+  auto reader = sparkplug::ShmRingReader::open(name);
+  assert(reader.has_value());
+
+  // 300-byte frames do not divide the ring evenly, forcing padding frames
+  std::vector<uint8_t> frame(300);
+  for (uint32_t i = 0; i < 200; ++i) {
+    std::memcpy(frame.data(), &i, sizeof(i));
+    assert(writer->write(frame).has_value());
+
+    auto read = reader->try_read_frame();
+    assert(read.has_value() && read->size() == frame.size());
+    uint32_t value = 0;
+    std::memcpy(&value, read->data(), sizeof(value));
+    assert(value == i);
+  }
+  assert(reader->overruns() == 0);
+
+  std::cout << "[OK] Frames survive wraparound\n";
+}
+
+void test_overrun_detection() {
+  auto name = ring_name("overrun");
+  auto writer = sparkplug::ShmRingWriter::create(name, 4096);
+  assert(writer.has_value());
+  auto reader = sparkplug::ShmRingReader::open(name);
+  assert(reader.has_value());
+
+  std::vector<uint8_t> frame(500);
+  for (int i = 0; i < 20; ++i) {
+    assert(writer->write(frame).has_value());
+  }
+
+  // Reader fell more than a full ring behind: it skips ahead and reports it
+  assert(!reader->try_read_frame().has_value());
+  assert(reader->overruns() == 1);
+
+  assert(writer->write(frame).has_value());
+  assert(reader->try_read_frame().has_value());
+
+  // Oversized frames are rejected
+  std::vector<uint8_t> huge(4096);
+  assert(!writer->write(huge).has_value());
+
+  std::cout << "[OK] Lagging reader detects overrun and resyncs\n";
+}
+
+void test_concurrent_reader() {
+  auto name = ring_name("concurrent");
+  auto writer = sparkplug::ShmRingWriter::create(name, 8192);
+  assert(writer.has_value());
+  auto reader = sparkplug::ShmRingReader::open(name);
+  assert(reader.has_value());
+
+  constexpr uint32_t kFrames = 200000;
+  std::atomic<bool> done{false};
+
+  std::thread producer([&] {
+    std::vector<uint8_t> frame(64);
+    for (uint32_t i = 1; i <= kFrames; ++i) {
+      // Every word of the frame carries the sequence number, so torn reads show up
+      for (size_t off = 0; off < frame.size(); off += sizeof(i)) {
+        std::memcpy(frame.data() + off, &i, sizeof(i));
+      }
+      (void)writer->write(frame);
+      if (i % 64 == 0) {
+        std::this_thread::yield(); // Let the reader in on single-core machines
+      }
+    }
+    done = true;
+  });
+
+  uint32_t last = 0;
+  uint64_t received = 0;
+  while (true) {
+    bool finished = done.load();
+    auto read = reader->try_read_frame();
+    if (!read) {
+      if (finished) {
+        break; // Writer was done before this poll came up empty
+      }
+      continue;
+    }
+    uint32_t first_word = 0;
+    std::memcpy(&first_word, read->data(), sizeof(first_word));
+    for (size_t off = 0; off < read->size(); off += sizeof(first_word)) {
+      uint32_t word = 0;
+      std::memcpy(&word, read->data() + off, sizeof(word));
+      assert(word == first_word);
+    }
+    assert(first_word > last);
+    last = first_word;
+    received++;
+  }
+  producer.join();
+
+  assert(received > 0);
+  std::cout << "[OK] Concurrent reader sees only whole, ordered frames (" << received
+            << " received, " << reader->overruns() << " overruns)\n";
+}
+
+void test_open_missing() {
+  auto reader = sparkplug::ShmRingReader::open(ring_name("missing"));
+  assert(!reader.has_value());
+  std::cout << "[OK] Opening a missing ring fails\n";
+}
+
+int main() {
+  std::cout << "=== Shared-Memory Ring Tests ===\n";
+  test_publish_and_read();
+  test_wraparound();
+  test_overrun_detection();
+  test_concurrent_reader();
+  test_open_missing();
+  std::cout << "\nAll shared-memory ring tests passed!\n";
+  return 0;
+}
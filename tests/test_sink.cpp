@@ -0,0 +1,254 @@
+// tests/test_sink.cpp
+// Unit tests for SinkPipeline batching/backpressure, the FileSink reference sink and
+// HostApplication::add_sink().
+// No broker required: records are pushed into the pipeline directly.
+
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sparkplug/host_application.hpp>
+#include <sparkplug/payload_builder.hpp>
+#include <sparkplug/sink.hpp>
+
+namespace {
+
+class RecordingSink : public sparkplug::Sink {
+public:
+  std::chrono::milliseconds delay{0};
+
+  sparkplug::stdx::expected<void, std::string>
+  write(std::span<const sparkplug::MetricRecord> batch) override {
+    if (delay.count() > 0) {
+      std::this_thread::sleep_for(delay);
+    }
+    std::scoped_lock lock(mutex_);
+    batch_sizes_.push_back(batch.size());
+    return {};
+  }
+
+  std::vector<size_t> batch_sizes() {
+    std::scoped_lock lock(mutex_);
+    return batch_sizes_;
+  }
+
+private:
+  std::mutex mutex_;
+  std::vector<size_t> batch_sizes_;
+};
+
+std::vector<sparkplug::MetricRecord> make_records(size_t n) {
+  std::vector<sparkplug::MetricRecord> records(n);
+  for (size_t i = 0; i < n; ++i) {
+    records[i].group_id = "G";
+    records[i].edge_node_id = "N";
+    records[i].message_type = sparkplug::MessageType::NDATA;
+    records[i].name = "Temperature";
+    records[i].datatype = 10;
+    records[i].timestamp = 1000 + i;
+    records[i].value = 20.0 + static_cast<double>(i);
+  }
+  return records;
+}
+
+} // namespace
+
+void test_size_trigger() {
+  auto sink = std::make_shared<RecordingSink>();
+  {
+    sparkplug::SinkPipeline pipeline(
+        sink, {.max_batch_size = 10, .flush_interval = std::chrono::seconds(30)});
+    auto records = make_records(25);
+    assert(pipeline.push(records) == 25);
+
+    for (int i = 0; i < 100 && pipeline.stats().batches_written < 2; ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    assert(pipeline.stats().batches_written == 2);
+  }
+
+  // Remaining 5 records are written on shutdown
+  auto sizes = sink->batch_sizes();
+  assert(sizes.size() == 3);
+  assert(sizes[0] == 10 && sizes[1] == 10 && sizes[2] == 5);
+
+  std::cout << "[OK] Size-triggered batches (10, 10, drain 5)\n";
+}
+
+void test_time_trigger() {
+  auto sink = std::make_shared<RecordingSink>();
+  sparkplug::SinkPipeline pipeline(
+      sink, {.max_batch_size = 1000, .flush_interval = std::chrono::milliseconds(50)});
+
+  auto records = make_records(3);
+  pipeline.push(records);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(300));
+  auto stats = pipeline.stats();
+  assert(stats.records_written == 3);
+  assert(stats.queue_depth == 0);
+
+  std::cout << "[OK] Time-triggered flush\n";
+}
+
+void test_block_backpressure() {
+  auto sink = std::make_shared<RecordingSink>();
+  sink->delay = std::chrono::milliseconds(20);
+
+  sparkplug::SinkPipeline pipeline(
+      sink, {.max_batch_size = 5,
+             .flush_interval = std::chrono::milliseconds(10),
+             .high_water_mark = 10,
+             .low_water_mark = 5,
+             .policy = sparkplug::BackpressurePolicy::Block});
+
+  auto records = make_records(5);
+  for (int i = 0; i < 20; ++i) {
+    pipeline.push(records);
+    assert(pipeline.stats().queue_depth <= 15);
+  }
+  pipeline.stop();
+
+  auto stats = pipeline.stats();
+  assert(stats.records_dropped == 0);
+  assert(stats.records_written == 100);
+  assert(stats.high_water_events > 0);
+
+  std::cout << "[OK] Block policy stalls producer without loss\n";
+}
+
+void test_drop_policies() {
+  auto sink = std::make_shared<RecordingSink>();
+  sink->delay = std::chrono::milliseconds(200);
+
+  {
+    sparkplug::SinkPipeline pipeline(
+        sink, {.max_batch_size = 4,
+               .flush_interval = std::chrono::seconds(30),
+               .high_water_mark = 4,
+               .low_water_mark = 2,
+               .policy = sparkplug::BackpressurePolicy::DropNewest});
+    auto records = make_records(4);
+    pipeline.push(records);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50)); // sink now busy
+    pipeline.push(records);
+    assert(pipeline.push(records) == 0);
+    assert(pipeline.stats().records_dropped == 4);
+  }
+
+  {
+    sparkplug::SinkPipeline pipeline(
+        sink, {.max_batch_size = 100,
+               .flush_interval = std::chrono::seconds(30),
+               .high_water_mark = 8,
+               .low_water_mark = 4,
+               .policy = sparkplug::BackpressurePolicy::DropOldest});
+    pipeline.push(make_records(8));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50)); // sink now busy
+    auto records = make_records(6);
+    pipeline.push(records);
+    assert(pipeline.push(records) == 6);
+    auto stats = pipeline.stats();
+    assert(stats.queue_depth == 8);
+    assert(stats.records_dropped == 4);
+  }
+
+  std::cout << "[OK] DropNewest / DropOldest policies\n";
+}
+
+void test_append_metric_records() {
+  std::unordered_map<uint64_t, std::string> aliases{{1, "Temperature"}, {2, "Running"}};
+
+  sparkplug::PayloadBuilder data;
+  data.set_timestamp(5000);
+  data.add_metric_by_alias(1, 21.5, 4000);
+  data.add_metric_by_alias(2, true);
+  data.add_metric("Label", "hello");
+  data.add_metric_by_alias(99, static_cast<int32_t>(-7));
+
+  sparkplug::Topic topic{.group_id = "G",
+                         .message_type = sparkplug::MessageType::DDATA,
+                         .edge_node_id = "N",
+                         .device_id = "D"};
+
+  std::vector<sparkplug::MetricRecord> records;
+  sparkplug::append_metric_records(topic, data.payload(), &aliases, records);
+
+  assert(records.size() == 4);
+  assert(records[0].name == "Temperature");
+  assert(records[0].timestamp == 4000);
+  assert(std::get<double>(records[0].value) == 21.5);
+  assert(records[1].name == "Running");
+  assert(std::get<bool>(records[1].value));
+  assert(records[2].name == "Label");
+  assert(std::get<std::string>(records[2].value) == "hello");
+  assert(records[3].name.empty()); // Unknown alias
+  assert(std::get<int64_t>(records[3].value) == -7);
+  assert(records[3].device_id == "D");
+
+  topic.message_type = sparkplug::MessageType::DDEATH;
+  records.clear();
+  sparkplug::append_metric_records(topic, data.payload(), &aliases, records);
+  assert(records.empty());
+
+  std::cout << "[OK] append_metric_records resolves aliases and decodes values\n";
+}
+
+void test_file_sink() {
+  const std::string path = "test_sink_output.csv";
+  std::remove(path.c_str());
+
+  {
+    auto sink = std::make_shared<sparkplug::FileSink>(path, false);
+    sparkplug::SinkPipeline pipeline(sink, {.max_batch_size = 2});
+    auto records = make_records(3);
+    records[2].name = "Say \"hi\"";
+    records[2].value = std::string("a,b");
+    pipeline.push(records);
+  }
+
+  std::ifstream in(path);
+  std::vector<std::string> lines;
+  for (std::string line; std::getline(in, line);) {
+    lines.push_back(line);
+  }
+  assert(lines.size() == 3);
+  assert(lines[0] == R"(1000,"G","N","",NDATA,"Temperature",10,20)");
+  assert(lines[2] == R"(1002,"G","N","",NDATA,"Say ""hi""",10,"a,b")");
+  std::remove(path.c_str());
+
+  std::cout << "[OK] FileSink writes CSV lines\n";
+}
+
+void test_host_add_sink() {
+  sparkplug::HostApplication host({.broker_url = "tcp://127.0.0.1:1", // Nothing listens
+                                   .client_id = "test_sink_host",
+                                   .host_id = "SinkHost"});
+  assert(host.add_sink(std::make_shared<RecordingSink>()).has_value());
+  (void)host.connect(); // Fails, but the client exists from here on
+
+  // Message callbacks read the sink list without a lock, so it is fixed now
+  assert(!host.add_sink(std::make_shared<RecordingSink>()).has_value());
+  assert(host.get_sink_stats().size() == 1);
+
+  std::cout << "[OK] Sinks are only added before connect()\n";
+}
+
+int main() {
+  std::cout << "=== SinkPipeline Tests ===\n";
+  test_size_trigger();
+  test_time_trigger();
+  test_block_backpressure();
+  test_drop_policies();
+  test_append_metric_records();
+  test_file_sink();
+  test_host_add_sink();
+  std::cout << "\nAll sink tests passed!\n";
+  return 0;
+}
@@ -0,0 +1,273 @@
+// tests/test_stale_detection.cpp
+// Tests for silent edge node/device detection on HostApplication.
+// The live test skips when no MQTT broker is on localhost:1883.
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <format>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sparkplug/detail/timer_wheel.hpp>
+#include <sparkplug/edge_node.hpp>
+#include <sparkplug/host_application.hpp>
+#include <sparkplug/stale_monitor.hpp>
+
+using namespace std::chrono_literals;
+using sparkplug::StaleMonitor;
+using sparkplug::detail::TimerWheel;
+
+void test_wheel_levels() {
+  auto start = TimerWheel::Clock::now();
+  TimerWheel wheel(1ms, 256, start);
+
+  // Delays spanning four levels fire at their own tick, never early
+  std::mt19937 rng(7);
+  std::uniform_int_distribution<int> level(0, 3);
+  std::map<uint32_t, uint64_t> expected; // timer -> expiry tick
+  std::map<uint32_t, uint64_t> fired;
+  std::vector<TimerWheel::TimerId> ids;
+  uint64_t now_tick = 0;
+  auto arm = [&](uint32_t n, uint64_t ticks) {
+    expected[n] = ticks;
+    return wheel.schedule_at(start + std::chrono::milliseconds(ticks),
+                             [&fired, &now_tick, n] { fired[n] = now_tick; });
+  };
+  for (uint32_t n = 0; n < 2000; ++n) {
+    uint64_t span = uint64_t{1} << (8 * (level(rng) + 1));
+    ids.push_back(arm(n, 1 + rng() % std::min<uint64_t>(span, 20000000)));
+  }
+  // Cancelled and moved timers
+  for (uint32_t n = 0; n < 2000; n += 10) {
+    assert(wheel.cancel(ids[n]));
+    expected.erase(n);
+  }
+  for (uint32_t n = 5; n < 2000; n += 10) {
+    assert(wheel.cancel(ids[n]));
+    ids[n] = arm(n, 300);
+  }
+  assert(!wheel.cancel(ids[0]));
+  assert(wheel.size() == expected.size());
+
+  // Tick by tick through the lower levels (exact), then in coarse strides
+  while (now_tick < 70000) {
+    wheel.advance(start + std::chrono::milliseconds(++now_tick));
+  }
+  for (const auto& [n, when] : fired) {
+    assert(when == expected[n]);
+  }
+  while (now_tick < 20000000) {
+    now_tick += 65536;
+    wheel.advance(start + std::chrono::milliseconds(now_tick));
+  }
+  assert(fired.size() == expected.size());
+  for (const auto& [n, when] : fired) {
+    assert(when >= expected[n] && when < expected[n] + 65536);
+  }
+  assert(wheel.size() == 0);
+
+  // A callback may arm a new timer for the same work
+  int count = 0;
+  std::function<void()> again = [&] {
+    if (++count < 3) {
+      wheel.schedule_at(start + std::chrono::milliseconds(now_tick + 10 + count * 20),
+                        again);
+    }
+  };
+  wheel.schedule_at(start + std::chrono::milliseconds(now_tick + 10), again);
+  wheel.advance(start + std::chrono::milliseconds(now_tick + 100));
+  assert(count == 3);
+  assert(wheel.size() == 0);
+
+  // Small levels stack deep enough that far expiries are not clamped
+  TimerWheel narrow(1ms, 2, start);
+  bool far_fired = false;
+  narrow.schedule(100000ms, [&] { far_fired = true; }); // 2^17 ticks, 17 levels
+  narrow.advance(start + 99999ms);
+  assert(!far_fired);
+  narrow.advance(start + 100000ms);
+  assert(far_fired);
+
+  std::cout << "[OK] Timer wheel fires across overflow levels, never early\n";
+}
+
+void test_stale_monitor() {
+  auto start = StaleMonitor::Clock::now();
+  StaleMonitor monitor({.node_timeout = 1000ms, .device_timeout = 500ms, .tick = 10ms},
+                       start);
+  std::vector<StaleMonitor::Expired> expired;
+
+  monitor.touch("Plant", "Edge01", "", start);
+  monitor.touch("Plant", "Edge02", "", start);
+  monitor.touch("Plant", "Edge01", "Pump01", start);
+  assert(monitor.size() == 3);
+
+  // Edge01 keeps talking (device included); touches only record the time
+  for (int i = 1; i <= 8; ++i) {
+    auto now = start + std::chrono::milliseconds(i * 200);
+    monitor.touch("Plant", "Edge01", "", now);
+    if (i < 2) {
+      monitor.touch("Plant", "Edge01", "Pump01", now);
+    }
+    monitor.expire(now, expired);
+  }
+  // The device went quiet after 200 ms, the node Edge02 immediately
+  assert(expired.size() == 2);
+  assert(expired[0].edge_node_id == "Edge01" && expired[0].device_id == "Pump01");
+  assert(expired[1].edge_node_id == "Edge02" && expired[1].device_id.empty());
+  assert(monitor.size() == 1);
+
+  // Removal (death) stops watching; a later touch starts again
+  monitor.remove("Plant", "Edge01", "");
+  assert(monitor.size() == 0);
+  expired.clear();
+  assert(monitor.expire(start + 10s, expired) == 0);
+  monitor.touch("Plant", "Edge02", "", start + 10s);
+  assert(monitor.expire(start + 11s, expired) == 1);
+
+  // Devices are not watched without a device timeout
+  StaleMonitor nodes_only({.node_timeout = 1000ms}, start);
+  nodes_only.touch("Plant", "Edge01", "Pump01", start);
+  assert(nodes_only.size() == 0);
+
+  std::cout << "[OK] Stale monitor re-arms lazily and reports silent entries\n";
+}
+
+void test_ids_with_separators() {
+  // Joined "group\x1fnode" keys used to make these two nodes one entry
+  auto start = StaleMonitor::Clock::now();
+  StaleMonitor monitor({.node_timeout = 1000ms, .tick = 10ms}, start);
+  monitor.touch("Plant\x1f" "A", "Edge01", "", start);
+  monitor.touch("Plant", "A\x1f" "Edge01", "", start);
+  assert(monitor.size() == 2);
+
+  std::vector<StaleMonitor::Expired> expired;
+  assert(monitor.expire(start + 2s, expired) == 2);
+  std::map<std::string, std::string> nodes;
+  for (const auto& entry : expired) {
+    nodes[entry.group_id] = entry.edge_node_id;
+  }
+  assert(nodes["Plant\x1f" "A"] == "Edge01");
+  assert(nodes["Plant"] == "A\x1f" "Edge01");
+
+  std::cout << "[OK] Ids containing 0x1F do not collide\n";
+}
+
+void test_scale() {
+  constexpr size_t kNodes = 100000;
+  auto start = StaleMonitor::Clock::now();
+  StaleMonitor monitor({.node_timeout = 60s, .tick = 100ms}, start);
+  std::vector<std::string> names;
+  names.reserve(kNodes);
+  for (size_t i = 0; i < kNodes; ++i) {
+    names.push_back(std::format("Edge{:06}", i));
+    monitor.touch("Fleet", names.back(), "", start);
+  }
+
+  // Each node reports every 12 s, except every tenth node, which falls silent
+  std::vector<StaleMonitor::Expired> expired;
+  auto begin = std::chrono::steady_clock::now();
+  size_t touches = 0;
+  for (int second = 1; second <= 120; ++second) {
+    auto now = start + std::chrono::seconds(second);
+    for (size_t i = 0; i < kNodes; ++i) {
+      if (i % 10 != 0 && second % 12 == 0) {
+        monitor.touch("Fleet", names[i], "", now);
+        touches++;
+      }
+    }
+    monitor.expire(now, expired);
+  }
+  auto elapsed = std::chrono::steady_clock::now() - begin;
+  assert(expired.size() == kNodes / 10);
+  assert(monitor.size() == kNodes - kNodes / 10);
+
+  auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+  std::cout << std::format("[OK] {} nodes: {} touches + expiry in {} ms ({} ns/touch)\n",
+                           kNodes, touches, ns / 1000000,
+                           ns / static_cast<int64_t>(touches));
+}
+
+void test_live_timeout() {
+  struct Event {
+    std::string node;
+    std::string device;
+    sparkplug::OfflineReason reason;
+  };
+  std::mutex events_mutex;
+  std::vector<Event> events;
+  sparkplug::HostApplication host(
+      {.broker_url = "tcp://localhost:1883",
+       .client_id = "test_stale_host",
+       .host_id = "StaleHost",
+       .offline_callback = [&](std::string_view, std::string_view edge_node_id,
+                               std::string_view device_id,
+                               sparkplug::OfflineReason reason) {
+         std::scoped_lock lock(events_mutex);
+         events.push_back({std::string(edge_node_id), std::string(device_id), reason});
+       }});
+  host.enable_stale_detection({.node_timeout = 300ms, .tick = 10ms});
+  if (!host.connect()) {
+    std::cout << "[SKIP] Skipping (no MQTT broker): live stale timeout\n";
+    return;
+  }
+  assert(host.subscribe_group("Stale").has_value());
+
+  sparkplug::EdgeNode node({.broker_url = "tcp://localhost:1883",
+                            .client_id = "test_stale_edge",
+                            .group_id = "Stale",
+                            .edge_node_id = "Edge01"});
+  assert(node.connect().has_value());
+  sparkplug::PayloadBuilder birth;
+  birth.add_metric_with_alias("Temperature", 1, 20.0);
+  assert(node.publish_birth(birth).has_value());
+  sparkplug::PayloadBuilder device_birth;
+  device_birth.add_metric_with_alias("Speed", 2, 100.0);
+  assert(node.publish_device_birth("Pump01", device_birth).has_value());
+  std::this_thread::sleep_for(100ms);
+  assert(host.get_node_state("Stale", "Edge01")->is_online);
+
+  // The node stays connected but stops publishing
+  std::this_thread::sleep_for(400ms);
+  assert(host.check_stale() == 1);
+  auto state = host.get_node_state("Stale", "Edge01");
+  assert(!state->is_online);
+  assert(state->offline_reason == sparkplug::OfflineReason::Timeout);
+  {
+    std::scoped_lock lock(events_mutex);
+    assert(events.size() == 1 && events[0].node == "Edge01" && events[0].device.empty());
+  }
+
+  // Its next message brings it back; a real death is reported as such
+  sparkplug::PayloadBuilder data;
+  data.add_metric_by_alias(1, 21.0);
+  assert(node.publish_data(data).has_value());
+  std::this_thread::sleep_for(100ms);
+  assert(host.get_node_state("Stale", "Edge01")->is_online);
+  (void)node.disconnect();
+  std::this_thread::sleep_for(200ms);
+  assert(host.get_node_state("Stale", "Edge01")->offline_reason ==
+         sparkplug::OfflineReason::Death);
+  assert(host.check_stale() == 0);
+
+  (void)host.disconnect();
+  std::cout << "[OK] Silent node marked offline by timeout and resumes on data\n";
+}
+
+int main() {
+  std::cout << "=== Stale Detection Tests ===\n";
+  test_wheel_levels();
+  test_stale_monitor();
+  test_ids_with_separators();
+  test_scale();
+  test_live_timeout();
+  std::cout << "\nAll stale detection tests passed!\n";
+  return 0;
+}
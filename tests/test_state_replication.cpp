@@ -0,0 +1,261 @@
+// tests/test_state_replication.cpp
+// Tests for warm-standby host state replication.
+// The live takeover test skips when no MQTT broker is on localhost:1883.
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <format>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include <sparkplug/edge_node.hpp>
+#include <sparkplug/host_application.hpp>
+#include <sparkplug/state_replication.hpp>
+
+using namespace std::chrono_literals;
+
+// Hand-encoded frame builder (single-byte varints only)
+struct FrameBuilder {
+  std::vector<uint8_t> bytes;
+
+  FrameBuilder(uint8_t kind, uint8_t seq, uint8_t count) {
+    bytes = {'S', 'P', 'R', 'S', 1, kind, seq, count};
+  }
+  FrameBuilder& str(std::string_view s) {
+    bytes.push_back(static_cast<uint8_t>(s.size()));
+    bytes.insert(bytes.end(), s.begin(), s.end());
+    return *this;
+  }
+  FrameBuilder& raw(std::initializer_list<uint8_t> values) {
+    bytes.insert(bytes.end(), values);
+    return *this;
+  }
+};
+
+sparkplug::HostApplication make_host(std::string id) {
+  return sparkplug::HostApplication(
+      {.broker_url = "tcp://localhost:1883", .client_id = id, .host_id = id});
+}
+
+// Plant/Edge01: online, seq 7, bdSeq 3, alias 1 = Temp, device Pump01 alias 2 = Speed
+std::vector<uint8_t> sample_snapshot() {
+  FrameBuilder frame(0, 0, 1);
+  frame.str("Plant").str("Edge01").raw({0x07, 7, 3, 100});
+  frame.raw({1, 1}).str("Temp");
+  frame.raw({1}).str("Pump01").raw({0x03, 5, 0, 1, 2}).str("Speed");
+  return frame.bytes;
+}
+
+void check_sample_state(const sparkplug::HostApplication& host) {
+  auto state = host.get_node_state("Plant", "Edge01");
+  assert(state.has_value());
+  assert(state->is_online && state->birth_received);
+  assert(state->last_seq == 7);
+  assert(state->bd_seq == 3);
+  assert(state->birth_timestamp == 100);
+  assert(host.get_metric_name("Plant", "Edge01", "", 1) == "Temp");
+  assert(host.get_metric_name("Plant", "Edge01", "Pump01", 2) == "Speed");
+}
+
+void test_snapshot_round_trip() {
+  auto standby = make_host("ReplStandby");
+  assert(standby.import_state(sample_snapshot()).has_value());
+  check_sample_state(standby);
+
+  // Re-exported state decodes to the same tables
+  auto snapshot = standby.export_state_snapshot();
+  assert(snapshot.size() == sample_snapshot().size());
+  auto second = make_host("ReplSecond");
+  assert(second.import_state(snapshot).has_value());
+  check_sample_state(second);
+
+  // A new snapshot replaces the table wholesale
+  FrameBuilder empty(0, 0, 0);
+  assert(second.import_state(empty.bytes).has_value());
+  assert(!second.get_node_state("Plant", "Edge01").has_value());
+
+  std::cout << "[OK] Snapshot carries seq state and alias tables\n";
+}
+
+void test_delta_ordering() {
+  auto standby = make_host("ReplDelta");
+  FrameBuilder seq_only(1, 1, 1);
+  seq_only.str("Plant").str("Edge01").raw({0x03, 8, 3, 100});
+  assert(!standby.import_state(seq_only.bytes).has_value()); // No snapshot yet
+
+  assert(standby.import_state(sample_snapshot()).has_value());
+  assert(standby.import_state(seq_only.bytes).has_value());
+  assert(standby.get_node_state("Plant", "Edge01")->last_seq == 8);
+  assert(standby.get_metric_name("Plant", "Edge01", "Pump01", 2) == "Speed");
+
+  // A seq-only record for a node without a full record does not create it
+  FrameBuilder unknown(1, 2, 1);
+  unknown.str("Plant").str("Edge99").raw({0x03, 4, 1, 100});
+  assert(standby.import_state(unknown.bytes).has_value());
+  assert(!standby.get_node_state("Plant", "Edge99").has_value());
+
+  // Gaps and damaged frames are rejected without touching state
+  FrameBuilder gap(1, 4, 1);
+  gap.str("Plant").str("Edge01").raw({0x03, 20, 3, 100});
+  auto result = standby.import_state(gap.bytes);
+  assert(!result.has_value());
+  assert(result.error().find("gap") != std::string::npos);
+
+  FrameBuilder next(1, 3, 1);
+  next.str("Plant").str("Edge01").raw({0x03, 9, 3, 100});
+  auto truncated = next.bytes;
+  truncated.pop_back();
+  assert(!standby.import_state(truncated).has_value());
+  truncated = {'X', 'Y'};
+  assert(!standby.import_state(truncated).has_value());
+  assert(standby.get_node_state("Plant", "Edge01")->last_seq == 8);
+  assert(standby.import_state(next.bytes).has_value());
+
+  // Deltas are only exported within a stream started by a snapshot
+  assert(!standby.export_state_delta().has_value());
+  (void)standby.export_state_snapshot();
+  auto delta = standby.export_state_delta();
+  assert(delta.has_value() && delta->empty());
+
+  std::cout << "[OK] Deltas apply in order; gaps and bad frames are rejected\n";
+}
+
+void test_delta_removal() {
+  auto standby = make_host("ReplRemoval");
+  assert(standby.import_state(sample_snapshot()).has_value());
+
+  // Flag 0x10: the active host no longer holds Plant/Edge01
+  FrameBuilder removal(1, 1, 2);
+  removal.str("Plant").str("Edge01").raw({0x10, 0, 0, 0});
+  removal.str("Plant").str("Unknown").raw({0x10, 0, 0, 0}); // Never held: ignored
+  assert(standby.import_state(removal.bytes).has_value());
+  assert(!standby.get_node_state("Plant", "Edge01").has_value());
+  assert(!standby.get_node_state("Plant", "Unknown").has_value());
+  assert(!standby.get_metric_name("Plant", "Edge01", "Pump01", 2).has_value());
+
+  // Snapshots list what exists, so a removal in one is malformed
+  FrameBuilder snapshot(0, 0, 1);
+  snapshot.str("Plant").str("Edge01").raw({0x10, 0, 0, 0});
+  assert(!standby.import_state(snapshot.bytes).has_value());
+
+  std::cout << "[OK] Delta removals drop the node on the standby\n";
+}
+
+void test_channel() {
+  std::string path = std::format("/tmp/sparkplug_repl_{}.sock", getpid());
+  auto standby = sparkplug::ReplicationChannel::listen(path);
+  assert(standby.has_value());
+  auto frame = standby->receive(10ms);
+  assert(frame.has_value() && !frame->has_value()); // Nothing connected yet
+
+  auto active = sparkplug::ReplicationChannel::connect(path);
+  assert(active.has_value());
+  std::vector<uint8_t> large(300000);
+  for (size_t i = 0; i < large.size(); ++i) {
+    large[i] = static_cast<uint8_t>(i * 7);
+  }
+
+  // The large frame needs the reader to drain the socket while it is being sent
+  std::thread sender([&] {
+    assert(active->send(sample_snapshot()).has_value());
+    assert(active->send(large).has_value());
+    assert(active->send({}).has_value());
+  });
+  auto first = standby->receive(2s);
+  assert(first.has_value() && first->has_value());
+  assert(std::ranges::equal(**first, sample_snapshot()));
+  auto second = standby->receive(2s);
+  assert(second.has_value() && second->has_value());
+  assert(std::ranges::equal(**second, large));
+  auto third = standby->receive(2s);
+  assert(third.has_value() && third->has_value() && (*third)->empty());
+  sender.join();
+
+  // A replacement active host is accepted after the first one goes away
+  *active = std::move(*sparkplug::ReplicationChannel::connect(path));
+  assert(active->send(sample_snapshot()).has_value());
+  auto replaced = standby->receive(2s);
+  assert(replaced.has_value() && replaced->has_value());
+  assert(std::ranges::equal(**replaced, sample_snapshot()));
+
+  std::cout << "[OK] Frames cross the local socket intact\n";
+}
+
+void test_state_file() {
+  std::string path = std::format("/tmp/sparkplug_repl_{}.state", getpid());
+  assert(sparkplug::write_state_file(path, sample_snapshot()).has_value());
+  auto data = sparkplug::read_state_file(path);
+  assert(data.has_value() && *data == sample_snapshot());
+
+  auto standby = make_host("ReplFile");
+  assert(standby.import_state(*data).has_value());
+  check_sample_state(standby);
+  unlink(path.c_str());
+  assert(!sparkplug::read_state_file(path).has_value());
+
+  std::cout << "[OK] Shared state file round trip\n";
+}
+
+void test_live_takeover() {
+  auto active = make_host("ReplActive");
+  if (!active.connect()) {
+    std::cout << "[SKIP] Skipping (no MQTT broker): live takeover\n";
+    return;
+  }
+  assert(active.subscribe_node("Repl", "Edge01").has_value());
+  (void)active.export_state_snapshot();
+
+  sparkplug::EdgeNode node({.broker_url = "tcp://localhost:1883",
+                            .client_id = "test_repl_edge",
+                            .group_id = "Repl",
+                            .edge_node_id = "Edge01"});
+  assert(node.connect().has_value());
+  sparkplug::PayloadBuilder birth;
+  birth.add_metric_with_alias("Temperature", 1, 20.0);
+  assert(node.publish_birth(birth).has_value());
+  for (int i = 0; i < 3; ++i) {
+    sparkplug::PayloadBuilder data;
+    data.add_metric_by_alias(1, 21.0 + i);
+    assert(node.publish_data(data).has_value());
+  }
+  std::this_thread::sleep_for(300ms);
+
+  auto standby = make_host("ReplStandbyLive");
+  auto delta = active.export_state_delta();
+  assert(delta.has_value() && !delta->empty());
+  assert(!standby.import_state(*delta).has_value()); // Needs the snapshot first
+  assert(standby.import_state(active.export_state_snapshot()).has_value());
+  assert(standby.get_node_state("Repl", "Edge01")->last_seq == 3);
+  assert(standby.get_metric_name("Repl", "Edge01", "", 1) == "Temperature");
+
+  sparkplug::PayloadBuilder more;
+  more.add_metric_by_alias(1, 30.0);
+  assert(node.publish_data(more).has_value());
+  std::this_thread::sleep_for(200ms);
+  delta = active.export_state_delta();
+  assert(delta.has_value());
+  assert(standby.import_state(*delta).has_value());
+  assert(standby.get_node_state("Repl", "Edge01")->last_seq == 4);
+
+  (void)node.disconnect();
+  (void)active.disconnect();
+  std::cout << "[OK] Standby tracks the active host's view of the fleet ("
+            << delta->size() << "-byte delta)\n";
+}
+
+int main() {
+  std::cout << "=== State Replication Tests ===\n";
+  test_snapshot_round_trip();
+  test_delta_ordering();
+  test_delta_removal();
+  test_channel();
+  test_state_file();
+  test_live_takeover();
+  std::cout << "\nAll state replication tests passed!\n";
+  return 0;
+}
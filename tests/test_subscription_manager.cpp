@@ -0,0 +1,201 @@
+// tests/test_subscription_manager.cpp
+// Tests for the batched, SUBACK-tracked subscription set.
+// The end-to-end test skips when no MQTT broker is on localhost:1883.
+
+#include <cassert>
+#include <chrono>
+#include <format>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <sparkplug/host_application.hpp>
+#include <sparkplug/subscription_manager.hpp>
+
+using namespace std::chrono_literals;
+using sparkplug::SubscriptionManager;
+using sparkplug::SubscriptionState;
+
+void test_batching() {
+  constexpr int kNodes = 3000;
+  SubscriptionManager subscriptions({.max_batch = 100});
+  for (int n = 0; n < kNodes; ++n) {
+    assert(subscriptions.add(std::format("spBv1.0/Plant/+/Edge{:04}/#", n), 1));
+  }
+  assert(!subscriptions.settled());
+
+  std::vector<SubscriptionManager::Batch> batches;
+  assert(subscriptions.plan(batches) == 30);
+  for (const auto& batch : batches) {
+    assert(!batch.unsubscribe && batch.topics.size() == 100);
+    assert(batch.qos.size() == 100 && batch.qos[0] == 1);
+  }
+  assert(subscriptions.state("spBv1.0/Plant/+/Edge0000/#") ==
+         SubscriptionState::InFlight);
+
+  // Nothing changed: nothing to send
+  std::vector<SubscriptionManager::Batch> again;
+  assert(subscriptions.plan(again) == 0);
+
+  for (const auto& batch : batches) {
+    subscriptions.on_subscribed(batch.id, {});
+  }
+  assert(subscriptions.settled());
+  auto stats = subscriptions.stats();
+  assert(stats.desired == kNodes && stats.active == kNodes && stats.pending == 0);
+  assert(stats.batches == 30);
+
+  // One more node costs one small request, not a resend of the set
+  assert(subscriptions.add("spBv1.0/Plant/+/Edge9999/#", 1));
+  assert(!subscriptions.add("spBv1.0/Plant/+/Edge0001/#", 1));
+  again.clear();
+  assert(subscriptions.plan(again) == 1 && again[0].topics.size() == 1);
+
+  std::cout << "[OK] 3000 node filters in 30 SUBSCRIBE packets, diffs stay small\n";
+}
+
+void test_suback_codes() {
+  SubscriptionManager subscriptions;
+  subscriptions.add("spBv1.0/A/#", 1);
+  subscriptions.add("spBv1.0/B/#", 1);
+  subscriptions.add("spBv1.0/C/#", 1);
+  std::vector<SubscriptionManager::Batch> batches;
+  assert(subscriptions.plan(batches) == 1);
+
+  // Granted QoS per topic, in request order; 0x80 is a refusal
+  const auto& topics = batches[0].topics;
+  std::vector<int> granted;
+  for (const auto& topic : topics) {
+    granted.push_back(topic == "spBv1.0/B/#" ? 0x80 : 0);
+  }
+  subscriptions.on_subscribed(batches[0].id, granted);
+  assert(subscriptions.settled());
+  assert(subscriptions.state("spBv1.0/A/#") == SubscriptionState::Active);
+  assert(subscriptions.state("spBv1.0/B/#") == SubscriptionState::Failed);
+  assert(subscriptions.failed_topics() == std::vector<std::string>{"spBv1.0/B/#"});
+  assert(subscriptions.stats().refusals == 1 && subscriptions.stats().failed == 1);
+
+  // Asking again retries a refused filter
+  assert(subscriptions.add("spBv1.0/B/#", 1));
+  batches.clear();
+  assert(subscriptions.plan(batches) == 1 && batches[0].topics.size() == 1);
+
+  // A request that fails as a whole fails each of its filters
+  subscriptions.on_failed(batches[0].id);
+  assert(subscriptions.state("spBv1.0/B/#") == SubscriptionState::Failed);
+
+  std::cout << "[OK] SUBACK codes are tracked per topic filter\n";
+}
+
+void test_changes_in_flight() {
+  SubscriptionManager subscriptions;
+  std::vector<SubscriptionManager::Batch> batches;
+  subscriptions.add("spBv1.0/A/#", 0);
+  subscriptions.plan(batches);
+
+  // Removed while the SUBSCRIBE is in flight: UNSUBSCRIBE once it is granted
+  assert(subscriptions.remove("spBv1.0/A/#"));
+  assert(subscriptions.state("spBv1.0/A/#") == SubscriptionState::None);
+  std::vector<SubscriptionManager::Batch> next;
+  assert(subscriptions.plan(next) == 0);
+  assert(!subscriptions.settled());
+  subscriptions.on_subscribed(batches[0].id, {});
+  assert(subscriptions.plan(next) == 1 && next[0].unsubscribe);
+
+  // Added again while the UNSUBSCRIBE is in flight: SUBSCRIBE after the UNSUBACK
+  assert(subscriptions.add("spBv1.0/A/#", 0));
+  batches.clear();
+  assert(subscriptions.plan(batches) == 0);
+  subscriptions.on_unsubscribed(next[0].id);
+  assert(subscriptions.plan(batches) == 1 && !batches[0].unsubscribe);
+  subscriptions.on_subscribed(batches[0].id, {});
+  assert(subscriptions.state("spBv1.0/A/#") == SubscriptionState::Active);
+
+  // A QoS change resubscribes; removing a never-sent filter sends nothing
+  assert(subscriptions.add("spBv1.0/A/#", 1));
+  batches.clear();
+  assert(subscriptions.plan(batches) == 1 && batches[0].qos[0] == 1);
+  subscriptions.add("spBv1.0/Z/#", 0);
+  assert(subscriptions.remove("spBv1.0/Z/#"));
+  next.clear();
+  assert(subscriptions.plan(next) == 0);
+
+  // A failed UNSUBSCRIBE leaves the subscription active
+  subscriptions.on_subscribed(batches[0].id, {});
+  subscriptions.remove("spBv1.0/A/#");
+  next.clear();
+  subscriptions.plan(next);
+  subscriptions.on_failed(next[0].id);
+  next.clear();
+  assert(subscriptions.plan(next) == 1 && next[0].unsubscribe); // Tried again
+  subscriptions.on_unsubscribed(next[0].id);
+  assert(subscriptions.stats().desired == 0 && subscriptions.settled());
+
+  std::cout << "[OK] Changes made while requests are in flight are applied after\n";
+}
+
+void test_reset_replays() {
+  SubscriptionManager subscriptions({.max_batch = 2});
+  std::vector<SubscriptionManager::Batch> batches;
+  for (const char* topic : {"spBv1.0/A/#", "spBv1.0/B/#", "spBv1.0/C/#"}) {
+    subscriptions.add(topic, 0);
+  }
+  assert(subscriptions.plan(batches) == 2);
+  subscriptions.on_subscribed(batches[0].id, {});
+  subscriptions.remove("spBv1.0/A/#");
+
+  // Reconnect: in-flight requests are forgotten and the desired set is resent
+  subscriptions.reset();
+  subscriptions.on_subscribed(batches[1].id, {}); // Late SUBACK of the old session
+  assert(subscriptions.stats().desired == 2 && subscriptions.stats().pending == 2);
+  batches.clear();
+  assert(subscriptions.plan(batches) == 1 && batches[0].topics.size() == 2);
+  subscriptions.on_subscribed(batches[0].id, {});
+  assert(subscriptions.settled() && subscriptions.stats().active == 2);
+
+  std::cout << "[OK] reset() replays the desired set after a reconnect\n";
+}
+
+void test_host_subscriptions() {
+  sparkplug::HostApplication host({.broker_url = "tcp://localhost:1883",
+                                   .client_id = "test_subscription_host",
+                                   .host_id = "SubscriptionHost",
+                                   .subscribe_batch_size = 50});
+  if (!host.connect()) {
+    std::cout << "[SKIP] Skipping (no MQTT broker): host batched subscriptions\n";
+    return;
+  }
+  std::vector<std::string> nodes;
+  for (int n = 0; n < 500; ++n) {
+    nodes.push_back(std::format("Edge{:03}", n));
+  }
+  assert(host.subscribe_nodes("SubscriptionTest", nodes).has_value());
+  assert(host.subscribe_state("SubscriptionHost").has_value());
+  assert(host.wait_for_subscriptions(5s).has_value());
+  auto stats = host.get_subscription_stats();
+  assert(stats.desired == 501 && stats.active == 501 && stats.batches == 11);
+
+  assert(host.unsubscribe_node("SubscriptionTest", "Edge000").has_value());
+  assert(host.wait_for_subscriptions(5s).has_value());
+  assert(host.get_subscription_stats().desired == 500);
+
+  // Reconnecting restores the set
+  (void)host.disconnect();
+  assert(host.connect().has_value());
+  assert(host.wait_for_subscriptions(5s).has_value());
+  assert(host.get_subscription_stats().active == 500);
+
+  (void)host.disconnect();
+  std::cout << "[OK] Host subscriptions are batched, acknowledged and restored\n";
+}
+
+int main() {
+  std::cout << "=== Subscription Manager Tests ===\n";
+  test_batching();
+  test_suback_codes();
+  test_changes_in_flight();
+  test_reset_replays();
+  test_host_subscriptions();
+  std::cout << "\nAll subscription manager tests passed!\n";
+  return 0;
+}
@@ -0,0 +1,191 @@
+// tests/test_tag_table.cpp
+// Unit tests for the shared-memory tag table and TagTableSource. No broker required.
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <sparkplug/tag_table.hpp>
+
+namespace {
+
+std::string table_name(std::string_view suffix) {
+  return "/sp_tags_" + std::to_string(getpid()) + "_" + std::string(suffix);
+}
+
+const std::vector<sparkplug::TagDefinition> kTags{
+    {.name = "Line1/Speed", .datatype = sparkplug::DataType::Double, .alias = 1},
+    {.name = "Line1/Running", .datatype = sparkplug::DataType::Boolean, .alias = 2},
+    {.name = "Line1/Count", .datatype = sparkplug::DataType::Int32, .alias = 3},
+    {.name = "Line1/Ratio", .datatype = sparkplug::DataType::Float, .alias = 4}};
+
+} // namespace
+
+void test_create_open_write_read() {
+  auto name = table_name("basic");
+  auto table = sparkplug::TagTable::create(name, kTags);
+  assert(table.has_value());
+  assert(table->size() == 4);
+
+  // A driver process attaches separately
+  auto driver = sparkplug::TagTable::open(name);
+  assert(driver.has_value());
+  auto slot = driver->find("Line1/Count");
+  assert(slot == 2u);
+  assert(!driver->find("Nope").has_value());
+
+  assert(driver->write(*slot, static_cast<int32_t>(-5), 1000).has_value());
+  assert(!driver->write(*slot, 1.0, 1000).has_value()); // Type mismatch
+  assert(!driver->write(99, true, 1000).has_value());   // Bad slot
+
+  auto sample = table->read(*slot);
+  assert(sample.has_value());
+  assert(sample->change_count == 1);
+  assert(sample->timestamp == 1000);
+  assert(static_cast<int64_t>(sample->bits) == -5);
+  assert(table->generation() == 1);
+
+  std::cout << "[OK] Driver writes are visible to the owner\n";
+}
+
+void test_source_birth_and_changes() {
+  auto name = table_name("source");
+  auto table = sparkplug::TagTable::create(name, kTags);
+  assert(table.has_value());
+
+  assert(table->write(0, 12.5, 1000).has_value());
+
+  sparkplug::TagTableSource source(*table);
+  sparkplug::PayloadBuilder birth;
+  source.add_birth_metrics(birth);
+
+  const auto& metrics = birth.payload().metrics();
+  assert(metrics.size() == 4);
+  assert(metrics[0].name() == "Line1/Speed" && metrics[0].alias() == 1);
+  assert(metrics[0].double_value() == 12.5);
+  assert(metrics[1].is_null()); // Never written
+
+  sparkplug::PayloadBuilder idle;
+  assert(source.collect_changes(idle) == 0);
+
+  assert(table->write(1, true, 2000).has_value());
+  assert(table->write(3, 0.5f, 2000).has_value());
+  assert(table->write(3, 0.25f, 2001).has_value());
+
+  sparkplug::PayloadBuilder data;
+  assert(source.collect_changes(data) == 2);
+  const auto& changed = data.payload().metrics();
+  assert(changed[0].alias() == 2 && !changed[0].has_name());
+  assert(changed[0].boolean_value());
+  assert(changed[1].alias() == 4);
+  assert(changed[1].float_value() == 0.25f); // Latest value wins
+  assert(changed[1].timestamp() == 2001);
+
+  sparkplug::PayloadBuilder again;
+  assert(source.collect_changes(again) == 0);
+
+  std::cout << "[OK] Source builds birth metrics and reports each change once\n";
+}
+
+void test_invalid_definitions() {
+  std::vector<sparkplug::TagDefinition> strings{
+      {.name = "Label", .datatype = sparkplug::DataType::String, .alias = 1}};
+  assert(!sparkplug::TagTable::create(table_name("bad"), strings).has_value());
+
+  std::vector<sparkplug::TagDefinition> long_name{
+      {.name = std::string(200, 'x'), .datatype = sparkplug::DataType::Int8, .alias = 1}};
+  assert(!sparkplug::TagTable::create(table_name("bad"), long_name).has_value());
+
+  std::cout << "[OK] Unsupported definitions rejected\n";
+}
+
+void test_concurrent_seqlock() {
+  auto name = table_name("seqlock");
+  std::vector<sparkplug::TagDefinition> tags{
+      {.name = "Counter", .datatype = sparkplug::DataType::UInt64, .alias = 1}};
+  auto table = sparkplug::TagTable::create(name, tags);
+  assert(table.has_value());
+  auto driver = sparkplug::TagTable::open(name);
+  assert(driver.has_value());
+
+  std::atomic<bool> done{false};
+  std::thread writer([&] {
+    for (uint64_t i = 1; i <= 100000; ++i) {
+      // Value and timestamp are written together; a torn read would split them
+      (void)driver->write(0, i, i);
+    }
+    done = true;
+  });
+
+  uint64_t last = 0;
+  while (!done) {
+    auto sample = table->read(0);
+    assert(sample.has_value());
+    assert(sample->bits == sample->timestamp);
+    assert(sample->change_count == sample->bits);
+    assert(sample->bits >= last);
+    last = sample->bits;
+  }
+  writer.join();
+  assert(table->read(0)->change_count == 100000);
+
+  std::cout << "[OK] Seqlock readers never observe torn slots\n";
+}
+
+void test_abandoned_write() {
+  auto name = table_name("abandoned");
+  auto table = sparkplug::TagTable::create(name, kTags);
+  assert(table.has_value());
+  assert(table->write(1, true, 1000).has_value());
+  auto generation = table->generation();
+
+  // Simulate a driver killed mid-write: lock slot 1's seq (header, then 128-byte
+  // slots with seq first) through a separate mapping, and never unlock it
+  int fd = shm_open(name.c_str(), O_RDWR, 0);
+  assert(fd >= 0);
+  size_t size = 128 + kTags.size() * 128;
+  void* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  assert(mapping != MAP_FAILED);
+  auto* seq = reinterpret_cast<std::atomic<uint64_t>*>(static_cast<char*>(mapping) +
+                                                       128 + 1 * 128);
+  seq->fetch_add(1);
+
+  // Readers and writers give up instead of spinning forever
+  auto begin = std::chrono::steady_clock::now();
+  assert(!table->read(1).has_value());
+  assert(!table->write(1, false, 2000).has_value());
+  assert(std::chrono::steady_clock::now() - begin < std::chrono::seconds(2));
+  assert(table->read(0).has_value()); // Other slots are unaffected
+  assert(!table->recover(0));          // Not locked
+
+  assert(table->recover(1));
+  assert(!table->recover(1));
+  assert(table->generation() > generation);
+  auto sample = table->read(1);
+  assert(sample && sample->bits == 1 && sample->timestamp == 1000);
+  assert(table->write(1, false, 2000).has_value());
+  assert(table->read(1)->bits == 0);
+  munmap(mapping, size);
+
+  std::cout << "[OK] Slot locked by a dead writer times out and recovers\n";
+}
+
+int main() {
+  std::cout << "=== Tag Table Tests ===\n";
+  test_create_open_write_read();
+  test_source_birth_and_changes();
+  test_invalid_definitions();
+  test_concurrent_seqlock();
+  test_abandoned_write();
+  std::cout << "\nAll tag table tests passed!\n";
+  return 0;
+}